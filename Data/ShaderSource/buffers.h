@@ -19,6 +19,14 @@ struct FrameConsts
     float ambientLight;
     float exposure;
     float gamma;
+    gpuMat4 viewProj;
+    gpuFloat4 eyePos;
+};
+
+// Per entity data, indexed by the object index instance attribute
+struct ObjectData
+{
+    gpuMat4 model;
 };
 
 #endif
\ No newline at end of file
@@ -9,4 +9,9 @@ layout(std140, set = FRAMECONSTS_SLOT, binding = 0) uniform FrameConstsBlock
     FrameConsts g_FrameConsts;
 };
 
+layout(std430, set = OBJECTS_SLOT, binding = 0) readonly buffer ObjectsBlock
+{
+    ObjectData g_Objects[];
+};
+
 #endif
\ No newline at end of file
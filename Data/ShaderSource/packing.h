@@ -0,0 +1,14 @@
+#ifndef PACKING_H
+#define PACKING_H
+
+// Inverse of EncodeOctahedral in VertexPacking.cpp, 'e' is read from a snorm attribute
+vec3 DecodeOctahedral(vec2 e)
+{
+    vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-v.z, 0.0);
+    v.x += v.x >= 0.0 ? -t : t;
+    v.y += v.y >= 0.0 ? -t : t;
+    return normalize(v);
+}
+
+#endif
@@ -11,8 +11,6 @@ IN(0, vec3, inWorldPos);
 IN(1, vec3, inNormal);
 IN(2, vec2, inUV);
 
-DECL_OBJ_PS;
-
 UNIFORM0(0, sampler2D, samplerIrradiance);
 UNIFORM0(1, sampler2D, samplerBRDFLUT);
 UNIFORM0(2, samplerCube, prefilteredMap);
@@ -93,7 +91,7 @@ vec3 perturbNormal()
 void main()
 {		
 	vec3 N = perturbNormal();
-	vec3 V = normalize(g_Obj.EyePos - inWorldPos);
+	vec3 V = normalize(g_FrameConsts.eyePos.xyz - inWorldPos);
 	vec3 R = reflect(-V, N); 
 
 	float metallic = texture(metallicMap, inUV).r;
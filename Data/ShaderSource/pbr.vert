@@ -2,13 +2,14 @@
 #extension GL_ARB_separate_shader_objects : enable
 #extension GL_ARB_shading_language_420pack : enable
 #include "common.h"
+#include "globalbuffers.h"
 
 IN(0, vec3, inPos);
 IN(1, vec3, inNormal);
 IN(2, vec2, inUV);
+IN(3, uint, inObjectIndex);
 
 DECL_POSITION;
-DECL_OBJ_PS;
 
 OUT(0, vec3, outWorldPos);
 OUT(1, vec3, outNormal);
@@ -16,9 +17,10 @@ OUT(2, vec2, outUV);
 
 void main() 
 {
-	outWorldPos = (g_Obj.Model * vec4(inPos, 1.0)).xyz;
-	outNormal = (g_Obj.Model * vec4(inNormal, 0)).xyz;
+	mat4 model = g_Objects[inObjectIndex].model;
+	outWorldPos = (model * vec4(inPos, 1.0)).xyz;
+	outNormal = (model * vec4(inNormal, 0)).xyz;
 	outUV = inUV;
 	outUV.t = 1.0 - inUV.t;
-	gl_Position =  g_Obj.MVP * vec4(inPos, 1.0);
+	gl_Position =  g_FrameConsts.viewProj * vec4(outWorldPos, 1.0);
 }
@@ -0,0 +1,28 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_ARB_shading_language_420pack : enable
+#include "common.h"
+#include "globalbuffers.h"
+#include "packing.h"
+
+// VertexPacked, the model matrix dequantizes the position
+IN(0, vec4, inPos);
+IN(1, vec2, inNormal);
+IN(2, vec2, inUV);
+IN(3, uint, inObjectIndex);
+
+DECL_POSITION;
+
+OUT(0, vec3, outWorldPos);
+OUT(1, vec3, outNormal);
+OUT(2, vec2, outUV);
+
+void main() 
+{
+	mat4 model = g_Objects[inObjectIndex].model;
+	outWorldPos = (model * inPos).xyz;
+	outNormal = (model * vec4(DecodeOctahedral(inNormal), 0)).xyz;
+	outUV = inUV;
+	outUV.t = 1.0 - inUV.t;
+	gl_Position =  g_FrameConsts.viewProj * vec4(outWorldPos, 1.0);
+}
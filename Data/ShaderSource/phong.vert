@@ -2,13 +2,14 @@
 #extension GL_ARB_separate_shader_objects : enable
 #extension GL_ARB_shading_language_420pack : enable
 #include "common.h"
+#include "globalbuffers.h"
 
 DECL_POSITION;
-DECL_OBJ_PS;
 
 IN(0, vec3, position);
 IN(1, vec3, normal);
 IN(2, vec2, texcoord);
+IN(3, uint, objectIndex);
 
 OUT(0, vec3, FragPos);
 OUT(1, vec3, Normal);
@@ -16,8 +17,9 @@ OUT(2, vec2, TexCoord);
 
 void main()
 {
-    gl_Position = g_Obj.MVP * vec4(position, 1.0);
-    FragPos = (g_Obj.Model * vec4(position, 1.0)).xyz;
-    Normal = (g_Obj.Model * vec4(normal, 0)).xyz; // because we have uniform scaling and it doesn't affect normals
+    mat4 model = g_Objects[objectIndex].model;
+    FragPos = (model * vec4(position, 1.0)).xyz;
+    gl_Position = g_FrameConsts.viewProj * vec4(FragPos, 1.0);
+    Normal = (model * vec4(normal, 0)).xyz; // because we have uniform scaling and it doesn't affect normals
     TexCoord = texcoord;
 }
\ No newline at end of file
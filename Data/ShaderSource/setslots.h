@@ -4,5 +4,6 @@
 // Set slot 0 is used by the materials
 #define LIGHTSOURCE_SLOT 1
 #define FRAMECONSTS_SLOT 2
+#define OBJECTS_SLOT 3
 
 #endif
\ No newline at end of file
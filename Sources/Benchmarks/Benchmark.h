@@ -0,0 +1,74 @@
+#pragma once
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+
+/*
+ *  Minimal benchmark framework of LavaBenchmarks.
+ *  BENCHMARK(Name) registers a benchmark at static initialization. Benchmarks print
+ *  their own results, timed with Bench::Timer or Bench::Measure.
+ */
+namespace Bench
+{
+    typedef void(*BenchmarkFunc)();
+
+    struct Benchmark
+    {
+        const char* name;
+        BenchmarkFunc func;
+    };
+
+    std::vector<Benchmark>& GetBenchmarks();
+
+    struct Registrar
+    {
+        Registrar(const char* name, BenchmarkFunc func)
+        {
+            GetBenchmarks().push_back({ name, func });
+        }
+    };
+
+    class Timer
+    {
+    public:
+        Timer() : mStart(std::chrono::high_resolution_clock::now()) { }
+
+        double ElapsedMs() const
+        {
+            auto now = std::chrono::high_resolution_clock::now();
+            return std::chrono::duration<double, std::milli>(now - mStart).count();
+        }
+
+    private:
+        std::chrono::high_resolution_clock::time_point mStart;
+    };
+
+    // Best time in milliseconds of 'repeats' runs of f, the minimum filters out the scheduling noise
+    template<typename F>
+    double Measure(uint32_t repeats, F&& f)
+    {
+        double best = 1e30;
+        for (uint32_t i = 0; i < repeats; i++)
+        {
+            Timer timer;
+            f();
+            double ms = timer.ElapsedMs();
+            best = ms < best ? ms : best;
+        }
+        return best;
+    }
+
+    // Keeps the compiler from removing a computation whose result is otherwise unused
+    template<typename T>
+    void DoNotOptimize(const T& value)
+    {
+        static volatile const void* sink;
+        sink = &value;
+    }
+}
+
+#define BENCHMARK(name) \
+    static void Benchmark_##name(); \
+    static Bench::Registrar Benchmark_##name##_registrar(#name, Benchmark_##name); \
+    static void Benchmark_##name()
@@ -0,0 +1,33 @@
+#include "Benchmark.h"
+#include <Engine\TaskScheduler.h>
+#include <string>
+
+namespace Bench
+{
+    std::vector<Benchmark>& GetBenchmarks()
+    {
+        static std::vector<Benchmark> benchmarks;
+        return benchmarks;
+    }
+}
+
+// Usage: LavaBenchmarks [filter], runs the benchmarks whose name contains the filter
+int main(int argc, char** argv)
+{
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+
+    GTaskScheduler.Init();
+
+    for (const auto& benchmark : Bench::GetBenchmarks())
+    {
+        if (filter && std::string(benchmark.name).find(filter) == std::string::npos)
+            continue;
+
+        printf("== %s\n", benchmark.name);
+        benchmark.func();
+        printf("\n");
+    }
+
+    GTaskScheduler.Destroy();
+    return 0;
+}
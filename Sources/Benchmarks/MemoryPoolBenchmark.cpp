@@ -0,0 +1,81 @@
+#include "Benchmark.h"
+#include <Common\ConcurrentMemoryPool.h>
+#include <MemoryPool.h>
+#include <mutex>
+#include <thread>
+
+using namespace Engine;
+
+namespace
+{
+    // About the size of a StaticMesh or a Material
+    struct PoolObject
+    {
+        char data[96];
+        PoolObject() { data[0] = 1; }
+    };
+
+    const uint32_t ROUNDS = 4000;
+    const uint32_t BATCH = 256;
+
+    // Every thread allocates BATCH objects and frees them, ROUNDS times
+    template<typename Alloc, typename Free>
+    double AllocateAndFree(uint32_t threadCount, Alloc alloc, Free free)
+    {
+        Bench::Timer timer;
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < threadCount; t++)
+        {
+            threads.emplace_back([&]()
+            {
+                std::vector<PoolObject*> objects(BATCH);
+                for (uint32_t r = 0; r < ROUNDS; r++)
+                {
+                    for (auto& p : objects) p = alloc();
+                    Bench::DoNotOptimize(objects.back());
+                    for (auto p : objects) free(p);
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        return timer.ElapsedMs();
+    }
+
+    void PrintResult(const char* name, double ms, uint32_t threadCount)
+    {
+        const double operations = 2.0 * ROUNDS * BATCH * threadCount;
+        printf("%-24s %9.1f ms  %6.1f ns per allocate or free\n", name, ms, ms * 1e6 / operations);
+    }
+}
+
+// The pool of the objects created on loading threads against the single-threaded pool,
+// which needs a lock to be shared, and against the heap
+BENCHMARK(MemoryPools)
+{
+    MemoryPool<PoolObject> pool;
+    ConcurrentMemoryPool<PoolObject> concurrentPool;
+    std::mutex poolMutex;
+
+    for (uint32_t threadCount : { 1u, 8u })
+    {
+        printf("%u threads, %u x %u objects each\n", threadCount, ROUNDS, BATCH);
+        if (threadCount == 1)
+        {
+            PrintResult("MemoryPool", AllocateAndFree(threadCount,
+                [&]() { return pool.newElement(); },
+                [&](PoolObject* p) { pool.deleteElement(p); }), threadCount);
+        }
+        PrintResult("MemoryPool with a mutex", AllocateAndFree(threadCount,
+            [&]() { std::lock_guard<std::mutex> lock(poolMutex); return pool.newElement(); },
+            [&](PoolObject* p) { std::lock_guard<std::mutex> lock(poolMutex); pool.deleteElement(p); }), threadCount);
+        PrintResult("ConcurrentMemoryPool", AllocateAndFree(threadCount,
+            [&]() { return concurrentPool.newElement(); },
+            [&](PoolObject* p) { concurrentPool.deleteElement(p); }), threadCount);
+        PrintResult("new and delete", AllocateAndFree(threadCount,
+            []() { return new PoolObject(); },
+            [](PoolObject* p) { delete p; }), threadCount);
+    }
+}
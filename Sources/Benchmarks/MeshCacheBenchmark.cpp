@@ -0,0 +1,128 @@
+#include "Benchmark.h"
+#include <Engine\MeshFile.h>
+#include <Common\MappedFile.h>
+#include <Common\MeshOptimizer.h>
+#include <Common\VertexDataTypes.h>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+using namespace Engine;
+
+namespace
+{
+    std::string GetTempPath(const char* name)
+    {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+
+    // Rolling terrain as an importer hands it over, every triangle with vertices of its own
+    std::vector<Vertex> CreateTriangleSoup(uint32_t size)
+    {
+        auto vertexAt = [size](uint32_t x, uint32_t z)
+        {
+            Vertex v;
+            float fx = float(x) / size, fz = float(z) / size;
+            v.position = Vector3(fx * 100.f, std::sin(fx * 12.f) * std::cos(fz * 9.f) * 5.f, fz * 100.f);
+            v.normal = Vector3(0.f, 1.f, 0.f);
+            v.texcoord = Vector2(fx, fz);
+            return v;
+        };
+
+        std::vector<Vertex> soup;
+        soup.reserve((size_t)size * size * 6);
+        for (uint32_t z = 0; z < size; z++)
+        {
+            for (uint32_t x = 0; x < size; x++)
+            {
+                soup.push_back(vertexAt(x, z));
+                soup.push_back(vertexAt(x, z + 1));
+                soup.push_back(vertexAt(x + 1, z));
+                soup.push_back(vertexAt(x + 1, z));
+                soup.push_back(vertexAt(x, z + 1));
+                soup.push_back(vertexAt(x + 1, z + 1));
+            }
+        }
+        return soup;
+    }
+
+    // The import of StaticMesh::Load without the file parsing: optimize, build the LODs and write the cache
+    bool ColdLoad(const char* sourcePath, const char* cachePath)
+    {
+        MeshSourceStamp source;
+        if (!MeshFile::GetSourceStamp(sourcePath, source)) return false;
+
+        std::vector<Vertex> vertices(source.size / sizeof(Vertex));
+        std::ifstream fin(sourcePath, std::ifstream::binary);
+        fin.read(reinterpret_cast<char*>(vertices.data()), vertices.size() * sizeof(Vertex));
+        std::vector<uint32_t> indices(vertices.size());
+        for (uint32_t i = 0; i < indices.size(); i++) indices[i] = i;
+
+        OptimizeMesh(vertices, indices);
+        MeshLodChain lods = BuildMeshLods(vertices, indices);
+
+        source.hash = MeshFile::HashFile(sourcePath);
+        float center[3] = { 50.f, 0.f, 50.f };
+        float extent[3] = { 50.f, 5.f, 50.f };
+        return MeshFile::Write(cachePath, source, vertices.data(), sizeof(Vertex), (uint32_t)vertices.size(),
+            indices.data(), (uint32_t)indices.size(), lods, center, extent);
+    }
+
+    // The cache hit of StaticMesh::Load, the copy to 'staging' stands for the one to the staging ring
+    bool WarmLoad(const char* sourcePath, const char* cachePath, std::vector<uint8_t>& staging)
+    {
+        MeshSourceStamp source;
+        if (!MeshFile::GetSourceStamp(sourcePath, source)) return false;
+
+        MappedFile cache;
+        if (!cache.Open(cachePath)) return false;
+        const MeshFileHeader* header = MeshFile::Read(cache.GetData(), cache.GetSize(), sizeof(Vertex));
+        if (!header || !MeshFile::IsUpToDate(*header, sourcePath, source, cachePath)) return false;
+
+        size_t size = cache.GetSize() - (size_t)header->vertexOffset;
+        staging.resize(size);
+        memcpy(staging.data(), cache.GetData() + header->vertexOffset, size);
+        return true;
+    }
+}
+
+// Load time of a 512x512 quad terrain without a cache, with an up to date one and with one whose
+// source got a new write time without changing, which is hashed once and restamped
+BENCHMARK(MeshCache)
+{
+    std::string sourcePath = GetTempPath("LavaBench_mesh.raw");
+    std::string cachePath = sourcePath + MeshFile::EXTENSION;
+    {
+        std::vector<Vertex> soup = CreateTriangleSoup(512);
+        std::ofstream fout(sourcePath, std::ofstream::binary | std::ofstream::trunc);
+        fout.write(reinterpret_cast<const char*>(soup.data()), soup.size() * sizeof(Vertex));
+    }
+
+    bool ok = true;
+    double coldMs = Bench::Measure(1, [&]() { ok &= ColdLoad(sourcePath.c_str(), cachePath.c_str()); });
+
+    std::vector<uint8_t> staging;
+    double warmMs = Bench::Measure(10, [&]() { ok &= WarmLoad(sourcePath.c_str(), cachePath.c_str(), staging); });
+
+    double touchedMs = 0.0, restampedMs = 0.0;
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        std::filesystem::last_write_time(sourcePath,
+            std::filesystem::last_write_time(sourcePath) + std::chrono::seconds(1));
+        Bench::Timer timer;
+        ok &= WarmLoad(sourcePath.c_str(), cachePath.c_str(), staging);
+        double ms = timer.ElapsedMs();
+        touchedMs = i == 0 || ms < touchedMs ? ms : touchedMs;
+        restampedMs += Bench::Measure(10, [&]() { ok &= WarmLoad(sourcePath.c_str(), cachePath.c_str(), staging); }) / 3;
+    }
+
+    printf("%-28s %10.2f ms\n", "cold (optimize, LODs, write)", coldMs);
+    printf("%-28s %10.2f ms  x%.1f\n", "warm", warmMs, coldMs / warmMs);
+    printf("%-28s %10.2f ms\n", "touched source, first load", touchedMs);
+    printf("%-28s %10.2f ms\n", "touched source, next loads", restampedMs);
+    printf("cache %.1f MB, %s\n", staging.size() / (1024.0 * 1024.0), ok ? "all loads hit" : "FAILED");
+
+    std::filesystem::remove(sourcePath);
+    std::filesystem::remove(cachePath);
+}
@@ -0,0 +1,262 @@
+#define OCTREE_IMPL
+#include "Benchmark.h"
+#include "PointOctree.h"
+#include <Octree.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace
+{
+    struct Entity
+    {
+        otr::Vector3 position;
+        otr::Vector3 extent;
+    };
+
+    struct Camera
+    {
+        otr::Vector3 eye;
+        otr::Vector3 forward;
+        float fovY;
+        float aspect;
+        float zNear;
+        float zFar;
+    };
+
+    // Column-major view-projection of a right handed camera with a [0, 1] depth range
+    void GetViewProj(const Camera& cam, float* m)
+    {
+        otr::Vector3 f = cam.forward;
+        otr::Vector3 r(-f.z, 0.f, f.x);
+        float len = std::sqrt(r.x * r.x + r.z * r.z);
+        r = r * (1.f / len);
+        otr::Vector3 u(r.y * f.z - r.z * f.y, r.z * f.x - r.x * f.z, r.x * f.y - r.y * f.x);
+
+        float view[3][4] = {
+            { r.x, r.y, r.z, -(r.x * cam.eye.x + r.y * cam.eye.y + r.z * cam.eye.z) },
+            { u.x, u.y, u.z, -(u.x * cam.eye.x + u.y * cam.eye.y + u.z * cam.eye.z) },
+            { -f.x, -f.y, -f.z, f.x * cam.eye.x + f.y * cam.eye.y + f.z * cam.eye.z } };
+
+        float t = 1.f / std::tan(cam.fovY * 0.5f);
+        float a = cam.zFar / (cam.zNear - cam.zFar);
+        float b = cam.zNear * cam.zFar / (cam.zNear - cam.zFar);
+        for (int col = 0; col < 4; col++)
+        {
+            m[4 * col + 0] = t / cam.aspect * view[0][col];
+            m[4 * col + 1] = t * view[1][col];
+            m[4 * col + 2] = a * view[2][col] + (col == 3 ? b : 0.f);
+            m[4 * col + 3] = -view[2][col];
+        }
+    }
+
+    // Bounding box of the frustum corners, what the world used to query the point octree with
+    void GetViewBounds(const Camera& cam, otr::Vector3& bmin, otr::Vector3& bmax)
+    {
+        otr::Vector3 f = cam.forward;
+        otr::Vector3 r(-f.z, 0.f, f.x);
+        r = r * (1.f / std::sqrt(r.x * r.x + r.z * r.z));
+        otr::Vector3 u(r.y * f.z - r.z * f.y, r.z * f.x - r.x * f.z, r.x * f.y - r.y * f.x);
+
+        bmin = otr::Vector3(1e30f);
+        bmax = otr::Vector3(-1e30f);
+        for (float dist : { cam.zNear, cam.zFar })
+        {
+            float h = dist * std::tan(cam.fovY * 0.5f);
+            float w = h * cam.aspect;
+            for (int i = 0; i < 4; i++)
+            {
+                otr::Vector3 c = cam.eye + f * dist + r * ((i & 1) ? w : -w) + u * ((i & 2) ? h : -h);
+                for (int k = 0; k < 3; k++)
+                {
+                    bmin[k] = std::min(bmin[k], c[k]);
+                    bmax[k] = std::max(bmax[k], c[k]);
+                }
+            }
+        }
+    }
+
+    // Same density for every entity count, so every camera sees about the same number of entities
+    std::vector<Entity> CreateEntities(uint32_t count, float& halfSize)
+    {
+        halfSize = 500.f * std::sqrt(count / 10000.f);
+        std::mt19937 rng(count);
+        std::uniform_real_distribution<float> pos(-halfSize, halfSize);
+        std::uniform_real_distribution<float> height(0.f, 40.f);
+        std::lognormal_distribution<float> size(0.f, 0.8f);
+
+        std::vector<Entity> entities(count);
+        for (auto& e : entities)
+        {
+            e.position = otr::Vector3(pos(rng), height(rng), pos(rng));
+            e.extent = otr::Vector3(std::min(size(rng), 50.f), std::min(size(rng), 50.f), std::min(size(rng), 50.f));
+        }
+        return entities;
+    }
+}
+
+// Culling time, returned entities and missed entities (visible but not returned) of the loose
+// octree frustum query against the point octree queried with the view bounding box
+BENCHMARK(OctreeCulling)
+{
+    constexpr uint32_t VIEW_COUNT = 32;
+    printf("%10s %10s %10s %10s %10s %10s %10s %12s %12s\n", "entities", "visible", "loose hit", "point hit",
+        "loose ms", "point ms", "brute ms", "loose miss", "point miss");
+
+    for (uint32_t count : { 10000u, 100000u, 1000000u })
+    {
+        float halfSize;
+        std::vector<Entity> entities = CreateEntities(count, halfSize);
+
+        otr::Octree<Entity>* loose = otr::Octree<Entity>::New(otr::Vector3(0.f), otr::Vector3(halfSize + 50.f));
+        std::vector<otr::OctreeData<Entity>*> boxes;
+        Bench::PointOctree<Entity> points(otr::Vector3(0.f), otr::Vector3(halfSize + 50.f));
+        for (auto& e : entities)
+        {
+            boxes.push_back(otr::OctreeData<Entity>::New(e.position, e.extent, &e));
+            loose->Insert(boxes.back());
+            points.Insert({ e.position, &e });
+        }
+
+        std::vector<otr::OctreeData<Entity>*> looseResult;
+        std::vector<Entity*> pointResult;
+        std::vector<uint8_t> returned(count);
+        double looseMs = 0.0, pointMs = 0.0, bruteMs = 0.0;
+        uint64_t visible = 0, looseMissed = 0, pointMissed = 0, looseHits = 0, pointHits = 0;
+
+        for (uint32_t v = 0; v < VIEW_COUNT; v++)
+        {
+            float yaw = 6.2831853f * v / VIEW_COUNT;
+            Camera cam = { otr::Vector3(halfSize * 0.3f * std::cos(yaw * 3.f), 20.f, halfSize * 0.3f * std::sin(yaw * 2.f)),
+                otr::Vector3(std::sin(yaw), 0.f, -std::cos(yaw)), 1.0472f, 16.f / 9.f, 0.1f, 400.f };
+
+            float viewProj[16];
+            GetViewProj(cam, viewProj);
+            otr::Frustum frustum = otr::Frustum::FromMatrix(viewProj);
+            otr::Vector3 bmin, bmax;
+            GetViewBounds(cam, bmin, bmax);
+
+            looseMs += Bench::Measure(3, [&]()
+            {
+                looseResult.clear();
+                loose->GetDataInsideFrustum(frustum, looseResult);
+            });
+            pointMs += Bench::Measure(3, [&]()
+            {
+                pointResult.clear();
+                points.GetPointsInsideBox(bmin, bmax, pointResult);
+            });
+
+            // Ground truth, every entity whose box touches the frustum
+            std::vector<uint8_t> inside(count);
+            bruteMs += Bench::Measure(1, [&]()
+            {
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    inside[i] = frustum.Classify(entities[i].position, entities[i].extent) != otr::Containment::OUTSIDE;
+                }
+            });
+
+            looseHits += looseResult.size();
+            pointHits += pointResult.size();
+
+            std::fill(returned.begin(), returned.end(), 0);
+            for (auto* d : looseResult)
+                returned[d->mData - entities.data()] = 1;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                visible += inside[i];
+                looseMissed += inside[i] && !returned[i];
+            }
+
+            std::fill(returned.begin(), returned.end(), 0);
+            for (auto* e : pointResult)
+                returned[e - entities.data()] = 1;
+            for (uint32_t i = 0; i < count; i++)
+                pointMissed += inside[i] && !returned[i];
+        }
+
+        printf("%10u %10.0f %10.0f %10.0f %10.3f %10.3f %10.3f %11.2f%% %11.2f%%\n", count,
+            double(visible) / VIEW_COUNT, double(looseHits) / VIEW_COUNT, double(pointHits) / VIEW_COUNT,
+            looseMs / VIEW_COUNT, pointMs / VIEW_COUNT, bruteMs / VIEW_COUNT,
+            visible ? 100.0 * looseMissed / visible : 0.0, visible ? 100.0 * pointMissed / visible : 0.0);
+
+        // Deletes the data boxes too
+        loose->Delete();
+    }
+}
+
+// Insert and box query throughput and node count of the loose octree for several bucket sizes,
+// with uniformly spread boxes and with boxes packed in a few tight clusters
+BENCHMARK(OctreeBuckets)
+{
+    constexpr uint32_t COUNT = 200000;
+    constexpr uint32_t QUERY_COUNT = 2000;
+    constexpr float HALF_SIZE = 1000.f;
+
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> uniform(-HALF_SIZE, HALF_SIZE);
+    std::normal_distribution<float> cluster(0.f, 2.f);
+    std::uniform_real_distribution<float> size(0.1f, 2.f);
+
+    std::vector<Entity> uniformEntities(COUNT), clusteredEntities(COUNT);
+    std::vector<otr::Vector3> centers(16);
+    for (auto& c : centers)
+        c = otr::Vector3(uniform(rng), uniform(rng), uniform(rng));
+    for (uint32_t i = 0; i < COUNT; i++)
+    {
+        otr::Vector3 extent(size(rng));
+        uniformEntities[i] = { otr::Vector3(uniform(rng), uniform(rng), uniform(rng)), extent };
+        // A share of the clustered boxes are coincident, like instances spawned at the same place
+        const otr::Vector3& c = centers[i % centers.size()];
+        otr::Vector3 offset = i % 4 == 0 ? otr::Vector3(0.f) : otr::Vector3(cluster(rng), cluster(rng), cluster(rng));
+        clusteredEntities[i] = { c + offset, extent };
+    }
+
+    std::vector<otr::Vector3> queries(QUERY_COUNT);
+    for (uint32_t i = 0; i < QUERY_COUNT; i++)
+    {
+        // Half of the queries next to the clusters, half anywhere
+        if (i % 2)
+            queries[i] = centers[i % centers.size()] + otr::Vector3(cluster(rng), cluster(rng), cluster(rng));
+        else
+            queries[i] = otr::Vector3(uniform(rng), uniform(rng), uniform(rng));
+    }
+
+    printf("%10s %8s %14s %14s %10s %10s\n", "layout", "bucket", "insert M/s", "query K/s", "nodes", "hits");
+    for (int layout = 0; layout < 2; layout++)
+    {
+        std::vector<Entity>& entities = layout == 0 ? uniformEntities : clusteredEntities;
+        // About the same number of hits per query in both layouts
+        otr::Vector3 queryExtent(layout == 0 ? 10.f : 1.f);
+        for (uint32_t bucketSize : { 1u, 4u, 8u, 16u, 32u })
+        {
+            otr::Octree<Entity>* octree = nullptr;
+            double insertMs = Bench::Measure(3, [&]()
+            {
+                if (octree)
+                    octree->Delete();
+                octree = otr::Octree<Entity>::New(otr::Vector3(0.f), otr::Vector3(HALF_SIZE + 10.f), bucketSize);
+                for (auto& e : entities)
+                    octree->Insert(otr::OctreeData<Entity>::New(e.position, e.extent, &e));
+            });
+
+            std::vector<otr::OctreeData<Entity>*> result;
+            uint64_t hits = 0;
+            double queryMs = Bench::Measure(3, [&]()
+            {
+                hits = 0;
+                for (const auto& q : queries)
+                {
+                    result.clear();
+                    octree->GetDataInsideBox(q - queryExtent, q + queryExtent, result);
+                    hits += result.size();
+                }
+            });
+
+            printf("%10s %8u %14.2f %14.1f %10zu %10llu\n", layout == 0 ? "uniform" : "clustered", bucketSize,
+                COUNT / insertMs / 1000.0, QUERY_COUNT / queryMs, octree->GetNodeCount(), (unsigned long long)hits);
+            octree->Delete();
+        }
+    }
+}
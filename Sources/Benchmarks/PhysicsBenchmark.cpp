@@ -0,0 +1,239 @@
+#include "Benchmark.h"
+#include <Engine\PhysicsWorld.h>
+#include <Engine\Time.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <thread>
+
+using namespace Engine;
+
+namespace
+{
+    struct StepTimes
+    {
+        double averageMs;
+        double worstMs;
+        uint64_t hash;
+        size_t bodies;
+    };
+
+    // FNV-1a of the final transforms, equal hashes mean the job count didn't change the simulation
+    uint64_t HashBodies(const std::vector<rp3d::RigidBody*>& bodies)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (auto body : bodies)
+        {
+            const rp3d::Transform& t = body->getTransform();
+            const float values[7] = { t.getPosition().x, t.getPosition().y, t.getPosition().z,
+                t.getOrientation().x, t.getOrientation().y, t.getOrientation().z, t.getOrientation().w };
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(values);
+            for (size_t i = 0; i < sizeof(values); i++)
+            {
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+            }
+        }
+        return hash;
+    }
+
+    // 20x20 stacks of 6 boxes or spheres on a static ground, each stack is an island of its own.
+    // Steps it for 'steps' frames of TIME_STEP.
+    StepTimes SimulateStacks(uint32_t jobs, uint32_t steps)
+    {
+        rp3d::BoxShape ground(rp3d::Vector3(200.f, 1.f, 200.f));
+        rp3d::BoxShape box(rp3d::Vector3(0.5f, 0.5f, 0.5f));
+        rp3d::SphereShape sphere(0.5f);
+        const UpdateBodyCBack ignore = [](rp3d::Vector3, rp3d::Quaternion) { };
+
+        PhysicsWorld* world = PhysicsWorld::Allocate();
+        world->Init();
+        world->SetSolverJobCount(jobs);
+        world->PhysicsUpdateCallback = []() { };
+
+        rp3d::RigidBody* floor = world->CreateRigidBody(
+            rp3d::Transform(rp3d::Vector3(0.f, -1.f, 0.f), rp3d::Quaternion::identity()), ignore);
+        floor->setType(rp3d::BodyType::STATIC);
+        floor->addCollisionShape(&ground, rp3d::Transform::identity(), 1.f);
+
+        std::vector<rp3d::RigidBody*> bodies;
+        for (uint32_t x = 0; x < 20; x++)
+        {
+            for (uint32_t z = 0; z < 20; z++)
+            {
+                rp3d::CollisionShape* shape = (x + z) % 4 == 0 ? static_cast<rp3d::CollisionShape*>(&sphere) : &box;
+                for (uint32_t y = 0; y < 6; y++)
+                {
+                    // Slightly off center so that the stacks don't stay balanced
+                    rp3d::Vector3 position(x * 3.f + 0.01f * y, 0.5f + y * 1.01f, z * 3.f);
+                    rp3d::RigidBody* body = world->CreateRigidBody(
+                        rp3d::Transform(position, rp3d::Quaternion::identity()), ignore);
+                    body->addCollisionShape(shape, rp3d::Transform::identity(), 1.f);
+                    bodies.push_back(body);
+                }
+            }
+        }
+
+        g_Time.deltaTime = TIME_STEP;
+        g_Time.fixedDeltaTime = TIME_STEP;
+
+        StepTimes times = {};
+        for (uint32_t i = 0; i < steps; i++)
+        {
+            Bench::Timer timer;
+            world->Update();
+            double ms = timer.ElapsedMs();
+            times.averageMs += ms / steps;
+            times.worstMs = ms > times.worstMs ? ms : times.worstMs;
+        }
+        times.hash = HashBodies(bodies);
+        times.bodies = bodies.size();
+
+        world->Destroy();
+        return times;
+    }
+
+    int32_t gTriggerEvents = 0;
+
+    // Enter and exit events of every trigger, they balance out with the overlapping pairs
+    void CountTriggerEvent(CollisionInfoMarshal& info)
+    {
+        gTriggerEvents += info.event == TriggerEvent::Enter ? 1 : -1;
+    }
+
+    typedef std::pair<uint32_t, uint32_t> IndexPair;
+
+    // Every pair of triggers against each other. The boxes are axis aligned, so their AABBs are exact
+    std::vector<IndexPair> FindPairsBruteForce(const std::vector<rp3d::ProxyShape*>& shapes)
+    {
+        std::vector<rp3d::AABB> bounds;
+        bounds.reserve(shapes.size());
+        for (auto shape : shapes)
+        {
+            bounds.push_back(shape->getWorldAABB());
+        }
+
+        std::vector<IndexPair> pairs;
+        for (uint32_t i = 0; i + 1 < bounds.size(); i++)
+        {
+            for (uint32_t j = i + 1; j < bounds.size(); j++)
+            {
+                if (bounds[i].testCollision(bounds[j]))
+                {
+                    pairs.push_back({ i, j });
+                }
+            }
+        }
+        return pairs;
+    }
+
+    std::vector<IndexPair> GetReportedPairs(const PhysicsWorld& world)
+    {
+        std::vector<IndexPair> pairs;
+        for (const auto& pair : world.GetTriggerPairs())
+        {
+            uint32_t a = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(pair.shape1->getBody()->getUserData()));
+            uint32_t b = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(pair.shape2->getBody()->getUserData()));
+            pairs.push_back({ std::min(a, b), std::max(a, b) });
+        }
+        std::sort(pairs.begin(), pairs.end());
+        return pairs;
+    }
+}
+
+// Physics step time of 400 stacks of boxes and spheres against the number of jobs solving the islands
+BENCHMARK(PhysicsIslands)
+{
+    const uint32_t STEPS = 300;
+    const uint32_t jobCounts[] = { 1, 2, 4, 8 };
+
+    printf("%u hardware threads\n", std::thread::hardware_concurrency());
+    StepTimes single = {};
+    for (uint32_t jobs : jobCounts)
+    {
+        StepTimes times = SimulateStacks(jobs, STEPS);
+        if (jobs == 1)
+        {
+            single = times;
+        }
+        printf("%u jobs: %zu bodies, %u steps, avg %8.3f ms  worst %8.3f ms  x%.2f  hash %016llx %s\n",
+            jobs, times.bodies, STEPS, times.averageMs, times.worstMs, single.averageMs / times.averageMs,
+            (unsigned long long)times.hash, times.hash == single.hash ? "" : "DIFFERS");
+    }
+}
+
+// Trigger update of 10k box triggers on a grid, 5% of them moved every frame, against the
+// brute force test of every pair, which also checks the reported pairs on every frame
+BENCHMARK(Triggers)
+{
+    const uint32_t TRIGGER_COUNT = 10000;
+    const uint32_t FRAMES = 60;
+    const uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(double(TRIGGER_COUNT))));
+
+    rp3d::BoxShape box(rp3d::Vector3(1.f, 1.f, 1.f));
+    PhysicsWorld* world = PhysicsWorld::Allocate();
+    world->Init();
+    world->PhysicsUpdateCallback = []() { };
+
+    // One trigger in ten overlaps a neighbour at the start, more of them do as they wander
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> jitter(0.f, 1.5f);
+    std::uniform_real_distribution<float> move(-1.f, 1.f);
+    std::vector<rp3d::CollisionBody*> bodies;
+    std::vector<rp3d::ProxyShape*> shapes;
+    for (uint32_t i = 0; i < TRIGGER_COUNT; i++)
+    {
+        rp3d::Vector3 position((i % side) * 3.f + jitter(rng), 0.f, (i / side) * 3.f);
+        rp3d::CollisionBody* body = world->CreateCollisionBody(
+            rp3d::Transform(position, rp3d::Quaternion::identity()), nullptr);
+        body->setUserData(reinterpret_cast<void*>(static_cast<uintptr_t>(i)));
+        rp3d::ProxyShape* shape = body->addCollisionShape(&box, rp3d::Transform::identity());
+        world->SetProxyCallback(shape, CountTriggerEvent);
+        bodies.push_back(body);
+        shapes.push_back(shape);
+    }
+
+    g_Time.deltaTime = TIME_STEP;
+    g_Time.fixedDeltaTime = TIME_STEP;
+    gTriggerEvents = 0;
+
+    double updateMs = 0.0, worstMs = 0.0, bruteMs = 0.0;
+    size_t pairCount = 0;
+    uint32_t mismatches = 0;
+    for (uint32_t frame = 0; frame < FRAMES; frame++)
+    {
+        for (uint32_t k = 0; k < TRIGGER_COUNT / 20; k++)
+        {
+            rp3d::CollisionBody* body = bodies[rng() % TRIGGER_COUNT];
+            rp3d::Transform t = body->getTransform();
+            t.setPosition(t.getPosition() + rp3d::Vector3(move(rng), 0.f, 0.f));
+            body->setTransform(t);
+        }
+
+        Bench::Timer timer;
+        world->Update();
+        double ms = timer.ElapsedMs();
+        updateMs += ms / FRAMES;
+        worstMs = std::max(worstMs, ms);
+
+        Bench::Timer bruteTimer;
+        std::vector<IndexPair> expected = FindPairsBruteForce(shapes);
+        bruteMs += bruteTimer.ElapsedMs() / FRAMES;
+
+        if (GetReportedPairs(*world) != expected || gTriggerEvents != 2 * (int32_t)expected.size())
+        {
+            mismatches++;
+        }
+        pairCount += expected.size();
+    }
+
+    printf("%u triggers, %u frames, %.1f pairs per frame\n", TRIGGER_COUNT, FRAMES, double(pairCount) / FRAMES);
+    printf("%-12s avg %8.3f ms  worst %8.3f ms\n", "update", updateMs, worstMs);
+    printf("%-12s avg %8.3f ms\n", "brute force", bruteMs);
+    printf("%s\n", mismatches == 0 ? "pairs match the brute force on every frame" : "FAILED");
+    if (mismatches != 0)
+    {
+        printf("%u frames with different pairs\n", mismatches);
+    }
+
+    world->Destroy();
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <Octree.h>
+
+namespace Bench
+{
+    /*
+     *  The point octree the world culled with before the loose octree, kept to benchmark against it.
+     *  Every leaf holds one point and the world drew the points inside the bounding box of the view
+     *  frustum, so entities whose center is outside that box were never drawn.
+     *  Coincident points make it split forever, only distinct points can be inserted.
+     */
+    template<typename T>
+    class PointOctree
+    {
+    public:
+        struct Point
+        {
+            otr::Vector3 position;
+            T* data;
+        };
+
+        PointOctree(const otr::Vector3& origin, const otr::Vector3& extent)
+            : mOrigin(origin), mExtent(extent), mHasData(false)
+        {
+            for (auto& child : mChild)
+                child = nullptr;
+        }
+
+        ~PointOctree()
+        {
+            for (auto& child : mChild)
+                delete child;
+        }
+
+        int GetOctantContainingPoint(const otr::Vector3& point) const
+        {
+            int octant = 0;
+            if (point.x >= mOrigin.x) octant |= 4;
+            if (point.y >= mOrigin.y) octant |= 2;
+            if (point.z >= mOrigin.z) octant |= 1;
+            return octant;
+        }
+
+        bool IsLeaf() const
+        {
+            return mChild[0] == nullptr;
+        }
+
+        void Insert(const Point& point)
+        {
+            if (IsLeaf())
+            {
+                if (!mHasData)
+                {
+                    mData = point;
+                    mHasData = true;
+                    return;
+                }
+
+                mHasData = false;
+                for (int i = 0; i < OCT_SIZE; ++i)
+                {
+                    otr::Vector3 newOrig = mOrigin;
+                    newOrig.x += mExtent.x * ((i & 4) ? 0.5f : -0.5f);
+                    newOrig.y += mExtent.y * ((i & 2) ? 0.5f : -0.5f);
+                    newOrig.z += mExtent.z * ((i & 1) ? 0.5f : -0.5f);
+                    mChild[i] = new PointOctree(newOrig, mExtent * 0.5f);
+                }
+                mChild[GetOctantContainingPoint(mData.position)]->Insert(mData);
+            }
+            mChild[GetOctantContainingPoint(point.position)]->Insert(point);
+        }
+
+        void GetPointsInsideBox(const otr::Vector3& bmin, const otr::Vector3& bmax, std::vector<T*>& points) const
+        {
+            if (IsLeaf())
+            {
+                if (mHasData && otr::IsPointInsideBox(mData.position, bmin, bmax))
+                {
+                    points.push_back(mData.data);
+                }
+                return;
+            }
+
+            for (int i = 0; i < OCT_SIZE; ++i)
+            {
+                otr::Vector3 cmax = mChild[i]->mOrigin + mChild[i]->mExtent;
+                otr::Vector3 cmin = mChild[i]->mOrigin - mChild[i]->mExtent;
+                if (otr::IsIntersecting(cmin, cmax, bmin, bmax))
+                {
+                    mChild[i]->GetPointsInsideBox(bmin, bmax, points);
+                }
+            }
+        }
+
+    private:
+        static constexpr int OCT_SIZE = 8;
+
+        otr::Vector3 mOrigin;
+        otr::Vector3 mExtent;
+        PointOctree* mChild[OCT_SIZE];
+        Point mData;
+        bool mHasData;
+    };
+}
@@ -0,0 +1,3 @@
+// LavaCore defines the implementation in TextureManager.cpp, which needs a device
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
@@ -0,0 +1,84 @@
+#include "Benchmark.h"
+#include <Engine\TaskScheduler.h>
+#include <stb_image.h>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <string>
+
+namespace
+{
+    // Every image of the texture directory the materials load, the program runs from the repository root
+    std::vector<std::string> GetTextureFiles()
+    {
+        std::vector<std::string> files;
+        std::filesystem::path dir = std::filesystem::path("Data") / "Texture";
+        if (!std::filesystem::exists(dir))
+            return files;
+
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(dir))
+        {
+            std::string ext = entry.path().extension().string();
+            if (ext == ".png" || ext == ".jpg")
+                files.push_back(entry.path().string());
+        }
+        return files;
+    }
+}
+
+// Decode time of the textures with LoadTex2D, one after the other on the main thread, and with
+// LoadTex2DAsync, scheduled on the task scheduler while the main thread only queues them.
+// The upload is the same for both and is left out, it needs a device
+BENCHMARK(TextureLoad)
+{
+    std::vector<std::string> files = GetTextureFiles();
+    if (files.empty())
+    {
+        printf("No texture in Data/Texture, run from the repository root\n");
+        return;
+    }
+
+    uint64_t bytes = 0;
+    double syncMs = Bench::Measure(3, [&]()
+    {
+        bytes = 0;
+        for (const auto& file : files)
+        {
+            int width, height, channels;
+            stbi_uc* pixels = stbi_load(file.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+            bytes += uint64_t(width) * height * 4;
+            stbi_image_free(pixels);
+        }
+    });
+
+    double queueMs = 0.0;
+    double asyncMs = Bench::Measure(3, [&]()
+    {
+        std::mutex mutex;
+        std::condition_variable done;
+        size_t decoded = 0;
+
+        Bench::Timer queueTimer;
+        for (const auto& file : files)
+        {
+            GTaskScheduler.Schedule([&mutex, &done, &decoded, file]()
+            {
+                int width, height, channels;
+                stbi_uc* pixels = stbi_load(file.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+                stbi_image_free(pixels);
+
+                std::lock_guard<std::mutex> lock(mutex);
+                ++decoded;
+                done.notify_one();
+            });
+        }
+        queueMs = queueTimer.ElapsedMs();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&]() { return decoded == files.size(); });
+    });
+
+    printf("%zu textures, %.1f MB decoded\n", files.size(), bytes / (1024.0 * 1024.0));
+    printf("sync:  %8.1f ms on the main thread\n", syncMs);
+    printf("async: %8.1f ms until all are decoded, %.3f ms on the main thread to queue them\n", asyncMs, queueMs);
+}
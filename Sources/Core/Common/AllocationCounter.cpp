@@ -0,0 +1,52 @@
+#include "AllocationCounter.h"
+
+#if _DEBUG
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    thread_local uint64_t tAllocationCount = 0;
+}
+
+uint64_t Engine::GetThreadAllocationCount()
+{
+    return tAllocationCount;
+}
+
+// The other forms of new and delete forward to these ones
+void* operator new(size_t size)
+{
+    ++tAllocationCount;
+    if (void* p = std::malloc(size > 0 ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return ::operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+    std::free(p);
+}
+#endif
@@ -0,0 +1,36 @@
+#pragma once
+#include "Constants.h"
+#include <cstdint>
+
+#if _DEBUG
+namespace Engine
+{
+    // Heap allocations made by the calling thread, counted by the replaced operator new
+    uint64_t GetThreadAllocationCount();
+
+    // Warns when the thread allocated from the heap during the scope
+    class NoAllocationScope
+    {
+    public:
+        explicit NoAllocationScope(const char* name)
+            : mName(name), mStart(GetThreadAllocationCount()) { }
+
+        ~NoAllocationScope()
+        {
+            const uint64_t count = GetThreadAllocationCount() - mStart;
+            if (count > 0)
+            {
+                LOG_WARNING("[LOG] {} made {} heap allocations\n", mName, count);
+            }
+        }
+
+    private:
+        const char* mName;
+        uint64_t mStart;
+    };
+}
+
+#define EXPECT_NO_ALLOCATIONS(name) Engine::NoAllocationScope noAllocationScope_(name)
+#else
+#define EXPECT_NO_ALLOCATIONS(name)
+#endif
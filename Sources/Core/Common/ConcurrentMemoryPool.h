@@ -0,0 +1,249 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace Engine
+{
+    // Thread-safe counterpart of MemoryPool, so objects can be created on a loading
+    // thread and destroyed on the main one. Each thread allocates from and frees to
+    // its own cache without synchronization. A cache that holds too many free slots
+    // hands a batch of them to a lock-free global stack, an empty cache takes a batch
+    // back or carves new slots from a block of its own. Blocks are only released
+    // with the pool. The caches are per type, so there must be one pool per type.
+    template<typename T, size_t BlockSize = 4096>
+    class ConcurrentMemoryPool
+    {
+    public:
+        static constexpr uint32_t BATCH_SIZE = 32;
+
+        ConcurrentMemoryPool() = default;
+        ConcurrentMemoryPool(const ConcurrentMemoryPool&) = delete;
+        ConcurrentMemoryPool& operator=(const ConcurrentMemoryPool&) = delete;
+
+        ~ConcurrentMemoryPool()
+        {
+            // The caches of the other threads must be gone by now
+            if (tCache.owner == this)
+            {
+                tCache = ThreadCache();
+            }
+
+            Block* block = mBlocks.load(std::memory_order_acquire);
+            while (block != nullptr)
+            {
+                Block* next = block->next;
+                operator delete(block);
+                block = next;
+            }
+        }
+
+        T* allocate()
+        {
+            ThreadCache& cache = GetCache();
+            if (cache.freeSlots == nullptr)
+            {
+                if (Slot* batch = PopBatch())
+                {
+                    cache.freeSlots = batch;
+                    cache.freeCount = batch->link.count;
+                }
+                else
+                {
+                    if (cache.currentSlot == cache.lastSlot)
+                    {
+                        AllocateBlock(cache);
+                    }
+                    return reinterpret_cast<T*>(cache.currentSlot++);
+                }
+            }
+
+            Slot* slot = cache.freeSlots;
+            cache.freeSlots = slot->link.next;
+            --cache.freeCount;
+            return reinterpret_cast<T*>(slot);
+        }
+
+        void deallocate(T* p)
+        {
+            if (p == nullptr) return;
+
+            ThreadCache& cache = GetCache();
+            Slot* slot = reinterpret_cast<Slot*>(p);
+            slot->link.next = cache.freeSlots;
+            cache.freeSlots = slot;
+
+            // Keeping one batch lets a thread alternate allocate and free without
+            // going through the global stack
+            if (++cache.freeCount >= 2 * BATCH_SIZE)
+            {
+                Slot* last = cache.freeSlots;
+                for (uint32_t i = 1; i < BATCH_SIZE; ++i)
+                {
+                    last = last->link.next;
+                }
+                Slot* batch = cache.freeSlots;
+                cache.freeSlots = last->link.next;
+                cache.freeCount -= BATCH_SIZE;
+                last->link.next = nullptr;
+                batch->link.count = BATCH_SIZE;
+                PushBatch(batch);
+            }
+        }
+
+        template<class... Args>
+        T* newElement(Args&&... args)
+        {
+            T* result = allocate();
+            new (result) T(std::forward<Args>(args)...);
+            return result;
+        }
+
+        void deleteElement(T* p)
+        {
+            if (p != nullptr)
+            {
+                p->~T();
+                deallocate(p);
+            }
+        }
+
+    private:
+        union Slot;
+
+        struct Link
+        {
+            Slot* next;
+            // Only used by the first slot of a batch on the global stack
+            std::atomic<Slot*> nextBatch;
+            uint32_t count;
+        };
+
+        union Slot
+        {
+            T element;
+            Link link;
+        };
+
+        struct Block
+        {
+            Block* next;
+        };
+
+        struct ThreadCache
+        {
+            ConcurrentMemoryPool* owner = nullptr;
+            Slot* freeSlots = nullptr;
+            uint32_t freeCount = 0;
+            Slot* currentSlot = nullptr;
+            Slot* lastSlot = nullptr;
+
+            // Gives everything back when the thread exits
+            ~ThreadCache()
+            {
+                if (owner != nullptr)
+                {
+                    owner->Flush(*this);
+                }
+            }
+        };
+
+        static constexpr size_t SLOT_OFFSET = (sizeof(Block) + alignof(Slot) - 1) / alignof(Slot) * alignof(Slot);
+        static_assert(BlockSize >= SLOT_OFFSET + 2 * sizeof(Slot), "BlockSize too small.");
+        // The free list head packs a tag in the unused top bits of the pointer against ABA
+        static_assert(sizeof(void*) == 8, "ConcurrentMemoryPool needs 64-bit pointers.");
+        static constexpr int TAG_SHIFT = 48;
+        static constexpr uint64_t POINTER_MASK = (1ull << TAG_SHIFT) - 1;
+
+        static thread_local ThreadCache tCache;
+
+        ThreadCache& GetCache()
+        {
+            ThreadCache& cache = tCache;
+            if (cache.owner == nullptr)
+            {
+                cache.owner = this;
+            }
+            assert(cache.owner == this && "One ConcurrentMemoryPool per type.");
+            return cache;
+        }
+
+        static Slot* Pointer(uint64_t head)
+        {
+            return reinterpret_cast<Slot*>(head & POINTER_MASK);
+        }
+
+        static uint64_t NextHead(uint64_t head, Slot* slot)
+        {
+            const uint64_t tag = (head >> TAG_SHIFT) + 1;
+            return reinterpret_cast<uint64_t>(slot) | (tag << TAG_SHIFT);
+        }
+
+        void PushBatch(Slot* batch)
+        {
+            uint64_t head = mBatches.load(std::memory_order_relaxed);
+            do
+            {
+                batch->link.nextBatch.store(Pointer(head), std::memory_order_relaxed);
+            } while (!mBatches.compare_exchange_weak(head, NextHead(head, batch),
+                std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        Slot* PopBatch()
+        {
+            uint64_t head = mBatches.load(std::memory_order_acquire);
+            while (Slot* batch = Pointer(head))
+            {
+                // The batch can be popped and reused meanwhile, the memory stays
+                // readable and the tag makes the exchange fail
+                Slot* next = batch->link.nextBatch.load(std::memory_order_relaxed);
+                if (mBatches.compare_exchange_weak(head, NextHead(head, next),
+                    std::memory_order_acquire, std::memory_order_acquire))
+                {
+                    return batch;
+                }
+            }
+            return nullptr;
+        }
+
+        void AllocateBlock(ThreadCache& cache)
+        {
+            Block* block = static_cast<Block*>(operator new(BlockSize));
+            block->next = mBlocks.load(std::memory_order_relaxed);
+            while (!mBlocks.compare_exchange_weak(block->next, block,
+                std::memory_order_release, std::memory_order_relaxed)) { }
+
+            char* body = reinterpret_cast<char*>(block) + SLOT_OFFSET;
+            cache.currentSlot = reinterpret_cast<Slot*>(body);
+            cache.lastSlot = cache.currentSlot + (BlockSize - SLOT_OFFSET) / sizeof(Slot);
+        }
+
+        void Flush(ThreadCache& cache)
+        {
+            // The slots never handed out go back as free ones too
+            while (cache.currentSlot != cache.lastSlot)
+            {
+                Slot* slot = cache.currentSlot++;
+                slot->link.next = cache.freeSlots;
+                cache.freeSlots = slot;
+                ++cache.freeCount;
+            }
+
+            if (cache.freeSlots != nullptr)
+            {
+                cache.freeSlots->link.count = cache.freeCount;
+                PushBatch(cache.freeSlots);
+            }
+            cache = ThreadCache();
+        }
+
+        std::atomic<uint64_t> mBatches{ 0 };
+        std::atomic<Block*> mBlocks{ nullptr };
+    };
+
+    template<typename T, size_t BlockSize>
+    thread_local typename ConcurrentMemoryPool<T, BlockSize>::ThreadCache ConcurrentMemoryPool<T, BlockSize>::tCache;
+}
@@ -30,6 +30,7 @@
 #define MAX_TASKS_PER_FRAME 16
 #define MAX_BUFFER_COPY_PER_FRAME 128
 constexpr float TIME_STEP = 1.f / 60.f;
+constexpr float MIN_TIME_STEP = 1.f / 1000.f;
 //#define SINGLE_THREAD
 
 #define MEM_POOL_DECLARE(Type) static Type* Allocate() { return mAllocator.newElement(); } \
@@ -44,6 +45,13 @@ static MemoryPool<Type, (BlockSize)> mAllocator
 
 #define MEM_POOL_DEFINE_SIZE(Type, BlockSize) MemoryPool<Type, (BlockSize)> Type::mAllocator
 
+// For types created and destroyed on several threads, see ConcurrentMemoryPool.h
+#define MEM_POOL_DECLARE_CONCURRENT(Type) static Type* Allocate() { return mAllocator.newElement(); } \
+private: \
+static Engine::ConcurrentMemoryPool<Type> mAllocator
+
+#define MEM_POOL_DEFINE_CONCURRENT(Type) Engine::ConcurrentMemoryPool<Type> Type::mAllocator
+
 namespace Engine
 {
     typedef void(*UpdateCback)();
@@ -0,0 +1,111 @@
+#pragma once
+#include <map>
+#include <iterator>
+#include <cstdint>
+
+namespace Engine
+{
+    // Sub-allocates ranges of a fixed size block, e.g. a big GPU buffer.
+    // Free ranges are kept ordered by offset so a freed range merges with its
+    // neighbours. Allocation is first-fit, the padding needed by the alignment
+    // stays free in front of the returned range.
+    class FreeListAllocator
+    {
+    public:
+        static constexpr uint64_t INVALID_OFFSET = ~0ull;
+
+        void Init(uint64_t size)
+        {
+            mSize = size;
+            mFreeSize = size;
+            mFreeRanges.clear();
+            if (size > 0)
+            {
+                mFreeRanges[0] = size;
+            }
+        }
+
+        // Returns the offset of the range or INVALID_OFFSET if no free range is big enough.
+        // The alignment doesn't have to be a power of two, e.g. a vertex stride
+        uint64_t Allocate(uint64_t size, uint64_t alignment = 1)
+        {
+            if (size == 0 || alignment == 0) return INVALID_OFFSET;
+
+            for (auto it = mFreeRanges.begin(); it != mFreeRanges.end(); ++it)
+            {
+                const uint64_t rangeOffset = it->first;
+                const uint64_t rangeSize = it->second;
+
+                const uint64_t remainder = rangeOffset % alignment;
+                const uint64_t padding = remainder == 0 ? 0 : alignment - remainder;
+                if (padding + size > rangeSize)
+                    continue;
+
+                const uint64_t offset = rangeOffset + padding;
+                const uint64_t tail = rangeSize - padding - size;
+
+                if (padding > 0) it->second = padding;
+                else mFreeRanges.erase(it);
+
+                if (tail > 0)
+                {
+                    mFreeRanges[offset + size] = tail;
+                }
+
+                mFreeSize -= size;
+                return offset;
+            }
+
+            return INVALID_OFFSET;
+        }
+
+        // The range must be one returned by Allocate with the same size
+        void Free(uint64_t offset, uint64_t size)
+        {
+            if (size == 0) return;
+
+            auto next = mFreeRanges.lower_bound(offset);
+            auto it = mFreeRanges.emplace_hint(next, offset, size);
+
+            // Merge with the range before and the one after
+            if (it != mFreeRanges.begin())
+            {
+                auto prev = std::prev(it);
+                if (prev->first + prev->second == offset)
+                {
+                    prev->second += size;
+                    mFreeRanges.erase(it);
+                    it = prev;
+                }
+            }
+
+            if (next != mFreeRanges.end() && it->first + it->second == next->first)
+            {
+                it->second += next->second;
+                mFreeRanges.erase(next);
+            }
+
+            mFreeSize += size;
+        }
+
+        uint64_t GetSize() const { return mSize; }
+        uint64_t GetFreeSize() const { return mFreeSize; }
+        uint32_t GetFreeRangeCount() const { return static_cast<uint32_t>(mFreeRanges.size()); }
+
+        uint64_t GetLargestFreeRange() const
+        {
+            uint64_t largest = 0;
+            for (const auto& range : mFreeRanges)
+            {
+                largest = range.second > largest ? range.second : largest;
+            }
+            return largest;
+        }
+
+    private:
+        // Offset -> size of every free range
+        std::map<uint64_t, uint64_t> mFreeRanges;
+        uint64_t mSize = 0;
+        uint64_t mFreeSize = 0;
+    };
+}
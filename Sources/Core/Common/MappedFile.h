@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+namespace Engine
+{
+    // Read-only view of a whole file mapped in memory
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile() { Close(); }
+
+        bool Open(const char* path);
+        void Close();
+
+        const uint8_t* GetData() const { return mData; }
+        size_t GetSize() const { return mSize; }
+
+    private:
+        void* mFile = nullptr;
+        void* mMapping = nullptr;
+        const uint8_t* mData = nullptr;
+        size_t mSize = 0;
+    };
+}
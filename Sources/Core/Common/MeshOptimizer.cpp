@@ -0,0 +1,213 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Engine
+{
+    namespace
+    {
+        // Size of the LRU cache the scores are tuned for, bigger than the hardware one
+        constexpr uint32_t CACHE_SIZE = 32;
+        constexpr float CACHE_DECAY_POWER = 1.5f;
+        constexpr float LAST_TRI_SCORE = 0.75f;
+        constexpr float VALENCE_BOOST_SCALE = 2.0f;
+        constexpr float VALENCE_BOOST_POWER = 0.5f;
+        constexpr uint32_t VALENCE_TABLE_SIZE = 64;
+
+        struct ScoreTables
+        {
+            float cache[CACHE_SIZE];
+            float valence[VALENCE_TABLE_SIZE];
+
+            ScoreTables()
+            {
+                for (uint32_t i = 0; i < CACHE_SIZE; i++)
+                {
+                    // The vertices of the last triangle get a fixed score so the
+                    // next one doesn't always reuse the same edge
+                    cache[i] = i < 3 ? LAST_TRI_SCORE :
+                        std::pow(1.f - (i - 3) / float(CACHE_SIZE - 3), CACHE_DECAY_POWER);
+                }
+                valence[0] = 0.f;
+                for (uint32_t i = 1; i < VALENCE_TABLE_SIZE; i++)
+                {
+                    valence[i] = VALENCE_BOOST_SCALE * std::pow(float(i), -VALENCE_BOOST_POWER);
+                }
+            }
+        };
+
+        const ScoreTables& GetScoreTables()
+        {
+            static const ScoreTables tables;
+            return tables;
+        }
+
+        // Vertices with few triangles left are boosted so they don't linger
+        float VertexScore(int32_t cachePosition, uint32_t remainingTriangles)
+        {
+            if (remainingTriangles == 0) return -1.f;
+
+            const ScoreTables& tables = GetScoreTables();
+            float score = cachePosition >= 0 ? tables.cache[cachePosition] : 0.f;
+            score += remainingTriangles < VALENCE_TABLE_SIZE ? tables.valence[remainingTriangles] :
+                VALENCE_BOOST_SCALE * std::pow(float(remainingTriangles), -VALENCE_BOOST_POWER);
+            return score;
+        }
+    }
+
+    uint64_t HashBytes(const void* data, size_t size)
+    {
+        // FNV-1a
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    VertexCacheStats AnalyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize)
+    {
+        VertexCacheStats stats = {};
+        if (indices.empty() || vertexCount == 0) return stats;
+
+        // A vertex is in the cache if less than 'cacheSize' misses happened since it was loaded
+        std::vector<uint32_t> loadTime(vertexCount, 0);
+        std::vector<bool> used(vertexCount, false);
+        uint32_t time = cacheSize + 1;
+        uint32_t misses = 0;
+        uint32_t usedCount = 0;
+
+        for (uint32_t index : indices)
+        {
+            if (time - loadTime[index] > cacheSize)
+            {
+                loadTime[index] = time++;
+                ++misses;
+            }
+            if (!used[index])
+            {
+                used[index] = true;
+                ++usedCount;
+            }
+        }
+
+        stats.acmr = misses / float(indices.size() / 3);
+        stats.atvr = misses / float(usedCount);
+        return stats;
+    }
+
+    void OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount)
+    {
+        const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+        if (triangleCount == 0) return;
+
+        // Triangles of every vertex, the first 'remaining' ones aren't emitted yet
+        std::vector<uint32_t> remaining(vertexCount, 0);
+        for (uint32_t index : indices)
+        {
+            ++remaining[index];
+        }
+
+        std::vector<uint32_t> firstTriangle(vertexCount + 1, 0);
+        for (uint32_t v = 0; v < vertexCount; v++)
+        {
+            firstTriangle[v + 1] = firstTriangle[v] + remaining[v];
+        }
+
+        std::vector<uint32_t> adjacency(indices.size());
+        {
+            std::vector<uint32_t> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+            for (uint32_t i = 0; i < indices.size(); i++)
+            {
+                adjacency[fill[indices[i]]++] = i / 3;
+            }
+        }
+
+        std::vector<int32_t> cachePosition(vertexCount, -1);
+        std::vector<float> vertexScore(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; v++)
+        {
+            vertexScore[v] = VertexScore(-1, remaining[v]);
+        }
+
+        std::vector<float> triangleScore(triangleCount);
+        std::vector<bool> emitted(triangleCount, false);
+        uint32_t bestTriangle = 0;
+        for (uint32_t t = 0; t < triangleCount; t++)
+        {
+            const uint32_t* tri = &indices[t * 3];
+            triangleScore[t] = vertexScore[tri[0]] + vertexScore[tri[1]] + vertexScore[tri[2]];
+            if (triangleScore[t] > triangleScore[bestTriangle]) bestTriangle = t;
+        }
+
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+        // The cache after a triangle holds its 3 vertices in front of the previous ones
+        std::vector<uint32_t> cache, nextCache;
+        cache.reserve(CACHE_SIZE + 3);
+        nextCache.reserve(CACHE_SIZE + 3);
+        // Next triangle in index order, used when no triangle touches the cache
+        uint32_t cursor = 0;
+
+        for (uint32_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+        {
+            if (bestTriangle == ~0u)
+            {
+                while (emitted[cursor]) ++cursor;
+                bestTriangle = cursor;
+            }
+
+            const uint32_t tri[3] = { indices[bestTriangle * 3], indices[bestTriangle * 3 + 1], indices[bestTriangle * 3 + 2] };
+            result.insert(result.end(), tri, tri + 3);
+            emitted[bestTriangle] = true;
+
+            for (uint32_t v : tri)
+            {
+                // Remove the triangle from the ones left to the vertex
+                uint32_t* list = &adjacency[firstTriangle[v]];
+                uint32_t* last = list + remaining[v] - 1;
+                *std::find(list, last + 1, bestTriangle) = *last;
+                --remaining[v];
+            }
+
+            nextCache.assign(tri, tri + 3);
+            for (uint32_t v : cache)
+            {
+                if (v != tri[0] && v != tri[1] && v != tri[2]) nextCache.push_back(v);
+            }
+
+            // Score the vertices which moved in or out of the cache and their triangles
+            for (uint32_t i = 0; i < nextCache.size(); i++)
+            {
+                uint32_t v = nextCache[i];
+                cachePosition[v] = i < CACHE_SIZE ? static_cast<int32_t>(i) : -1;
+                vertexScore[v] = VertexScore(cachePosition[v], remaining[v]);
+            }
+
+            bestTriangle = ~0u;
+            float bestScore = -1.f;
+            for (uint32_t v : nextCache)
+            {
+                for (uint32_t i = firstTriangle[v]; i < firstTriangle[v] + remaining[v]; i++)
+                {
+                    uint32_t t = adjacency[i];
+                    const uint32_t* other = &indices[t * 3];
+                    triangleScore[t] = vertexScore[other[0]] + vertexScore[other[1]] + vertexScore[other[2]];
+                    if (triangleScore[t] > bestScore || (triangleScore[t] == bestScore && t < bestTriangle))
+                    {
+                        bestScore = triangleScore[t];
+                        bestTriangle = t;
+                    }
+                }
+            }
+
+            if (nextCache.size() > CACHE_SIZE) nextCache.resize(CACHE_SIZE);
+            cache.swap(nextCache);
+        }
+
+        indices.swap(result);
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <unordered_set>
+
+namespace Engine
+{
+    // Efficiency of the post transform cache for a triangle list
+    struct VertexCacheStats
+    {
+        // Average cache miss ratio, vertices transformed per triangle. 0.5 at best, 3 at worst
+        float acmr;
+        // Average transform to vertex ratio, vertices transformed per vertex used. 1 at best
+        float atvr;
+    };
+
+    struct MeshOptimizeStats
+    {
+        VertexCacheStats before, after;
+        uint32_t weldedVertices;
+        uint32_t removedVertices;
+    };
+
+    uint64_t HashBytes(const void* data, size_t size);
+
+    // Simulates a FIFO cache of 'cacheSize' vertices, about what the hardware has
+    VertexCacheStats AnalyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount,
+        uint32_t cacheSize = 16);
+
+    // Reorders the triangles to reuse the vertices of the last ones, Tom Forsyth's
+    // linear-speed vertex cache optimization. Deterministic, ties go to the first triangle
+    void OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount);
+
+    // Points the indices of identical vertices to the first one. Returns the number of duplicates,
+    // they stay in 'vertices' until OptimizeVertexFetch drops them
+    template<typename T>
+    uint32_t WeldVertices(const std::vector<T>& vertices, std::vector<uint32_t>& indices)
+    {
+        auto hash = [&vertices](uint32_t i) { return static_cast<size_t>(HashBytes(&vertices[i], sizeof(T))); };
+        auto equal = [&vertices](uint32_t a, uint32_t b) { return memcmp(&vertices[a], &vertices[b], sizeof(T)) == 0; };
+        std::unordered_set<uint32_t, decltype(hash), decltype(equal)> unique(vertices.size(), hash, equal);
+
+        std::vector<uint32_t> remap(vertices.size());
+        uint32_t duplicates = 0;
+        for (uint32_t i = 0; i < vertices.size(); i++)
+        {
+            auto result = unique.insert(i);
+            remap[i] = *result.first;
+            if (!result.second) ++duplicates;
+        }
+
+        for (uint32_t& index : indices)
+        {
+            index = remap[index];
+        }
+        return duplicates;
+    }
+
+    // Orders the vertices by first use so the vertex fetches stay local and drops the unused ones
+    template<typename T>
+    void OptimizeVertexFetch(std::vector<T>& vertices, std::vector<uint32_t>& indices)
+    {
+        std::vector<uint32_t> remap(vertices.size(), ~0u);
+        std::vector<T> ordered;
+        ordered.reserve(vertices.size());
+
+        for (uint32_t& index : indices)
+        {
+            if (remap[index] == ~0u)
+            {
+                remap[index] = static_cast<uint32_t>(ordered.size());
+                ordered.push_back(vertices[index]);
+            }
+            index = remap[index];
+        }
+
+        vertices.swap(ordered);
+    }
+
+    // Welds, reorders for the vertex cache and then for the vertex fetch a triangle list.
+    // Index lists which aren't made of triangles are left as they are
+    template<typename T>
+    MeshOptimizeStats OptimizeMesh(std::vector<T>& vertices, std::vector<uint32_t>& indices)
+    {
+        MeshOptimizeStats stats = {};
+        const uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+        stats.before = AnalyzeVertexCache(indices, vertexCount);
+        stats.after = stats.before;
+        if (indices.empty() || indices.size() % 3 != 0)
+            return stats;
+
+        stats.weldedVertices = WeldVertices(vertices, indices);
+        OptimizeVertexCache(indices, vertexCount);
+        OptimizeVertexFetch(vertices, indices);
+
+        stats.removedVertices = vertexCount - static_cast<uint32_t>(vertices.size());
+        stats.after = AnalyzeVertexCache(indices, static_cast<uint32_t>(vertices.size()));
+        return stats;
+    }
+}
@@ -0,0 +1,346 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace Engine
+{
+    namespace
+    {
+        // Meshes under this many triangles aren't worth the LODs
+        constexpr size_t MIN_LOD_TRIANGLES = 512;
+        // A LOD has to drop at least this many of the triangles of the previous one
+        constexpr float MIN_LOD_REDUCTION = 0.1f;
+        // Error allowed to every simplification, relative to the bounding box diagonal
+        constexpr float MAX_LOD_ERROR = 0.01f;
+        // Cosine of the largest rotation of a triangle normal a collapse may cause
+        constexpr float MIN_NORMAL_COSINE = 0.25f;
+
+        struct Position
+        {
+            float x, y, z;
+        };
+
+        Position Sub(const Position& a, const Position& b)
+        {
+            return { a.x - b.x, a.y - b.y, a.z - b.z };
+        }
+
+        Position Cross(const Position& a, const Position& b)
+        {
+            return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+        }
+
+        float Dot(const Position& a, const Position& b)
+        {
+            return a.x * b.x + a.y * b.y + a.z * b.z;
+        }
+
+        // Sum of the squared distances to planes weighted by their triangle area,
+        // the symmetric 4x4 matrix is stored as its upper triangle
+        struct Quadric
+        {
+            double xx, xy, xz, xw, yy, yz, yw, zz, zw, ww;
+            double weight;
+
+            void AddPlane(double a, double b, double c, double d, double w)
+            {
+                xx += w * a * a; xy += w * a * b; xz += w * a * c; xw += w * a * d;
+                yy += w * b * b; yz += w * b * c; yw += w * b * d;
+                zz += w * c * c; zw += w * c * d;
+                ww += w * d * d;
+                weight += w;
+            }
+
+            void Add(const Quadric& q)
+            {
+                xx += q.xx; xy += q.xy; xz += q.xz; xw += q.xw;
+                yy += q.yy; yz += q.yz; yw += q.yw;
+                zz += q.zz; zw += q.zw;
+                ww += q.ww;
+                weight += q.weight;
+            }
+
+            double Evaluate(const Position& p) const
+            {
+                const double x = p.x, y = p.y, z = p.z;
+                double e = xx * x * x + yy * y * y + zz * z * z + ww
+                    + 2.0 * (xy * x * y + xz * x * z + yz * y * z + xw * x + yw * y + zw * z);
+                return std::max(e, 0.0);
+            }
+        };
+
+        // Mean squared distance to the planes of both quadrics when 'p' replaces both ends
+        double CollapseError(const Quadric& a, const Quadric& b, const Position& p)
+        {
+            const double weight = a.weight + b.weight;
+            if (weight <= 0.0) return 0.0;
+            return (a.Evaluate(p) + b.Evaluate(p)) / weight;
+        }
+
+        struct Collapse
+        {
+            double error;
+            uint32_t source;
+            uint32_t target;
+
+            bool operator<(const Collapse& other) const
+            {
+                // Ties are broken by the vertices so the result is deterministic
+                if (error != other.error) return error < other.error;
+                if (source != other.source) return source < other.source;
+                return target < other.target;
+            }
+        };
+
+        struct PositionHash
+        {
+            size_t operator()(const Position& p) const { return static_cast<size_t>(HashBytes(&p, sizeof(p))); }
+        };
+
+        struct PositionEqual
+        {
+            bool operator()(const Position& a, const Position& b) const { return a.x == b.x && a.y == b.y && a.z == b.z; }
+        };
+
+        uint64_t EdgeKey(uint32_t a, uint32_t b)
+        {
+            return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+        }
+    }
+
+    std::vector<uint32_t> SimplifyMesh(const float* positionData, size_t positionStride, size_t vertexCount,
+        const std::vector<uint32_t>& indices, size_t targetIndexCount, float maxError, float& resultError)
+    {
+        resultError = 0.f;
+        std::vector<uint32_t> result(indices);
+        if (indices.empty() || indices.size() % 3 != 0 || indices.size() <= targetIndexCount)
+            return result;
+
+        std::vector<Position> positions(vertexCount);
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(positionData);
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            const float* p = reinterpret_cast<const float*>(bytes + i * positionStride);
+            positions[i] = { p[0], p[1], p[2] };
+        }
+
+        // The vertices sharing a position are split by an attribute seam, the
+        // first one stands for all of them in the quadrics and the topology
+        std::vector<uint32_t> remap(vertexCount);
+        std::vector<uint8_t> locked(vertexCount, 0);
+        {
+            std::unordered_map<Position, uint32_t, PositionHash, PositionEqual> unique(vertexCount);
+            for (uint32_t i = 0; i < vertexCount; i++)
+            {
+                auto inserted = unique.emplace(positions[i], i);
+                remap[i] = inserted.first->second;
+                if (!inserted.second)
+                {
+                    locked[i] = 1;
+                    locked[remap[i]] = 1;
+                }
+            }
+        }
+
+        // Every edge of a closed surface belongs to two triangles, the other ones are borders
+        {
+            std::unordered_map<uint64_t, uint32_t> edges(result.size());
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                for (uint32_t e = 0; e < 3; e++)
+                {
+                    ++edges[EdgeKey(remap[result[i + e]], remap[result[i + (e + 1) % 3]])];
+                }
+            }
+            for (const auto& edge : edges)
+            {
+                if (edge.second != 2)
+                {
+                    locked[edge.first >> 32] = 1;
+                    locked[edge.first & 0xFFFFFFFF] = 1;
+                }
+            }
+        }
+
+        std::vector<Quadric> quadrics(vertexCount, Quadric{});
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            const Position& p0 = positions[result[i]];
+            Position normal = Cross(Sub(positions[result[i + 1]], p0), Sub(positions[result[i + 2]], p0));
+            const float length = std::sqrt(Dot(normal, normal));
+            if (length == 0.f) continue;
+
+            const double a = normal.x / length, b = normal.y / length, c = normal.z / length;
+            const double d = -(a * p0.x + b * p0.y + c * p0.z);
+            const double area = 0.5 * length;
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                quadrics[remap[result[i + k]]].AddPlane(a, b, c, d, area);
+            }
+        }
+
+        const double maxErrorSq = double(maxError) * maxError;
+        std::vector<uint32_t> triangleOffsets(vertexCount + 1);
+        std::vector<uint32_t> vertexTriangles;
+        std::vector<Collapse> collapses;
+        std::vector<uint32_t> collapseTarget(vertexCount);
+        std::vector<uint8_t> touched(vertexCount);
+
+        // Every pass collapses the cheapest edges whose vertices weren't touched by another
+        // collapse of the pass, so the adjacency and the quadrics stay valid until its end
+        size_t indexCount = result.size();
+        while (indexCount > targetIndexCount)
+        {
+            std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+            for (uint32_t index : result)
+            {
+                ++triangleOffsets[index + 1];
+            }
+            for (size_t i = 0; i < vertexCount; i++)
+            {
+                triangleOffsets[i + 1] += triangleOffsets[i];
+            }
+            vertexTriangles.resize(result.size());
+            {
+                std::vector<uint32_t> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+                for (size_t i = 0; i < result.size(); i++)
+                {
+                    vertexTriangles[fill[result[i]]++] = static_cast<uint32_t>(i / 3);
+                }
+            }
+
+            // A locked source keeps its place. The target is the vertex the triangles of
+            // the source use, the one on the same side of a seam
+            collapses.clear();
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                for (uint32_t e = 0; e < 3; e++)
+                {
+                    const uint32_t a = result[i + e];
+                    const uint32_t b = result[i + (e + 1) % 3];
+                    if (!locked[a])
+                        collapses.push_back({ CollapseError(quadrics[a], quadrics[remap[b]], positions[b]), a, b });
+                    if (!locked[b])
+                        collapses.push_back({ CollapseError(quadrics[b], quadrics[remap[a]], positions[a]), b, a });
+                }
+            }
+            std::sort(collapses.begin(), collapses.end());
+
+            for (uint32_t i = 0; i < vertexCount; i++)
+            {
+                collapseTarget[i] = i;
+            }
+            std::fill(touched.begin(), touched.end(), 0);
+
+            size_t collapsed = 0;
+            for (const Collapse& collapse : collapses)
+            {
+                if (collapse.error > maxErrorSq || indexCount <= targetIndexCount) break;
+
+                const uint32_t source = collapse.source;
+                const uint32_t target = collapse.target;
+                if (touched[source] || touched[remap[target]]) continue;
+
+                // The triangles around the source must not flip or turn into slivers
+                const Position& to = positions[target];
+                uint32_t removed = 0;
+                bool valid = true;
+                for (uint32_t t = triangleOffsets[source]; t < triangleOffsets[source + 1] && valid; t++)
+                {
+                    const uint32_t* tri = &result[vertexTriangles[t] * 3];
+                    const uint32_t k = tri[0] == source ? 0 : tri[1] == source ? 1 : 2;
+                    const uint32_t v1 = tri[(k + 1) % 3];
+                    const uint32_t v2 = tri[(k + 2) % 3];
+                    if (remap[v1] == remap[target] || remap[v2] == remap[target])
+                    {
+                        ++removed;
+                        continue;
+                    }
+
+                    const Position& p1 = positions[v1];
+                    const Position& p2 = positions[v2];
+                    Position before = Cross(Sub(p1, positions[source]), Sub(p2, positions[source]));
+                    Position after = Cross(Sub(p1, to), Sub(p2, to));
+                    const float lengths = std::sqrt(Dot(before, before) * Dot(after, after));
+                    valid = Dot(before, after) > MIN_NORMAL_COSINE * lengths;
+                }
+                if (!valid || removed == 0) continue;
+
+                collapseTarget[source] = target;
+                quadrics[remap[target]].Add(quadrics[source]);
+                resultError = std::max(resultError, static_cast<float>(std::sqrt(collapse.error)));
+                indexCount -= 3 * removed;
+                ++collapsed;
+
+                touched[source] = 1;
+                touched[remap[target]] = 1;
+                for (uint32_t t = triangleOffsets[source]; t < triangleOffsets[source + 1]; t++)
+                {
+                    const uint32_t* tri = &result[vertexTriangles[t] * 3];
+                    touched[remap[tri[0]]] = touched[remap[tri[1]]] = touched[remap[tri[2]]] = 1;
+                }
+            }
+
+            if (collapsed == 0) break;
+
+            // Drop the triangles which lost an edge
+            size_t write = 0;
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                const uint32_t a = collapseTarget[result[i]];
+                const uint32_t b = collapseTarget[result[i + 1]];
+                const uint32_t c = collapseTarget[result[i + 2]];
+                if (remap[a] == remap[b] || remap[b] == remap[c] || remap[a] == remap[c]) continue;
+                result[write++] = a;
+                result[write++] = b;
+                result[write++] = c;
+            }
+            result.resize(write);
+            indexCount = write;
+        }
+
+        return result;
+    }
+
+    MeshLodChain BuildMeshLods(const float* positionData, size_t positionStride, size_t vertexCount,
+        std::vector<uint32_t>& indices)
+    {
+        MeshLodChain chain = MeshLodChain::Single(static_cast<uint32_t>(indices.size()));
+        if (indices.size() % 3 != 0 || indices.size() / 3 < MIN_LOD_TRIANGLES)
+            return chain;
+
+        Position bmin = { positionData[0], positionData[1], positionData[2] };
+        Position bmax = bmin;
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(positionData);
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            const float* p = reinterpret_cast<const float*>(bytes + i * positionStride);
+            bmin = { std::min(bmin.x, p[0]), std::min(bmin.y, p[1]), std::min(bmin.z, p[2]) };
+            bmax = { std::max(bmax.x, p[0]), std::max(bmax.y, p[1]), std::max(bmax.z, p[2]) };
+        }
+        Position diagonal = Sub(bmax, bmin);
+        const float maxError = MAX_LOD_ERROR * std::sqrt(Dot(diagonal, diagonal));
+
+        // Every LOD simplifies the previous one, their errors add up
+        std::vector<uint32_t> source(indices);
+        while (chain.count < MAX_MESH_LODS)
+        {
+            float error;
+            std::vector<uint32_t> lod = SimplifyMesh(positionData, positionStride, vertexCount,
+                source, source.size() / 2 / 3 * 3, maxError, error);
+            if (lod.empty() || lod.size() > source.size() * (1.f - MIN_LOD_REDUCTION))
+                break;
+
+            OptimizeVertexCache(lod, static_cast<uint32_t>(vertexCount));
+            const MeshLod& previous = chain.lods[chain.count - 1];
+            chain.lods[chain.count++] = { static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(lod.size()),
+                previous.error + error };
+            indices.insert(indices.end(), lod.begin(), lod.end());
+            source.swap(lod);
+        }
+
+        return chain;
+    }
+}
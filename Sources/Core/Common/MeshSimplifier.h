@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace Engine
+{
+    constexpr uint32_t MAX_MESH_LODS = 4;
+
+    // Indices of a mesh drawn for a level of detail
+    struct MeshLod
+    {
+        // From the first index of the mesh
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        // Estimated distance to the full mesh surface, in local space units
+        float error;
+    };
+
+    // LOD 0 is the full mesh, every next one has about half the triangles of the previous
+    struct MeshLodChain
+    {
+        MeshLod lods[MAX_MESH_LODS];
+        uint32_t count;
+
+        static MeshLodChain Single(uint32_t indexCount) { return { { { 0, indexCount, 0.f } }, 1 }; }
+    };
+
+    // Collapses the edges of the triangle list 'indices' in the order of their quadric error
+    // until it has 'targetIndexCount' indices or the next collapse would move the surface further
+    // than 'maxError'. The collapses keep one of the two vertices so the result indexes the same
+    // vertices. Vertices on a border or on an attribute seam, which share their position with
+    // other vertices, don't move. 'resultError' receives the estimated error of the result
+    std::vector<uint32_t> SimplifyMesh(const float* positions, size_t positionStride, size_t vertexCount,
+        const std::vector<uint32_t>& indices, size_t targetIndexCount, float maxError, float& resultError);
+
+    // Appends the simplified LODs of the triangle list to 'indices', each one ordered for the
+    // vertex cache. Small meshes and the ones that don't simplify only get LOD 0
+    MeshLodChain BuildMeshLods(const float* positions, size_t positionStride, size_t vertexCount,
+        std::vector<uint32_t>& indices);
+
+    template<typename T>
+    MeshLodChain BuildMeshLods(const std::vector<T>& vertices, std::vector<uint32_t>& indices)
+    {
+        if (vertices.empty())
+            return MeshLodChain::Single(static_cast<uint32_t>(indices.size()));
+        return BuildMeshLods(&vertices[0].position.x, sizeof(T), vertices.size(), indices);
+    }
+}
@@ -0,0 +1,386 @@
+#include "MipGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <immintrin.h>
+
+namespace Engine
+{
+    namespace
+    {
+        constexpr uint32_t KAISER_TAPS = 6;
+        // Rows of the destination level given to one task, and the max number of tasks
+        constexpr uint32_t MIN_ROWS_PER_TASK = 16;
+        constexpr uint32_t MAX_TASKS = 32;
+
+        // Zeroth order modified Bessel function of the first kind
+        double BesselI0(double x)
+        {
+            double sum = 1.0;
+            double term = 1.0;
+            for (int k = 1; k < 25; k++)
+            {
+                double f = x / (2.0 * k);
+                term *= f * f;
+                sum += term;
+            }
+            return sum;
+        }
+
+        // Weights of the source texels 2x - 2 ... 2x + 3 for the destination texel x
+        struct KaiserWeights
+        {
+            float w[KAISER_TAPS];
+
+            KaiserWeights()
+            {
+                const double pi = 3.14159265358979323846;
+                const double alpha = 4.0;
+                // In destination texels
+                const double radius = 1.5;
+
+                double total = 0.0;
+                double weights[KAISER_TAPS];
+                for (uint32_t i = 0; i < KAISER_TAPS; i++)
+                {
+                    // Distance from the destination texel center, in destination texels
+                    double d = (i - 2.5) * 0.5;
+                    double sinc = std::sin(pi * d) / (pi * d);
+                    double r = d / radius;
+                    double window = BesselI0(alpha * std::sqrt(1.0 - r * r)) / BesselI0(alpha);
+                    weights[i] = sinc * window;
+                    total += weights[i];
+                }
+
+                for (uint32_t i = 0; i < KAISER_TAPS; i++)
+                {
+                    w[i] = static_cast<float>(weights[i] / total);
+                }
+            }
+        };
+
+        const float* GetKaiserWeights()
+        {
+            static const KaiserWeights weights;
+            return weights.w;
+        }
+
+        const float* GetSRGBToLinear()
+        {
+            static const std::vector<float> lut = []()
+            {
+                std::vector<float> table(256);
+                for (uint32_t i = 0; i < 256; i++)
+                {
+                    double c = i / 255.0;
+                    table[i] = static_cast<float>(c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4));
+                }
+                return table;
+            }();
+            return lut.data();
+        }
+
+        // Indexed by the linear value quantized to 16 bits
+        const uint8_t* GetLinearToSRGB()
+        {
+            static const std::vector<uint8_t> lut = []()
+            {
+                std::vector<uint8_t> table(65536);
+                for (uint32_t i = 0; i < 65536; i++)
+                {
+                    double l = i / 65535.0;
+                    double c = l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+                    table[i] = static_cast<uint8_t>(std::min(255.0, c * 255.0 + 0.5));
+                }
+                return table;
+            }();
+            return lut.data();
+        }
+
+        inline uint32_t ClampIndex(int32_t index, uint32_t size)
+        {
+            return static_cast<uint32_t>(std::min(std::max(index, 0), static_cast<int32_t>(size) - 1));
+        }
+
+        void DownsampleBox(const float* src, uint32_t width, uint32_t height, float* dst,
+            uint32_t rowBegin, uint32_t rowEnd)
+        {
+            const uint32_t dstWidth = NextMipSize(width);
+            const size_t rowFloats = (size_t)width * 4;
+            // A single column is averaged with itself
+            const size_t step = width > 1 ? 4 : 0;
+            const __m128 quarter = _mm_set1_ps(0.25f);
+
+            for (uint32_t y = rowBegin; y < rowEnd; y++)
+            {
+                const float* row0 = src + ClampIndex(2 * y, height) * rowFloats;
+                const float* row1 = src + ClampIndex(2 * y + 1, height) * rowFloats;
+                float* out = dst + (size_t)y * dstWidth * 4;
+                uint32_t x = 0;
+
+#ifdef __AVX2__
+                // Two destination texels per iteration
+                if (width > 1)
+                {
+                    const __m256 quarter8 = _mm256_set1_ps(0.25f);
+                    for (; x + 2 <= dstWidth; x += 2)
+                    {
+                        const float* a = row0 + (size_t)x * 8;
+                        const float* b = row1 + (size_t)x * 8;
+                        __m256 s0 = _mm256_add_ps(_mm256_loadu_ps(a), _mm256_loadu_ps(b));
+                        __m256 s1 = _mm256_add_ps(_mm256_loadu_ps(a + 8), _mm256_loadu_ps(b + 8));
+                        __m256 lo = _mm256_permute2f128_ps(s0, s1, 0x20);
+                        __m256 hi = _mm256_permute2f128_ps(s0, s1, 0x31);
+                        _mm256_storeu_ps(out + (size_t)x * 4, _mm256_mul_ps(_mm256_add_ps(lo, hi), quarter8));
+                    }
+                }
+#endif
+                for (; x < dstWidth; x++)
+                {
+                    const float* a = row0 + (size_t)x * 8;
+                    const float* b = row1 + (size_t)x * 8;
+                    __m128 s = _mm_add_ps(
+                        _mm_add_ps(_mm_loadu_ps(a), _mm_loadu_ps(a + step)),
+                        _mm_add_ps(_mm_loadu_ps(b), _mm_loadu_ps(b + step)));
+                    _mm_storeu_ps(out + (size_t)x * 4, _mm_mul_ps(s, quarter));
+                }
+            }
+        }
+
+        void DownsampleKaiser(const float* src, uint32_t width, uint32_t height, float* dst,
+            uint32_t rowBegin, uint32_t rowEnd)
+        {
+            const float* k = GetKaiserWeights();
+            const uint32_t dstWidth = NextMipSize(width);
+            const size_t rowFloats = (size_t)width * 4;
+            // Vertical pass of the current destination row
+            std::vector<float> column(rowFloats);
+
+            __m128 k4[KAISER_TAPS];
+            for (uint32_t t = 0; t < KAISER_TAPS; t++)
+            {
+                k4[t] = _mm_set1_ps(k[t]);
+            }
+            const __m128 zero = _mm_setzero_ps();
+
+            for (uint32_t y = rowBegin; y < rowEnd; y++)
+            {
+                const float* rows[KAISER_TAPS];
+                for (uint32_t t = 0; t < KAISER_TAPS; t++)
+                {
+                    rows[t] = src + ClampIndex(2 * (int32_t)y - 2 + t, height) * rowFloats;
+                }
+
+                size_t i = 0;
+#ifdef __AVX2__
+                __m256 k8[KAISER_TAPS];
+                for (uint32_t t = 0; t < KAISER_TAPS; t++)
+                {
+                    k8[t] = _mm256_set1_ps(k[t]);
+                }
+                for (; i + 8 <= rowFloats; i += 8)
+                {
+                    __m256 acc = _mm256_mul_ps(k8[0], _mm256_loadu_ps(rows[0] + i));
+                    for (uint32_t t = 1; t < KAISER_TAPS; t++)
+                    {
+                        acc = _mm256_add_ps(acc, _mm256_mul_ps(k8[t], _mm256_loadu_ps(rows[t] + i)));
+                    }
+                    _mm256_storeu_ps(column.data() + i, acc);
+                }
+#endif
+                for (; i < rowFloats; i += 4)
+                {
+                    __m128 acc = _mm_mul_ps(k4[0], _mm_loadu_ps(rows[0] + i));
+                    for (uint32_t t = 1; t < KAISER_TAPS; t++)
+                    {
+                        acc = _mm_add_ps(acc, _mm_mul_ps(k4[t], _mm_loadu_ps(rows[t] + i)));
+                    }
+                    _mm_storeu_ps(column.data() + i, acc);
+                }
+
+                // Horizontal pass, one RGBA texel per register. The negative
+                // lobes can ring below zero next to hard edges
+                float* out = dst + (size_t)y * dstWidth * 4;
+                for (uint32_t x = 0; x < dstWidth; x++)
+                {
+                    __m128 acc = zero;
+                    for (uint32_t t = 0; t < KAISER_TAPS; t++)
+                    {
+                        uint32_t sx = ClampIndex(2 * (int32_t)x - 2 + t, width);
+                        acc = _mm_add_ps(acc, _mm_mul_ps(k4[t], _mm_loadu_ps(column.data() + (size_t)sx * 4)));
+                    }
+                    _mm_storeu_ps(out + (size_t)x * 4, _mm_max_ps(acc, zero));
+                }
+            }
+        }
+
+        // Splits the rows of a level between the tasks of 'parallelFor'
+        void ForEachRowChunk(uint32_t rows, const ParallelForFunc& parallelFor,
+            const std::function<void(uint32_t, uint32_t)>& f)
+        {
+            uint32_t chunkCount = std::min(std::max(1u, rows / MIN_ROWS_PER_TASK), MAX_TASKS);
+            if (!parallelFor || chunkCount == 1)
+            {
+                f(0, rows);
+                return;
+            }
+
+            uint32_t chunkSize = (rows + chunkCount - 1) / chunkCount;
+            parallelFor(chunkCount, [&](uint32_t chunk)
+            {
+                uint32_t begin = chunk * chunkSize;
+                uint32_t end = std::min(begin + chunkSize, rows);
+                if (begin < end) f(begin, end);
+            });
+        }
+
+        void DecodeRGBA8(const uint8_t* src, size_t texels, bool srgb, float* dst)
+        {
+            const float* lut = GetSRGBToLinear();
+            for (size_t i = 0; i < texels * 4; i += 4)
+            {
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    dst[i + c] = srgb ? lut[src[i + c]] : src[i + c] * (1.f / 255.f);
+                }
+                dst[i + 3] = src[i + 3] * (1.f / 255.f);
+            }
+        }
+
+        void EncodeRGBA8(const float* src, size_t texels, bool srgb, uint8_t* dst)
+        {
+            const uint8_t* lut = GetLinearToSRGB();
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 one = _mm_set1_ps(1.f);
+            // sRGB color is quantized to the index of the table, alpha straight to 8 bits
+            const __m128 scale = srgb ? _mm_setr_ps(65535.f, 65535.f, 65535.f, 255.f) : _mm_set1_ps(255.f);
+
+            alignas(16) int32_t q[4];
+            for (size_t i = 0; i < texels * 4; i += 4)
+            {
+                __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), zero), one);
+                _mm_store_si128(reinterpret_cast<__m128i*>(q), _mm_cvtps_epi32(_mm_mul_ps(v, scale)));
+
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    dst[i + c] = srgb ? lut[q[c]] : static_cast<uint8_t>(q[c]);
+                }
+                dst[i + 3] = static_cast<uint8_t>(q[3]);
+            }
+        }
+    }
+
+    void DownsampleRGBA32F(const float* src, uint32_t width, uint32_t height, float* dst,
+        MipFilter filter, uint32_t rowBegin, uint32_t rowEnd)
+    {
+        if (filter == MipFilter::Box)
+            DownsampleBox(src, width, height, dst, rowBegin, rowEnd);
+        else
+            DownsampleKaiser(src, width, height, dst, rowBegin, rowEnd);
+    }
+
+    void DownsampleRGBA32FScalar(const float* src, uint32_t width, uint32_t height, float* dst,
+        MipFilter filter, uint32_t rowBegin, uint32_t rowEnd)
+    {
+        const uint32_t dstWidth = NextMipSize(width);
+        const float* k = GetKaiserWeights();
+
+        auto texel = [&](uint32_t x, uint32_t y) { return src + ((size_t)y * width + x) * 4; };
+
+        for (uint32_t y = rowBegin; y < rowEnd; y++)
+        {
+            for (uint32_t x = 0; x < dstWidth; x++)
+            {
+                float* out = dst + ((size_t)y * dstWidth + x) * 4;
+
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    float sum = 0.f;
+                    if (filter == MipFilter::Box)
+                    {
+                        uint32_t x0 = ClampIndex(2 * x, width), x1 = ClampIndex(2 * x + 1, width);
+                        uint32_t y0 = ClampIndex(2 * y, height), y1 = ClampIndex(2 * y + 1, height);
+                        sum = (texel(x0, y0)[c] + texel(x1, y0)[c] + texel(x0, y1)[c] + texel(x1, y1)[c]) * 0.25f;
+                    }
+                    else
+                    {
+                        for (uint32_t j = 0; j < KAISER_TAPS; j++)
+                        {
+                            uint32_t sy = ClampIndex(2 * (int32_t)y - 2 + j, height);
+                            for (uint32_t i = 0; i < KAISER_TAPS; i++)
+                            {
+                                uint32_t sx = ClampIndex(2 * (int32_t)x - 2 + i, width);
+                                sum += k[j] * k[i] * texel(sx, sy)[c];
+                            }
+                        }
+                        sum = std::max(sum, 0.f);
+                    }
+                    out[c] = sum;
+                }
+            }
+        }
+    }
+
+    std::vector<size_t> GenerateMipChainRGBA32F(std::vector<float>& mips, uint32_t width, uint32_t height,
+        uint32_t levels, MipFilter filter, const ParallelForFunc& parallelFor)
+    {
+        // Every level is allocated first so the tasks never see 'mips' reallocate
+        std::vector<size_t> offsets(levels, 0);
+        size_t total = (size_t)width * height * 4;
+        for (uint32_t level = 1, w = width, h = height; level < levels; level++)
+        {
+            w = NextMipSize(w);
+            h = NextMipSize(h);
+            offsets[level] = total;
+            total += (size_t)w * h * 4;
+        }
+        mips.resize(total);
+
+        for (uint32_t level = 1; level < levels; level++)
+        {
+            const float* src = mips.data() + offsets[level - 1];
+            float* dst = mips.data() + offsets[level];
+
+            ForEachRowChunk(NextMipSize(height), parallelFor, [&](uint32_t begin, uint32_t end)
+            {
+                DownsampleRGBA32F(src, width, height, dst, filter, begin, end);
+            });
+
+            width = NextMipSize(width);
+            height = NextMipSize(height);
+        }
+
+        return offsets;
+    }
+
+    std::vector<size_t> GenerateMipChainRGBA8(std::vector<uint8_t>& mips, uint32_t width, uint32_t height,
+        uint32_t levels, MipFilter filter, bool srgb, const ParallelForFunc& parallelFor)
+    {
+        // The whole chain is filtered from the linear first level, so the
+        // small levels don't pile up the rounding of the bigger ones
+        std::vector<float> linear((size_t)width * height * 4);
+        ForEachRowChunk(height, parallelFor, [&](uint32_t begin, uint32_t end)
+        {
+            size_t offset = (size_t)begin * width * 4;
+            DecodeRGBA8(mips.data() + offset, (size_t)(end - begin) * width, srgb, linear.data() + offset);
+        });
+
+        // A texel takes 4 floats or 4 bytes, the offsets are the same for both
+        std::vector<size_t> offsets = GenerateMipChainRGBA32F(linear, width, height, levels, filter, parallelFor);
+        mips.resize(linear.size());
+
+        for (uint32_t level = 1; level < levels; level++)
+        {
+            width = NextMipSize(width);
+            height = NextMipSize(height);
+            const uint32_t levelWidth = width;
+
+            ForEachRowChunk(height, parallelFor, [&](uint32_t begin, uint32_t end)
+            {
+                size_t offset = offsets[level] + (size_t)begin * levelWidth * 4;
+                EncodeRGBA8(linear.data() + offset, (size_t)(end - begin) * levelWidth, srgb, mips.data() + offset);
+            });
+        }
+
+        return offsets;
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <functional>
+
+namespace Engine
+{
+    enum class MipFilter
+    {
+        // Average of the 2x2 texels under the destination texel
+        Box,
+        // 6x6 Kaiser windowed sinc, keeps more detail than the box without aliasing
+        Kaiser
+    };
+
+    // Runs f(i) for every i in [0, count) and returns when all of them are done,
+    // e.g. TaskScheduler::ParallelFor. The mips are generated serially without one
+    typedef std::function<void(uint32_t, const std::function<void(uint32_t)>&)> ParallelForFunc;
+
+    // Size of the next mip level, odd sizes round down like Vulkan does
+    inline uint32_t NextMipSize(uint32_t size) { return size > 1 ? size / 2 : 1; }
+
+    inline uint32_t GetMipLevelCount(uint32_t width, uint32_t height)
+    {
+        uint32_t levels = 1;
+        while (width > 1 || height > 1)
+        {
+            width = NextMipSize(width);
+            height = NextMipSize(height);
+            ++levels;
+        }
+        return levels;
+    }
+
+    // Writes the rows [rowBegin, rowEnd) of the level after the linear RGBA32F image 'src'.
+    // Uses AVX2 when the build targets it, SSE otherwise
+    void DownsampleRGBA32F(const float* src, uint32_t width, uint32_t height, float* dst,
+        MipFilter filter, uint32_t rowBegin, uint32_t rowEnd);
+    // Plain C++ version of the kernels, the reference of the SIMD ones
+    void DownsampleRGBA32FScalar(const float* src, uint32_t width, uint32_t height, float* dst,
+        MipFilter filter, uint32_t rowBegin, uint32_t rowEnd);
+
+    // 'mips' has to start with the full image, the levels after it are appended.
+    // Return the offset of every level in 'mips', in elements
+    std::vector<size_t> GenerateMipChainRGBA32F(std::vector<float>& mips, uint32_t width, uint32_t height,
+        uint32_t levels, MipFilter filter, const ParallelForFunc& parallelFor = nullptr);
+    // Color is filtered in linear space when 'srgb' is set, alpha is always linear
+    std::vector<size_t> GenerateMipChainRGBA8(std::vector<uint8_t>& mips, uint32_t width, uint32_t height,
+        uint32_t levels, MipFilter filter, bool srgb, const ParallelForFunc& parallelFor = nullptr);
+}
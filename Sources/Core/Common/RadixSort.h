@@ -0,0 +1,64 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+namespace Engine
+{
+    // LSD radix sort on the 64-bit 'key' member of T, 8 bits per pass.
+    // Passes where every key has the same byte are skipped. 'tmp' is scratch
+    // memory kept by the caller so sorting every frame doesn't allocate.
+    template<typename T>
+    void RadixSort(std::vector<T>& items, std::vector<T>& tmp)
+    {
+        constexpr uint32_t PASSES = sizeof(uint64_t);
+        constexpr uint32_t BUCKETS = 256;
+
+        const size_t count = items.size();
+        if (count < 2) return;
+
+        uint32_t histogram[PASSES][BUCKETS];
+        std::memset(histogram, 0, sizeof(histogram));
+
+        for (const T& item : items)
+        {
+            for (uint32_t pass = 0; pass < PASSES; pass++)
+            {
+                ++histogram[pass][(item.key >> (pass * 8)) & 0xFF];
+            }
+        }
+
+        tmp.resize(count);
+        T* src = items.data();
+        T* dst = tmp.data();
+
+        for (uint32_t pass = 0; pass < PASSES; pass++)
+        {
+            uint32_t* bucket = histogram[pass];
+            const uint32_t shift = pass * 8;
+
+            if (bucket[(src[0].key >> shift) & 0xFF] == count)
+                continue;
+
+            uint32_t offset = 0;
+            for (uint32_t b = 0; b < BUCKETS; b++)
+            {
+                uint32_t n = bucket[b];
+                bucket[b] = offset;
+                offset += n;
+            }
+
+            for (size_t i = 0; i < count; i++)
+            {
+                dst[bucket[(src[i].key >> shift) & 0xFF]++] = src[i];
+            }
+
+            std::swap(src, dst);
+        }
+
+        if (src != items.data())
+        {
+            items.swap(tmp);
+        }
+    }
+}
@@ -0,0 +1,165 @@
+#include "TextureResidency.h"
+#include "MipGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+
+namespace Engine
+{
+    void TextureResidency::Init(uint64_t budget, uint64_t maxLoadPerUpdate)
+    {
+        mTextures.clear();
+        mBudget = budget;
+        mMaxLoadPerUpdate = maxLoadPerUpdate;
+        mResidentSize = 0;
+        mFrame = 0;
+    }
+
+    uint32_t TextureResidency::Add(uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t bytesPerTexel)
+    {
+        assert(mipLevels > 0);
+
+        Entry entry;
+        entry.width = width;
+        entry.height = height;
+        entry.mipLevels = mipLevels;
+        entry.bytesPerTexel = bytesPerTexel;
+
+        entry.pinnedMip = 0;
+        while (entry.pinnedMip + 1 < mipLevels &&
+            std::max(width >> entry.pinnedMip, height >> entry.pinnedMip) > MIN_RESIDENT_SIZE)
+        {
+            ++entry.pinnedMip;
+        }
+
+        entry.residentMip = entry.pinnedMip;
+        entry.requestedMip = NO_REQUEST;
+        entry.targetMip = entry.pinnedMip;
+        entry.lastUsed = mFrame;
+
+        mResidentSize += TailSize(entry, entry.pinnedMip);
+        mTextures.push_back(entry);
+        return static_cast<uint32_t>(mTextures.size() - 1);
+    }
+
+    void TextureResidency::Request(uint32_t texture, uint32_t mip)
+    {
+        Entry& entry = mTextures[texture];
+        entry.requestedMip = std::min(entry.requestedMip, std::min(mip, entry.pinnedMip));
+        entry.lastUsed = mFrame;
+    }
+
+    uint32_t TextureResidency::GetMipForScreenSize(uint32_t texture, float pixels) const
+    {
+        const Entry& entry = mTextures[texture];
+        float texels = static_cast<float>(std::max(entry.width, entry.height));
+        if (pixels >= texels) return 0;
+        if (pixels < 1.f) return entry.mipLevels - 1;
+
+        uint32_t mip = static_cast<uint32_t>(std::floor(std::log2(texels / pixels)));
+        return std::min(mip, entry.mipLevels - 1);
+    }
+
+    void TextureResidency::Update(std::vector<Change>& changes)
+    {
+        // Requested textures want their request, the others keep their mips
+        // as a cache until the budget needs the memory
+        uint64_t total = 0;
+        for (Entry& entry : mTextures)
+        {
+            entry.targetMip = std::min(entry.residentMip, entry.requestedMip);
+            total += TailSize(entry, entry.targetMip);
+        }
+
+        // Least recently used textures give their mips back first. The textures
+        // used in this frame only give the mips they didn't request
+        mOrder.resize(mTextures.size());
+        for (uint32_t i = 0; i < mOrder.size(); i++) mOrder[i] = i;
+        std::stable_sort(mOrder.begin(), mOrder.end(), [this](uint32_t a, uint32_t b)
+        {
+            return mTextures[a].lastUsed < mTextures[b].lastUsed;
+        });
+
+        for (uint32_t i = 0; i < mOrder.size() && total > mBudget; i++)
+        {
+            Entry& entry = mTextures[mOrder[i]];
+            uint32_t floor = entry.requestedMip != NO_REQUEST ? entry.requestedMip : entry.pinnedMip;
+            while (total > mBudget && entry.targetMip < floor)
+            {
+                total -= MipSize(entry, entry.targetMip);
+                ++entry.targetMip;
+            }
+        }
+
+        // Still too much, the requests are lowered starting from the biggest mips
+        while (total > mBudget)
+        {
+            Entry* biggest = nullptr;
+            for (Entry& entry : mTextures)
+            {
+                if (entry.targetMip < entry.pinnedMip &&
+                    (!biggest || MipSize(entry, entry.targetMip) > MipSize(*biggest, biggest->targetMip)))
+                {
+                    biggest = &entry;
+                }
+            }
+            if (!biggest) break;
+
+            total -= MipSize(*biggest, biggest->targetMip);
+            ++biggest->targetMip;
+        }
+
+        // Drops are applied right away, loads as long as they fit in the upload limit.
+        // The first load always goes through so a big texture can't stall the others
+        uint64_t loaded = 0;
+        for (uint32_t i = 0; i < mTextures.size(); i++)
+        {
+            Entry& entry = mTextures[i];
+            if (entry.targetMip < entry.residentMip)
+            {
+                uint64_t loadSize = TailSize(entry, entry.targetMip);
+                if (loaded > 0 && loaded + loadSize > mMaxLoadPerUpdate)
+                {
+                    entry.targetMip = entry.residentMip;
+                }
+                else
+                {
+                    loaded += loadSize;
+                }
+            }
+
+            if (entry.targetMip != entry.residentMip)
+            {
+                changes.push_back({ i, entry.residentMip, entry.targetMip });
+                mResidentSize -= TailSize(entry, entry.residentMip);
+                mResidentSize += TailSize(entry, entry.targetMip);
+                entry.residentMip = entry.targetMip;
+            }
+
+            entry.requestedMip = NO_REQUEST;
+        }
+
+        ++mFrame;
+    }
+
+    uint64_t TextureResidency::MipSize(const Entry& entry, uint32_t mip) const
+    {
+        uint32_t width = entry.width, height = entry.height;
+        for (uint32_t i = 0; i < mip; i++)
+        {
+            width = NextMipSize(width);
+            height = NextMipSize(height);
+        }
+        return (uint64_t)width * height * entry.bytesPerTexel;
+    }
+
+    uint64_t TextureResidency::TailSize(const Entry& entry, uint32_t mip) const
+    {
+        uint64_t size = 0;
+        for (uint32_t i = mip; i < entry.mipLevels; i++)
+        {
+            size += MipSize(entry, i);
+        }
+        return size;
+    }
+}
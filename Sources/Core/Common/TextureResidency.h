@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace Engine
+{
+    // Decides which mips of the streamed textures stay in memory under a budget.
+    // Only bookkeeping, the owner of the textures uploads and drops the mips it is told to.
+    // A texture is resident from one mip down to its smallest one, so it only needs
+    // the index of its most detailed resident mip.
+    class TextureResidency
+    {
+    public:
+        // Mips at most this big are never dropped, a texture always has something to sample
+        static constexpr uint32_t MIN_RESIDENT_SIZE = 64;
+
+        struct Change
+        {
+            uint32_t texture;
+            // Most detailed resident mip before and after the change
+            uint32_t oldMip, newMip;
+        };
+
+        // 'maxLoadPerUpdate' limits the bytes of the tails loaded by one Update
+        void Init(uint64_t budget, uint64_t maxLoadPerUpdate);
+        void SetBudget(uint64_t budget) { mBudget = budget; }
+
+        // Returns the handle of the texture, resident from its first pinned mip
+        uint32_t Add(uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t bytesPerTexel);
+
+        // Keeps the most detailed mip requested for the texture until the next Update
+        void Request(uint32_t texture, uint32_t mip);
+        // Mip whose texels cover about one pixel of an object 'pixels' wide on screen
+        uint32_t GetMipForScreenSize(uint32_t texture, float pixels) const;
+
+        // Ends the frame. Loads the requested mips which fit in the budget, evicting
+        // the mips of the least recently used textures first, and appends the
+        // textures whose resident mips changed to 'changes'
+        void Update(std::vector<Change>& changes);
+
+        uint32_t GetResidentMip(uint32_t texture) const { return mTextures[texture].residentMip; }
+        // Bytes of the resident mips of every texture
+        uint64_t GetResidentSize() const { return mResidentSize; }
+        uint64_t GetBudget() const { return mBudget; }
+        uint64_t GetFrame() const { return mFrame; }
+
+    private:
+        static constexpr uint32_t NO_REQUEST = ~0u;
+
+        struct Entry
+        {
+            uint32_t width, height;
+            uint32_t mipLevels;
+            uint32_t bytesPerTexel;
+            // Most detailed mip which is never dropped
+            uint32_t pinnedMip;
+            uint32_t residentMip;
+            // Most detailed mip requested during the frame, NO_REQUEST if unused
+            uint32_t requestedMip;
+            // Mip the texture ends up with after the current Update
+            uint32_t targetMip;
+            uint64_t lastUsed;
+        };
+
+        uint64_t MipSize(const Entry& entry, uint32_t mip) const;
+        // Bytes of the mips from 'mip' down to the smallest one
+        uint64_t TailSize(const Entry& entry, uint32_t mip) const;
+
+        std::vector<Entry> mTextures;
+        // Scratch lists of Update
+        std::vector<uint32_t> mOrder;
+
+        uint64_t mBudget = 0;
+        uint64_t mMaxLoadPerUpdate = 0;
+        uint64_t mResidentSize = 0;
+        uint64_t mFrame = 0;
+    };
+}
@@ -86,6 +86,65 @@ namespace Engine
         }
     };
 
+    // Vertex quantized to 16 bytes. The position is snorm in the mesh bounds, decoded by the
+    // dequantization folded in the model matrix, w is 1. The normal is octahedral, see VertexPacking.h
+    struct VertexPacked
+    {
+        int16_t position[4];
+        int16_t normal[2];
+        uint16_t texcoord[2];
+
+        static vk::VertexInputBindingDescription GetBindingDescription(uint32_t binding = 0,
+            vk::VertexInputRate inputRate = vk::VertexInputRate::eVertex)
+        {
+            return vk::VertexInputBindingDescription(
+                binding,
+                sizeof(VertexPacked),
+                inputRate
+            );
+        }
+
+        static std::array<vk::VertexInputAttributeDescription, 3> GetAttributeDescriptions(uint32_t binding = 0)
+        {
+            return std::array<vk::VertexInputAttributeDescription, 3>
+            {
+                vk::VertexInputAttributeDescription(0, binding, vk::Format::eR16G16B16A16Snorm, offsetof(VertexPacked, position)),
+                vk::VertexInputAttributeDescription(1, binding, vk::Format::eR16G16Snorm, offsetof(VertexPacked, normal)),
+                vk::VertexInputAttributeDescription(2, binding, vk::Format::eR16G16Sfloat, offsetof(VertexPacked, texcoord))
+            };
+        }
+    };
+
+    // VertexExt quantized to 20 bytes like VertexPacked, the tangent is octahedral too
+    struct VertexExtPacked
+    {
+        int16_t position[4];
+        int16_t normal[2];
+        int16_t tangent[2];
+        uint16_t texcoord[2];
+
+        static vk::VertexInputBindingDescription GetBindingDescription(uint32_t binding = 0,
+            vk::VertexInputRate inputRate = vk::VertexInputRate::eVertex)
+        {
+            return vk::VertexInputBindingDescription(
+                binding,
+                sizeof(VertexExtPacked),
+                inputRate
+            );
+        }
+
+        static std::array<vk::VertexInputAttributeDescription, 4> GetAttributeDescriptions(uint32_t binding = 0)
+        {
+            return std::array<vk::VertexInputAttributeDescription, 4>
+            {
+                vk::VertexInputAttributeDescription(0, binding, vk::Format::eR16G16B16A16Snorm, offsetof(VertexExtPacked, position)),
+                vk::VertexInputAttributeDescription(1, binding, vk::Format::eR16G16Snorm, offsetof(VertexExtPacked, normal)),
+                vk::VertexInputAttributeDescription(2, binding, vk::Format::eR16G16Snorm, offsetof(VertexExtPacked, tangent)),
+                vk::VertexInputAttributeDescription(3, binding, vk::Format::eR16G16Sfloat, offsetof(VertexExtPacked, texcoord))
+            };
+        }
+    };
+
 	struct VertexPos
 	{
 		Vector3 position;
@@ -138,10 +197,39 @@ namespace Engine
 		}
 	};
 
+    // Per instance input of the instanced draws, read from binding 1.
+    // The attribute location follows the ones of the vertex type.
+    struct InstanceData
+    {
+        uint32_t objectIndex;
+
+        static vk::VertexInputBindingDescription GetBindingDescription(uint32_t binding = 1,
+            vk::VertexInputRate inputRate = vk::VertexInputRate::eInstance)
+        {
+            return vk::VertexInputBindingDescription(
+                binding,
+                sizeof(InstanceData),
+                inputRate
+            );
+        }
+
+        static std::array<vk::VertexInputAttributeDescription, 1> GetAttributeDescriptions(uint32_t binding = 1,
+            uint32_t location = 0)
+        {
+            return std::array<vk::VertexInputAttributeDescription, 1>
+            {
+                vk::VertexInputAttributeDescription(location, binding, vk::Format::eR32Uint, offsetof(InstanceData, objectIndex))
+            };
+        }
+    };
+
     typedef std::vector<Vertex> VertexList;
     typedef std::vector<VertexPos> VertexPosList;
     typedef std::vector<Vertex2D> Vertex2DList;
     typedef std::vector<VertexExt> VertexExtList;
     typedef std::vector<VertexUI> VertexUIList;
+    typedef std::vector<VertexPacked> VertexPackedList;
+    typedef std::vector<VertexExtPacked> VertexExtPackedList;
+    typedef std::vector<InstanceData> InstanceDataList;
     typedef std::vector<uint32_t> IndexList;
 }
\ No newline at end of file
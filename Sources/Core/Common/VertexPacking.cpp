@@ -0,0 +1,256 @@
+#include "VertexPacking.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Engine
+{
+    namespace
+    {
+        constexpr float SNORM16_MAX = 32767.f;
+        constexpr float RAD_TO_DEG = 57.2957795f;
+
+        float Length(const Vector3& v)
+        {
+            return std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+        }
+
+        // Angle between 'a' and the unit vector 'b' in degrees, 0 if 'a' is a zero vector
+        float AngleBetween(const Vector3& a, const Vector3& b)
+        {
+            float length = Length(a);
+            if (length == 0.f) return 0.f;
+            float cosine = (a.x * b.x + a.y * b.y + a.z * b.z) / length;
+            return std::acos(std::min(1.f, std::max(-1.f, cosine))) * RAD_TO_DEG;
+        }
+
+        void PackPosition(const Vector3& p, const VertexQuantization& q, int16_t out[4])
+        {
+            const float invScale = 1.f / q.scale;
+            out[0] = FloatToSnorm16((p.x - q.bias.x) * invScale);
+            out[1] = FloatToSnorm16((p.y - q.bias.y) * invScale);
+            out[2] = FloatToSnorm16((p.z - q.bias.z) * invScale);
+            // w is read as 1 so the dequantization can be folded in the model matrix
+            out[3] = static_cast<int16_t>(SNORM16_MAX);
+        }
+
+        Vector3 UnpackPosition(const int16_t in[4], const VertexQuantization& q)
+        {
+            return Vector3(
+                Snorm16ToFloat(in[0]) * q.scale + q.bias.x,
+                Snorm16ToFloat(in[1]) * q.scale + q.bias.y,
+                Snorm16ToFloat(in[2]) * q.scale + q.bias.z);
+        }
+
+        float PositionError(const Vector3& a, const Vector3& b)
+        {
+            return std::max(std::fabs(a.x - b.x), std::max(std::fabs(a.y - b.y), std::fabs(a.z - b.z)));
+        }
+
+        float TexcoordError(const Vector2& a, const Vector2& b)
+        {
+            return std::max(std::fabs(a.x - b.x), std::fabs(a.y - b.y));
+        }
+    }
+
+    VertexQuantization VertexQuantization::FromBounds(const Vector3& center, const Vector3& extent)
+    {
+        VertexQuantization q;
+        q.bias = center;
+        q.scale = std::max(extent.x, std::max(extent.y, extent.z));
+        // Flat meshes still need a scale, a point can use any
+        if (!(q.scale > 0.f)) q.scale = 1.f;
+        return q;
+    }
+
+    uint16_t FloatToHalf(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(float));
+        const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+        const uint32_t abs = bits & 0x7FFFFFFF;
+
+        // Infinity and NaN, which stays a quiet NaN
+        if (abs >= 0x7F800000)
+            return static_cast<uint16_t>(sign | 0x7C00 | (abs > 0x7F800000 ? 0x200 : 0));
+        // Rounds past the largest half, 65504
+        if (abs >= 0x477FF000)
+            return static_cast<uint16_t>(sign | 0x7C00);
+        // Below the smallest normal half, 2^-14, the value is a multiple of 2^-24
+        if (abs < 0x38800000)
+        {
+            float absValue;
+            std::memcpy(&absValue, &abs, sizeof(float));
+            return static_cast<uint16_t>(sign | static_cast<uint16_t>(std::nearbyint(absValue * 16777216.f)));
+        }
+
+        // Rebias the exponent from 127 to 15 and round the 13 dropped bits to nearest even
+        const uint32_t rounded = abs + 0xFFF + ((abs >> 13) & 1);
+        return static_cast<uint16_t>(sign | ((rounded - 0x38000000) >> 13));
+    }
+
+    float HalfToFloat(uint16_t value)
+    {
+        const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+        const uint32_t exponent = (value >> 10) & 0x1F;
+        const uint32_t mantissa = value & 0x3FF;
+
+        uint32_t bits;
+        if (exponent == 0)
+        {
+            float subnormal = mantissa * (1.f / 16777216.f);
+            std::memcpy(&bits, &subnormal, sizeof(float));
+            bits |= sign;
+        }
+        else if (exponent == 0x1F)
+        {
+            bits = sign | 0x7F800000 | (mantissa << 13);
+        }
+        else
+        {
+            bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+        }
+
+        float result;
+        std::memcpy(&result, &bits, sizeof(float));
+        return result;
+    }
+
+    int16_t FloatToSnorm16(float value)
+    {
+        value = std::min(1.f, std::max(-1.f, value));
+        return static_cast<int16_t>(std::lround(value * SNORM16_MAX));
+    }
+
+    float Snorm16ToFloat(int16_t value)
+    {
+        return std::max(value / SNORM16_MAX, -1.f);
+    }
+
+    void EncodeOctahedral(const Vector3& v, int16_t out[2])
+    {
+        const float l1 = std::fabs(v.x) + std::fabs(v.y) + std::fabs(v.z);
+        if (l1 == 0.f)
+        {
+            out[0] = out[1] = 0;
+            return;
+        }
+
+        float x = v.x / l1;
+        float y = v.y / l1;
+        // The lower hemisphere is folded over the diagonals of the square
+        if (v.z < 0.f)
+        {
+            const float foldedX = (1.f - std::fabs(y)) * (x >= 0.f ? 1.f : -1.f);
+            const float foldedY = (1.f - std::fabs(x)) * (y >= 0.f ? 1.f : -1.f);
+            x = foldedX;
+            y = foldedY;
+        }
+
+        out[0] = FloatToSnorm16(x);
+        out[1] = FloatToSnorm16(y);
+    }
+
+    Vector3 DecodeOctahedral(const int16_t in[2])
+    {
+        Vector3 v(Snorm16ToFloat(in[0]), Snorm16ToFloat(in[1]), 0.f);
+        v.z = 1.f - std::fabs(v.x) - std::fabs(v.y);
+        const float t = std::max(-v.z, 0.f);
+        v.x += v.x >= 0.f ? -t : t;
+        v.y += v.y >= 0.f ? -t : t;
+
+        const float invLength = 1.f / Length(v);
+        return Vector3(v.x * invLength, v.y * invLength, v.z * invLength);
+    }
+
+    VertexPacked PackVertex(const Vertex& vertex, const VertexQuantization& q)
+    {
+        VertexPacked packed;
+        PackPosition(vertex.position, q, packed.position);
+        EncodeOctahedral(vertex.normal, packed.normal);
+        packed.texcoord[0] = FloatToHalf(vertex.texcoord.x);
+        packed.texcoord[1] = FloatToHalf(vertex.texcoord.y);
+        return packed;
+    }
+
+    VertexExtPacked PackVertex(const VertexExt& vertex, const VertexQuantization& q)
+    {
+        VertexExtPacked packed;
+        PackPosition(vertex.position, q, packed.position);
+        EncodeOctahedral(vertex.normal, packed.normal);
+        EncodeOctahedral(vertex.tangent, packed.tangent);
+        packed.texcoord[0] = FloatToHalf(vertex.texcoord.x);
+        packed.texcoord[1] = FloatToHalf(vertex.texcoord.y);
+        return packed;
+    }
+
+    Vertex UnpackVertex(const VertexPacked& vertex, const VertexQuantization& q)
+    {
+        Vertex unpacked;
+        unpacked.position = UnpackPosition(vertex.position, q);
+        unpacked.normal = DecodeOctahedral(vertex.normal);
+        unpacked.texcoord = Vector2(HalfToFloat(vertex.texcoord[0]), HalfToFloat(vertex.texcoord[1]));
+        return unpacked;
+    }
+
+    VertexExt UnpackVertex(const VertexExtPacked& vertex, const VertexQuantization& q)
+    {
+        VertexExt unpacked;
+        unpacked.position = UnpackPosition(vertex.position, q);
+        unpacked.normal = DecodeOctahedral(vertex.normal);
+        unpacked.tangent = DecodeOctahedral(vertex.tangent);
+        unpacked.texcoord = Vector2(HalfToFloat(vertex.texcoord[0]), HalfToFloat(vertex.texcoord[1]));
+        return unpacked;
+    }
+
+    VertexPackedList PackVertices(const VertexList& vertices, const VertexQuantization& q)
+    {
+        VertexPackedList packed;
+        packed.reserve(vertices.size());
+        for (const auto& v : vertices)
+        {
+            packed.push_back(PackVertex(v, q));
+        }
+        return packed;
+    }
+
+    VertexExtPackedList PackVertices(const VertexExtList& vertices, const VertexQuantization& q)
+    {
+        VertexExtPackedList packed;
+        packed.reserve(vertices.size());
+        for (const auto& v : vertices)
+        {
+            packed.push_back(PackVertex(v, q));
+        }
+        return packed;
+    }
+
+    VertexPackingError MeasurePackingError(const VertexList& vertices, const VertexPackedList& packed,
+        const VertexQuantization& q)
+    {
+        VertexPackingError error = {};
+        for (size_t i = 0; i < vertices.size() && i < packed.size(); i++)
+        {
+            const Vertex unpacked = UnpackVertex(packed[i], q);
+            error.position = std::max(error.position, PositionError(vertices[i].position, unpacked.position));
+            error.normal = std::max(error.normal, AngleBetween(vertices[i].normal, unpacked.normal));
+            error.texcoord = std::max(error.texcoord, TexcoordError(vertices[i].texcoord, unpacked.texcoord));
+        }
+        return error;
+    }
+
+    VertexPackingError MeasurePackingError(const VertexExtList& vertices, const VertexExtPackedList& packed,
+        const VertexQuantization& q)
+    {
+        VertexPackingError error = {};
+        for (size_t i = 0; i < vertices.size() && i < packed.size(); i++)
+        {
+            const VertexExt unpacked = UnpackVertex(packed[i], q);
+            error.position = std::max(error.position, PositionError(vertices[i].position, unpacked.position));
+            error.normal = std::max(error.normal, AngleBetween(vertices[i].normal, unpacked.normal));
+            error.tangent = std::max(error.tangent, AngleBetween(vertices[i].tangent, unpacked.tangent));
+            error.texcoord = std::max(error.texcoord, TexcoordError(vertices[i].texcoord, unpacked.texcoord));
+        }
+        return error;
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "VertexDataTypes.h"
+
+namespace Engine
+{
+    // Maps the snorm positions of a packed mesh to its local space, p = q * scale + bias.
+    // The scale is the same on every axis so the normals only need to be renormalized
+    struct VertexQuantization
+    {
+        Vector3 bias;
+        float scale;
+
+        // Fits the bounding box of the mesh in the snorm range
+        static VertexQuantization FromBounds(const Vector3& center, const Vector3& extent);
+    };
+
+    // Largest difference between the vertices of a mesh and their packed version
+    struct VertexPackingError
+    {
+        // In local space units
+        float position;
+        // In degrees
+        float normal;
+        float tangent;
+        float texcoord;
+    };
+
+    // Size of the vertices of a mesh before and after packing
+    struct VertexFootprint
+    {
+        size_t vertexCount;
+        size_t unpackedBytes;
+        size_t packedBytes;
+
+        template<typename T, typename P>
+        static VertexFootprint Of(size_t vertexCount)
+        { return { vertexCount, vertexCount * sizeof(T), vertexCount * sizeof(P) }; }
+
+        float Ratio() const { return unpackedBytes ? (float)packedBytes / unpackedBytes : 1.f; }
+    };
+
+    // IEEE half float, rounded to nearest even
+    uint16_t FloatToHalf(float value);
+    float HalfToFloat(uint16_t value);
+
+    // Decoded like the R16 snorm formats, -32768 and -32767 are both -1
+    int16_t FloatToSnorm16(float value);
+    float Snorm16ToFloat(int16_t value);
+
+    // Octahedral mapping of a unit vector to two snorm values. A zero vector decodes to +Z
+    void EncodeOctahedral(const Vector3& v, int16_t out[2]);
+    Vector3 DecodeOctahedral(const int16_t in[2]);
+
+    VertexPacked PackVertex(const Vertex& vertex, const VertexQuantization& q);
+    VertexExtPacked PackVertex(const VertexExt& vertex, const VertexQuantization& q);
+    // What the vertex shaders read from a packed vertex
+    Vertex UnpackVertex(const VertexPacked& vertex, const VertexQuantization& q);
+    VertexExt UnpackVertex(const VertexExtPacked& vertex, const VertexQuantization& q);
+
+    VertexPackedList PackVertices(const VertexList& vertices, const VertexQuantization& q);
+    VertexExtPackedList PackVertices(const VertexExtList& vertices, const VertexQuantization& q);
+
+    // Unpacks 'packed' and compares it to the vertices it was packed from
+    VertexPackingError MeasurePackingError(const VertexList& vertices, const VertexPackedList& packed,
+        const VertexQuantization& q);
+    VertexPackingError MeasurePackingError(const VertexExtList& vertices, const VertexExtPackedList& packed,
+        const VertexQuantization& q);
+}
@@ -125,9 +125,16 @@ namespace Vulkan
             queueInfo.push_back(qinfo2);
         }
 
+        vk::PhysicalDeviceFeatures supported;
+        mPhysicalDevice.getFeatures(&supported);
+        mMultiDrawIndirect = supported.multiDrawIndirect == VK_TRUE;
+        mDrawIndirectFirstInstance = supported.drawIndirectFirstInstance == VK_TRUE;
+
         vk::PhysicalDeviceFeatures pdf;
         pdf.samplerAnisotropy = VK_TRUE;
         pdf.geometryShader = VK_TRUE;
+        pdf.multiDrawIndirect = supported.multiDrawIndirect;
+        pdf.drawIndirectFirstInstance = supported.drawIndirectFirstInstance;
 #ifdef _DEBUG
         vk::DeviceCreateInfo devInfo({},
             queueInfo.size(),
@@ -43,6 +43,9 @@ namespace Vulkan
     public:
         uint16_t mApiMajor, mApiMinor, mApiPatch;
         QueueFamilyIndex mQueueFamilyIndex;
+        // Optional features enabled on the logical device
+        bool mMultiDrawIndirect;
+        bool mDrawIndirectFirstInstance;
 
         operator vk::Device() const { return mDevice; }
 
@@ -3,6 +3,7 @@
 #include "Device.h"
 #include "Swapchain.h"
 #include "TaskScheduler.h"
+#include "FrameAllocator.h"
 #include <Manager\WorldManager.h>
 #include <Manager\ShaderManager.h>
 #include <Manager\PipelineManager.h>
@@ -26,7 +27,8 @@ namespace Engine
     {
         assert(glfwInit());
         CreateWindow(params);
-        //g_TaskScheduler.Init();
+        g_TaskScheduler.Init();
+        g_FrameAllocator.Init();
 		g_PrimitiveManager.Init();
 		g_AudioManager.Init();
         InitGraphics();
@@ -48,13 +50,17 @@ namespace Engine
         DestroyGraphics();
 		g_PrimitiveManager.Destroy();
 		g_AudioManager.Destroy();
-        //g_TaskScheduler.Destroy();
+        g_TaskScheduler.Destroy();
+        g_FrameAllocator.Destroy();
         glfwDestroyWindow(mWindow);
         glfwTerminate();
     }
     
     void Engine::Update()
     {
+        // The jobs of the last frame are done, its transient data stays valid for this one
+        g_FrameAllocator.NextFrame();
+
         UpdateCallback();
 
 #ifdef SINGLE_THREAD
@@ -137,6 +143,7 @@ namespace Engine
         g_RenderpassManager.Init();
         g_Swapchain.Init();
 		g_RenderpassManager.PostSwapchainInit();
+		g_ResourceManager.PostSwapchainInit();
         g_ShaderManager.Init();
         g_PipelineManager.Init();
 		g_MaterialManager.Init();
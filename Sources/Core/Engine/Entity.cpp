@@ -2,36 +2,32 @@
 #include <Manager\BufferManager.h>
 #include <Manager\PipelineManager.h>
 #include <Manager\WorldManager.h>
-#include <Common\PushConstantsStructs.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <Octree.h>
 
 namespace Engine
 {
-    MEM_POOL_DEFINE(Entity);
+    MEM_POOL_DEFINE_CONCURRENT(Entity);
 
     void Entity::Destroy()
     {
+        if (mOctreeData)
+        {
+            otr::Octree<Entity>::Remove(mOctreeData);
+            mOctreeData->Delete();
+            mOctreeData = nullptr;
+        }
         mMesh->Destroy();
         //mMaterial->Destroy();
         LOG_INFO("[LOG] Delete entity {0:#x}\n", (uint64_t)this);
         mAllocator.deleteElement(this);
     }
 
-    void Entity::Draw(vk::CommandBuffer cmdBuff)
+    void Entity::PrepareDraw(uint32_t imageIndex)
     {
-        const Pipeline& pipe = PipelineOfType(mMaterial->mPipeType);
-        vk::Pipeline pipeline = pipe.mPipeline;
-        cmdBuff.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
-
-        ObjPS pc;
-        pc.MVP = mMVP;
-        pc.model = mModel;
-        pc.eyePos = mWorld->mCameraPos;
-
-        cmdBuff.pushConstants(pipe.mPipelineLayout, vk::ShaderStageFlagBits::eVertex
-            | vk::ShaderStageFlagBits::eFragment,
-            0, sizeof(ObjPS), &pc);
-
-		if (!mIsPBRSet && mMaterial->mPipeType == "pbr")
+		if (!mIsPBRSet && mMaterial->IsPBR())
 		{
 			auto& iblProbe = CurrentWorld->GetNearestIBLProbe(mPosition);
 			mMaterial->UpdateUniform(0, CurrentWorld->mSkySettings.hdrEnv);
@@ -40,17 +36,156 @@ namespace Engine
 			mIsPBRSet = true;
 		}
 
-        mMaterial->Bind(cmdBuff);
-		pipe.BindGlobalDescSets(cmdBuff);
+        mMaterial->WriteDescriptorsIfDirty(imageIndex);
+    }
+
+    void Entity::Draw(vk::CommandBuffer cmdBuff, DrawState& state,
+        uint32_t firstInstance, uint32_t instanceCount)
+    {
+        BindState(cmdBuff, state);
+
+        const MeshAllocation& alloc = mMesh->mAlloc;
+        const MeshLod& lod = mMesh->mLods.lods[mLod];
+        cmdBuff.drawIndexed(lod.indexCount, instanceCount, alloc.firstIndex + lod.firstIndex, alloc.vertexOffset, firstInstance);
+        ++state.stats.draws;
+        state.stats.instances += instanceCount;
+    }
+
+    void Entity::BindState(vk::CommandBuffer cmdBuff, DrawState& state) const
+    {
+        const Pipeline& pipe = PipelineOfType(mMaterial->mPipeType);
+        DrawStats& stats = state.stats;
+
+        if (state.pipeline != pipe.mPipeline)
+        {
+            cmdBuff.bindPipeline(vk::PipelineBindPoint::eGraphics, pipe.mPipeline);
+            state.pipeline = pipe.mPipeline;
+            ++stats.binds;
+        }
+        else ++stats.skippedBinds;
+
+        // Binding set 0 with another layout disturbs the sets after it, so both
+        // the material and the global sets are bound again when the layout changes
+        if (state.layout != pipe.mPipelineLayout || state.material != mMaterial)
+        {
+            mMaterial->Bind(cmdBuff, state.imageIndex);
+            state.material = mMaterial;
+            ++stats.binds;
+        }
+        else ++stats.skippedBinds;
+
+        if (state.layout != pipe.mPipelineLayout)
+        {
+            pipe.BindGlobalDescSets(cmdBuff, state.imageIndex);
+            state.layout = pipe.mPipelineLayout;
+            ++stats.binds;
+        }
+        else ++stats.skippedBinds;
+
+        // Meshes share their buffers, the draws pick their range with offsets
+        vk::Buffer meshBuffer = BufferAt(mMesh->mAlloc.buffer);
+        vk::DeviceSize offset = 0;
+
+        if (state.vertexBuffer != meshBuffer)
+        {
+            cmdBuff.bindVertexBuffers(0, 1, &meshBuffer, &offset);
+            state.vertexBuffer = meshBuffer;
+            ++stats.binds;
+        }
+        else ++stats.skippedBinds;
+
+        if (state.indexBuffer != meshBuffer)
+        {
+            cmdBuff.bindIndexBuffer(meshBuffer, offset, vk::IndexType::eUint32);
+            state.indexBuffer = meshBuffer;
+            ++stats.binds;
+        }
+        else ++stats.skippedBinds;
+    }
+
+    bool Entity::CanShareIndirectDraw(const Entity* other) const
+    {
+        return mMaterial == other->mMaterial && mMesh->mAlloc.buffer == other->mMesh->mAlloc.buffer;
+    }
 
-        vk::Buffer vbo = BufferAt(mMesh->mVBO);
-        vk::DeviceSize vertOffset = 0;
-        vk::DeviceSize indOffset = mMesh->mIBO;
+    vk::DrawIndexedIndirectCommand Entity::GetIndirectCommand(uint32_t firstInstance, uint32_t instanceCount) const
+    {
+        const MeshAllocation& alloc = mMesh->mAlloc;
+        const MeshLod& lod = mMesh->mLods.lods[mLod];
+        return vk::DrawIndexedIndirectCommand(
+            lod.indexCount,
+            instanceCount,
+            alloc.firstIndex + lod.firstIndex,
+            static_cast<int32_t>(alloc.vertexOffset),
+            firstInstance);
+    }
 
-        cmdBuff.bindVertexBuffers(0, 1, &vbo, &vertOffset);
-        cmdBuff.bindIndexBuffer(vbo, indOffset, vk::IndexType::eUint32);
+    uint64_t Entity::GetSortKey(float depth) const
+    {
+        // Ids are truncated to their field, a collision only costs a few more binds
+        // 8 bits pipeline | 16 bits material | 14 bits mesh | 2 bits LOD | 24 bits depth
+        static_assert(MAX_MESH_LODS <= 4, "The LOD has 2 bits in the sort key");
+        const uint64_t pipeline = PipelineOfType(mMaterial->mPipeType).mId & 0xFF;
+        const uint64_t material = mMaterial->mId & 0xFFFF;
+        const uint64_t mesh = mMesh->mId & 0x3FFF;
+        const uint64_t lod = mLod & 0x3;
+
+        // Positive floats sort like their bits, keep the top 24 of the 31 used
+        uint32_t depthBits = 0;
+        if (depth > 0.f)
+        {
+            std::memcpy(&depthBits, &depth, sizeof(float));
+            depthBits >>= 7;
+        }
+
+        return (pipeline << 56) | (material << 40) | (mesh << 26) | (lod << 24) | (depthBits & 0xFFFFFF);
+    }
+    
+    void Entity::UpdateBounds()
+    {
+        // The model matrix is column-major so rowN holds the N-th column
+        const Vector3& c = mMesh->mBoundsCenter;
+        const Vector3& e = mMesh->mBoundsExtent;
+        const Matrix4& m = mModel;
+
+        mBoundsCenter.x = m.row1.x * c.x + m.row2.x * c.y + m.row3.x * c.z + m.row4.x;
+        mBoundsCenter.y = m.row1.y * c.x + m.row2.y * c.y + m.row3.y * c.z + m.row4.y;
+        mBoundsCenter.z = m.row1.z * c.x + m.row2.z * c.y + m.row3.z * c.z + m.row4.z;
+
+        mBoundsExtent.x = std::fabs(m.row1.x) * e.x + std::fabs(m.row2.x) * e.y + std::fabs(m.row3.x) * e.z;
+        mBoundsExtent.y = std::fabs(m.row1.y) * e.x + std::fabs(m.row2.y) * e.y + std::fabs(m.row3.y) * e.z;
+        mBoundsExtent.z = std::fabs(m.row1.z) * e.x + std::fabs(m.row2.z) * e.y + std::fabs(m.row3.z) * e.z;
+    }
+    
+    float Entity::GetMaxScale() const
+    {
+        // The model matrix is column-major so rowN holds the N-th column
+        const Matrix4& m = mModel;
+        const float sx = m.row1.x * m.row1.x + m.row1.y * m.row1.y + m.row1.z * m.row1.z;
+        const float sy = m.row2.x * m.row2.x + m.row2.y * m.row2.y + m.row2.z * m.row2.z;
+        const float sz = m.row3.x * m.row3.x + m.row3.y * m.row3.y + m.row3.z * m.row3.z;
+        return std::sqrt(std::max(sx, std::max(sy, sz)));
+    }
 
-        cmdBuff.drawIndexed(mMesh->mCount, 1, 0, 0, 0);
+    Matrix4 Entity::GetObjectModel() const
+    {
+        if (!mMesh->mPacked)
+            return mModel;
+
+        // model * translate(bias) * scale(s), the columns of the model are scaled
+        // and the bias moves the translation
+        const VertexQuantization& q = mMesh->mQuantization;
+        const Matrix4& m = mModel;
+        Matrix4 result;
+        result.row1 = Vector4(m.row1.x * q.scale, m.row1.y * q.scale, m.row1.z * q.scale, m.row1.w * q.scale);
+        result.row2 = Vector4(m.row2.x * q.scale, m.row2.y * q.scale, m.row2.z * q.scale, m.row2.w * q.scale);
+        result.row3 = Vector4(m.row3.x * q.scale, m.row3.y * q.scale, m.row3.z * q.scale, m.row3.w * q.scale);
+        result.row4 = Vector4(
+            m.row1.x * q.bias.x + m.row2.x * q.bias.y + m.row3.x * q.bias.z + m.row4.x,
+            m.row1.y * q.bias.x + m.row2.y * q.bias.y + m.row3.y * q.bias.z + m.row4.y,
+            m.row1.z * q.bias.x + m.row2.z * q.bias.y + m.row3.z * q.bias.z + m.row4.z,
+            m.row1.w * q.bias.x + m.row2.w * q.bias.y + m.row3.w * q.bias.z + m.row4.w);
+        return result;
     }
     
     void Entity::OnAddToWorld()
@@ -82,6 +217,8 @@ extern "C"
     LAVA_API void AddMesh_Native(Engine::Entity* ent, Engine::StaticMesh* mesh)
     {
         ent->mMesh = mesh;
+        // The new mesh may have fewer LODs, the world picks the LOD again when it is visible
+        ent->mLod = 0;
     }
 
     LAVA_API void SetMVP_Native(Engine::Entity* ent, Engine::Matrix4 mvp)
@@ -91,7 +228,15 @@ extern "C"
 
     LAVA_API void SetModel_Native(Engine::Entity* ent, Engine::Matrix4 model)
     {
+        // Dynamic entities send their model every frame, only a moved entity is relocated and re-uploaded
+        if (std::memcmp(&ent->mModel, &model, sizeof(model)) == 0)
+            return;
+
         ent->mModel = model;
+        if (ent->mWorld && ent->mOctreeData)
+        {
+            ent->mWorld->UpdateEntityTransform(ent);
+        }
     }
 
     LAVA_API void SetPosition_Native(Engine::Entity* ent, Engine::Vector3 pos)
@@ -4,8 +4,38 @@
 #include "Material.h"
 #include <Common\MathTypes.h>
 
+namespace otr
+{
+    template<typename T> class OctreeData;
+}
+
 namespace Engine
 {
+    // Bind counters of the recorded world
+    struct DrawStats
+    {
+        uint32_t draws;
+        uint32_t instances;
+        uint32_t binds;
+        uint32_t skippedBinds;
+        // Indirect draw calls and the commands they consumed
+        uint32_t indirectDraws;
+        uint32_t indirectCommands;
+    };
+
+    // State bound last in a command buffer, used to skip redundant binds
+    struct DrawState
+    {
+        vk::Pipeline pipeline;
+        vk::PipelineLayout layout;
+        const Material* material;
+        vk::Buffer vertexBuffer;
+        vk::Buffer indexBuffer;
+        // Swapchain image recorded, selects its descriptor sets
+        uint32_t imageIndex;
+        DrawStats stats;
+    };
+
     struct Entity
     {
         StaticMesh* mMesh;
@@ -13,17 +43,51 @@ namespace Engine
         Matrix4 mMVP;
         Matrix4 mModel;
         Vector3 mPosition;
+        // World space bounding box
+        Vector3 mBoundsCenter;
+        Vector3 mBoundsExtent;
         class World* mWorld;
+        // Handle of this entity in the world octree, null if not in a world
+        otr::OctreeData<Entity>* mOctreeData;
+        // Index of the model matrix in the objects buffer, fed to the shaders through the instance buffer
+        uint32_t mObjectIndex;
+        // LOD of the mesh drawn, picked by the world from the camera distance
+        uint32_t mLod;
 
 		virtual void Init() { mIsPBRSet = false; }
         void Destroy();
 
-        virtual void Draw(vk::CommandBuffer cmdBuff);
+        // Updates the entity and material state needed by Draw. Must be called
+        // from a single thread before Draw, which only records commands for 'imageIndex'
+        void PrepareDraw(uint32_t imageIndex);
+        // Draws 'instanceCount' instances of the mesh. Their object indices are read
+        // from the instance buffer starting at 'firstInstance'
+        virtual void Draw(vk::CommandBuffer cmdBuff, DrawState& state,
+            uint32_t firstInstance, uint32_t instanceCount);
+        // True if both entities can be drawn by the same instanced draw
+        bool CanInstanceWith(const Entity* other) const
+        { return mMesh == other->mMesh && mMaterial == other->mMaterial && mLod == other->mLod; }
+
+        // Binds the pipeline, material and mesh buffers which changed since the last draw
+        void BindState(vk::CommandBuffer cmdBuff, DrawState& state) const;
+        // True if the draws of both entities can be read from the same indirect buffer range
+        bool CanShareIndirectDraw(const Entity* other) const;
+        // Indirect command of an instanced draw
+        vk::DrawIndexedIndirectCommand GetIndirectCommand(uint32_t firstInstance, uint32_t instanceCount) const;
+        // Key used to sort the draws: pipeline, material, mesh, LOD and depth from the most significant bits
+        uint64_t GetSortKey(float depth) const;
+
+        // Transforms the mesh bounding box by the model matrix
+        void UpdateBounds();
+        // Largest scale of the model matrix, converts the mesh LOD errors to world space
+        float GetMaxScale() const;
+        // Model matrix the shaders read, with the dequantization of a packed mesh folded in
+        Matrix4 GetObjectModel() const;
 
         void OnAddToWorld();
         void OnRemoveFromWorld();
 
-        MEM_POOL_DECLARE(Entity);
+        MEM_POOL_DECLARE_CONCURRENT(Entity);
 
 	private:
 		bool mIsPBRSet;
@@ -0,0 +1,121 @@
+#include "FrameAllocator.h"
+#include <algorithm>
+
+namespace Engine
+{
+    FrameAllocator g_FrameAllocator;
+
+    namespace
+    {
+        // The chunk of the current frame buffer this thread allocates from
+        struct ThreadChunk
+        {
+            const FrameAllocator* owner = nullptr;
+            uint64_t frameNumber = 0;
+            uintptr_t cursor = 0;
+            uintptr_t end = 0;
+        };
+
+        thread_local ThreadChunk tChunk;
+
+        uintptr_t AlignUp(uintptr_t address, size_t alignment)
+        {
+            return (address + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+        }
+    }
+
+    void FrameAllocator::Init(size_t frameSize)
+    {
+        for (auto& frame : mFrames)
+        {
+            frame.memory = new uint8_t[frameSize];
+            frame.size = frameSize;
+            frame.offset = 0;
+        }
+        mFrameNumber = 0;
+        LOG_INFO("[LOG] Frame allocator create {} bytes per frame\n", frameSize);
+    }
+
+    void FrameAllocator::Destroy()
+    {
+        for (auto& frame : mFrames)
+        {
+            for (auto p : frame.overflow)
+            {
+                delete[] p;
+            }
+            frame.overflow.clear();
+            delete[] frame.memory;
+            frame.memory = nullptr;
+            frame.size = 0;
+        }
+        LOG_INFO("[LOG] Frame allocator delete.\n");
+    }
+
+    void FrameAllocator::NextFrame()
+    {
+        const uint64_t next = mFrameNumber.load(std::memory_order_relaxed) + 1;
+
+        // The buffer of two frames ago is reused, everything in it is dropped
+        Frame& frame = mFrames[next & 1];
+        if (!frame.overflow.empty())
+        {
+            for (auto p : frame.overflow)
+            {
+                delete[] p;
+            }
+            frame.overflow.clear();
+
+            const size_t size = std::max(frame.size * 2, frame.offset.load(std::memory_order_relaxed));
+            LOG_WARNING("[LOG] Frame allocator grows from {} to {} bytes\n", frame.size, size);
+            delete[] frame.memory;
+            frame.memory = new uint8_t[size];
+            frame.size = size;
+        }
+        frame.offset.store(0, std::memory_order_relaxed);
+
+        mFrameNumber.store(next, std::memory_order_release);
+    }
+
+    void* FrameAllocator::Allocate(size_t size, size_t alignment)
+    {
+        const uint64_t frameNumber = mFrameNumber.load(std::memory_order_acquire);
+        Frame& frame = mFrames[frameNumber & 1];
+
+        // Big allocations would waste most of a chunk
+        if (size + alignment > THREAD_CHUNK_SIZE / 4)
+        {
+            return AllocateFromFrame(frame, size, alignment);
+        }
+
+        ThreadChunk& chunk = tChunk;
+        if (chunk.owner != this || chunk.frameNumber != frameNumber ||
+            AlignUp(chunk.cursor, alignment) + size > chunk.end)
+        {
+            auto memory = reinterpret_cast<uintptr_t>(
+                AllocateFromFrame(frame, THREAD_CHUNK_SIZE, alignof(std::max_align_t)));
+            chunk = { this, frameNumber, memory, memory + THREAD_CHUNK_SIZE };
+        }
+
+        uintptr_t address = AlignUp(chunk.cursor, alignment);
+        chunk.cursor = address + size;
+        return reinterpret_cast<void*>(address);
+    }
+
+    void* FrameAllocator::AllocateFromFrame(Frame& frame, size_t size, size_t alignment)
+    {
+        // Reserving the worst padding keeps the offsets independent of the other threads
+        const size_t reserved = size + alignment - 1;
+        const size_t offset = frame.offset.fetch_add(reserved, std::memory_order_relaxed);
+        if (offset + reserved <= frame.size)
+        {
+            return reinterpret_cast<void*>(
+                AlignUp(reinterpret_cast<uintptr_t>(frame.memory) + offset, alignment));
+        }
+
+        std::lock_guard<std::mutex> lock(mOverflowMutex);
+        uint8_t* memory = new uint8_t[reserved];
+        frame.overflow.push_back(memory);
+        return reinterpret_cast<void*>(AlignUp(reinterpret_cast<uintptr_t>(memory), alignment));
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <Common\Constants.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#define GFrameAllocator Engine::g_FrameAllocator
+
+namespace Engine
+{
+    // Linear allocator for transient data of a frame. There are two buffers, so what
+    // was allocated stays valid during the next frame too and is dropped all at once
+    // when its buffer is reused. Threads take chunks of the current buffer with an
+    // atomic add and allocate from them without locking, so the jobs of a frame can
+    // use it. Work that can outlive the frame, like loading, must not.
+    class FrameAllocator
+    {
+    public:
+        static constexpr size_t DEFAULT_FRAME_SIZE = 256 * 1024;
+        static constexpr size_t THREAD_CHUNK_SIZE = 16 * 1024;
+
+        void Init(size_t frameSize = DEFAULT_FRAME_SIZE);
+        void Destroy();
+
+        // Must be called on the main thread while no job is allocating
+        void NextFrame();
+
+        void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    private:
+        struct Frame
+        {
+            uint8_t* memory = nullptr;
+            size_t size = 0;
+            std::atomic<size_t> offset{ 0 };
+            // Allocations that didn't fit, the buffer grows when it is reused
+            std::vector<uint8_t*> overflow;
+        };
+
+        void* AllocateFromFrame(Frame& frame, size_t size, size_t alignment);
+
+        Frame mFrames[2];
+        std::atomic<uint64_t> mFrameNumber{ 0 };
+        std::mutex mOverflowMutex;
+    };
+
+    extern FrameAllocator g_FrameAllocator;
+
+    // STL allocator on top of the frame allocator, deallocation does nothing
+    template<typename T>
+    struct FrameStlAllocator
+    {
+        using value_type = T;
+
+        FrameStlAllocator() = default;
+
+        template<typename U>
+        FrameStlAllocator(const FrameStlAllocator<U>&) { }
+
+        T* allocate(size_t count)
+        {
+            return static_cast<T*>(GFrameAllocator.Allocate(count * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T*, size_t) { }
+
+        template<typename U>
+        bool operator==(const FrameStlAllocator<U>&) const { return true; }
+
+        template<typename U>
+        bool operator!=(const FrameStlAllocator<U>&) const { return false; }
+    };
+
+    template<typename T>
+    using FrameVector = std::vector<T, FrameStlAllocator<T>>;
+}
@@ -30,7 +30,8 @@ namespace Engine
 
 		T& operator[](uint32_t i) { mSoftDirty = true; return mVectorBuffer[i]; }
 
-		// Send data to the GPU.
+		// Send data to the GPU. Recreates the buffer if elements were added or removed, so it
+		// must not be used by a frame that is still executing, see ResourceManager.
 		void Commit();
 
 	private:
@@ -47,7 +48,7 @@ namespace Engine
 	
 	template<typename T>
 	inline GpuArrayBuffer<T>::GpuArrayBuffer(vk::BufferUsageFlags flags)
-		: mDirty(true), mSoftDirty(true), mFlags(flags), mBuffer(nullptr)
+		: mDirty(true), mSoftDirty(true), mFlags(flags), mBuffer(nullptr), mVmaAllocation(nullptr)
 	{
 		mVectorBuffer.reserve(INIT_CAPACITY);
 	}
@@ -55,13 +56,18 @@ namespace Engine
 	template<typename T>
 	void GpuArrayBuffer<T>::CreateMappedGPUBuffer()
 	{
-		if (mBuffer)
-			vmaDestroyBuffer(GVmaAllocator, mBuffer, mVmaAllocation);
+		// The old buffer is destroyed after the new one is created, so the new one can't
+		// reuse its handle and the descriptor writes comparing handles see the change
+		vk::Buffer oldBuffer = mBuffer;
+		VmaAllocation oldAllocation = mVmaAllocation;
 		vk::DeviceSize size = mVectorBuffer.size() * sizeof(T);
 
 		mBuffer = g_BufferManager.CreateBuffer(size, mFlags, VMA_MEMORY_USAGE_CPU_ONLY,
 			VMA_ALLOCATION_CREATE_MAPPED_BIT,
 			mVmaAllocation, &mVmaAllocInfo);
+
+		if (oldBuffer)
+			vmaDestroyBuffer(GVmaAllocator, oldBuffer, oldAllocation);
 	}
 
 	template<typename T>
@@ -1,10 +1,14 @@
 ﻿#include "Material.h"
 #include <Manager\PipelineManager.h>
 #include <Manager\TextureManager.h>
+#include <Manager\WorldManager.h>
+#include "Swapchain.h"
+#include "FrameAllocator.h"
+#include <Common\AllocationCounter.h>
 
 namespace Engine
 {
-    MEM_POOL_DEFINE(Material);
+    MEM_POOL_DEFINE_CONCURRENT(Material);
 
     void Material::InitializeUniforms()
     {
@@ -25,15 +29,22 @@ namespace Engine
             uniform.mType = binding.descriptorType;
         }
 
-        mDescSet = pipeline.AllocateDescriptorSet();
-        dirty = false;
+        mDescSets.resize(GSwapchain.GetImageCount());
+        for (auto& descSet : mDescSets)
+        {
+            descSet = pipeline.AllocateDescriptorSet();
+        }
+        mDirty = 0;
     }
 
     void Material::UpdateUniform(uint32_t binding, const std::any& value)
     {
         THROW_IF(binding >= mUniforms.size(), "Uniform binding point out of range {0}!", binding);
         mUniforms[binding].mValue = value;
-        dirty = true;
+        mDirty = WORLD_DIRTY;
+        // The descriptors are written when the world is recorded again
+        if (CurrentWorld)
+            CurrentWorld->mDirty = WORLD_DIRTY;
     }
 
 	void Material::UpdateUniform(const std::string& name, const std::any& value)
@@ -44,23 +55,42 @@ namespace Engine
 		UpdateUniform(binding, value);
 	}
 
-    void Material::Bind(vk::CommandBuffer cmdBuff)
+    void Material::OnTextureLoaded(uint32_t texIndex)
+    {
+        for (const auto& uniform : mUniforms)
+        {
+            const uint32_t* value = std::any_cast<uint32_t>(&uniform.mValue);
+            if (uniform.mType == vk::DescriptorType::eCombinedImageSampler && value && *value == texIndex)
+            {
+                mDirty = WORLD_DIRTY;
+                if (CurrentWorld)
+                    CurrentWorld->mDirty = WORLD_DIRTY;
+                return;
+            }
+        }
+    }
+
+    void Material::Bind(vk::CommandBuffer cmdBuff, uint32_t imageIndex)
     {
-        WriteDescriptorsIfDirty();
+        WriteDescriptorsIfDirty(imageIndex);
 
         const Pipeline& pipeline = PipelineOfType(mPipeType);
         cmdBuff.bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
-            pipeline.mPipelineLayout, 0, 1, &mDescSet,
+            pipeline.mPipelineLayout, 0, 1, &mDescSets[imageIndex],
             0, nullptr);
     }
     
-    void Material::WriteDescriptorsIfDirty()
+    void Material::WriteDescriptorsIfDirty(uint32_t imageIndex)
     {
-        if (dirty)
+        assert(imageIndex < mDescSets.size());
+        const uint8_t dirtyBit = 1 << imageIndex;
+        if (mDirty & dirtyBit)
         {
-            std::vector<vk::WriteDescriptorSet> writeDescSets;
+            EXPECT_NO_ALLOCATIONS("Material::WriteDescriptorsIfDirty");
+
+            FrameVector<vk::WriteDescriptorSet> writeDescSets;
             writeDescSets.resize(mUniforms.size());
-			std::vector<vk::DescriptorImageInfo> imageInfo;
+			FrameVector<vk::DescriptorImageInfo> imageInfo;
 			imageInfo.resize(mUniforms.size());
             
             for (size_t i = 0; i < mUniforms.size(); i++)
@@ -81,7 +111,7 @@ namespace Engine
 						writeDescSets[i].descriptorType = mUniforms[i].mType;
 						writeDescSets[i].dstArrayElement = 0;
 						writeDescSets[i].dstBinding = static_cast<uint32_t>(i);
-						writeDescSets[i].dstSet = mDescSet;
+						writeDescSets[i].dstSet = mDescSets[imageIndex];
 						writeDescSets[i].pImageInfo = &imageInfo[i];
 					}
 					else
@@ -96,8 +126,9 @@ namespace Engine
                 }
             }
 
-            g_vkDevice.updateDescriptorSets(writeDescSets, {});
-            dirty = false;
+            vk::ArrayProxy<const vk::WriteDescriptorSet> writes(static_cast<uint32_t>(writeDescSets.size()), writeDescSets.data());
+            g_vkDevice.updateDescriptorSets(writes, {});
+            mDirty &= ~dirtyBit;
         }
     }
 }
@@ -1,7 +1,7 @@
 ﻿#pragma once
 
 #include <vulkan\vulkan.hpp>
-#include <MemoryPool.h>
+#include <Common\ConcurrentMemoryPool.h>
 #include <string>
 #include <Common\Constants.h>
 #include <any>
@@ -19,21 +19,41 @@ namespace Engine
         friend class MaterialManager;
 
         std::string mPipeType;
+        // Index of the material in the manager, used to sort draws
+        uint32_t mId;
 
         void InitializeUniforms();
+        // The pbr pipelines share the uniforms, "pbrpacked" only reads packed vertices
+        bool IsPBR() const { return mPipeType == "pbr" || mPipeType == "pbrpacked"; }
 
         void UpdateUniform(uint32_t binding, const std::any& value);
         void UpdateUniform(const std::string&, const std::any& value);
 
-        void Bind(vk::CommandBuffer cmdBuff);
-
-        MEM_POOL_DECLARE(Material);
+        // Binds the descriptor set of the swapchain image the command buffer is recorded for
+        void Bind(vk::CommandBuffer cmdBuff, uint32_t imageIndex);
+        // Only call once the frame last submitted with the image is done, the set may be bound by it
+        void WriteDescriptorsIfDirty(uint32_t imageIndex);
+        // Writes the descriptors again if one of the textures is the one at 'texIndex'
+        void OnTextureLoaded(uint32_t texIndex);
+        // Calls f with the index of every texture the material samples
+        template<typename F>
+        void ForEachTexture(F&& f) const
+        {
+            for (const auto& uniform : mUniforms)
+            {
+                const uint32_t* value = std::any_cast<uint32_t>(&uniform.mValue);
+                if (uniform.mType == vk::DescriptorType::eCombinedImageSampler && value)
+                    f(*value);
+            }
+        }
+
+        MEM_POOL_DECLARE_CONCURRENT(Material);
 
     private:
-        void WriteDescriptorsIfDirty();
-
-        bool dirty;
+        // One bit per swapchain image whose set is not written with the uniforms yet
+        uint8_t mDirty;
         std::vector<Uniform> mUniforms;
-        vk::DescriptorSet mDescSet;
+        // One set per swapchain image, so a set is never written while a frame in flight uses it
+        std::vector<vk::DescriptorSet> mDescSets;
     };
 }
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "MeshFile.h"
+#include <Common\MappedFile.h>
+#include <Common\MeshOptimizer.h>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+
+namespace Engine
+{
+    bool MeshFile::GetSourceStamp(const char* path, MeshSourceStamp& stamp)
+    {
+        std::error_code error;
+        auto size = std::filesystem::file_size(path, error);
+        if (error) return false;
+        auto writeTime = std::filesystem::last_write_time(path, error);
+        if (error) return false;
+
+        stamp.size = static_cast<uint64_t>(size);
+        stamp.writeTime = static_cast<uint64_t>(writeTime.time_since_epoch().count());
+        stamp.hash = 0;
+        return true;
+    }
+
+    uint64_t MeshFile::HashFile(const char* path)
+    {
+        MappedFile file;
+        if (!file.Open(path)) return 0;
+        return HashBytes(file.GetData(), file.GetSize());
+    }
+
+    bool MeshFile::Write(const char* dstPath, const MeshSourceStamp& source,
+        const void* vertices, uint32_t vertexStride, uint32_t vertexCount,
+        const uint32_t* indices, uint32_t indexCount, const MeshLodChain& lods,
+        const float boundsCenter[3], const float boundsExtent[3])
+    {
+        MeshFileHeader header = {};
+        header.magic = MeshFileHeader::MAGIC;
+        header.version = MeshFileHeader::VERSION;
+        header.source = source;
+        header.vertexStride = vertexStride;
+        header.vertexCount = vertexCount;
+        header.indexCount = indexCount;
+        header.lods = lods;
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            header.boundsCenter[i] = boundsCenter[i];
+            header.boundsExtent[i] = boundsExtent[i];
+        }
+        header.vertexOffset = sizeof(MeshFileHeader);
+        header.indexOffset = header.vertexOffset + (uint64_t)vertexStride * vertexCount;
+
+        std::ofstream fout(dstPath, std::ofstream::binary | std::ofstream::trunc);
+        if (!fout.good()) return false;
+
+        fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        fout.write(reinterpret_cast<const char*>(vertices), (std::streamsize)vertexStride * vertexCount);
+        fout.write(reinterpret_cast<const char*>(indices), (std::streamsize)sizeof(uint32_t) * indexCount);
+        return fout.good();
+    }
+
+    const MeshFileHeader* MeshFile::Read(const void* data, size_t size, uint32_t vertexStride)
+    {
+        if (!data || size < sizeof(MeshFileHeader)) return nullptr;
+
+        const MeshFileHeader* header = static_cast<const MeshFileHeader*>(data);
+        if (header->magic != MeshFileHeader::MAGIC ||
+            header->version != MeshFileHeader::VERSION ||
+            header->vertexStride != vertexStride ||
+            header->vertexOffset + (uint64_t)header->vertexStride * header->vertexCount > size ||
+            header->indexOffset + sizeof(uint32_t) * (uint64_t)header->indexCount > size ||
+            header->indexOffset % sizeof(uint32_t) != 0 ||
+            header->lods.count == 0 || header->lods.count > MAX_MESH_LODS)
+        {
+            return nullptr;
+        }
+
+        for (uint32_t i = 0; i < header->lods.count; i++)
+        {
+            const MeshLod& lod = header->lods.lods[i];
+            if ((uint64_t)lod.firstIndex + lod.indexCount > header->indexCount)
+                return nullptr;
+        }
+
+        return header;
+    }
+
+    // Overwrites the write time of the source in the header of the cache, the rest of the file is unchanged
+    static bool RestampCache(const char* cachePath, uint64_t writeTime)
+    {
+        std::fstream file(cachePath, std::fstream::binary | std::fstream::in | std::fstream::out);
+        if (!file.good()) return false;
+
+        file.seekp(offsetof(MeshFileHeader, source) + offsetof(MeshSourceStamp, writeTime));
+        file.write(reinterpret_cast<const char*>(&writeTime), sizeof(writeTime));
+        return file.good();
+    }
+
+    bool MeshFile::IsUpToDate(const MeshFileHeader& header, const char* path, const MeshSourceStamp& source,
+        const char* cachePath)
+    {
+        if (header.source.size != source.size) return false;
+        if (header.source.writeTime == source.writeTime) return true;
+        if (header.source.hash != HashFile(path)) return false;
+
+        // A read-only cache stays valid, it is only hashed again on the next load
+        RestampCache(cachePath, source.writeTime);
+        return true;
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <Common\MeshSimplifier.h>
+
+namespace Engine
+{
+    // Identifies the version of the source file a mesh cache was built from
+    struct MeshSourceStamp
+    {
+        uint64_t size;
+        uint64_t writeTime;
+        // Hash of the content, only computed when the write time doesn't match
+        uint64_t hash;
+    };
+
+    // Header of a cached mesh, the vertices and the indices follow it
+    struct MeshFileHeader
+    {
+        static constexpr uint32_t MAGIC = 0x48534D4C; // "LMSH"
+        // 2: the meshes are optimized before they are cached
+        // 3: the LODs follow the indices of the full mesh
+        static constexpr uint32_t VERSION = 3;
+
+        uint32_t magic;
+        uint32_t version;
+        MeshSourceStamp source;
+        // sizeof the Vertex the cache was written with
+        uint32_t vertexStride;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        // Local space bounding box
+        float boundsCenter[3];
+        float boundsExtent[3];
+        MeshLodChain lods;
+        // Offsets from the start of the file
+        uint64_t vertexOffset;
+        uint64_t indexOffset;
+    };
+
+    // Writes and reads the cache of imported meshes, the runtime maps it and
+    // copies the vertices and indices to staging memory without importing anything
+    class MeshFile
+    {
+    public:
+        // Appended to the path of the source mesh
+        static constexpr const char* EXTENSION = ".lmesh";
+        // Cache of the VertexPacked version, the bounds give its quantization
+        static constexpr const char* PACKED_EXTENSION = ".packed.lmesh";
+
+        // Size and write time of the file at 'path', the hash is left to 0
+        static bool GetSourceStamp(const char* path, MeshSourceStamp& stamp);
+        static uint64_t HashFile(const char* path);
+
+        static bool Write(const char* dstPath, const MeshSourceStamp& source,
+            const void* vertices, uint32_t vertexStride, uint32_t vertexCount,
+            const uint32_t* indices, uint32_t indexCount, const MeshLodChain& lods,
+            const float boundsCenter[3], const float boundsExtent[3]);
+        // Returns the header if 'data' holds a whole cache of vertices 'vertexStride' bytes big, null otherwise
+        static const MeshFileHeader* Read(const void* data, size_t size, uint32_t vertexStride);
+        // True if the cache at 'cachePath' was built from the source file at 'path' stamped 'source'.
+        // A source with another write time is hashed, e.g. copied without changes, and if the
+        // content matches the cache takes the new write time so the next loads skip the hash
+        static bool IsUpToDate(const MeshFileHeader& header, const char* path, const MeshSourceStamp& source,
+            const char* cachePath);
+    };
+}
@@ -1,11 +1,15 @@
 #include "PhysicsWorld.h"
 #include "Time.h"
+#include "TaskScheduler.h"
 #include <Common\MathTypes.h>
+#include <algorithm>
+#include <cstring>
+#include <thread>
 using namespace reactphysics3d;
 
 namespace Engine
 {
-    MEM_POOL_DEFINE_SIZE(PhysicsWorld, 8192);
+    MEM_POOL_DEFINE_SIZE(PhysicsWorld, 16384);
 
     MemoryPool<reactphysics3d::BoxShape> PhysicsWorld::mBoxAllocator;
     MemoryPool<reactphysics3d::SphereShape> PhysicsWorld::mSphereAllocator;
@@ -17,6 +21,31 @@ namespace Engine
         LOG_INFO("[LOG] Create physics world {0:#x}\n", (uint64_t)this);
 		mProxyCallback.reserve(2);
         //mState.reserve(NUM_BODIES);
+
+#ifdef SINGLE_THREAD
+        SetSolverJobCount(1);
+#else
+        SetSolverJobCount(std::clamp(std::thread::hardware_concurrency(), 1u, MAX_SOLVER_JOBS));
+#endif
+    }
+
+    void PhysicsWorld::SetSolverJobCount(uint32_t count)
+    {
+        // The islands are split into at most count batches, each one solved by a
+        // single job, so the simulation does not depend on the job count
+        count = std::max(count, 1u);
+        if (count == 1)
+        {
+            mDynamics.setParallelFor(nullptr, 1);
+        }
+        else
+        {
+            mDynamics.setParallelFor([](uint32_t n, const std::function<void(uint32_t)>& f)
+            {
+                GTaskScheduler.ParallelFor(n, f);
+            }, count);
+        }
+        LOG_INFO("[LOG] Physics world {0:#x} solves islands on {1} jobs\n", (uint64_t)this, count);
     }
 
     void PhysicsWorld::Destroy()
@@ -33,6 +62,8 @@ namespace Engine
 		rb->setLinearDamping(0.0f);
 
         mRbState.push_back(RbState{ rb, rbCallback });
+        mSyncedTransforms.push_back(transform);
+        mStepTransforms.push_back(StepTransforms{ transform, transform });
         return rb;
     }
 
@@ -48,62 +79,230 @@ namespace Engine
     {   
         assert(PhysicsUpdateCallback);
 
+        float timeStep = g_Time.fixedDeltaTime;
+
         // Add the time difference in the accumulator 
         mAccumulator += g_Time.deltaTime;
         bool sim = false;
 
+        mFrameStats = PhysicsFrameStats{};
+        if (mAdaptiveStep && mAccumulator > mMaxSubsteps * timeStep)
+        {
+            timeStep = std::min(mAccumulator / mMaxSubsteps, timeStep * MAX_ADAPTIVE_STEP_SCALE);
+        }
+
+        // Drop what can't be simulated with the allowed substeps, catching up
+        // after a hitch would only make the next frame longer
+        const float maxAccumulator = mMaxSubsteps * timeStep;
+        if (mAccumulator > maxAccumulator)
+        {
+            mFrameStats.timeDropped = mAccumulator - maxAccumulator;
+            mAccumulator = maxAccumulator;
+        }
+
         // While there is enough accumulated time to take 
         // one or several physics steps 
-        while (mAccumulator >= TIME_STEP)
+        while (mAccumulator >= timeStep && mFrameStats.substeps < mMaxSubsteps)
         {
             PhysicsUpdateCallback();
 
+            // Only the state before the last step is interpolated from
+            if (mAccumulator < 2.0f * timeStep || mFrameStats.substeps + 1 == mMaxSubsteps)
+            {
+                for (size_t i = 0; i < mRbState.size(); i++)
+                {
+                    mStepTransforms[i].previous = mRbState[i].rb->getTransform();
+                }
+            }
+
             // Update the Dynamics world with a constant time step 
-            mDynamics.update(TIME_STEP);
+            mDynamics.update(timeStep);
 
             // Decrease the accumulated time 
-            mAccumulator -= TIME_STEP;
+            mAccumulator -= timeStep;
+            mFrameStats.substeps++;
             sim = true;
         }
+        mFrameStats.stepSize = timeStep;
 
         if (sim)
         {
-            // Advance the state with the remaining accumulator
-            // so that we don't lag behind
-            // I use this method instead of interpolation because the
-            // interp method doesn't work for some reason
-            //mDynamics.update(mAccumulator);
+            for (size_t i = 0; i < mRbState.size(); i++)
+            {
+                mStepTransforms[i].current = mRbState[i].rb->getTransform();
+            }
+        }
+        else
+        {
+            // Bodies moved by the user since the last step are not blended
+            for (size_t i = 0; i < mRbState.size(); i++)
+            {
+                const auto& trans = mRbState[i].rb->getTransform();
+                if (trans != mStepTransforms[i].current)
+                {
+                    mStepTransforms[i] = StepTransforms{ trans, trans };
+                }
+            }
+        }
+
+        // The rendered state lags one step behind the simulation and is blended
+        // with the time left in the accumulator, so it moves on every frame
+        SyncTransforms(std::min(mAccumulator / timeStep, 1.0f));
+
+		UpdateTriggers();
+    }
+
+    static rp3d::Transform InterpolateStep(const rp3d::Transform& previous, const rp3d::Transform& current, float alpha)
+    {
+        // Bodies that did not move are returned as they are, blending
+        // them could change the last bits and mark them dirty
+        if (previous == current)
+        {
+            return current;
+        }
+        return rp3d::Transform::interpolateTransforms(previous, current, alpha);
+    }
+
+    void PhysicsWorld::SetTransformSyncBuffer(const TransformSyncBuffer& buffer, TransformSyncCBack callback)
+    {
+        mSyncBuffer = buffer;
+        mSyncCallback = callback;
+        mSyncAll = true;
+    }
 
-            // Set this to 0 because we simulated all of the deltaTime
-            //mAccumulator = 0;
+    void PhysicsWorld::SyncTransforms(float alpha)
+    {
+        uint32_t count = 0;
+        if (mSyncCallback)
+        {
+            count = std::min(static_cast<uint32_t>(mRbState.size()), mSyncBuffer.capacity);
+            std::memset(mSyncBuffer.dirtyBits, 0, ((count + 31) / 32) * sizeof(uint32_t));
 
-			for (auto& state : mRbState)
+            for (uint32_t i = 0; i < count; i++)
             {
-                auto trans = state.rb->getTransform();
-                state.updateRigidBody(trans.getPosition(), trans.getOrientation());
+                const auto trans = InterpolateStep(mStepTransforms[i].previous, mStepTransforms[i].current, alpha);
+                // Sleeping and static bodies keep their transform and are skipped
+                if (!mSyncAll && trans == mSyncedTransforms[i])
+                {
+                    continue;
+                }
+                mSyncedTransforms[i] = trans;
+                mSyncBuffer.positions[i] = trans.getPosition();
+                mSyncBuffer.orientations[i] = trans.getOrientation();
+                mSyncBuffer.dirtyBits[i / 32] |= 1u << (i % 32);
             }
+            mSyncAll = false;
+        }
+
+        for (size_t i = count; i < mRbState.size(); i++)
+        {
+            auto trans = InterpolateStep(mStepTransforms[i].previous, mStepTransforms[i].current, alpha);
+            mRbState[i].updateRigidBody(trans.getPosition(), trans.getOrientation());
         }
 
-		for (size_t i = 0; i < mCbState.size() - 1; i++)
+        if (mSyncCallback)
+        {
+            mSyncCallback(count);
+        }
+    }
+
+	PhysicsWorld::TriggerPair PhysicsWorld::TriggerPair::Make(rp3d::ProxyShape* a, rp3d::ProxyShape* b)
+	{
+		if (a->getBroadPhaseId() > b->getBroadPhaseId())
+		{
+			std::swap(a, b);
+		}
+		return TriggerPair{ a->getBroadPhaseId(), b->getBroadPhaseId(), a, b };
+	}
+
+	void PhysicsWorld::UpdateTriggers()
+	{
+		struct PairCollector : public rp3d::OverlappingPairCallback
+		{
+			std::vector<TriggerPair>& pairs;
+
+			PairCollector(std::vector<TriggerPair>& p) : pairs(p) { }
+
+			void notifyOverlappingPair(rp3d::ProxyShape* shape1, rp3d::ProxyShape* shape2) override
+			{
+				pairs.push_back(TriggerPair::Make(shape1, shape2));
+			}
+		};
+
+		// The pairs come from the broad-phase pair cache, so only the triggers
+		// that moved are looked up in the AABB tree
+		mCurrentTriggerPairs.clear();
+		PairCollector collector(mCurrentTriggerPairs);
+		mCollision.testOverlap(&collector);
+		std::sort(mCurrentTriggerPairs.begin(), mCurrentTriggerPairs.end());
+
+		// Both lists are sorted, pairs only in the new one started overlapping
+		// and pairs only in the old one stopped
+		mTriggerEvents.clear();
+		size_t i = 0, j = 0;
+		while (i < mCurrentTriggerPairs.size() || j < mTriggerPairs.size())
 		{
-			auto& state1 = mCbState[i];
-			for (size_t j = i + 1; j < mCbState.size(); j++)
+			if (j == mTriggerPairs.size() ||
+				(i < mCurrentTriggerPairs.size() && mCurrentTriggerPairs[i] < mTriggerPairs[j]))
+			{
+				mTriggerEvents.push_back({ mCurrentTriggerPairs[i].shape1, TriggerEvent::Enter });
+				mTriggerEvents.push_back({ mCurrentTriggerPairs[i].shape2, TriggerEvent::Enter });
+				i++;
+			}
+			else if (i == mCurrentTriggerPairs.size() || mTriggerPairs[j] < mCurrentTriggerPairs[i])
+			{
+				mTriggerEvents.push_back({ mTriggerPairs[j].shape1, TriggerEvent::Exit });
+				mTriggerEvents.push_back({ mTriggerPairs[j].shape2, TriggerEvent::Exit });
+				j++;
+			}
+			else
 			{
-				auto& state2 = mCbState[j];
-				if (mCollision.testOverlap(state1.cb, state2.cb))
-				{
-					CollisionInfoMarshal cim;
-					cim.pointOfContact = Vector3(0, 0, 0); // Dummy value because it's unused
-
-					const auto& pl1 = state1.cb->getProxyShapesList();
-					const auto& pl2 = state2.cb->getProxyShapesList();
-					// Assume only one shape per collision body
-					mProxyCallback[pl1](cim);
-					mProxyCallback[pl2](cim);
-				}
+				i++;
+				j++;
 			}
 		}
-    }
+		mTriggerPairs.swap(mCurrentTriggerPairs);
+
+		// The callbacks may remove triggers, so they run after the pairs are updated
+		for (const auto& pending : mTriggerEvents)
+		{
+			FireTriggerEvent(pending.shape, pending.event);
+		}
+	}
+
+	void PhysicsWorld::FireTriggerEvent(rp3d::ProxyShape* ps, TriggerEvent event)
+	{
+		auto it = mProxyCallback.find(ps);
+		if (it != mProxyCallback.end() && it->second)
+		{
+			CollisionInfoMarshal cim;
+			cim.pointOfContact = Vector3(0, 0, 0); // Dummy value because it's unused
+			cim.event = event;
+			it->second(cim);
+		}
+	}
+
+	void PhysicsWorld::RemoveTrigger(rp3d::ProxyShape* ps)
+	{
+		mProxyCallback.erase(ps);
+
+		std::vector<rp3d::ProxyShape*> others;
+		auto removed = std::remove_if(mTriggerPairs.begin(), mTriggerPairs.end(), [&](const TriggerPair& pair)
+		{
+			if (pair.shape1 != ps && pair.shape2 != ps)
+			{
+				return false;
+			}
+			others.push_back(pair.shape1 == ps ? pair.shape2 : pair.shape1);
+			return true;
+		});
+		mTriggerPairs.erase(removed, mTriggerPairs.end());
+
+		for (auto other : others)
+		{
+			FireTriggerEvent(other, TriggerEvent::Exit);
+		}
+	}
 }
 
 /* EXPORTED INTERFACE */
@@ -120,6 +319,33 @@ extern "C"
 		pworld->SetGravity(gravity);
 	}
 
+	LAVA_API void SetSolverJobCount_Native(Engine::PhysicsWorld* pworld, uint32_t count)
+	{
+		pworld->SetSolverJobCount(count);
+	}
+
+	LAVA_API void SetMaxSubsteps_Native(Engine::PhysicsWorld* pworld, uint32_t count)
+	{
+		pworld->SetMaxSubsteps(count);
+	}
+
+	LAVA_API void SetAdaptiveStep_Native(Engine::PhysicsWorld* pworld, bool adaptive)
+	{
+		pworld->SetAdaptiveStep(adaptive);
+	}
+
+	LAVA_API Engine::PhysicsFrameStats GetFrameStats_Native(Engine::PhysicsWorld* pworld)
+	{
+		return pworld->GetFrameStats();
+	}
+
+	LAVA_API void SetTransformSyncBuffer_Native(Engine::PhysicsWorld* pworld,
+		rp3d::Vector3* positions, rp3d::Quaternion* orientations, uint32_t* dirtyBits,
+		uint32_t capacity, Engine::TransformSyncCBack callback)
+	{
+		pworld->SetTransformSyncBuffer({ positions, orientations, dirtyBits, capacity }, callback);
+	}
+
 	// -------- CollisionBody -------- //
 	LAVA_API rp3d::CollisionBody* CreateCollisionBody_Native(Engine::PhysicsWorld* pworld,
 		rp3d::Vector3 pos,
@@ -243,8 +469,9 @@ extern "C"
         rb->removeCollisionShape(proxy);
     }
 
-	LAVA_API void DestroyBoxTrigger_Native(rp3d::CollisionBody* cb, rp3d::ProxyShape* proxy)
+	LAVA_API void DestroyBoxTrigger_Native(Engine::PhysicsWorld* pworld, rp3d::CollisionBody* cb, rp3d::ProxyShape* proxy)
 	{
+		pworld->RemoveTrigger(proxy);
 		Engine::PhysicsWorld::mBoxAllocator.deleteElement(
 			static_cast<rp3d::BoxShape*>(proxy->getUserData())
 		);
@@ -4,17 +4,48 @@
 #include <Common\Constants.h>
 #include <Common\MathTypes.h>
 #include <MemoryPool.h>
+#include <algorithm>
 #include <forward_list>
 
 namespace Engine
 {
+	enum class TriggerEvent : uint32_t
+	{
+		// The trigger started overlapping another trigger
+		Enter,
+		// The trigger stopped overlapping another trigger
+		Exit
+	};
+
 	struct CollisionInfoMarshal
 	{
 		Vector3 pointOfContact;
+		TriggerEvent event;
 	};
 
 	typedef void(*UpdateBodyCBack)(reactphysics3d::Vector3, reactphysics3d::Quaternion);
 	typedef void(*CollisionCBack)(CollisionInfoMarshal&);
+	typedef void(*TransformSyncCBack)(uint32_t bodyCount);
+
+	// Structure of arrays owned by the caller, the transform of a rigid body
+	// is written at the index of its creation order
+	struct TransformSyncBuffer
+	{
+		rp3d::Vector3* positions;
+		rp3d::Quaternion* orientations;
+		// One bit per body, set when the body moved since the last sync
+		uint32_t* dirtyBits;
+		uint32_t capacity;
+	};
+
+	// What the last PhysicsWorld::Update did
+	struct PhysicsFrameStats
+	{
+		uint32_t substeps;
+		// Time that was not simulated because of the substep limit
+		float timeDropped;
+		float stepSize;
+	};
 
 	/*struct CollisionBodyExt
 	{
@@ -26,13 +57,23 @@ namespace Engine
     {
         friend class World;
         static constexpr size_t NUM_BODIES = 4;
+        static constexpr uint32_t MAX_SOLVER_JOBS = 8;
+        static constexpr uint32_t DEFAULT_MAX_SUBSTEPS = 4;
+        // The adaptive step never grows past this many fixed steps
+        static constexpr float MAX_ADAPTIVE_STEP_SCALE = 2.0f;
     public:
         void Init();
         void Destroy();
 
         PhysicsWorld() : mDynamics(reactphysics3d::Vector3(0.0f, -9.81f, 0.0f)),
             PhysicsUpdateCallback(nullptr),
-            mAccumulator(0) { }
+            mAccumulator(0),
+            mMaxSubsteps(DEFAULT_MAX_SUBSTEPS),
+            mAdaptiveStep(false),
+            mFrameStats{},
+            mSyncBuffer{},
+            mSyncCallback(nullptr),
+            mSyncAll(false) { }
 
         reactphysics3d::RigidBody* CreateRigidBody(const reactphysics3d::Transform& transform,
             UpdateBodyCBack callback);
@@ -42,23 +83,72 @@ namespace Engine
 
         void SetGravity(reactphysics3d::Vector3 g) { mDynamics.setGravity(g); }
 
+        // Number of jobs the islands are solved on, 1 solves them on the calling thread
+        void SetSolverJobCount(uint32_t count);
+
+        // Steps taken in one update at most, the time past that is dropped
+        // so that a long frame does not make the next one longer
+        void SetMaxSubsteps(uint32_t count) { mMaxSubsteps = std::max(count, 1u); }
+
+        // When set, a long frame is caught up with larger steps before time is dropped.
+        // The simulation then depends on the frame times.
+        void SetAdaptiveStep(bool adaptive) { mAdaptiveStep = adaptive; }
+
+        const PhysicsFrameStats& GetFrameStats() const { return mFrameStats; }
+
+        // Time fed to Update that is left for the next steps
+        float GetAccumulator() const { return mAccumulator; }
+
+		// Two trigger shapes that overlap, sorted by their broad-phase ids
+		struct TriggerPair
+		{
+			int id1;
+			int id2;
+			rp3d::ProxyShape* shape1;
+			rp3d::ProxyShape* shape2;
+
+			static TriggerPair Make(rp3d::ProxyShape* a, rp3d::ProxyShape* b);
+			bool operator<(const TriggerPair& other) const
+			{
+				return id1 < other.id1 || (id1 == other.id1 && id2 < other.id2);
+			}
+		};
+
+		// Trigger pairs overlapping since the last update
+		const std::vector<TriggerPair>& GetTriggerPairs() const { return mTriggerPairs; }
+
+        // Simulates g_Time.deltaTime in fixed steps, called once per frame by the world owning it
+        void Update();
+
 		void SetProxyCallback(rp3d::ProxyShape* ps, CollisionCBack cb)
 		{
 			mProxyCallback[ps] = cb;
 		}
 
+		// Must be called before the trigger shape is removed from its body,
+		// the triggers it overlaps get an exit event
+		void RemoveTrigger(rp3d::ProxyShape* ps);
+
+		// Rigid bodies are synced through the buffer with a single callback per update
+		// instead of one callback per body. Bodies past the capacity use their own callback.
+		// The synced transforms are interpolated between the last two physics steps.
+		void SetTransformSyncBuffer(const TransformSyncBuffer& buffer, TransformSyncCBack callback);
+
         UpdateCback PhysicsUpdateCallback;
 
         static MemoryPool<reactphysics3d::BoxShape> mBoxAllocator;
         static MemoryPool<reactphysics3d::SphereShape> mSphereAllocator;
         static MemoryPool<reactphysics3d::CapsuleShape> mCapsuleAllocator;
         //static MemoryPool<CollisionBodyExt> mCBAllocator;
-    private:
-        MEM_POOL_DECLARE_SIZE(PhysicsWorld, 8192);
 
+        MEM_POOL_DECLARE_SIZE(PhysicsWorld, 16384);
+    private:
         reactphysics3d::DynamicsWorld mDynamics;
         reactphysics3d::CollisionWorld mCollision;
         float mAccumulator;
+        uint32_t mMaxSubsteps;
+        bool mAdaptiveStep;
+        PhysicsFrameStats mFrameStats;
 
         struct RbState
         {
@@ -67,6 +157,23 @@ namespace Engine
         };
         std::vector<RbState> mRbState;
 
+		TransformSyncBuffer mSyncBuffer;
+		TransformSyncCBack mSyncCallback;
+		// Set when the buffer changed and holds no transform yet
+		bool mSyncAll;
+		// Last transform written for each rigid body
+		std::vector<rp3d::Transform> mSyncedTransforms;
+
+		// Transforms of a rigid body before and after the last physics step
+		struct StepTransforms
+		{
+			rp3d::Transform previous;
+			rp3d::Transform current;
+		};
+		std::vector<StepTransforms> mStepTransforms;
+
+		void SyncTransforms(float alpha);
+
 		struct CbState
 		{
 			rp3d::CollisionBody* cb;
@@ -76,6 +183,19 @@ namespace Engine
 
 		std::unordered_map<rp3d::ProxyShape*, CollisionCBack> mProxyCallback;
 
-        void Update();
+		// Pairs that overlapped at the last update
+		std::vector<TriggerPair> mTriggerPairs;
+		// Pairs that overlap now, kept to reuse its memory
+		std::vector<TriggerPair> mCurrentTriggerPairs;
+
+		struct PendingTriggerEvent
+		{
+			rp3d::ProxyShape* shape;
+			TriggerEvent event;
+		};
+		std::vector<PendingTriggerEvent> mTriggerEvents;
+
+		void UpdateTriggers();
+		void FireTriggerEvent(rp3d::ProxyShape* ps, TriggerEvent event);
     };
 }
\ No newline at end of file
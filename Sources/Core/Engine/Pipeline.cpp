@@ -95,6 +95,19 @@ namespace Engine
                 LOG_ERROR("Pipeline error: Invalid vertex input type {0}!", type.c_str());
             }
         }
+        // Must come after the vertex input, the instance attributes follow its locations
+        if (HAS_PROPERTY("instanceInput"))
+        {
+            std::string type = j["instanceInput"];
+            if (IsValidInstanceType(type))
+            {
+                GetInstanceInputCI(type, temp);
+            }
+            else
+            {
+                LOG_ERROR("Pipeline error: Invalid instance input type {0}!", type.c_str());
+            }
+        }
         if (HAS_PROPERTY("primitiveTopology"))
         {
             std::string topo = j["primitiveTopology"];
@@ -351,7 +364,7 @@ namespace Engine
         return mDescAllocator.AllocateDescriptorSet();
     }
 
-	void Pipeline::BindGlobalDescSets(vk::CommandBuffer cmdBuff) const
+	void Pipeline::BindGlobalDescSets(vk::CommandBuffer cmdBuff, uint32_t imageIndex) const
 	{
 		if (mSetIndices.empty()) return;
 
@@ -361,7 +374,7 @@ namespace Engine
 		
 		for (auto slot : mSetIndices)
 		{
-			auto ds = g_ResourceManager.GetDescriptorSet(slot);
+			auto ds = g_ResourceManager.GetDescriptorSet(slot, imageIndex);
 			THROW_IF(!ds, "Cannot bind null descriptor set!");
 			descSets.push_back(ds);
 		}
@@ -522,9 +535,9 @@ namespace Engine
 
     void GraphicsPipelineCI::ToVulkanType(vk::GraphicsPipelineCreateInfo& gpCI)
     {
-        mVertexInput.vertexBindingDescriptionCount = 1;
+        mVertexInput.vertexBindingDescriptionCount = static_cast<uint32_t>(mVertexInputBindingDesc.size());
         mVertexInput.vertexAttributeDescriptionCount = static_cast<uint32_t>(mVertexInputAttributeDesc.size());
-        mVertexInput.pVertexBindingDescriptions = &mVertexInputBindingDesc;
+        mVertexInput.pVertexBindingDescriptions = mVertexInputBindingDesc.data();
         mVertexInput.pVertexAttributeDescriptions = mVertexInputAttributeDesc.data();
 
         mMultisample.pSampleMask = mSampleMask.has_value() ? &mSampleMask.value() : nullptr;
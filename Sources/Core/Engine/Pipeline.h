@@ -10,7 +10,7 @@ namespace Engine
 {
     struct GraphicsPipelineCI
     {
-        vk::VertexInputBindingDescription mVertexInputBindingDesc;
+        std::vector<vk::VertexInputBindingDescription> mVertexInputBindingDesc;
         std::vector<vk::VertexInputAttributeDescription> mVertexInputAttributeDesc;
         vk::PipelineVertexInputStateCreateInfo mVertexInput;
 
@@ -55,10 +55,13 @@ namespace Engine
         }
 
         vk::DescriptorSet AllocateDescriptorSet();
-		void BindGlobalDescSets(vk::CommandBuffer cmdBuff) const;
+		// Binds the global sets of the swapchain image at 'imageIndex'
+		void BindGlobalDescSets(vk::CommandBuffer cmdBuff, uint32_t imageIndex) const;
 
         vk::Pipeline mPipeline;
         vk::PipelineLayout mPipelineLayout;
+        // Index of the pipeline in the manager, used to sort draws
+        uint32_t mId;
 
         static GraphicsPipelineCI BaseGraphicsPipelineCI;
         static GraphicsPipelineCI TempGraphicsPipelineCI;
@@ -2,10 +2,16 @@
 
 #define VERTEX_INPUT_CREATE_INFO(Type) auto bindingDescription = Type::GetBindingDescription();\
 auto attributeDescriptions = Type::GetAttributeDescriptions();\
-temp.mVertexInputBindingDesc = bindingDescription;\
+temp.mVertexInputBindingDesc.assign(1, bindingDescription);\
 temp.mVertexInputAttributeDesc.resize(attributeDescriptions.size());\
 temp.mVertexInputAttributeDesc.assign(attributeDescriptions.begin(), attributeDescriptions.end())
 
+#define INSTANCE_INPUT_CREATE_INFO(Type) auto bindingDescription = Type::GetBindingDescription();\
+auto attributeDescriptions = Type::GetAttributeDescriptions(bindingDescription.binding,\
+    static_cast<uint32_t>(temp.mVertexInputAttributeDesc.size()));\
+temp.mVertexInputBindingDesc.push_back(bindingDescription);\
+temp.mVertexInputAttributeDesc.insert(temp.mVertexInputAttributeDesc.end(), attributeDescriptions.begin(), attributeDescriptions.end())
+
 #define INPUT_ASSEMBLY_CREATE_INFO(Type) temp.mInputAssembly.topology = vk::PrimitiveTopology::e##Type;\
 temp.mInputAssembly.primitiveRestartEnable = VK_FALSE
 
@@ -95,7 +101,15 @@ namespace Engine
     static bool IsValidVertexType(const std::string& type)
     {
         if (type == "Vertex" || type == "Vertex2D" || type == "VertexExt"
-			|| type == "VertexPos" || type == "VertexUI" || type == "None")
+			|| type == "VertexPos" || type == "VertexUI" || type == "VertexPacked"
+			|| type == "VertexExtPacked" || type == "None")
+            return true;
+        return false;
+    }
+
+    static bool IsValidInstanceType(const std::string& type)
+    {
+        if (type == "InstanceData" || type == "None")
             return true;
         return false;
     }
@@ -156,6 +170,22 @@ namespace Engine
 		{
 			VERTEX_INPUT_CREATE_INFO(VertexUI);
 		}
+		else if (type == "VertexPacked")
+		{
+			VERTEX_INPUT_CREATE_INFO(VertexPacked);
+		}
+		else if (type == "VertexExtPacked")
+		{
+			VERTEX_INPUT_CREATE_INFO(VertexExtPacked);
+		}
+    }
+
+    static void GetInstanceInputCI(std::string type, GraphicsPipelineCI& temp)
+    {
+        if (type == "InstanceData")
+        {
+            INSTANCE_INPUT_CREATE_INFO(InstanceData);
+        }
     }
 
     static void GetInputAssemblyCI(std::string type, GraphicsPipelineCI& temp)
@@ -244,6 +274,7 @@ namespace Engine
 }
 
 #undef VERTEX_INPUT_CREATE_INFO
+#undef INSTANCE_INPUT_CREATE_INFO
 #undef INPUT_ASSEMBLY_CREATE_INFO
 #undef POLYGON_MODE
 #undef CULL_MODE
\ No newline at end of file
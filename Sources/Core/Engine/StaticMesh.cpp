@@ -4,22 +4,57 @@
 #include <assimp\Importer.hpp>
 #include <assimp\scene.h>
 #include <assimp\postprocess.h>
+#include "MeshFile.h"
+#include <Common\MappedFile.h>
+#include <Common\MeshOptimizer.h>
+#include <chrono>
 #include <fstream>
+#include <algorithm>
 
 #define ALLOCATE_STATIC_MESH(vertices, indices) StaticMesh* ent = Allocate(); \
-auto ioff = CreateVertexIndexBuffer(vertices, indices); \
-ent->mVBO = ioff.first; \
-ent->mIBO = ioff.second; \
-ent->mCount = (uint32_t)indices.size(); \
+ent->mAlloc = CreateMeshBuffer(vertices, indices); \
+ent->mId = mNextId++; \
+ent->mLods = MeshLodChain::Single((uint32_t)indices.size()); \
+ent->mPacked = false; \
+ent->ComputeBounds(vertices); \
 LOG_INFO("[LOG] Create static mesh {0:#x}\n", (uint64_t)ent); \
 return ent
 
-#define CREATE_STATIC_MESH(Type) Engine::StaticMesh::Create(Engine::Vertex##Type##List(vertices, vertices + verticesLength), \
+#define CREATE_STATIC_MESH(Type) CREATE_STATIC_MESH_WITH(CreateOptimized, Type)
+
+#define CREATE_STATIC_MESH_WITH(Factory, Type) Engine::StaticMesh::Factory(Engine::Vertex##Type##List(vertices, vertices + verticesLength), \
 Engine::IndexList(indices, indices + indicesLength))
 
 namespace Engine
 {
-    MEM_POOL_DEFINE(StaticMesh);
+    MEM_POOL_DEFINE_CONCURRENT(StaticMesh);
+    uint32_t StaticMesh::mNextId = 0;
+
+    template<typename T>
+    void StaticMesh::ComputeBounds(const std::vector<T>& vertices)
+    {
+        if (vertices.empty())
+        {
+            mBoundsCenter = Vector3();
+            mBoundsExtent = Vector3();
+            return;
+        }
+
+        Vector3 bmin = vertices[0].position;
+        Vector3 bmax = vertices[0].position;
+        for (const auto& v : vertices)
+        {
+            bmin.x = std::min(bmin.x, v.position.x);
+            bmin.y = std::min(bmin.y, v.position.y);
+            bmin.z = std::min(bmin.z, v.position.z);
+            bmax.x = std::max(bmax.x, v.position.x);
+            bmax.y = std::max(bmax.y, v.position.y);
+            bmax.z = std::max(bmax.z, v.position.z);
+        }
+
+        mBoundsCenter = Vector3((bmin.x + bmax.x) * 0.5f, (bmin.y + bmax.y) * 0.5f, (bmin.z + bmax.z) * 0.5f);
+        mBoundsExtent = Vector3((bmax.x - bmin.x) * 0.5f, (bmax.y - bmin.y) * 0.5f, (bmax.z - bmin.z) * 0.5f);
+    }
 
     StaticMesh * StaticMesh::Create(const VertexList & vertices, const IndexList & indices)
     {
@@ -36,7 +71,133 @@ namespace Engine
         ALLOCATE_STATIC_MESH(vertices, indices);
     }
 
-    StaticMesh * StaticMesh::Load(const char * path)
+    template<typename T>
+    StaticMesh * StaticMesh::CreateOptimized(std::vector<T> vertices, IndexList indices)
+    {
+        MeshLodChain lods = Optimize(vertices, indices);
+        StaticMesh* mesh = Create(vertices, indices);
+        mesh->mLods = lods;
+        return mesh;
+    }
+
+    template<typename T>
+    StaticMesh * StaticMesh::CreatePacked(std::vector<T> vertices, IndexList indices)
+    {
+        MeshLodChain lods = Optimize(vertices, indices);
+        std::vector<decltype(PackVertex(vertices[0], VertexQuantization()))> packed;
+        StaticMesh* mesh = Pack(vertices, indices, packed);
+        mesh->mLods = lods;
+        return mesh;
+    }
+
+    template<typename T, typename P>
+    StaticMesh * StaticMesh::Pack(const std::vector<T>& vertices, const IndexList& indices, std::vector<P>& packed)
+    {
+        StaticMesh* mesh = Allocate();
+        mesh->ComputeBounds(vertices);
+        mesh->mPacked = true;
+        mesh->mQuantization = VertexQuantization::FromBounds(mesh->mBoundsCenter, mesh->mBoundsExtent);
+        packed = PackVertices(vertices, mesh->mQuantization);
+        mesh->mAlloc = CreateMeshBuffer(packed, indices);
+        mesh->mId = mNextId++;
+        mesh->mLods = MeshLodChain::Single((uint32_t)indices.size());
+
+        VertexFootprint footprint = VertexFootprint::Of<T, P>(vertices.size());
+        VertexPackingError error = MeasurePackingError(vertices, packed, mesh->mQuantization);
+        LOG_INFO("[LOG] Pack mesh: {} vertices, {} -> {} bytes ({:.1f}%), max error position {:.6f}, normal {:.4f} deg, "
+            "tangent {:.4f} deg, uv {:.6f}\n", footprint.vertexCount, footprint.unpackedBytes, footprint.packedBytes,
+            footprint.Ratio() * 100.f, error.position, error.normal, error.tangent, error.texcoord);
+        LOG_INFO("[LOG] Create static mesh {0:#x}\n", (uint64_t)mesh);
+        return mesh;
+    }
+
+    template<typename T>
+    MeshLodChain StaticMesh::Optimize(std::vector<T>& vertices, IndexList& indices)
+    {
+        MeshOptimizeStats stats = OptimizeMesh(vertices, indices);
+        LOG_INFO("[LOG] Optimize mesh: {} vertices welded, {} removed, ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}\n",
+            stats.weldedVertices, stats.removedVertices, stats.before.acmr, stats.after.acmr,
+            stats.before.atvr, stats.after.atvr);
+
+        MeshLodChain lods = BuildMeshLods(vertices, indices);
+        for (uint32_t i = 1; i < lods.count; i++)
+        {
+            LOG_INFO("[LOG] Mesh LOD {}: {} -> {} triangles, error {:.5f}\n", i, lods.lods[0].indexCount / 3,
+                lods.lods[i].indexCount / 3, lods.lods[i].error);
+        }
+        return lods;
+    }
+
+    StaticMesh * StaticMesh::Load(const char * path, bool packed)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        MeshSourceStamp source;
+        if (!MeshFile::GetSourceStamp(path, source))
+        {
+            LOG_ERROR("[ERROR] Mesh file {} not found\n", path);
+            throw "err";
+        }
+
+        // A cache written from this version of the source skips the import
+        std::string cachePath = std::string(path) + (packed ? MeshFile::PACKED_EXTENSION : MeshFile::EXTENSION);
+        const uint32_t vertexStride = packed ? sizeof(VertexPacked) : sizeof(Vertex);
+        {
+            MappedFile cache;
+            if (cache.Open(cachePath.c_str()))
+            {
+                const MeshFileHeader* header = MeshFile::Read(cache.GetData(), cache.GetSize(), vertexStride);
+                if (header && MeshFile::IsUpToDate(*header, path, source, cachePath.c_str()))
+                {
+                    StaticMesh* mesh = Create(*header, cache.GetData(), packed);
+                    LOG_INFO("[LOG] Load mesh {} from cache in {} ms\n", path,
+                        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+                    return mesh;
+                }
+            }
+        }
+
+        VertexList vertices;
+        IndexList indices;
+        Import(path, vertices, indices);
+        // The cache holds the optimized mesh and its LODs, the warm loads skip both
+        MeshLodChain lods = Optimize(vertices, indices);
+        VertexPackedList packedVertices;
+        StaticMesh* mesh = packed ? Pack(vertices, indices, packedVertices) : Create(vertices, indices);
+        const void* vertexData = packed ? (const void*)packedVertices.data() : vertices.data();
+        mesh->mLods = lods;
+
+        source.hash = MeshFile::HashFile(path);
+        float center[3] = { mesh->mBoundsCenter.x, mesh->mBoundsCenter.y, mesh->mBoundsCenter.z };
+        float extent[3] = { mesh->mBoundsExtent.x, mesh->mBoundsExtent.y, mesh->mBoundsExtent.z };
+        if (!MeshFile::Write(cachePath.c_str(), source, vertexData, vertexStride, (uint32_t)vertices.size(),
+            indices.data(), (uint32_t)indices.size(), lods, center, extent))
+        {
+            LOG_WARNING("[WARNING] Failed to write mesh cache {}\n", cachePath);
+        }
+
+        LOG_INFO("[LOG] Import mesh {} in {} ms\n", path,
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+        return mesh;
+    }
+
+    StaticMesh * StaticMesh::Create(const MeshFileHeader& header, const uint8_t* data, bool packed)
+    {
+        StaticMesh* mesh = Allocate();
+        mesh->mAlloc = GBufferManager.AllocateMesh(data + header.vertexOffset, header.vertexStride, header.vertexCount,
+            reinterpret_cast<const uint32_t*>(data + header.indexOffset), header.indexCount);
+        mesh->mId = mNextId++;
+        mesh->mLods = header.lods;
+        mesh->mBoundsCenter = Vector3(header.boundsCenter[0], header.boundsCenter[1], header.boundsCenter[2]);
+        mesh->mBoundsExtent = Vector3(header.boundsExtent[0], header.boundsExtent[1], header.boundsExtent[2]);
+        // The positions were packed in the same bounds
+        mesh->mPacked = packed;
+        mesh->mQuantization = VertexQuantization::FromBounds(mesh->mBoundsCenter, mesh->mBoundsExtent);
+        LOG_INFO("[LOG] Create static mesh {0:#x}\n", (uint64_t)mesh);
+        return mesh;
+    }
+
+    void StaticMesh::Import(const char* path, VertexList& vertices, IndexList& indices)
     {
         Assimp::Importer importer;
         const aiScene* scene = importer.ReadFile(path,
@@ -47,74 +208,65 @@ namespace Engine
             LOG_ERROR("Assimp error: {}", importer.GetErrorString());
             throw "err";
         }
-        else
+
+        // The preset triangulates, every face has 3 indices
+        size_t vertexCount = 0, indexCount = 0;
+        for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+        {
+            vertexCount += scene->mMeshes[i]->mNumVertices;
+            indexCount += scene->mMeshes[i]->mNumFaces * 3;
+        }
+        vertices.reserve(vertexCount);
+        indices.reserve(indexCount);
+
+        for (unsigned int i = 0; i < scene->mNumMeshes; i++)
         {
-            std::vector<Vertex> vertices;
-            std::vector<unsigned int> indices;
+            aiMesh* mesh = scene->mMeshes[i];
+            // The indices of a mesh start at its first vertex
+            uint32_t baseVertex = (uint32_t)vertices.size();
 
-            for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+            for (unsigned int j = 0; j < mesh->mNumVertices; j++)
             {
-                aiMesh* mesh = scene->mMeshes[i];
+                Vertex newVertex;
 
-                for (unsigned int j = 0; j < mesh->mNumVertices; j++)
-                {
-                    Vertex newVertex;
+                newVertex.position = Vector3(
+                    mesh->mVertices[j].x,
+                    mesh->mVertices[j].y,
+                    mesh->mVertices[j].z
+                );
 
-                    newVertex.position = Vector3(
-                        mesh->mVertices[j].x,
-                        mesh->mVertices[j].y,
-                        mesh->mVertices[j].z
-                    );
+                newVertex.normal = Vector3(
+                    mesh->mNormals[j].x,
+                    mesh->mNormals[j].y,
+                    mesh->mNormals[j].z
+                );
 
-                    newVertex.normal = Vector3(
-                        mesh->mNormals[j].x,
-                        mesh->mNormals[j].y,
-                        mesh->mNormals[j].z
+                if (mesh->mTextureCoords[0] != nullptr)
+                {
+                    newVertex.texcoord = Vector2(
+                        mesh->mTextureCoords[0][j].x,
+                        mesh->mTextureCoords[0][j].y
                     );
-
-                    if (mesh->mTextureCoords[0] != nullptr)
-                    {
-                        newVertex.texcoord = Vector2(
-                            mesh->mTextureCoords[0][j].x,
-                            mesh->mTextureCoords[0][j].y
-                        );
-                    }
-
-                    /*if (mesh->mTangents != nullptr)
-                    {
-                        newVertex.tangent = glm::vec3(
-                            mesh->mTangents[j].x,
-                            mesh->mTangents[j].y,
-                            mesh->mTangents[j].z
-                        );
-
-                        newVertex.bitangent = glm::vec3(
-                            mesh->mBitangents[j].x,
-                            mesh->mBitangents[j].y,
-                            mesh->mBitangents[j].z
-                        );
-                    }*/
-
-                    vertices.push_back(newVertex);
                 }
 
-                for (unsigned int j = 0; j < mesh->mNumFaces; ++j)
+                vertices.push_back(newVertex);
+            }
+
+            for (unsigned int j = 0; j < mesh->mNumFaces; ++j)
+            {
+                const aiFace& face = mesh->mFaces[j];
+                for (unsigned int k = 0; k < face.mNumIndices; ++k)
                 {
-                    aiFace face = mesh->mFaces[j];
-                    for (unsigned int k = 0; k < face.mNumIndices; ++k)
-                    {
-                        indices.push_back(face.mIndices[k]);
-                    }
+                    indices.push_back(baseVertex + face.mIndices[k]);
                 }
             }
-
-            return Create(vertices, indices);
         }
     }
 
     void StaticMesh::Destroy()
     {
         LOG_INFO("[LOG] Delete static mesh {0:#x}\n", (uint64_t)this);
+        GBufferManager.FreeMesh(mAlloc);
         mAllocator.deleteElement(this);
     }
 }
@@ -140,6 +292,23 @@ extern "C"
         return CREATE_STATIC_MESH(Ext);
     }
 
+    LAVA_API void* CreateMeshPacked_Native(Engine::Vertex* vertices, int verticesLength,
+        uint32_t* indices, int indicesLength)
+    {
+        return CREATE_STATIC_MESH_WITH(CreatePacked, );
+    }
+
+    LAVA_API void* CreateMeshExtPacked_Native(Engine::VertexExt* vertices, int verticesLength,
+        uint32_t* indices, int indicesLength)
+    {
+        return CREATE_STATIC_MESH_WITH(CreatePacked, Ext);
+    }
+
+    LAVA_API void* LoadPackedFromFile_Native(const char* path)
+    {
+        return Engine::StaticMesh::Load(path, true);
+    }
+
     LAVA_API void* LoadFromFile_Native(const char* path)
     {
         /*std::ifstream fin(path, std::ifstream::binary);
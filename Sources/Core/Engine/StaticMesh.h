@@ -1,11 +1,16 @@
 #pragma once
 
 #include <Common\VertexDataTypes.h>
-#include <MemoryPool.h>
+#include <Common\VertexPacking.h>
+#include <Common\MeshSimplifier.h>
+#include <Manager\BufferManager.h>
+#include <Common\ConcurrentMemoryPool.h>
 #include <Common\Constants.h>
 
 namespace Engine
 {
+    struct MeshFileHeader;
+
     // Represents a graphical entity in the world
     class StaticMesh
     {
@@ -15,16 +20,51 @@ namespace Engine
         static StaticMesh* Create(const VertexList& vertices, const IndexList& indices);
         static StaticMesh* Create(const Vertex2DList& vertices, const IndexList& indices);
         static StaticMesh* Create(const VertexExtList& vertices, const IndexList& indices);
+        // Runs the mesh through the optimizer and builds its LODs first, see OptimizeMesh and BuildMeshLods
+        template<typename T>
+        static StaticMesh* CreateOptimized(std::vector<T> vertices, IndexList indices);
+        // Optimizes the mesh and packs it to VertexPacked or VertexExtPacked
+        template<typename T>
+        static StaticMesh* CreatePacked(std::vector<T> vertices, IndexList indices);
 
         static StaticMesh* Load(const char* buffer, size_t length);
-        static StaticMesh* Load(const char* path);
+        // Imports the mesh at 'path' and caches it next to it, the next loads
+        // map the cache instead until the source changes. A packed mesh is drawn with VertexPacked
+        static StaticMesh* Load(const char* path, bool packed = false);
 
         void Destroy();
 
-        MEM_POOL_DECLARE(StaticMesh);
+        bool IsPacked() const { return mPacked; }
+        const MeshLodChain& GetLods() const { return mLods; }
+
+        MEM_POOL_DECLARE_CONCURRENT(StaticMesh);
     
     private:
-        uint32_t mVBO, mIBO;
-        uint32_t mCount;
+        // Mesh of a cache mapped at 'data'
+        static StaticMesh* Create(const MeshFileHeader& header, const uint8_t* data, bool packed);
+        // Packs 'vertices' to 'packed' in the bounds of the mesh and uploads them
+        template<typename T, typename P>
+        static StaticMesh* Pack(const std::vector<T>& vertices, const IndexList& indices, std::vector<P>& packed);
+        static void Import(const char* path, VertexList& vertices, IndexList& indices);
+        // Appends the LODs to 'indices'
+        template<typename T>
+        static MeshLodChain Optimize(std::vector<T>& vertices, IndexList& indices);
+
+        template<typename T>
+        void ComputeBounds(const std::vector<T>& vertices);
+
+        // Vertices and indices in a shared mesh buffer
+        MeshAllocation mAlloc;
+        // Index ranges of the LODs in mAlloc, LOD 0 draws the full mesh
+        MeshLodChain mLods;
+        // Keeps the instances of a mesh together when the draws are sorted
+        uint32_t mId;
+        static uint32_t mNextId;
+        // Local space bounding box
+        Vector3 mBoundsCenter;
+        Vector3 mBoundsExtent;
+        // The positions of a packed mesh are decoded by the model matrix, see Entity::GetObjectModel
+        bool mPacked;
+        VertexQuantization mQuantization;
     };
 }
\ No newline at end of file
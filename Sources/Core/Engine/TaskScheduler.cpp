@@ -1,4 +1,5 @@
 #include "TaskScheduler.h"
+#include <algorithm>
 
 namespace Engine
 {
@@ -9,6 +10,14 @@ namespace Engine
 #ifndef SINGLE_THREAD
         mThreadPool = new ThreadPool(MAX_TASKS_PER_FRAME);
         LOG_INFO("[LOG] Thread pool create.\n");
+
+        // The calling thread of a ParallelFor is one of its workers
+        mParallelStop = false;
+        const uint32_t workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+        for (uint32_t i = 0; i < workerCount; i++)
+        {
+            mParallelWorkers.emplace_back([this]() { ParallelWorker(); });
+        }
 #endif
     }
 
@@ -17,9 +26,111 @@ namespace Engine
 #ifndef SINGLE_THREAD
         delete mThreadPool;
         LOG_INFO("[LOG] Thread pool delete.\n")
+
+        {
+            std::lock_guard<std::mutex> lock(mParallelMutex);
+            mParallelStop = true;
+        }
+        mParallelWork.notify_all();
+        for (auto& worker : mParallelWorkers)
+        {
+            worker.join();
+        }
+        mParallelWorkers.clear();
 #endif
     }
 
+#ifndef SINGLE_THREAD
+    void TaskScheduler::RunParallel(uint32_t count, ParallelFunc invoke, void* func)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        ParallelJob* job = nullptr;
+        if (count > 1)
+        {
+            std::lock_guard<std::mutex> lock(mParallelMutex);
+            for (auto& slot : mParallelJobs)
+            {
+                if (!slot.active)
+                {
+                    job = &slot;
+                    job->invoke = invoke;
+                    job->func = func;
+                    job->count = count;
+                    job->next = 0;
+                    job->active = true;
+                    break;
+                }
+            }
+        }
+
+        // A single index, or every slot taken e.g. by a ParallelFor inside another one
+        if (!job)
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                invoke(func, i);
+            }
+            return;
+        }
+
+        mParallelWork.notify_all();
+        RunParallelIndices(*job);
+
+        // Every index was taken, the workers still on the job are running their last ones
+        std::unique_lock<std::mutex> lock(mParallelMutex);
+        mParallelDone.wait(lock, [job]() { return job->helpers == 0; });
+        job->active = false;
+    }
+
+    void TaskScheduler::RunParallelIndices(ParallelJob& job)
+    {
+        for (uint32_t i = job.next++; i < job.count; i = job.next++)
+        {
+            job.invoke(job.func, i);
+        }
+    }
+
+    TaskScheduler::ParallelJob* TaskScheduler::FindParallelJob()
+    {
+        for (auto& slot : mParallelJobs)
+        {
+            if (slot.active && slot.next.load() < slot.count)
+            {
+                return &slot;
+            }
+        }
+        return nullptr;
+    }
+
+    void TaskScheduler::ParallelWorker()
+    {
+        std::unique_lock<std::mutex> lock(mParallelMutex);
+        for (;;)
+        {
+            ParallelJob* job = nullptr;
+            mParallelWork.wait(lock, [this, &job]() { return mParallelStop || (job = FindParallelJob()) != nullptr; });
+            if (mParallelStop)
+            {
+                return;
+            }
+
+            job->helpers++;
+            lock.unlock();
+            RunParallelIndices(*job);
+            lock.lock();
+
+            if (--job->helpers == 0)
+            {
+                mParallelDone.notify_all();
+            }
+        }
+    }
+#endif
+
 #ifdef SINGLE_THREAD
     void TaskScheduler::Execute()
     {
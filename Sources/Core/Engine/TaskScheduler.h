@@ -1,6 +1,8 @@
 #pragma once
 #include <ThreadPool.h>
 #include <Common\Constants.h>
+#include <atomic>
+#include <memory>
 
 #define GTaskScheduler Engine::g_TaskScheduler
 #define ScheduleTask(F, ...) g_TaskScheduler.Schedule(F, __VA_ARGS__)
@@ -29,9 +31,57 @@ namespace Engine
 #endif
         }
 
+        // Runs f(i) for every i in [0, count) and waits for all of them to finish.
+        // The calling thread takes indices along with the parallel workers. Nothing is
+        // allocated, f is called through a pointer to it and the job lives in a fixed slot.
+        template<typename F>
+        void ParallelFor(uint32_t count, F&& f)
+        {
+#ifdef SINGLE_THREAD
+            for (uint32_t i = 0; i < count; i++)
+            {
+                f(i);
+            }
+#else
+            typedef std::remove_reference_t<F> Func;
+            RunParallel(count, [](void* func, uint32_t i) { (*static_cast<Func*>(func))(i); },
+                const_cast<void*>(static_cast<const void*>(std::addressof(f))));
+#endif
+        }
+
     private:
 #ifndef SINGLE_THREAD
+        // ParallelFor calls running at the same time, the ones past that run on their calling thread
+        static constexpr uint32_t MAX_PARALLEL_JOBS = 4;
+
+        typedef void(*ParallelFunc)(void* func, uint32_t index);
+
+        struct ParallelJob
+        {
+            ParallelFunc invoke = nullptr;
+            void* func = nullptr;
+            uint32_t count = 0;
+            // Next index to run, past count once every index was taken
+            std::atomic<uint32_t> next{ 0 };
+            // Workers running indices of the job, the slot is reused once they all left
+            uint32_t helpers = 0;
+            bool active = false;
+        };
+
+        void RunParallel(uint32_t count, ParallelFunc invoke, void* func);
+        void RunParallelIndices(ParallelJob& job);
+        ParallelJob* FindParallelJob();
+        void ParallelWorker();
+
         ThreadPool* mThreadPool;
+
+        ParallelJob mParallelJobs[MAX_PARALLEL_JOBS];
+        std::vector<std::thread> mParallelWorkers;
+        // Guards the slots and the helper counts
+        std::mutex mParallelMutex;
+        std::condition_variable mParallelWork;
+        std::condition_variable mParallelDone;
+        bool mParallelStop = false;
 #else
         std::queue<std::function<void()>> mTask;
 #endif
@@ -0,0 +1,91 @@
+#include "TextureFile.h"
+#include <Common\Constants.h>
+#include <Common\MipGenerator.h>
+#include <Engine\TaskScheduler.h>
+#include <vulkan\vulkan.hpp>
+#include <stb_image.h>
+#include <fstream>
+#include <vector>
+
+namespace Engine
+{
+    bool TextureFile::Cook(const char* srcPath, const char* dstPath, bool genmips, bool srgb)
+    {
+        int width, height, channels;
+        stbi_uc* pixels = stbi_load(srcPath, &width, &height, &channels, STBI_rgb_alpha);
+        if (!pixels)
+        {
+            LOG_ERROR("[ERROR] Failed to cook texture {}: {}\n", srcPath, stbi_failure_reason());
+            return false;
+        }
+
+        bool written = Write(dstPath, pixels, (uint32_t)width, (uint32_t)height, genmips, srgb);
+        stbi_image_free(pixels);
+
+        LOG_INFO("[LOG] Cook texture {} -> {}\n", srcPath, dstPath);
+        return written;
+    }
+
+    bool TextureFile::Write(const char* dstPath, const uint8_t* rgba, uint32_t width, uint32_t height,
+        bool genmips, bool srgb)
+    {
+        if (!rgba || width == 0 || height == 0) return false;
+
+        uint32_t levels = genmips ? GetMipLevelCount(width, height) : 1;
+        if (levels > TextureFileHeader::MAX_MIPS) return false;
+
+        std::vector<uint8_t> mips(rgba, rgba + (size_t)width * height * 4);
+        std::vector<size_t> offsets = GenerateMipChainRGBA8(mips, width, height, levels, MipFilter::Kaiser, srgb,
+            [](uint32_t count, const std::function<void(uint32_t)>& f) { GTaskScheduler.ParallelFor(count, f); });
+
+        TextureFileHeader header = {};
+        header.magic = TextureFileHeader::MAGIC;
+        header.version = TextureFileHeader::VERSION;
+        header.width = width;
+        header.height = height;
+        header.format = static_cast<uint32_t>(vk::Format::eR8G8B8A8Unorm);
+        header.mipLevels = levels;
+        for (uint32_t i = 0; i < levels; i++)
+        {
+            size_t end = i + 1 < levels ? offsets[i + 1] : mips.size();
+            header.mipOffset[i] = sizeof(TextureFileHeader) + offsets[i];
+            header.mipSize[i] = end - offsets[i];
+        }
+
+        std::ofstream fout(dstPath, std::ofstream::binary | std::ofstream::trunc);
+        if (!fout.good()) return false;
+
+        fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        fout.write(reinterpret_cast<const char*>(mips.data()), mips.size());
+        return fout.good();
+    }
+
+    const TextureFileHeader* TextureFile::Read(const void* data, size_t size)
+    {
+        if (!data || size < sizeof(TextureFileHeader)) return nullptr;
+
+        const TextureFileHeader* header = static_cast<const TextureFileHeader*>(data);
+        if (header->magic != TextureFileHeader::MAGIC ||
+            header->version != TextureFileHeader::VERSION ||
+            header->format != static_cast<uint32_t>(vk::Format::eR8G8B8A8Unorm) ||
+            header->mipLevels == 0 || header->mipLevels > TextureFileHeader::MAX_MIPS)
+        {
+            return nullptr;
+        }
+
+        uint32_t width = header->width;
+        uint32_t height = header->height;
+        for (uint32_t i = 0; i < header->mipLevels; i++)
+        {
+            if (header->mipSize[i] != (uint64_t)width * height * 4 ||
+                header->mipOffset[i] + header->mipSize[i] > size)
+            {
+                return nullptr;
+            }
+            width = NextMipSize(width);
+            height = NextMipSize(height);
+        }
+
+        return header;
+    }
+}
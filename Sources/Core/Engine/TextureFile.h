@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+namespace Engine
+{
+    // Header of a cooked texture. The mips follow it from the biggest one,
+    // each one tightly packed in the format of the header
+    struct TextureFileHeader
+    {
+        static constexpr uint32_t MAGIC = 0x5845544C; // "LTEX"
+        static constexpr uint32_t VERSION = 1;
+        static constexpr uint32_t MAX_MIPS = 16;
+
+        uint32_t magic;
+        uint32_t version;
+        uint32_t width, height;
+        // vk::Format of the mips
+        uint32_t format;
+        uint32_t mipLevels;
+        // Offsets from the start of the file
+        uint64_t mipOffset[MAX_MIPS];
+        uint64_t mipSize[MAX_MIPS];
+    };
+
+    // Writes and reads the container of cooked textures, the runtime maps it
+    // and copies the mips to staging memory without decoding anything
+    class TextureFile
+    {
+    public:
+        // Appended to the path of the source image
+        static constexpr const char* EXTENSION = ".ltex";
+
+        // Decodes the image at 'srcPath' and writes it with its mips to 'dstPath'.
+        // 'srgb' filters the color of the mips in linear space, leave it off for normal maps and masks
+        static bool Cook(const char* srcPath, const char* dstPath, bool genmips, bool srgb = true);
+        static bool Write(const char* dstPath, const uint8_t* rgba, uint32_t width, uint32_t height,
+            bool genmips, bool srgb = true);
+        // Returns the header if 'data' holds a whole cooked texture, null otherwise
+        static const TextureFileHeader* Read(const void* data, size_t size);
+    };
+}
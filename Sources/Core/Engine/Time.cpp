@@ -58,7 +58,14 @@ LAVA_API float GetTimeNow()
 
 LAVA_API float GetFixedDeltaTime()
 {
-    return TIME_STEP;
+    return Engine::g_Time.fixedDeltaTime;
+}
+
+LAVA_API void SetFixedDeltaTime(float dt)
+{
+    // A step of 0 would never consume the accumulated time, NaN fails the test too
+    dt = dt >= MIN_TIME_STEP ? dt : MIN_TIME_STEP;
+    Engine::g_Time.fixedDeltaTime = dt;
 }
 
 LAVA_API float GetDeltaTime()
@@ -10,6 +10,7 @@ namespace Engine
         float time = 0.f;
         float fixedTime = 0.f;
         float timeScale = 1.f;
+        float fixedDeltaTime = TIME_STEP;
 
         double lastTime = 0.0;
 
@@ -50,6 +51,13 @@ extern "C"
     /// </summary>
     LAVA_API float GetFixedDeltaTime();
 
+    /// <summary>
+    /// Sets the fixed update rate. The physics is stepped at this rate and
+    /// the rendered transforms are interpolated between the last two steps.
+    /// <para>Values below MIN_TIME_STEP are clamped to it.</para>
+    /// </summary>
+    LAVA_API void SetFixedDeltaTime(float dt);
+
     /// <summary>
     /// Returns the time that passed since the last frame.
     /// </summary>
@@ -6,6 +6,13 @@
 #include <Manager\BufferManager.h>
 #include <Manager\WorldManager.h>
 #include <Manager\ResourceManager.h>
+#include <Manager\TextureManager.h>
+#include "TaskScheduler.h"
+#include <Common\AllocationCounter.h>
+#include <Common\RadixSort.h>
+#include <algorithm>
+#include <cmath>
+#include <thread>
 #define OCTREE_IMPL
 #include <Octree.h>
 
@@ -18,7 +25,11 @@ namespace Engine
         LOG_INFO("[LOG] Create world {0:#x}\n", (uint64_t)this);
         mEntityList.reserve(INIT_CAPACITY);
 		mIBLProbes.reserve(1);
-        mDirty = WORLD_CLEAN;
+        mDirty = WORLD_DIRTY;
+        mUploadAllTransforms = WORLD_DIRTY;
+        mDrawStats = {};
+        mIndirectDraw = false;
+        mLodErrorPixels = 1.f;
         mPhysicsWorld = nullptr;
         
         mVisibleEntities = nullptr;
@@ -30,11 +41,22 @@ namespace Engine
             mPhysicsWorld->Init();
         }
 
+#ifdef SINGLE_THREAD
+        mRecordThreadCount = 1;
+#else
+        mRecordThreadCount = std::clamp(std::thread::hardware_concurrency(), 1u, MAX_RECORD_THREADS);
+#endif
+
         vk::CommandPoolCreateInfo commandPoolCreateInfo(
             vk::CommandPoolCreateFlagBits::eTransient |
             vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
             GRAPHICS_FAMILY_INDEX);
-        mCommandPool = g_vkDevice.createCommandPool(commandPoolCreateInfo);
+        mCommandPool.resize(mRecordThreadCount);
+        mChunkStats.reserve(mRecordThreadCount);
+        for (auto& pool : mCommandPool)
+        {
+            pool = g_vkDevice.createCommandPool(commandPoolCreateInfo);
+        }
 
         CreateWorldCommandBuffers();
     }
@@ -42,7 +64,18 @@ namespace Engine
     void World::Destroy()
     {
         LOG_INFO("[LOG] Destroy world {0:#x}\n", (uint64_t)this);
-        g_vkDevice.destroyCommandPool(mCommandPool);
+        for (auto pool : mCommandPool)
+        {
+            g_vkDevice.destroyCommandPool(pool);
+        }
+        for (auto& instances : mInstanceBuffers)
+        {
+            instances.Destroy();
+        }
+        for (auto& commands : mIndirectBuffers)
+        {
+            commands.Destroy();
+        }
         DestroyEntities();
         mPhysicsWorld->Destroy();
         mAllocator.deleteElement(this);
@@ -50,25 +83,62 @@ namespace Engine
 
     void World::FreeWorldCommandBuffers()
     {
-        g_vkDevice.freeCommandBuffers(mCommandPool, mCommandBuffer);
+        std::vector<vk::CommandBuffer> buffers(mCommandBuffer.size());
+        for (uint32_t t = 0; t < mRecordThreadCount; t++)
+        {
+            for (size_t i = 0; i < mCommandBuffer.size(); i++)
+            {
+                buffers[i] = mCommandBuffer[i][t];
+            }
+            g_vkDevice.freeCommandBuffers(mCommandPool[t], buffers);
+        }
+        mCommandBuffer.clear();
+
+        for (auto& instances : mInstanceBuffers)
+        {
+            instances.Destroy();
+        }
+        mInstanceBuffers.clear();
+
+        for (auto& commands : mIndirectBuffers)
+        {
+            commands.Destroy();
+        }
+        mIndirectBuffers.clear();
     }
 
     void World::CreateWorldCommandBuffers()
     {
-        // World should be split and cmdbuffer registered by multiple threads
-        // I should add at least one secondary buffer for objects created at runtime
-        // One world for static objects, and one for animated objects but not created at runtime
-        vk::CommandBufferAllocateInfo cmdBufferAllocInfo(
-            mCommandPool,
-            vk::CommandBufferLevel::eSecondary,
-            GSwapchain.GetImageCount());
+        // Every record thread allocates from its own pool one secondary buffer per swapchain image
+        uint32_t imageCount = GSwapchain.GetImageCount();
+        mCommandBuffer.assign(imageCount, std::vector<vk::CommandBuffer>(mRecordThreadCount));
+        mRecordedCount.assign(imageCount, 0);
+        mRecordedList.assign(imageCount, {});
+        mInstanceBuffers.assign(imageCount, GpuArrayBuffer<InstanceData>(vk::BufferUsageFlagBits::eVertexBuffer));
+        mIndirectBuffers.assign(imageCount,
+            GpuArrayBuffer<vk::DrawIndexedIndirectCommand>(vk::BufferUsageFlagBits::eIndirectBuffer));
+        mDirtyTransforms.assign(imageCount, {});
+        mDirty = WORLD_DIRTY;
+        mUploadAllTransforms = WORLD_DIRTY;
 
-        mCommandBuffer = g_vkDevice.allocateCommandBuffers(cmdBufferAllocInfo);
+        for (uint32_t t = 0; t < mRecordThreadCount; t++)
+        {
+            vk::CommandBufferAllocateInfo cmdBufferAllocInfo(
+                mCommandPool[t],
+                vk::CommandBufferLevel::eSecondary,
+                imageCount);
+
+            auto buffers = g_vkDevice.allocateCommandBuffers(cmdBufferAllocInfo);
+            for (uint32_t i = 0; i < imageCount; i++)
+            {
+                mCommandBuffer[i][t] = buffers[i];
+            }
+        }
     }
 
-	void World::UploadLightSources() const
+	void World::UploadLightSources(uint32_t imageIndex) const
 	{
-		auto& lightsBuffer = g_ResourceManager.GetLightsBuffer();
+		auto& lightsBuffer = g_ResourceManager.GetLightsBuffer(imageIndex);
 		
 		if (lightsBuffer.Size() != mLightInfo.size())
 		{
@@ -101,16 +171,60 @@ namespace Engine
 		lightsBuffer.Commit();
 	}
 
-	void World::UploadFrameConsts() const
+	void World::UploadFrameConsts(uint32_t imageIndex) const
 	{
-		auto& frameConsts = g_ResourceManager.GetFrameConstsBuffer();
+		auto& frameConsts = g_ResourceManager.GetFrameConstsBuffer(imageIndex);
 		frameConsts.Get().ambientLight = mSkySettings.ambient;
 		frameConsts.Get().numLights = mLightInfo.size();
 		frameConsts.Get().exposure = mSkySettings.exposure;
 		frameConsts.Get().gamma = mSkySettings.gamma;
+		frameConsts.Get().viewProj = mViewProj;
+		frameConsts.Get().eyePos = Vector4(mCameraPos, 1.0f);
 		frameConsts.Commit();
 	}
 
+	void World::UploadTransforms(uint32_t imageIndex)
+	{
+		auto& objects = g_ResourceManager.GetObjectsBuffer(imageIndex);
+		auto& dirtyTransforms = mDirtyTransforms[imageIndex];
+		const uint8_t imageBit = 1 << imageIndex;
+
+		if (objects.Size() != mEntityList.size())
+		{
+			objects.Clear();
+			objects.Reserve(mEntityList.size());
+
+			for (auto ent : mEntityList)
+			{
+				ObjectData od;
+				od.model = ent->GetObjectModel();
+				objects.Add(od);
+			}
+		}
+		else if (mUploadAllTransforms & imageBit)
+		{
+			for (auto ent : mEntityList)
+			{
+				objects[ent->mObjectIndex].model = ent->GetObjectModel();
+			}
+		}
+		else
+		{
+			for (auto ent : dirtyTransforms)
+			{
+				objects[ent->mObjectIndex].model = ent->GetObjectModel();
+			}
+		}
+
+		mUploadAllTransforms &= ~imageBit;
+		dirtyTransforms.clear();
+
+		if (objects.Size() > 0)
+		{
+			objects.Commit();
+		}
+	}
+
 	void World::AddIBLProbeInfo(const IBLProbeInfo & info)
 	{
 		IBLProbe probe;
@@ -121,13 +235,37 @@ namespace Engine
     
     void World::AddEntity(Entity * ent)
     {
+        ent->mObjectIndex = static_cast<uint32_t>(mEntityList.size());
         mEntityList.push_back(ent);
         ent->OnAddToWorld();
         ent->mWorld = this;
-        otr::Vector3 position(ent->mPosition.x, ent->mPosition.y, ent->mPosition.z);
-        mVisibleEntities->Insert(otr::OctreeData<Entity>::New(position, ent));
+        InsertVisible(ent);
         mDirty = WORLD_DIRTY;
     }
+
+    void World::UpdateEntityTransform(Entity* ent)
+    {
+        assert(ent->mOctreeData != nullptr);
+        ent->UpdateBounds();
+        otr::Vector3 center(ent->mBoundsCenter.x, ent->mBoundsCenter.y, ent->mBoundsCenter.z);
+        otr::Vector3 extent(ent->mBoundsExtent.x, ent->mBoundsExtent.y, ent->mBoundsExtent.z);
+        otr::Octree<Entity>::Relocate(ent->mOctreeData, center, extent);
+        // The model matrix is read from the objects buffer so the recorded commands stay valid.
+        // Every swapchain image has its own buffer, each one is written when its image comes up
+        for (auto& dirtyTransforms : mDirtyTransforms)
+        {
+            dirtyTransforms.push_back(ent);
+        }
+    }
+
+    void World::InsertVisible(Entity* ent)
+    {
+        ent->UpdateBounds();
+        otr::Vector3 center(ent->mBoundsCenter.x, ent->mBoundsCenter.y, ent->mBoundsCenter.z);
+        otr::Vector3 extent(ent->mBoundsExtent.x, ent->mBoundsExtent.y, ent->mBoundsExtent.z);
+        ent->mOctreeData = otr::OctreeData<Entity>::New(center, extent, ent);
+        mVisibleEntities->Insert(ent->mOctreeData);
+    }
     
     void World::BuildVisibles()
     {
@@ -139,11 +277,33 @@ namespace Engine
         otr::Vector3 extent(1e6f);
         mVisibleEntities = otr::Octree<Entity>::New(origin, extent);
         assert(mVisibleEntities != nullptr);
+
+        // The old handles were freed with the tree
+        for (Entity* ent : mEntityList)
+        {
+            InsertVisible(ent);
+        }
     }
 
     void World::RecordWorldCommandBuffers(uint32_t imageIndex)
     {
-        //if ((mDirty & (1 << imageIndex)) == 0) return;
+        // The lists only grow with the scene, ParallelFor takes no allocation either
+        EXPECT_NO_ALLOCATIONS("World::RecordWorldCommandBuffers");
+
+        mVisibleList.clear();
+        otr::Frustum frustum = otr::Frustum::FromMatrix(reinterpret_cast<const float*>(&mViewProj));
+        mVisibleEntities->GetDataInsideFrustum(frustum, mVisibleList);
+        RequestTextureMips();
+        if (SelectLods())
+        {
+            mDirty = WORLD_DIRTY;
+        }
+
+        // Camera and transforms live in buffers, so the commands recorded for this
+        // image are still valid unless the world changed or other entities are visible
+        const uint8_t dirtyBit = 1 << imageIndex;
+        if ((mDirty & dirtyBit) == 0 && mVisibleList == mRecordedList[imageIndex])
+            return;
 
         vk::CommandBufferInheritanceInfo inheritanceInfo(
             GSwapchain.GetFramePass()->GetVkObject(),
@@ -156,34 +316,288 @@ namespace Engine
             vk::CommandBufferUsageFlagBits::eSimultaneousUse |
             vk::CommandBufferUsageFlagBits::eRenderPassContinue,
             &inheritanceInfo);
-        mCommandBuffer[imageIndex].begin(beginInfo);
 
         vk::Viewport viewport(0.f, 0.f, (float)GWINDOW_WIDTH, (float)GWINDOW_HEIGHT, 0.f, 1.f);
-        mCommandBuffer[imageIndex].setViewport(0, { viewport });
-
         vk::Rect2D scissor({}, { GWINDOW_WIDTH, GWINDOW_HEIGHT });
-        mCommandBuffer[imageIndex].setScissor(0, { scissor });
 
-        /*for (auto ent : mEntityList)
+        const bool complete = BuildDrawList(imageIndex);
+        vk::Buffer instanceBuffer = mDrawList.empty() ? vk::Buffer() : mInstanceBuffers[imageIndex].GetBuffer();
+
+        if (mIndirectDraw)
         {
-            ent->Draw(mCommandBuffer[imageIndex]);
-        }*/
+            BuildIndirectCommands(imageIndex);
+        }
 
-        std::vector<otr::OctreeData<Entity>*> entities;
-        otr::Vector3 bmin(mViewBoundingMin.x, mViewBoundingMin.y, mViewBoundingMin.z);
-        otr::Vector3 bmax(mViewBoundingMax.x, mViewBoundingMax.y, mViewBoundingMax.z);
-        mVisibleEntities->GetPointsInsideBox(bmin, bmax, entities);
+        // Split the draw list in contiguous chunks, one per record thread.
+        // The indirect path records a few draws per bucket, one thread is enough
+        uint32_t entityCount = static_cast<uint32_t>(mDrawList.size());
+        uint32_t chunkCount = (entityCount + MIN_ENTITIES_PER_THREAD - 1) / MIN_ENTITIES_PER_THREAD;
+        chunkCount = std::clamp(chunkCount, 1u, mIndirectDraw ? 1u : mRecordThreadCount);
+        uint32_t chunkSize = (entityCount + chunkCount - 1) / chunkCount;
 
-        for (auto ent : entities)
+        const auto& cmdBuffers = mCommandBuffer[imageIndex];
+        mChunkStats.assign(chunkCount, {});
+        GTaskScheduler.ParallelFor(chunkCount, [&](uint32_t chunk)
+        {
+            vk::CommandBuffer cmdBuff = cmdBuffers[chunk];
+            cmdBuff.begin(beginInfo);
+            cmdBuff.setViewport(0, { viewport });
+            cmdBuff.setScissor(0, { scissor });
+
+            // Every secondary buffer starts without any state bound
+            DrawState state = {};
+            state.imageIndex = imageIndex;
+            uint32_t first = chunk * chunkSize;
+            uint32_t last = std::min(first + chunkSize, entityCount);
+
+            if (first < last)
+            {
+                vk::DeviceSize offset = 0;
+                cmdBuff.bindVertexBuffers(1, 1, &instanceBuffer, &offset);
+                ++state.stats.binds;
+            }
+
+            if (mIndirectDraw)
+            {
+                RecordIndirect(cmdBuff, imageIndex, state);
+                state.stats.instances += last - first;
+                first = last;
+            }
+
+            // Consecutive entities sharing the mesh and the material are drawn as instances
+            for (uint32_t i = first; i < last; )
+            {
+                Entity* ent = mDrawList[i].entity;
+                uint32_t count = 1;
+                while (i + count < last && mDrawList[i + count].entity->CanInstanceWith(ent))
+                {
+                    ++count;
+                }
+
+                ent->Draw(cmdBuff, state, i, count);
+                i += count;
+            }
+            mChunkStats[chunk] = state.stats;
+
+            cmdBuff.end();
+        });
+
+        mDrawStats = {};
+        for (const auto& stats : mChunkStats)
         {
-            ent->mData->Draw(mCommandBuffer[imageIndex]);
+            mDrawStats.draws += stats.draws;
+            mDrawStats.instances += stats.instances;
+            mDrawStats.binds += stats.binds;
+            mDrawStats.skippedBinds += stats.skippedBinds;
+            mDrawStats.indirectDraws += stats.indirectDraws;
+            mDrawStats.indirectCommands += stats.indirectCommands;
         }
 
-        mCommandBuffer[imageIndex].end();
-
-        //mDirty &= ~(1 << imageIndex);
+        mRecordedCount[imageIndex] = chunkCount;
+        mRecordedList[imageIndex] = mVisibleList;
+        // The entities left out are added once their meshes are uploaded
+        if (complete)
+        {
+            mDirty &= ~dirtyBit;
+        }
     }
     
+    bool World::BuildDrawList(uint32_t imageIndex)
+    {
+        EXPECT_NO_ALLOCATIONS("World::BuildDrawList");
+
+        mDrawList.clear();
+        mDrawList.reserve(mVisibleList.size());
+
+        // Clip space w is the view depth. The matrix is column-major so rowN holds the N-th column.
+        const Matrix4& m = mViewProj;
+        bool complete = true;
+        for (auto data : mVisibleList)
+        {
+            Entity* ent = data->mData;
+            if (!GBufferManager.IsUploaded(ent->mMesh->mAlloc))
+            {
+                complete = false;
+                continue;
+            }
+
+            // Entities and materials update their descriptors on first draw, do it
+            // here so the record threads only read shared state
+            ent->PrepareDraw(imageIndex);
+
+            const Vector3& c = ent->mBoundsCenter;
+            float depth = m.row1.w * c.x + m.row2.w * c.y + m.row3.w * c.z + m.row4.w;
+            mDrawList.push_back({ ent->GetSortKey(depth), ent });
+        }
+
+        RadixSort(mDrawList, mDrawListTmp);
+
+        // The instance attribute of a draw list item is the object index of its entity
+        auto& instances = mInstanceBuffers[imageIndex];
+        instances.Clear();
+        instances.Reserve(mDrawList.size());
+        for (const auto& item : mDrawList)
+        {
+            InstanceData instance;
+            instance.objectIndex = item.entity->mObjectIndex;
+            instances.Add(instance);
+        }
+
+        if (instances.Size() > 0)
+        {
+            instances.Commit();
+        }
+        return complete;
+    }
+
+    void World::RequestTextureMips() const
+    {
+        // The y row of the view-projection is the up axis scaled by the focal length
+        // and clip space w is the view depth, see BuildDrawList
+        const Matrix4& m = mViewProj;
+        const float focal = std::sqrt(m.row1.y * m.row1.y + m.row2.y * m.row2.y + m.row3.y * m.row3.y);
+        const float halfHeight = 0.5f * GWINDOW_HEIGHT;
+
+        for (auto data : mVisibleList)
+        {
+            const Entity* ent = data->mData;
+            if (!ent->mMaterial) continue;
+
+            const Vector3& c = ent->mBoundsCenter;
+            const Vector3& e = ent->mBoundsExtent;
+            float depth = std::max(m.row1.w * c.x + m.row2.w * c.y + m.row3.w * c.z + m.row4.w, 1e-3f);
+            float diameter = 2.f * std::sqrt(e.x * e.x + e.y * e.y + e.z * e.z);
+            float pixels = diameter * focal * halfHeight / depth;
+
+            ent->mMaterial->ForEachTexture([pixels](uint32_t texture)
+            {
+                GTextureManager.RequestTextureSize(texture, pixels);
+            });
+        }
+    }
+
+    bool World::SelectLods()
+    {
+        // Pixels covered by a world unit at distance 1, see RequestTextureMips
+        const Matrix4& m = mViewProj;
+        const float focal = std::sqrt(m.row1.y * m.row1.y + m.row2.y * m.row2.y + m.row3.y * m.row3.y);
+        const float pixelsPerUnit = focal * 0.5f * GWINDOW_HEIGHT;
+
+        bool changed = false;
+        for (auto data : mVisibleList)
+        {
+            Entity* ent = data->mData;
+            const MeshLodChain& lods = ent->mMesh->GetLods();
+
+            // Distance to the closest point of the bounds, 0 inside them
+            const Vector3& c = ent->mBoundsCenter;
+            const Vector3& e = ent->mBoundsExtent;
+            const float dx = std::max(std::fabs(mCameraPos.x - c.x) - e.x, 0.f);
+            const float dy = std::max(std::fabs(mCameraPos.y - c.y) - e.y, 0.f);
+            const float dz = std::max(std::fabs(mCameraPos.z - c.z) - e.z, 0.f);
+            const float distance = std::max(std::sqrt(dx * dx + dy * dy + dz * dz), 1e-3f);
+            // Pixels covered by a local space unit of the mesh
+            const float pixels = ent->GetMaxScale() * pixelsPerUnit / distance;
+
+            uint32_t lod = 0;
+            while (lod + 1 < lods.count && lods.lods[lod + 1].error * pixels <= mLodErrorPixels)
+            {
+                ++lod;
+            }
+            // Moving around a switch distance would otherwise record the world every frame
+            if (lod < ent->mLod && ent->mLod < lods.count &&
+                lods.lods[ent->mLod].error * pixels <= mLodErrorPixels * LOD_HYSTERESIS)
+            {
+                lod = ent->mLod;
+            }
+
+            if (ent->mLod != lod)
+            {
+                ent->mLod = lod;
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    void World::SetIndirectDraw(bool enable)
+    {
+        // Every indirect command reads its instances from firstInstance
+        if (enable && !GDevice.mDrawIndirectFirstInstance)
+        {
+            LOG_WARNING("[WARNING] Indirect draw needs drawIndirectFirstInstance, using direct draws.\n");
+            enable = false;
+        }
+
+        if (mIndirectDraw != enable)
+        {
+            mIndirectDraw = enable;
+            mDirty = WORLD_DIRTY;
+        }
+    }
+
+    void World::BuildIndirectCommands(uint32_t imageIndex)
+    {
+        auto& commands = mIndirectBuffers[imageIndex];
+        commands.Clear();
+        mIndirectBuckets.clear();
+
+        // One command per instance group, groups sharing the bound state form a bucket
+        const uint32_t count = static_cast<uint32_t>(mDrawList.size());
+        for (uint32_t i = 0; i < count; )
+        {
+            Entity* ent = mDrawList[i].entity;
+            uint32_t instanceCount = 1;
+            while (i + instanceCount < count && mDrawList[i + instanceCount].entity->CanInstanceWith(ent))
+            {
+                ++instanceCount;
+            }
+
+            if (mIndirectBuckets.empty() || !mIndirectBuckets.back().entity->CanShareIndirectDraw(ent))
+            {
+                mIndirectBuckets.push_back({ ent, static_cast<uint32_t>(commands.Size()), 0 });
+            }
+
+            commands.Add(ent->GetIndirectCommand(i, instanceCount));
+            ++mIndirectBuckets.back().commandCount;
+            i += instanceCount;
+        }
+
+        if (commands.Size() > 0)
+        {
+            commands.Commit();
+        }
+    }
+
+    void World::RecordIndirect(vk::CommandBuffer cmdBuff, uint32_t imageIndex, DrawState& state) const
+    {
+        if (mIndirectBuckets.empty()) return;
+
+        vk::Buffer commandBuffer = mIndirectBuffers[imageIndex].GetBuffer();
+        const uint32_t stride = sizeof(vk::DrawIndexedIndirectCommand);
+
+        for (const auto& bucket : mIndirectBuckets)
+        {
+            bucket.entity->BindState(cmdBuff, state);
+            vk::DeviceSize offset = bucket.firstCommand * stride;
+
+            if (GDevice.mMultiDrawIndirect)
+            {
+                cmdBuff.drawIndexedIndirect(commandBuffer, offset, bucket.commandCount, stride);
+                ++state.stats.indirectDraws;
+            }
+            else
+            {
+                for (uint32_t c = 0; c < bucket.commandCount; c++)
+                {
+                    cmdBuff.drawIndexedIndirect(commandBuffer, offset + c * stride, 1, stride);
+                }
+                state.stats.indirectDraws += bucket.commandCount;
+            }
+            state.stats.indirectCommands += bucket.commandCount;
+        }
+    }
+
     void World::DestroyEntities()
     {
         for (auto ent : mEntityList)
@@ -234,10 +648,24 @@ extern "C"
 		world->mSkyViewProj = viewProj;
 	}
 
-    LAVA_API void SetViewBounds_Native(Engine::World* world, Engine::Vector3 bmin, Engine::Vector3 bmax)
+    LAVA_API void SetViewProj_Native(Engine::World* world, Engine::Matrix4 viewProj)
+    {
+        world->mViewProj = viewProj;
+    }
+
+    LAVA_API Engine::DrawStats GetDrawStats_Native(Engine::World* world)
+    {
+        return world->GetDrawStats();
+    }
+
+    LAVA_API void SetIndirectDraw_Native(Engine::World* world, bool enable)
+    {
+        world->SetIndirectDraw(enable);
+    }
+
+    LAVA_API void SetLodErrorPixels_Native(Engine::World* world, float pixels)
     {
-        world->mViewBoundingMin = bmin;
-        world->mViewBoundingMax = bmax;
+        world->SetLodErrorPixels(pixels);
     }
 
     LAVA_API void* GetPhysicsWorld_Native(Engine::World* world)
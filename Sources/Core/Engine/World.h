@@ -4,9 +4,11 @@
 #include "PhysicsWorld.h"
 #include <Common\LightInfo.h>
 #include <Common\WorldStructs.h>
+#include "GpuArrayBuffer.h"
 #include "buffers.h"
 
-#define WORLD_DIRTY 0x3
+// One bit per swapchain image
+#define WORLD_DIRTY 0xFF
 #define WORLD_CLEAN 0x0
 
 namespace otr
@@ -21,6 +23,11 @@ namespace Engine
     {
         friend class WorldManager;
         static constexpr uint32_t INIT_CAPACITY = 8;
+        // Max number of threads recording the world and the min number of entities each one gets
+        static constexpr uint32_t MAX_RECORD_THREADS = 8;
+        static constexpr uint32_t MIN_ENTITIES_PER_THREAD = 64;
+        // A visible entity keeps a coarser LOD until its error is this many times the threshold
+        static constexpr float LOD_HYSTERESIS = 1.25f;
 
     public:
         void Init(bool hasPhysics);
@@ -28,6 +35,10 @@ namespace Engine
         
         void AddEntity(Entity* ent);
         // TODO: RemoveEntity
+        // Updates the entity bounds, its place in the octree and its model matrix on the GPU
+        void UpdateEntityTransform(Entity* ent);
+        // Forces the world to upload all transforms and record its command buffers again
+        void Invalidate() { mDirty = WORLD_DIRTY; mUploadAllTransforms = WORLD_DIRTY; }
 
         void BuildVisibles();
         void RecordWorldCommandBuffers(uint32_t imageIndex);
@@ -36,11 +47,27 @@ namespace Engine
 
         PhysicsWorld* GetPhysicsWorld() const { return mPhysicsWorld; }
 
-		void UploadLightSources() const;
-		void UploadFrameConsts() const;
+		// Fill the buffers of the swapchain image at 'imageIndex'
+		void UploadLightSources(uint32_t imageIndex) const;
+		void UploadFrameConsts(uint32_t imageIndex) const;
+		void UploadTransforms(uint32_t imageIndex);
 
-        vk::CommandBuffer GetWorldCommandBuffer(uint32_t index) const 
-        { return mCommandBuffer[index]; }
+        // Secondary buffers recorded for the swapchain image at 'index'
+        const vk::CommandBuffer* GetWorldCommandBuffers(uint32_t index) const 
+        { return mCommandBuffer[index].data(); }
+
+        uint32_t GetWorldCommandBufferCount(uint32_t index) const
+        { return mRecordedCount[index]; }
+
+        // Counters of the last recorded world
+        const DrawStats& GetDrawStats() const { return mDrawStats; }
+
+        // Draws every pipeline/material/mesh buffer bucket with one indirect draw
+        void SetIndirectDraw(bool enable);
+        bool IsIndirectDraw() const { return mIndirectDraw; }
+
+        // Entities draw the coarsest LOD whose error covers at most this many pixels
+        void SetLodErrorPixels(float pixels) { mLodErrorPixels = pixels; }
 
 		IBLProbe GetNearestIBLProbe(Vector3 position)
 		{
@@ -53,8 +80,8 @@ namespace Engine
 
         uint8_t mDirty;
         Vector3 mCameraPos;
-        Vector3 mViewBoundingMin;
-        Vector3 mViewBoundingMax;
+        // Camera view-projection used for frustum culling
+        Matrix4 mViewProj;
 		SkySettings mSkySettings;
 		Matrix4 mSkyViewProj;
 		std::vector<LightInfo> mLightInfo;
@@ -62,12 +89,62 @@ namespace Engine
         MEM_POOL_DECLARE(World);
         void DestroyEntities();
 		void UpdatePhysicsWorld();
+        void InsertVisible(Entity* ent);
+        // Requests the mips of the streamed textures from the screen size of the visible entities
+        void RequestTextureMips() const;
+        // Picks the LOD of the visible entities from their distance to the camera, true if one changed
+        bool SelectLods();
+        // Sorts the visible entities by state to minimize the binds and
+        // fills the instance buffer of the image. False if an entity was left out
+        // because the data of its mesh is not uploaded yet
+        bool BuildDrawList(uint32_t imageIndex);
+
+        struct DrawItem
+        {
+            uint64_t key;
+            Entity* entity;
+        };
 
-        std::vector<vk::CommandBuffer> mCommandBuffer;
+        // Range of indirect commands drawn with the state of 'entity'
+        struct IndirectBucket
+        {
+            Entity* entity;
+            uint32_t firstCommand;
+            uint32_t commandCount;
+        };
+
+        // Fills the indirect buffer of the image from the draw list
+        void BuildIndirectCommands(uint32_t imageIndex);
+        void RecordIndirect(vk::CommandBuffer cmdBuff, uint32_t imageIndex, DrawState& state) const;
+
+        // One secondary buffer per record thread for every swapchain image
+        std::vector<std::vector<vk::CommandBuffer>> mCommandBuffer;
+        std::vector<uint32_t> mRecordedCount;
         std::vector<Entity*> mEntityList;
         otr::Octree<Entity>* mVisibleEntities;
+        std::vector<otr::OctreeData<Entity>*> mVisibleList;
+        // Entities recorded in the command buffers of every swapchain image
+        std::vector<std::vector<otr::OctreeData<Entity>*>> mRecordedList;
+        // Entities moved since the objects buffer of every swapchain image was written
+        std::vector<std::vector<Entity*>> mDirtyTransforms;
+        // Object index of every draw list item, one buffer per swapchain image
+        std::vector<GpuArrayBuffer<InstanceData>> mInstanceBuffers;
+        std::vector<DrawItem> mDrawList;
+        std::vector<DrawItem> mDrawListTmp;
+        std::vector<DrawStats> mChunkStats;
+        DrawStats mDrawStats;
+
+        bool mIndirectDraw;
+        std::vector<GpuArrayBuffer<vk::DrawIndexedIndirectCommand>> mIndirectBuffers;
+        std::vector<IndirectBucket> mIndirectBuckets;
+
+        // One bit per swapchain image, like mDirty
+        uint8_t mUploadAllTransforms;
+        float mLodErrorPixels;
 
-        vk::CommandPool mCommandPool;
+        // Command pools are externally synchronized so every record thread has its own
+        std::vector<vk::CommandPool> mCommandPool;
+        uint32_t mRecordThreadCount;
         PhysicsWorld* mPhysicsWorld;
 
 		std::vector<IBLProbe> mIBLProbes;
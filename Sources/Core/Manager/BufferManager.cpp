@@ -1,7 +1,9 @@
 #define VMA_IMPLEMENTATION
 #include "BufferManager.h"
 #include <Engine\Device.h>
+#include <Engine\Swapchain.h>
 #include <Engine\TaskScheduler.h>
+#include <algorithm>
 
 namespace Engine
 {
@@ -11,13 +13,13 @@ namespace Engine
     {
         mBuffer.reserve(BUFFER_INIT_CAPACITY);
         mBufferAllocation.reserve(BUFFER_INIT_CAPACITY);
-
-        mStagBuffer.reserve(BUFFER_INIT_CAPACITY);
-        mStagBuffer.reserve(BUFFER_INIT_CAPACITY);
+        mQueuedCopies = 0;
+        mSubmittedCopies = 0;
+        mRetiredCopies = 0;
 
         InitVmaAllocator();
         CreateCopyPool();
-        mBufferFence = GDevice.CreateFence();
+        CreateStagingRing();
 		mUIFence = GDevice.CreateFence();
         
         LOG_INFO("[LOG] BufferManager Init\n");
@@ -25,10 +27,24 @@ namespace Engine
 
     void BufferManager::Destroy()
     {
+        RetireUploads(true);
+        while (!mCopyRequest.empty())
+        {
+            CopyRequest& req = mCopyRequest.front();
+            if (req.stagAllocation)
+                vmaDestroyBuffer(mAllocator, req.stagBuffer, req.stagAllocation);
+            mCopyRequest.pop();
+        }
+
+        for (auto& frame : mUploadFrame)
+        {
+            g_vkDevice.destroyFence(frame.fence);
+        }
+        vmaDestroyBuffer(mAllocator, mStagingRing, mStagingRingAllocation);
+
         DestroyBuffers();
         vmaDestroyAllocator(mAllocator);
         g_vkDevice.destroyCommandPool(mCopyPool);
-        g_vkDevice.destroyFence(mBufferFence);
 		g_vkDevice.destroyFence(mUIFence);
         
         LOG_INFO("[LOG] BufferManager Destroy\n");
@@ -37,11 +53,34 @@ namespace Engine
 	void BufferManager::CreateCopyPool()
     {
         vk::CommandPoolCreateInfo poolInfo(
-            vk::CommandPoolCreateFlagBits::eTransient,
+            vk::CommandPoolCreateFlagBits::eTransient | vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
             GRAPHICS_FAMILY_INDEX);
         mCopyPool = g_vkDevice.createCommandPool(poolInfo);
     }
 
+    void BufferManager::CreateStagingRing()
+    {
+        VmaAllocationInfo allocInfo;
+        mStagingRing = CreateBuffer(STAGING_RING_SIZE, vk::BufferUsageFlagBits::eTransferSrc,
+            VMA_MEMORY_USAGE_CPU_ONLY, VMA_ALLOCATION_CREATE_MAPPED_BIT,
+            mStagingRingAllocation, &allocInfo);
+        mStagingRingData = (char*)allocInfo.pMappedData;
+        mRingHead = 0;
+        mRingTail = 0;
+
+        vk::CommandBufferAllocateInfo cmdBuffAllocateInfo(mCopyPool, vk::CommandBufferLevel::ePrimary, UPLOAD_FRAME_COUNT);
+        auto cmdBuffers = g_vkDevice.allocateCommandBuffers(cmdBuffAllocateInfo);
+        for (uint32_t i = 0; i < UPLOAD_FRAME_COUNT; i++)
+        {
+            UploadFrame& frame = mUploadFrame[i];
+            frame.cmdBuffer = cmdBuffers[i];
+            frame.fence = GDevice.CreateFence();
+            frame.inFlight = false;
+            frame.ringEnd = 0;
+        }
+        mUploadFrameIndex = 0;
+    }
+
     void BufferManager::InitVmaAllocator()
     {
         VmaAllocatorCreateInfo info = {};
@@ -53,39 +92,276 @@ namespace Engine
 
     void BufferManager::ExecuteOperations()
     {
+        ReleaseMeshFrees();
+        RetireUploads(false);
+
         if (!mCopyRequest.empty())
         {
-            vk::CommandBufferAllocateInfo cmdBuffAllocateInfo(mCopyPool, vk::CommandBufferLevel::ePrimary, 1);
-            mCopyCmdBuffer = g_vkDevice.allocateCommandBuffers(cmdBuffAllocateInfo)[0];
-            vk::CommandBufferBeginInfo cmdBuffBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+            SubmitCopies();
+        }
+    }
+
+    void* BufferManager::Stage(CopyRequest& req)
+    {
+        // Ring ranges never wrap around the end of the buffer
+        uint64_t head = (mRingHead + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1);
+        uint64_t offset = head % STAGING_RING_SIZE;
+        if (offset + req.size > STAGING_RING_SIZE)
+        {
+            head += STAGING_RING_SIZE - offset;
+            offset = 0;
+        }
+
+        if (head + req.size - mRingTail <= STAGING_RING_SIZE)
+        {
+            mRingHead = head + req.size;
+            req.stagBuffer = mStagingRing;
+            req.stagAllocation = nullptr;
+            req.stagOffset = offset;
+            req.ringEnd = mRingHead;
+            return mStagingRingData + offset;
+        }
+
+        // The ring is full of copies not done yet
+        VmaAllocationInfo stagAllocInfo;
+        req.stagBuffer = CreateBuffer(req.size, vk::BufferUsageFlagBits::eTransferSrc,
+            VMA_MEMORY_USAGE_CPU_ONLY, VMA_ALLOCATION_CREATE_MAPPED_BIT,
+            req.stagAllocation, &stagAllocInfo);
+        req.stagOffset = 0;
+        req.ringEnd = mRingHead;
+        return stagAllocInfo.pMappedData;
+    }
+
+    uint64_t BufferManager::PushCopy(const CopyRequest& req)
+    {
+        mCopyRequest.push(req);
+        return ++mQueuedCopies;
+    }
+
+    uint64_t BufferManager::UploadImage(vk::Image image, uint32_t mipLevels, const void* data, vk::DeviceSize size,
+        std::vector<vk::BufferImageCopy> regions)
+    {
+        assert(size > 0);
+
+        CopyRequest req{ 0, 0, size };
+        memcpy(Stage(req), data, size);
+        req.image = image;
+        req.mipLevels = mipLevels;
+        req.regions = std::move(regions);
+        for (auto& region : req.regions)
+        {
+            region.bufferOffset += req.stagOffset;
+        }
 
-            mCopyCmdBuffer.begin(cmdBuffBeginInfo);
+        return PushCopy(req);
+    }
 
-            while (!mCopyRequest.empty())
+    void BufferManager::SubmitCopies()
+    {
+        // Every frame is still in flight, the copies wait for the next one
+        UploadFrame& frame = mUploadFrame[mUploadFrameIndex];
+        if (frame.inFlight) return;
+
+        vk::CommandBufferBeginInfo cmdBuffBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+        frame.cmdBuffer.begin(cmdBuffBeginInfo);
+
+        // Every mip of an image is written by its copy, the old content is dropped
+        vk::ImageMemoryBarrier preTransferBarrier(
+            {}, vk::AccessFlagBits::eTransferWrite,
+            vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
+            VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, {},
+            vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1));
+        vk::ImageMemoryBarrier postTransferBarrier(
+            vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead,
+            vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal,
+            VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, {},
+            vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1));
+        mImageBarriers.clear();
+
+        uint32_t copyCount = 0;
+        while (!mCopyRequest.empty() && copyCount < MAX_BUFFER_COPY_PER_FRAME)
+        {
+            CopyRequest& req = mCopyRequest.front();
+
+            if (req.image)
             {
-                CopyRequest& req = mCopyRequest.front();
+                preTransferBarrier.image = req.image;
+                preTransferBarrier.subresourceRange.levelCount = req.mipLevels;
+                frame.cmdBuffer.pipelineBarrier(
+                    vk::PipelineStageFlagBits::eTopOfPipe,
+                    vk::PipelineStageFlagBits::eTransfer,
+                    (vk::DependencyFlagBits)0, {}, {}, { preTransferBarrier });
 
-                vk::DeviceSize size = mBufferAllocation[req.bufIndex]->GetSize();
-                vk::BufferCopy bufCopy(0, 0, size);
-                mCopyCmdBuffer.copyBuffer(mStagBuffer[req.stagIndex], mBuffer[req.bufIndex], 1, &bufCopy);
+                frame.cmdBuffer.copyBufferToImage(req.stagBuffer, req.image, vk::ImageLayout::eTransferDstOptimal,
+                    (uint32_t)req.regions.size(), req.regions.data());
 
-                mCopyRequest.pop();
+                postTransferBarrier.image = req.image;
+                postTransferBarrier.subresourceRange.levelCount = req.mipLevels;
+                mImageBarriers.push_back(postTransferBarrier);
+            }
+            else
+            {
+                vk::BufferCopy bufCopy(req.stagOffset, req.dstOffset, req.size);
+                frame.cmdBuffer.copyBuffer(req.stagBuffer, mBuffer[req.bufIndex], 1, &bufCopy);
             }
 
-            mCopyCmdBuffer.end();
+            if (req.stagAllocation)
+            {
+                frame.stagBuffer.push_back(req.stagBuffer);
+                frame.stagAllocation.push_back(req.stagAllocation);
+            }
+            frame.ringEnd = req.ringEnd;
 
-            vk::SubmitInfo subInfo(0, nullptr, nullptr, 1, &mCopyCmdBuffer, 0, nullptr);
-            BUFFER_TRANSFER_QUEUE.submit(1, &subInfo, mBufferFence);
+            mCopyRequest.pop();
+            ++copyCount;
+            ++mSubmittedCopies;
+        }
 
-            LOG_INFO("[LOG] BufferManager start upload\n");
+        // The draws are submitted after the copies on the same queue, the barrier
+        // makes the copied data visible to them without waiting on the CPU
+        vk::MemoryBarrier barrier(
+            vk::AccessFlagBits::eTransferWrite,
+            vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eIndexRead);
+        frame.cmdBuffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eVertexInput,
+            (vk::DependencyFlagBits)0, { barrier }, {}, {});
 
-            GDevice.WaitForFence(mBufferFence);
-            GDevice.ResetFence(mBufferFence);
-            
-            g_vkDevice.freeCommandBuffers(mCopyPool, 1, &mCopyCmdBuffer);
-            DestroyStagingBuffers();
+        if (!mImageBarriers.empty())
+        {
+            frame.cmdBuffer.pipelineBarrier(
+                vk::PipelineStageFlagBits::eTransfer,
+                vk::PipelineStageFlagBits::eFragmentShader,
+                (vk::DependencyFlagBits)0, {}, {}, mImageBarriers);
+        }
+
+        frame.cmdBuffer.end();
+
+        vk::SubmitInfo subInfo(0, nullptr, nullptr, 1, &frame.cmdBuffer, 0, nullptr);
+        GRAPHICS_QUEUE.submit(1, &subInfo, frame.fence);
+        frame.lastCopy = mSubmittedCopies;
+        frame.inFlight = true;
+        mUploadFrameIndex = (mUploadFrameIndex + 1) % UPLOAD_FRAME_COUNT;
+
+        LOG_INFO("[LOG] BufferManager submit {} copies\n", copyCount);
+    }
+
+    void BufferManager::RetireUploads(bool wait)
+    {
+        // Frames are submitted round robin, the next one to reuse is the oldest
+        for (uint32_t i = 0; i < UPLOAD_FRAME_COUNT; i++)
+        {
+            UploadFrame& frame = mUploadFrame[(mUploadFrameIndex + i) % UPLOAD_FRAME_COUNT];
+            if (!frame.inFlight) continue;
+
+            if (wait)
+            {
+                GDevice.WaitForFence(frame.fence);
+            }
+            else if (g_vkDevice.getFenceStatus(frame.fence) != vk::Result::eSuccess)
+            {
+                break;
+            }
+
+            GDevice.ResetFence(frame.fence);
+            DestroyStagingBuffers(frame);
+            mRingTail = frame.ringEnd;
+            mRetiredCopies = frame.lastCopy;
+            frame.inFlight = false;
+        }
+    }
+
+    MeshAllocation BufferManager::AllocateMesh(const void* vertices, vk::DeviceSize vertexStride, size_t vertexCount,
+        const uint32_t* indices, size_t indexCount)
+    {
+        // Indices start on the first 4 byte boundary after the vertices
+        vk::DeviceSize vertexSize = vertexStride * vertexCount;
+        vk::DeviceSize indexStart = (vertexSize + sizeof(uint32_t) - 1) & ~(vk::DeviceSize)(sizeof(uint32_t) - 1);
+        vk::DeviceSize size = indexStart + sizeof(uint32_t) * indexCount;
+        assert(size > 0);
+
+        // The range has to start on a whole vertex and a whole index
+        vk::DeviceSize alignment = std::lcm<vk::DeviceSize>(vertexStride, sizeof(uint32_t));
+        MeshAllocation alloc = AllocateMeshRange(size, alignment);
+        alloc.vertexOffset = static_cast<uint32_t>(alloc.offset / vertexStride);
+        alloc.firstIndex = static_cast<uint32_t>((alloc.offset + indexStart) / sizeof(uint32_t));
+
+        // Stage the data and copy it to the range
+        CopyRequest req{ alloc.buffer, alloc.offset, size };
+        char* staging = (char*)Stage(req);
+        memcpy(staging, vertices, vertexSize);
+        memcpy(staging + indexStart, indices, sizeof(uint32_t) * indexCount);
+        alloc.uploadId = PushCopy(req);
+
+        return alloc;
+    }
+
+    MeshAllocation BufferManager::AllocateMeshRange(vk::DeviceSize size, vk::DeviceSize alignment)
+    {
+        MeshAllocation alloc = {};
+        alloc.size = size;
+
+        for (auto& meshBuffer : mMeshBuffers)
+        {
+            uint64_t offset = meshBuffer.allocator.Allocate(size, alignment);
+            if (offset != FreeListAllocator::INVALID_OFFSET)
+            {
+                alloc.buffer = meshBuffer.bufIndex;
+                alloc.offset = offset;
+                return alloc;
+            }
+        }
+
+        // None of the mesh buffers has a free range big enough
+        vk::DeviceSize bufferSize = std::max(MESH_BUFFER_SIZE, size);
+        VmaAllocation bufAllocation;
+        vk::Buffer buffer = CreateBuffer(bufferSize,
+            vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer |
+            vk::BufferUsageFlagBits::eIndexBuffer,
+            VMA_MEMORY_USAGE_GPU_ONLY, 0, bufAllocation, nullptr);
+
+        MeshBuffer meshBuffer;
+        meshBuffer.bufIndex = (uint32_t)mBuffer.size();
+        meshBuffer.allocator.Init(bufferSize);
+        mBuffer.push_back(buffer);
+        mBufferAllocation.push_back(bufAllocation);
+
+        alloc.buffer = meshBuffer.bufIndex;
+        alloc.offset = meshBuffer.allocator.Allocate(size, alignment);
+        mMeshBuffers.push_back(meshBuffer);
+
+        LOG_INFO("[LOG] BufferManager new mesh buffer of {} bytes\n", bufferSize);
+        return alloc;
+    }
+
+    void BufferManager::FreeMesh(const MeshAllocation& alloc)
+    {
+        // Recorded command buffers of the swapchain images may still read the range
+        mPendingMeshFrees.push_back({ alloc, GSwapchain.GetImageCount() + 1 });
+    }
+
+    void BufferManager::ReleaseMeshFrees()
+    {
+        for (size_t i = 0; i < mPendingMeshFrees.size(); )
+        {
+            PendingMeshFree& pending = mPendingMeshFrees[i];
+            if (--pending.framesLeft > 0)
+            {
+                ++i;
+                continue;
+            }
+
+            for (auto& meshBuffer : mMeshBuffers)
+            {
+                if (meshBuffer.bufIndex == pending.alloc.buffer)
+                {
+                    meshBuffer.allocator.Free(pending.alloc.offset, pending.alloc.size);
+                    break;
+                }
+            }
 
-            LOG_INFO("[LOG] BufferManager end upload\n");
+            pending = mPendingMeshFrees.back();
+            mPendingMeshFrees.pop_back();
         }
     }
 
@@ -117,14 +393,14 @@ namespace Engine
         return buffer;
     }
 
-    void BufferManager::DestroyStagingBuffers()
+    void BufferManager::DestroyStagingBuffers(UploadFrame& frame)
     {
-        for (size_t i = 0; i < mStagBufferAllocation.size(); i++)
+        for (size_t i = 0; i < frame.stagAllocation.size(); i++)
         {
-            vmaDestroyBuffer(mAllocator, mStagBuffer[i], mStagBufferAllocation[i]);
+            vmaDestroyBuffer(mAllocator, frame.stagBuffer[i], frame.stagAllocation[i]);
         }
-        mStagBuffer.clear();
-        mStagBufferAllocation.clear();
+        frame.stagBuffer.clear();
+        frame.stagAllocation.clear();
     }
 
     void BufferManager::DestroyBuffers()
@@ -1,23 +1,44 @@
 #pragma once
 #include <Common\Constants.h>
 #include <Common\VertexDataTypes.h>
+#include <Common\FreeListAllocator.h>
 #include <vk_mem_alloc.h>
 #include <queue>
-#include <utility>
+#include <array>
+#include <numeric>
 
 #define GBufferManager Engine::g_BufferManager
-#define CreateVertexIndexBuffer(v, i) g_BufferManager.Allocate(v, i, vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndexBuffer)
+#define CreateMeshBuffer(v, i) g_BufferManager.AllocateMesh(v, i)
 #define CreateVertexBuffer(v) g_BufferManager.Allocate(v, vk::BufferUsageFlagBits::eVertexBuffer)
 #define BufferAt(i) g_BufferManager.GetBuffer(i)
 #define GVmaAllocator g_BufferManager.mAllocator
 
 namespace Engine
 {
-    typedef std::pair<uint32_t, uint32_t> IndexOffset;
+    // Range of a shared mesh buffer holding the vertices followed by the indices of a mesh
+    struct MeshAllocation
+    {
+        // Index of the mesh buffer, see BufferAt
+        uint32_t buffer;
+        // Offsets of the mesh data for the draw commands, in vertices and indices
+        uint32_t vertexOffset;
+        uint32_t firstIndex;
+        vk::DeviceSize offset;
+        vk::DeviceSize size;
+        // Copy request bringing the data to the range, see IsUploaded
+        uint64_t uploadId;
+    };
 
     class BufferManager
     {
         static constexpr uint32_t BUFFER_INIT_CAPACITY = 16;
+        // Size of a shared mesh buffer, bigger meshes get a buffer of their own
+        static constexpr vk::DeviceSize MESH_BUFFER_SIZE = 32 * 1024 * 1024;
+        // Persistently mapped staging memory, data that doesn't fit gets a staging buffer of its own
+        static constexpr vk::DeviceSize STAGING_RING_SIZE = 64 * 1024 * 1024;
+        static constexpr vk::DeviceSize STAGING_ALIGNMENT = 16;
+        // Upload submissions which can be in flight at the same time
+        static constexpr uint32_t UPLOAD_FRAME_COUNT = 3;
 
     public:
         typedef void(*UploadCompleteCback)(void*);
@@ -39,118 +60,157 @@ namespace Engine
             VmaMemoryUsage vmaMemoryUsage, VmaAllocationCreateFlags vmaAllocationFlags,
             VmaAllocation& vmaAllocation, VmaAllocationInfo* vmaAllocationInfo);
 
-        // ---- Allocation function for indexed vertex buffer ---- //
-        template<typename T, typename U>
-        IndexOffset Allocate(const std::vector<T>& data1, const std::vector<U>& data2,
-            vk::BufferUsageFlags flags)
+        // ---- Allocation function for meshes ---- //
+        // The vertices and the indices are packed in a range of a shared mesh buffer
+        template<typename T>
+        MeshAllocation AllocateMesh(const std::vector<T>& vertices, const IndexList& indices)
         {
-            vk::Buffer dataBuffer, stagingBuffer;
-            IndexOffset indexOffset;
-
-            // 1. Allocate the staging buffers
-            indexOffset.second = sizeof(T) * data1.size();
-            vk::DeviceSize size = indexOffset.second + sizeof(U) * data2.size();
-			assert(size > 0);
-
-            VmaAllocation stagAllocation;
-            VmaAllocationInfo stagAllocInfo;
-            stagingBuffer = CreateBuffer(size, vk::BufferUsageFlagBits::eTransferSrc,
-                VMA_MEMORY_USAGE_CPU_ONLY, VMA_ALLOCATION_CREATE_MAPPED_BIT,
-                stagAllocation, &stagAllocInfo);
-
-            // 2. Copy the contents from vertices and indices to the staging buffers
-            memcpy(stagAllocInfo.pMappedData, data1.data(), indexOffset.second);
-            // Assume byte level
-            memcpy((char*)stagAllocInfo.pMappedData + indexOffset.second, data2.data(),
-                size  - indexOffset.second);
-
-            // 3. Create the local device buffer
-            VmaAllocation bufAllocation;
-            dataBuffer = CreateBuffer(size, vk::BufferUsageFlagBits::eTransferDst | flags,
-                VMA_MEMORY_USAGE_GPU_ONLY, 0, bufAllocation, nullptr);
+            return AllocateMesh(vertices.data(), sizeof(T), vertices.size(), indices.data(), indices.size());
+        }
 
-            // 4. Update global arrays and create copy request
-            uint32_t bufIndex = (uint32_t)mBuffer.size();
-            mBuffer.push_back(dataBuffer);
-            mBufferAllocation.push_back(bufAllocation);
+        // Same as above for vertices of 'vertexStride' bytes, e.g. read from a mesh cache
+        MeshAllocation AllocateMesh(const void* vertices, vk::DeviceSize vertexStride, size_t vertexCount,
+            const uint32_t* indices, size_t indexCount);
 
-            uint32_t stagIndex = (uint32_t)mStagBuffer.size();
-            mStagBuffer.push_back(stagingBuffer);
-            mStagBufferAllocation.push_back(stagAllocation);
+        // The range is released once the frames in flight are done with it
+        void FreeMesh(const MeshAllocation& alloc);
 
-            CopyRequest req{ bufIndex, stagIndex };
-            mCopyRequest.push(req);
+        // The copy of the mesh data is submitted. Draws submitted after it on the
+        // graphics queue read the data, the others must leave the mesh out
+        bool IsUploaded(const MeshAllocation& alloc) const
+        {
+            return alloc.uploadId <= mSubmittedCopies;
+        }
 
-            indexOffset.first = bufIndex;
+        // ---- Upload of images ---- //
+        // Stages the 'size' bytes of 'data' and copies them to the mips of 'image' described by
+        // 'regions', whose buffer offsets are relative to 'data'. The copy leaves every mip of
+        // the image ready to be sampled. Returns the upload id, see IsRetired
+        uint64_t UploadImage(vk::Image image, uint32_t mipLevels, const void* data, vk::DeviceSize size,
+            std::vector<vk::BufferImageCopy> regions);
 
-            return indexOffset;
+        // The submission of the copy is done on the GPU, the data can be used from any queue
+        bool IsRetired(uint64_t uploadId) const
+        {
+            return uploadId <= mRetiredCopies;
         }
 
 		// ---- Allocation function for vertex buffer ---- //
 		template<typename T>
 		uint32_t Allocate(const std::vector<T>& data, vk::BufferUsageFlags flags)
 		{
-			vk::Buffer dataBuffer, stagingBuffer;
+			vk::Buffer dataBuffer;
 
-			// 1. Allocate the staging buffers
+			// 1. Create the local device buffer
 			vk::DeviceSize size = sizeof(T) * data.size();
 			assert(size > 0);
 
-			VmaAllocation stagAllocation;
-			VmaAllocationInfo stagAllocInfo;
-			stagingBuffer = CreateBuffer(size, vk::BufferUsageFlagBits::eTransferSrc,
-				VMA_MEMORY_USAGE_CPU_ONLY, VMA_ALLOCATION_CREATE_MAPPED_BIT,
-				stagAllocation, &stagAllocInfo);
-
-			// 2. Copy the contents from data to the staging buffers
-			memcpy(stagAllocInfo.pMappedData, data.data(), size);
-
-			// 3. Create the local device buffer
 			VmaAllocation bufAllocation;
 			dataBuffer = CreateBuffer(size, vk::BufferUsageFlagBits::eTransferDst | flags,
 				VMA_MEMORY_USAGE_GPU_ONLY, 0, bufAllocation, nullptr);
 
-			// 4. Update global arrays and create copy request
 			uint32_t bufIndex = (uint32_t)mBuffer.size();
 			mBuffer.push_back(dataBuffer);
 			mBufferAllocation.push_back(bufAllocation);
 
-			uint32_t stagIndex = (uint32_t)mStagBuffer.size();
-			mStagBuffer.push_back(stagingBuffer);
-			mStagBufferAllocation.push_back(stagAllocation);
-
-			CopyRequest req{ bufIndex, stagIndex };
-			mCopyRequest.push(req);
+			// 2. Stage the data and create the copy request
+			CopyRequest req{ bufIndex, 0, size };
+			memcpy(Stage(req), data.data(), size);
+			PushCopy(req);
 
 			return bufIndex;
 		}
 
         VmaAllocator mAllocator;
-        vk::Fence mBufferFence;
 		vk::Fence mUIFence;
     private:
+        typedef std::vector<vk::Buffer> BufferVector;
+        typedef std::vector<VmaAllocation> AllocationVector;
+
         struct CopyRequest
         {
-			uint32_t bufIndex, stagIndex;
+			uint32_t bufIndex;
+			vk::DeviceSize dstOffset, size;
+			// Source of the copy, a range of the staging ring unless stagAllocation is set
+			vk::Buffer stagBuffer;
+			VmaAllocation stagAllocation;
+			vk::DeviceSize stagOffset;
+			// Ring position after the data of this request
+			uint64_t ringEnd;
+			// Set if the destination is the image instead of the buffer
+			vk::Image image;
+			uint32_t mipLevels;
+			std::vector<vk::BufferImageCopy> regions;
         };
 
-        typedef std::vector<vk::Buffer> BufferVector;
-        typedef std::vector<VmaAllocation> AllocationVector;
+        // Copies submitted in one frame, retired once the fence is signaled
+        struct UploadFrame
+        {
+            vk::CommandBuffer cmdBuffer;
+            vk::Fence fence;
+            bool inFlight;
+            // The ring is free up to here when the frame retires
+            uint64_t ringEnd;
+            // Upload id of the last copy of the frame
+            uint64_t lastCopy;
+            BufferVector stagBuffer;
+            AllocationVector stagAllocation;
+        };
+
+        // Device local buffer shared by the vertices and indices of many meshes
+        struct MeshBuffer
+        {
+            uint32_t bufIndex;
+            FreeListAllocator allocator;
+        };
+
+        struct PendingMeshFree
+        {
+            MeshAllocation alloc;
+            uint32_t framesLeft;
+        };
 
         vk::CommandPool mCopyPool;
-        vk::CommandBuffer mCopyCmdBuffer;
 
         BufferVector mBuffer;
         AllocationVector mBufferAllocation;
-        BufferVector mStagBuffer;
-        AllocationVector mStagBufferAllocation;
 
         std::queue<CopyRequest> mCopyRequest;
+        // Copies are submitted in request order, so counting them tells which ones are submitted
+        uint64_t mQueuedCopies;
+        uint64_t mSubmittedCopies;
+        uint64_t mRetiredCopies;
+
+        // Ring positions only grow, the offset in the buffer is the position modulo its size
+        vk::Buffer mStagingRing;
+        VmaAllocation mStagingRingAllocation;
+        char* mStagingRingData;
+        uint64_t mRingHead, mRingTail;
+
+        std::array<UploadFrame, UPLOAD_FRAME_COUNT> mUploadFrame;
+        uint32_t mUploadFrameIndex;
+
+        std::vector<MeshBuffer> mMeshBuffers;
+        std::vector<PendingMeshFree> mPendingMeshFrees;
+        std::vector<vk::ImageMemoryBarrier> mImageBarriers;
 
         void CreateCopyPool();
         void InitVmaAllocator();
+        void CreateStagingRing();
+
+        // Picks the staging memory of the request and returns where its data has to be written
+        void* Stage(CopyRequest& req);
+        // Queues the request and returns its upload id
+        uint64_t PushCopy(const CopyRequest& req);
+        void SubmitCopies();
+        // Releases the staging memory of the submissions the GPU is done with.
+        // Only waits for them when 'wait' is set, i.e. on destroy
+        void RetireUploads(bool wait);
+
+        MeshAllocation AllocateMeshRange(vk::DeviceSize size, vk::DeviceSize alignment);
+        void ReleaseMeshFrees();
         
-        void DestroyStagingBuffers();
+        void DestroyStagingBuffers(UploadFrame& frame);
         void DestroyBuffers();
     };
 
@@ -22,9 +22,19 @@ namespace Engine
         }
     }
 
-#define SET_PBR_UNIFORM(uniform, path) path = j[uniform];\
+    void MaterialManager::OnTextureLoaded(uint32_t texIndex)
+    {
+        for (auto mat : mMaterials)
+        {
+            mat->OnTextureLoaded(texIndex);
+        }
+    }
+
+#define SET_PBR_UNIFORM(uniform, path, placeholder, srgb) path = j[uniform];\
 	if (path.find(".") == std::string::npos) texInd = g_TextureManager.GetColorTexture(path);\
-	else {std::string newPath = textureDir + std::string("/") + path; texInd = g_TextureManager.LoadTex2D(newPath.c_str());}\
+	else {std::string newPath = textureDir + std::string("/") + path;\
+		texInd = streamed ? g_TextureManager.LoadTex2DStreamed(newPath.c_str(), srgb, placeholder) :\
+		g_TextureManager.LoadTex2DAsync(newPath.c_str(), false, placeholder);}\
 	mat->UpdateUniform(uniform, texInd)
 
     Material * MaterialManager::FromJSON(const char * jsonFile)
@@ -45,16 +55,19 @@ namespace Engine
 		std::string type = j["type"];
 		Material* mat = NewMaterial(type.c_str());
 
-		if (type == "pbr")
+		if (mat->IsPBR())
 		{
 			std::string path;
 			uint32_t texInd;
+			// Streamed maps only keep the mips the screen needs, only the albedo is sRGB
+			bool streamed = j.value("streamed", false);
 			
-			SET_PBR_UNIFORM(ALBEDO, path);
-			SET_PBR_UNIFORM(NORMAL, path);
-			SET_PBR_UNIFORM(AO, path);
-			SET_PBR_UNIFORM(METALLIC, path);
-			SET_PBR_UNIFORM(ROUGHNESS, path);
+			// The maps are decoded in parallel, the placeholders are neutral values
+			SET_PBR_UNIFORM(ALBEDO, path, "white", true);
+			SET_PBR_UNIFORM(NORMAL, path, "flatnormal", false);
+			SET_PBR_UNIFORM(AO, path, "white", false);
+			SET_PBR_UNIFORM(METALLIC, path, "black", false);
+			SET_PBR_UNIFORM(ROUGHNESS, path, "white", false);
 		}
 		
 		return mat;
@@ -68,6 +81,8 @@ namespace Engine
         PipelineOfType(pipelineType);
 
         Material* mat = Material::mAllocator.newElement();
+        mat->mId = static_cast<uint32_t>(mMaterials.size());
+        mMaterials.push_back(mat);
         mat->mPipeType = pipelineType;
         mat->InitializeUniforms();
         return mat;
@@ -16,6 +16,9 @@ namespace Engine
         Material* FromJSON(const char* jsonFile);
         Material* NewMaterial(const char* pipelineType);
 
+        // Rewrites the descriptors of the materials sampling the texture
+        void OnTextureLoaded(uint32_t texIndex);
+
     private:
         std::vector<Material*> mMaterials;
     };
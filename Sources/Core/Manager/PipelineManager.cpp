@@ -27,7 +27,11 @@ namespace Engine
     void PipelineManager::LoadFromJSON(const char * jsonFile)
     {
         std::string pipelineType = GetPipelineName(jsonFile);
+        auto it = mPipeline.find(pipelineType);
+        uint32_t id = it != mPipeline.end() ? it->second.mId : static_cast<uint32_t>(mPipeline.size());
+
         mPipeline[pipelineType] = Pipeline::FromJSON(jsonFile);
+        mPipeline[pipelineType].mId = id;
 
         LOG_INFO("[LOG] Create pipeline from json: {0}\n", jsonFile);
     }
@@ -1,6 +1,8 @@
 #include "RenderpassManager.h"
 #include <Engine\Swapchain.h>
 #include <Engine\Device.h>
+#include <Engine\FrameAllocator.h>
+#include <Common\AllocationCounter.h>
 #include <RenderPass\SkyPass.h>
 #include <RenderPass\PrenvPass.h>
 #include <RenderPass\BrdfPass.h>
@@ -75,7 +77,9 @@ namespace Engine
 	void RenderpassManager::RenderPasses(vk::Semaphore & waitSem, vk::PipelineStageFlags waitStage, vk::Semaphore & signalSem)
 	{
 		THROW_IF(mPass.empty(), "Render passes not initialized!");
-		std::vector<vk::SubmitInfo> submitInfos;
+		EXPECT_NO_ALLOCATIONS("RenderpassManager::RenderPasses");
+
+		FrameVector<vk::SubmitInfo> submitInfos;
 		submitInfos.reserve(mPass.size());
 		
 		if (mPass.size() == 1)
@@ -107,7 +111,8 @@ namespace Engine
 			);
 		}
 
-		GRAPHICS_QUEUE.submit(submitInfos, mFence[GSwapchain.GetCurrentFrameIndex()]);
+		vk::ArrayProxy<const vk::SubmitInfo> submits(static_cast<uint32_t>(submitInfos.size()), submitInfos.data());
+		GRAPHICS_QUEUE.submit(submits, mFence[GSwapchain.GetCurrentFrameIndex()]);
 	}
 
 	void RenderpassManager::CreateFences()
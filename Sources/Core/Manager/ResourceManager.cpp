@@ -7,6 +7,7 @@
 #include <RenderPass\BrdfPass.h>
 #include <Engine\Device.h>
 #include <Engine\Engine.h>
+#include <Engine\Swapchain.h>
 #include <setslots.h>
 
 #define GResourceManager Engine::g_ResourceManager
@@ -67,18 +68,36 @@ namespace Engine
     void ResourceManager::Init()
     {
 		CreateDepthBuffer();
-		InitDescriptorAllocatorsAndSets();
-		mFrameConsts.Init();
 		mIBLdone = false;
     }
 
+	void ResourceManager::PostSwapchainInit()
+	{
+		// Like the frame fences, the buffers are kept when the swapchain is recreated
+		const uint32_t imageCount = GSwapchain.GetImageCount();
+		InitDescriptorAllocatorsAndSets(imageCount);
+
+		mLights.assign(imageCount, GpuArrayBuffer<LightSource>());
+		mFrameConsts.assign(imageCount, GpuBuffer<FrameConsts>());
+		mObjects.assign(imageCount, GpuArrayBuffer<ObjectData>(vk::BufferUsageFlagBits::eStorageBuffer));
+		for (auto& frameConsts : mFrameConsts)
+		{
+			frameConsts.Init();
+		}
+		LOG_INFO("[LOG] ResourceManager PostSwapchain init\n");
+	}
+
     void ResourceManager::Destroy()
     {
 		DestroyDepthBuffer();
 		DestroyDescriptorAllocators();
 		DestroyRenderPassResources();
-		mLights.Destroy();
-		mFrameConsts.Destroy();
+		for (uint32_t i = 0; i < mFrameConsts.size(); i++)
+		{
+			mLights[i].Destroy();
+			mFrameConsts[i].Destroy();
+			mObjects[i].Destroy();
+		}
     }
 
 	void ResourceManager::CreateDepthBuffer()
@@ -103,11 +122,12 @@ namespace Engine
 		vmaDestroyImage(GVmaAllocator, mDepthImage, mDepthAlloc);
 	}
 
-    vk::DescriptorSet ResourceManager::GetDescriptorSet(uint32_t slot) const
+    vk::DescriptorSet ResourceManager::GetDescriptorSet(uint32_t slot, uint32_t imageIndex) const
     {
         THROW_IF(slot > 8, "Set slot must not be greater than 8!");
         THROW_IF(slot == 0, "Set slot 0 is reserved for materials!");
-        return mDescSets[slot - 1];
+        const auto& descSets = mDescSets[slot - 1];
+        return imageIndex < descSets.size() ? descSets[imageIndex] : vk::DescriptorSet();
     }
 	
 	vk::DescriptorSetLayout ResourceManager::GetDescriptorSetLayoutAt(uint32_t slot) const
@@ -242,7 +262,7 @@ namespace Engine
 		return mBrdfRes[ind].mBrdfLutIndex;
 	}
 
-	void ResourceManager::InitDescriptorAllocatorsAndSets()
+	void ResourceManager::InitDescriptorAllocatorsAndSets(uint32_t imageCount)
 	{
 		std::vector<vk::DescriptorPoolSize> poolSizes;
 		poolSizes.resize(1);
@@ -252,7 +272,7 @@ namespace Engine
 		constexpr uint32_t lightIndex = LIGHTSOURCE_SLOT - 1;
 		
 		poolSizes[0].type = vk::DescriptorType::eUniformBuffer;
-		poolSizes[0].descriptorCount = 1;
+		poolSizes[0].descriptorCount = imageCount;
 
 		vk::DescriptorSetLayoutBinding binding(0, poolSizes[0].type, 1, vk::ShaderStageFlagBits::eAll);
 		descSetCI.bindingCount = 1;
@@ -260,14 +280,32 @@ namespace Engine
 
 		mDescLayout[lightIndex] = g_vkDevice.createDescriptorSetLayout(descSetCI);
 		mDescAllocators[lightIndex].Init(poolSizes, mDescLayout[lightIndex]);
-		mDescSets[lightIndex] = mDescAllocators[lightIndex].AllocateDescriptorSet();
+		AllocateDescriptorSets(lightIndex, imageCount);
 
 		// Frame consts desc allocator
 		constexpr uint32_t frameIndex = FRAMECONSTS_SLOT - 1;
 		// same pool size and binding as light source
 		mDescLayout[frameIndex] = g_vkDevice.createDescriptorSetLayout(descSetCI);
 		mDescAllocators[frameIndex].Init(poolSizes, mDescLayout[frameIndex]);
-		mDescSets[frameIndex] = mDescAllocators[frameIndex].AllocateDescriptorSet();
+		AllocateDescriptorSets(frameIndex, imageCount);
+
+		// Objects desc allocator
+		constexpr uint32_t objectsIndex = OBJECTS_SLOT - 1;
+		poolSizes[0].type = vk::DescriptorType::eStorageBuffer;
+		binding.descriptorType = poolSizes[0].type;
+		mDescLayout[objectsIndex] = g_vkDevice.createDescriptorSetLayout(descSetCI);
+		mDescAllocators[objectsIndex].Init(poolSizes, mDescLayout[objectsIndex]);
+		AllocateDescriptorSets(objectsIndex, imageCount);
+	}
+
+	void ResourceManager::AllocateDescriptorSets(uint32_t index, uint32_t imageCount)
+	{
+		mDescSets[index].resize(imageCount);
+		for (auto& descSet : mDescSets[index])
+		{
+			descSet = mDescAllocators[index].AllocateDescriptorSet();
+		}
+		mSlotBuffers[index].assign(imageCount, nullptr);
 	}
 	
 	void ResourceManager::DestroyDescriptorAllocators()
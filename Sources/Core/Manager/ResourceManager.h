@@ -17,6 +17,8 @@ namespace Engine
     {
     public:
         void Init();
+        // Creates the per swapchain image buffers and descriptor sets
+        void PostSwapchainInit();
         void Destroy();
 
 		void CreateDepthBuffer();
@@ -26,29 +28,41 @@ namespace Engine
 		vk::Format GetDepthFormat() const { return mDepthFormat; }
 		vk::ImageView GetDepthImageView() const { return mDepthImageView; }
 
-        vk::DescriptorSet GetDescriptorSet(uint32_t slot) const;
+        vk::DescriptorSet GetDescriptorSet(uint32_t slot, uint32_t imageIndex) const;
 		vk::DescriptorSetLayout GetDescriptorSetLayoutAt(uint32_t slot) const;
 		
+		// Returns true if the descriptor was written. Writing a descriptor set invalidates
+		// the command buffers which bound it, so it's skipped if the buffer didn't change.
+		// Only the set of the image being recorded may be written, see mDescSets.
 		template<typename T>
-		void WriteBufferToDescriptorSlot(uint32_t slot, const T& buffer)
+		bool WriteBufferToDescriptorSlot(uint32_t slot, uint32_t imageIndex, const T& buffer,
+			vk::DescriptorType type = vk::DescriptorType::eUniformBuffer)
 		{
 			THROW_IF(slot > 8, "Set slot must not be greater than 8!");
 			THROW_IF(slot == 0, "Set slot 0 is reserved for materials!");
 
 			uint32_t index = slot - 1;
+			THROW_IF(imageIndex >= mDescSets[index].size(), "No descriptor set for swapchain image {}!", imageIndex);
+			if (mSlotBuffers[index][imageIndex] == buffer.GetBuffer())
+				return false;
+
 			vk::WriteDescriptorSet writeDescSet;
 			writeDescSet.descriptorCount = 1;
-			writeDescSet.descriptorType = vk::DescriptorType::eUniformBuffer;
+			writeDescSet.descriptorType = type;
 			writeDescSet.dstArrayElement = 0;
 			writeDescSet.dstBinding = 0;
-			writeDescSet.dstSet = mDescSets[index];
+			writeDescSet.dstSet = mDescSets[index][imageIndex];
 			vk::DescriptorBufferInfo bufferInfo(buffer.GetBuffer(), 0, VK_WHOLE_SIZE);
 			writeDescSet.pBufferInfo = &bufferInfo;
 			g_vkDevice.updateDescriptorSets({ writeDescSet }, { });
+			mSlotBuffers[index][imageIndex] = buffer.GetBuffer();
+			return true;
 		}
 
-		GpuArrayBuffer<LightSource>& GetLightsBuffer() { return mLights; };
-		GpuBuffer<FrameConsts>& GetFrameConstsBuffer() { return mFrameConsts; }
+		// The buffers of a swapchain image may only be written once its fence signaled
+		GpuArrayBuffer<LightSource>& GetLightsBuffer(uint32_t imageIndex) { return mLights[imageIndex]; };
+		GpuBuffer<FrameConsts>& GetFrameConstsBuffer(uint32_t imageIndex) { return mFrameConsts[imageIndex]; }
+		GpuArrayBuffer<ObjectData>& GetObjectsBuffer(uint32_t imageIndex) { return mObjects[imageIndex]; }
 
 		uint32_t AddIBLProbeInfo(const IBLProbeInfo& probe);
 		void ExecuteIBLPasses();
@@ -58,23 +72,29 @@ namespace Engine
 		uint32_t GetBrdfMap(uint32_t ind) const;
 
     private:
-		void InitDescriptorAllocatorsAndSets();
+		void InitDescriptorAllocatorsAndSets(uint32_t imageCount);
+		void AllocateDescriptorSets(uint32_t index, uint32_t imageCount);
 		void DestroyDescriptorAllocators();
 		void DestroyRenderPassResources();
 		
-		// Global descriptor sets used by various renderpasses
+		// Global descriptor sets used by various renderpasses. The buffers are written every
+		// frame, so every swapchain image has its own sets and buffers and the frames still
+		// executing keep reading theirs.
 		static constexpr uint32_t DESC_SET_SIZE = 8;
-        std::array<vk::DescriptorSet, DESC_SET_SIZE> mDescSets;
+        std::array<std::vector<vk::DescriptorSet>, DESC_SET_SIZE> mDescSets;
 		std::array<vk::DescriptorSetLayout, DESC_SET_SIZE> mDescLayout;
 		std::array<DescriptorAllocator, DESC_SET_SIZE> mDescAllocators;
+		// Buffer currently written to each global descriptor set
+		std::array<std::vector<vk::Buffer>, DESC_SET_SIZE> mSlotBuffers;
 
 		vk::Image mDepthImage;
 		vk::Format mDepthFormat;
 		vk::ImageView mDepthImageView;
 		VmaAllocation mDepthAlloc;
 
-		GpuArrayBuffer<LightSource> mLights;
-		GpuBuffer<FrameConsts> mFrameConsts;
+		std::vector<GpuArrayBuffer<LightSource>> mLights;
+		std::vector<GpuBuffer<FrameConsts>> mFrameConsts;
+		std::vector<GpuArrayBuffer<ObjectData>> mObjects;
 
 		//TODO std::vector<Texture> mIrradPasses;
 		std::vector<PrenvPassResources> mPrenvRes;
@@ -1,9 +1,14 @@
 #include "TextureManager.h"
 #include "BufferManager.h"
+#include "MaterialManager.h"
+#include <Engine\TextureFile.h>
+#include <Common\MappedFile.h>
+#include <Common\MipGenerator.h>
 #include <Engine\TaskScheduler.h>
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 #include <Engine\Device.h>
+#include <Engine\Swapchain.h>
 #include <algorithm>
 
 namespace Engine
@@ -16,6 +21,7 @@ namespace Engine
 		mColorTextures.reserve(7);
         //mImageAllocation.reserve(TEXTURE_INIT_CAPACITY);
         mUploadFence = GDevice.CreateFence();
+        mResidency.Init(STREAMING_BUDGET, STREAMING_LOAD_PER_FRAME);
 
         vk::CommandPoolCreateInfo poolInfo(
             vk::CommandPoolCreateFlagBits::eTransient,
@@ -29,10 +35,37 @@ namespace Engine
     {
         g_vkDevice.destroyFence(mUploadFence);
 
+#ifndef SINGLE_THREAD
+        // The decode tasks write to the manager, wait for the ones still running
+        {
+            std::unique_lock<std::mutex> lock(mDecodeMutex);
+            mDecodeDone.wait(lock, [this]() { return mDecoded.size() == mPendingDecodes; });
+        }
+#endif
+        for (auto& res : mDecoded)
+        {
+            stbi_image_free(res.pixels);
+        }
+        mDecoded.clear();
+
         for (size_t i = 0; i < mTexture.size(); ++i)
         {
-			mTexture[i].Destroy();
+            // Placeholders belong to their color texture
+            if (mPlaceholderTextures.count(static_cast<uint32_t>(i)) == 0)
+			    mTexture[i].Destroy();
+        }
+        mPlaceholderTextures.clear();
+
+        for (auto& stream : mPendingStreams)
+        {
+            g_vkDevice.destroyImageView(stream.image.mImageView);
+            vmaDestroyImage(GVmaAllocator, stream.image.mImage, stream.image.mImageAllocation);
         }
+        mPendingStreams.clear();
+
+        ReleaseImages(true);
+        mStreamed.clear();
+        mResidencyTexture.clear();
 
         g_vkDevice.destroyCommandPool(mCommandPool);
 
@@ -41,6 +74,13 @@ namespace Engine
 
     void TextureManager::ExecuteOperations()
     {
+        if (mPendingDecodes > 0)
+        {
+            FinishDecodes();
+        }
+
+        UpdateStreaming();
+
         if (!mUploadRequest.empty())
         {
             std::vector<vk::ImageMemoryBarrier> preTransferTransition(
@@ -89,6 +129,8 @@ namespace Engine
             {
                 size_t j = mUploadRequest[i].imageIndex;
                 preTransferTransition[i].image = mTexture[j].mImage;
+                // Every mip is written either by a copy or by GenerateMipmaps
+                preTransferTransition[i].subresourceRange.levelCount = mTexture[j].mMipLevels;
                 
                 bufferImageCopy[i].imageExtent = vk::Extent3D(
                     mTexture[j].mWidth,
@@ -99,6 +141,7 @@ namespace Engine
 				if (!mUploadRequest[i].genmips)
 				{
 					postTransferBarrier.image = mTexture[j].mImage;
+					postTransferBarrier.subresourceRange.levelCount = mTexture[j].mMipLevels;
 					postTransferTransition.push_back(postTransferBarrier);
 				}
             }
@@ -118,12 +161,14 @@ namespace Engine
             for (size_t i = 0; i < mUploadRequest.size(); ++i)
             {
                 size_t j = mUploadRequest[i].imageIndex;
+                const auto& regions = mUploadRequest[i].regions;
                 
                 mTransferCmdBuffer.copyBufferToImage(
                     mUploadRequest[i].stagBuffer,
                     mTexture[j].mImage,
                     vk::ImageLayout::eTransferDstOptimal,
-                    { bufferImageCopy[i] }
+                    regions.empty() ? 1 : (uint32_t)regions.size(),
+                    regions.empty() ? &bufferImageCopy[i] : regions.data()
                 );
 
 				if (mUploadRequest[i].genmips)
@@ -237,15 +282,14 @@ namespace Engine
 		return g_vkDevice.createImageView(imageViewCI);
 	}
 
-	uint32_t TextureManager::LoadTex2DFromData(const void* data, int width, int height, int channels, bool genmips)
+	void TextureManager::InitTex2D(uint32_t index, const void* pixels, int width, int height, int channels, bool genmips)
 	{
 		Texture tex;
 		tex.mDepth = 1;
 		tex.mWidth = (uint32_t)width;
 		tex.mHeight = (uint32_t)height;
 		tex.mChannels = (uint32_t)channels;
-		assert(data);
-		const stbi_uc* pixels = static_cast<const stbi_uc*>(data);
+		assert(pixels);
 		vk::DeviceSize imageSize = tex.mWidth * tex.mHeight * STBI_rgb_alpha;
 
 		uint32_t miplevels = 1;
@@ -274,9 +318,7 @@ namespace Engine
 		tex.mMipLevels = miplevels;
 		tex.mLayers = 1;
 
-		uint32_t index = mTexture.size();
-		mTexture.push_back(tex);
-		//mImageAllocation.push_back(imageAllocation);
+		mTexture[index] = tex;
 
 		UploadRequest req;
 		req.imageIndex = index;
@@ -284,58 +326,312 @@ namespace Engine
 		req.stagAllocation = stagAllocation;
 		req.genmips = genmips;
 		mUploadRequest.push_back(req);
+	}
 
+	uint32_t TextureManager::LoadTex2DFromData(const void* data, int width, int height, int channels, bool genmips)
+	{
+		uint32_t index = mTexture.size();
+		mTexture.emplace_back();
+		InitTex2D(index, data, width, height, channels, genmips);
 		return index;
 	}
 
 	uint32_t TextureManager::LoadTex2D(const char * path, bool genmips)
     {
-        Texture tex;
-        tex.mDepth = 1;
-        stbi_uc* pixels = stbi_load(path, (int*)&tex.mWidth, (int*)&tex.mHeight, (int*)&tex.mChannels, STBI_rgb_alpha);
-        vk::DeviceSize imageSize = tex.mWidth * tex.mHeight * STBI_rgb_alpha;
+        uint32_t index;
+        if (TryLoadCooked(path, index))
+            return index;
+
+        int width, height, channels;
+        stbi_uc* pixels = stbi_load(path, &width, &height, &channels, STBI_rgb_alpha);
         assert(pixels);
 
-		uint32_t miplevels = 1;
-		if (genmips)
-			miplevels = static_cast<uint32_t>(std::floor(std::log2(std::max(tex.mWidth, tex.mHeight)))) + 1;
-        
-        VmaAllocation stagAllocation;
-        VmaAllocationInfo stagAllocInfo;
-        vk::Buffer stagBuffer;
+        index = LoadTex2DFromData(pixels, width, height, channels, genmips);
+        stbi_image_free(pixels);
+        return index;
+    }
 
-        stagBuffer = g_BufferManager.CreateBuffer(imageSize, vk::BufferUsageFlagBits::eTransferSrc,
-            VMA_MEMORY_USAGE_CPU_ONLY, VMA_ALLOCATION_CREATE_MAPPED_BIT, stagAllocation, &stagAllocInfo);
+	uint32_t TextureManager::LoadTex2DAsync(const char* path, bool genmips, const std::string& placeholder)
+	{
+		uint32_t index;
+		if (TryLoadCooked(path, index))
+			return index;
 
-        memcpy(stagAllocInfo.pMappedData, pixels, static_cast<size_t>(imageSize));
-        stbi_image_free(pixels);
+		// The slot shares the image of the placeholder until the decode is done
+		Texture placeholderTex = mTexture[GetColorTexture(placeholder)];
+		index = mTexture.size();
+		mTexture.push_back(placeholderTex);
 
-        VmaAllocation imageAllocation;
+		if (mPendingDecodes++ == 0)
+			mDecodeStart = std::chrono::steady_clock::now();
+		mPlaceholderTextures.insert(index);
 
-        vk::Extent3D extent( (uint32_t)tex.mWidth, (uint32_t)tex.mHeight, (uint32_t)tex.mDepth );
-        tex.mImage = CreateImage2D(extent, miplevels,
-            vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
-            VMA_MEMORY_USAGE_GPU_ONLY, 0, imageAllocation, nullptr);
+		std::string file(path);
+		GTaskScheduler.Schedule([this, index, file, genmips]()
+		{
+			DecodeResult res;
+			res.imageIndex = index;
+			res.genmips = genmips;
+			res.pixels = stbi_load(file.c_str(), &res.width, &res.height, &res.channels, STBI_rgb_alpha);
+			if (!res.pixels)
+				LOG_ERROR("[ERROR] Failed to load texture {}: {}\n", file, stbi_failure_reason());
+
+			std::lock_guard<std::mutex> lock(mDecodeMutex);
+			mDecoded.push_back(res);
+			mDecodeDone.notify_one();
+		});
 
-        tex.mImageView = CreateImageView2D(tex.mImage, miplevels, vk::Format::eR8G8B8A8Unorm);
-        tex.mSampler = CreateSampler();
-		tex.mImageAllocation = imageAllocation;
-		tex.mMipLevels = miplevels;
+		return index;
+	}
+
+	bool TextureManager::TryLoadCooked(const char* path, uint32_t& index)
+	{
+		std::string cooked = std::string(path) + TextureFile::EXTENSION;
+		index = LoadCooked(cooked.c_str());
+		return index != UINT32_MAX;
+	}
+
+	uint32_t TextureManager::LoadCooked(const char* path)
+	{
+		MappedFile file;
+		if (!file.Open(path))
+			return UINT32_MAX;
+
+		const TextureFileHeader* header = TextureFile::Read(file.GetData(), file.GetSize());
+		if (!header)
+		{
+			LOG_WARNING("[WARNING] Invalid cooked texture {}\n", path);
+			return UINT32_MAX;
+		}
+
+		Texture tex;
+		tex.mSampler = CreateSampler();
+
+		uint32_t index = mTexture.size();
+		mTexture.push_back(tex);
+		CreateCookedImage(index, file.GetData(), header, 0);
+
+		return index;
+	}
+
+	// Bytes of the cooked mips from 'firstMip' to the last one, they are stored back to back
+	static vk::DeviceSize GetCookedPayloadSize(const TextureFileHeader* header, uint32_t firstMip)
+	{
+		const uint32_t lastMip = header->mipLevels - 1;
+		return header->mipOffset[lastMip] + header->mipSize[lastMip] - header->mipOffset[firstMip];
+	}
+
+	void TextureManager::CreateCookedImage(uint32_t index, const uint8_t* data, const TextureFileHeader* header,
+		uint32_t firstMip)
+	{
+		Texture& tex = mTexture[index];
+		UploadRequest req;
+		req.imageIndex = index;
+		req.genmips = false;
+		req.regions = InitCookedImage(tex, header, firstMip);
+
+		// The mips are staged with a single copy
+		vk::DeviceSize payloadSize = GetCookedPayloadSize(header, firstMip);
+		VmaAllocationInfo stagAllocInfo;
+		req.stagBuffer = g_BufferManager.CreateBuffer(payloadSize, vk::BufferUsageFlagBits::eTransferSrc,
+			VMA_MEMORY_USAGE_CPU_ONLY, VMA_ALLOCATION_CREATE_MAPPED_BIT, req.stagAllocation, &stagAllocInfo);
+
+		memcpy(stagAllocInfo.pMappedData, data + header->mipOffset[firstMip], static_cast<size_t>(payloadSize));
+
+		mUploadRequest.push_back(req);
+	}
+
+	std::vector<vk::BufferImageCopy> TextureManager::InitCookedImage(Texture& tex, const TextureFileHeader* header,
+		uint32_t firstMip)
+	{
+		tex.mDepth = 1;
+		tex.mWidth = header->width;
+		tex.mHeight = header->height;
+		for (uint32_t i = 0; i < firstMip; i++)
+		{
+			tex.mWidth = NextMipSize(tex.mWidth);
+			tex.mHeight = NextMipSize(tex.mHeight);
+		}
+		tex.mChannels = STBI_rgb_alpha;
+		tex.mMipLevels = header->mipLevels - firstMip;
 		tex.mLayers = 1;
 
-        uint32_t index = mTexture.size();
-        mTexture.push_back(tex);
-        //mImageAllocation.push_back(imageAllocation);
+		const uint64_t firstOffset = header->mipOffset[firstMip];
+		std::vector<vk::BufferImageCopy> regions;
+		regions.reserve(tex.mMipLevels);
 
-        UploadRequest req;
-        req.imageIndex = index;
-        req.stagBuffer = stagBuffer;
-        req.stagAllocation = stagAllocation;
-		req.genmips = genmips;
-        mUploadRequest.push_back(req);
+		uint32_t width = tex.mWidth;
+		uint32_t height = tex.mHeight;
+		for (uint32_t i = 0; i < tex.mMipLevels; i++)
+		{
+			regions.push_back(vk::BufferImageCopy(
+				header->mipOffset[firstMip + i] - firstOffset, 0, 0,
+				vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, i, 0, 1),
+				vk::Offset3D(0, 0, 0),
+				vk::Extent3D(width, height, 1)));
+			width = NextMipSize(width);
+			height = NextMipSize(height);
+		}
 
-        return index;
-    }
+		vk::Extent3D extent(tex.mWidth, tex.mHeight, tex.mDepth);
+		tex.mImage = CreateImage2D(extent, tex.mMipLevels,
+			vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
+			VMA_MEMORY_USAGE_GPU_ONLY, 0, tex.mImageAllocation, nullptr);
+		tex.mImageView = CreateImageView2D(tex.mImage, tex.mMipLevels, vk::Format::eR8G8B8A8Unorm);
+
+		return regions;
+	}
+
+	uint32_t TextureManager::LoadTex2DStreamed(const char* path, bool srgb, const std::string& placeholder)
+	{
+		std::string cooked = std::string(path) + TextureFile::EXTENSION;
+		auto file = std::make_unique<MappedFile>();
+		if (!file->Open(cooked.c_str()))
+		{
+			// Cooked next to the image, the next runs map it right away
+			if (!TextureFile::Cook(path, cooked.c_str(), true, srgb) || !file->Open(cooked.c_str()))
+				return LoadTex2DAsync(path, true, placeholder);
+		}
+
+		const TextureFileHeader* header = TextureFile::Read(file->GetData(), file->GetSize());
+		if (!header)
+		{
+			LOG_WARNING("[WARNING] Invalid cooked texture {}\n", cooked);
+			return LoadTex2DAsync(path, true, placeholder);
+		}
+
+		StreamedTexture streamed;
+		streamed.residency = mResidency.Add(header->width, header->height, header->mipLevels, STBI_rgb_alpha);
+		streamed.header = header;
+
+		Texture tex;
+		tex.mSampler = CreateSampler();
+
+		uint32_t index = mTexture.size();
+		mTexture.push_back(tex);
+		CreateCookedImage(index, file->GetData(), header, mResidency.GetResidentMip(streamed.residency));
+
+		streamed.file = std::move(file);
+		mStreamed.emplace(index, std::move(streamed));
+		mResidencyTexture.push_back(index);
+
+		return index;
+	}
+
+	void TextureManager::RequestTextureSize(uint32_t index, float pixels)
+	{
+		auto it = mStreamed.find(index);
+		if (it == mStreamed.end())
+			return;
+
+		uint32_t handle = it->second.residency;
+		mResidency.Request(handle, mResidency.GetMipForScreenSize(handle, pixels));
+	}
+
+	void TextureManager::UpdateStreaming()
+	{
+		ReleaseImages(false);
+		if (mStreamed.empty())
+			return;
+
+		FinishStreams();
+
+		mResidencyChanges.clear();
+		mResidency.Update(mResidencyChanges);
+
+		for (const auto& change : mResidencyChanges)
+		{
+			uint32_t index = mResidencyTexture[change.texture];
+			const StreamedTexture& streamed = mStreamed[index];
+
+			// The texture keeps drawing with its image until the copy of the new one retired.
+			// The mips go through the staging ring of the buffer manager, nothing waits here
+			PendingStream stream;
+			stream.texture = index;
+			stream.image = mTexture[index];
+			std::vector<vk::BufferImageCopy> regions = InitCookedImage(stream.image, streamed.header, change.newMip);
+			stream.uploadId = g_BufferManager.UploadImage(stream.image.mImage, stream.image.mMipLevels,
+				streamed.file->GetData() + streamed.header->mipOffset[change.newMip],
+				GetCookedPayloadSize(streamed.header, change.newMip), std::move(regions));
+			mPendingStreams.push_back(stream);
+		}
+
+		if (!mResidencyChanges.empty())
+		{
+			LOG_INFO("[LOG] TextureManager streamed {} textures, {} / {} MB resident\n", mResidencyChanges.size(),
+				mResidency.GetResidentSize() >> 20, mResidency.GetBudget() >> 20);
+		}
+	}
+
+	void TextureManager::FinishStreams()
+	{
+		// Upload ids grow in request order and the copies retire in that order, so a texture
+		// streamed again swaps its images in the order they were requested
+		size_t count = 0;
+		for (; count < mPendingStreams.size() && g_BufferManager.IsRetired(mPendingStreams[count].uploadId); count++)
+		{
+			PendingStream& stream = mPendingStreams[count];
+			Texture& tex = mTexture[stream.texture];
+
+			// The frames in flight sample the old image. The materials write the set of an image
+			// again when it is recorded next, after its fence, so no set is written while bound
+			mPendingImageDestroys.push_back({ tex.mImage, tex.mImageView, tex.mImageAllocation,
+				GSwapchain.GetImageCount() + 1 });
+
+			tex = stream.image;
+			GMaterialManager.OnTextureLoaded(stream.texture);
+		}
+		mPendingStreams.erase(mPendingStreams.begin(), mPendingStreams.begin() + count);
+	}
+
+	void TextureManager::ReleaseImages(bool all)
+	{
+		for (size_t i = 0; i < mPendingImageDestroys.size(); )
+		{
+			PendingImageDestroy& pending = mPendingImageDestroys[i];
+			if (!all && --pending.framesLeft > 0)
+			{
+				++i;
+				continue;
+			}
+
+			g_vkDevice.destroyImageView(pending.view);
+			vmaDestroyImage(GVmaAllocator, pending.image, pending.allocation);
+
+			pending = mPendingImageDestroys.back();
+			mPendingImageDestroys.pop_back();
+		}
+	}
+
+	void TextureManager::FinishDecodes()
+	{
+		std::vector<DecodeResult> decoded;
+		{
+			std::lock_guard<std::mutex> lock(mDecodeMutex);
+			decoded.swap(mDecoded);
+		}
+
+		for (auto& res : decoded)
+		{
+			--mPendingDecodes;
+			// A texture which failed to load keeps its placeholder
+			if (!res.pixels) continue;
+
+			InitTex2D(res.imageIndex, res.pixels, res.width, res.height, res.channels, res.genmips);
+			stbi_image_free(res.pixels);
+			mPlaceholderTextures.erase(res.imageIndex);
+
+			// The descriptors of the materials still point to the placeholder
+			GMaterialManager.OnTextureLoaded(res.imageIndex);
+		}
+
+		if (!decoded.empty() && mPendingDecodes == 0)
+		{
+			auto elapsed = std::chrono::steady_clock::now() - mDecodeStart;
+			LOG_INFO("[LOG] TextureManager async loads done in {} ms\n",
+				std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+		}
+	}
 
     vk::ImageView TextureManager::CreateImageView2D(vk::Image image, uint32_t mipLevels, vk::Format format,
         vk::ImageAspectFlags aspectFlags)
@@ -356,12 +652,17 @@ namespace Engine
 		Texture tex;
 		tex.mDepth = 1;
 		float* pixels = stbi_loadf(path, (int*)&tex.mWidth, (int*)&tex.mHeight, (int*)&tex.mChannels, STBI_rgb_alpha);
-		vk::DeviceSize imageSize = tex.mWidth * tex.mHeight * STBI_rgb_alpha * sizeof(float);
 		assert(pixels);
 
-		uint32_t miplevels = 1;
-		if (genmips)
-			miplevels = static_cast<uint32_t>(std::floor(std::log2(std::max(tex.mWidth, tex.mHeight)))) + 1;
+		uint32_t miplevels = genmips ? GetMipLevelCount(tex.mWidth, tex.mHeight) : 1;
+
+		// Float formats don't have to support linear blits, the mips are filtered
+		// on the CPU and every level gets a copy region of its own
+		std::vector<float> mips(pixels, pixels + (size_t)tex.mWidth * tex.mHeight * STBI_rgb_alpha);
+		stbi_image_free(pixels);
+		std::vector<size_t> offsets = GenerateMipChainRGBA32F(mips, tex.mWidth, tex.mHeight, miplevels,
+			MipFilter::Kaiser, [](uint32_t count, const std::function<void(uint32_t)>& f) { GTaskScheduler.ParallelFor(count, f); });
+		vk::DeviceSize imageSize = mips.size() * sizeof(float);
 
 		VmaAllocation stagAllocation;
 		VmaAllocationInfo stagAllocInfo;
@@ -370,8 +671,7 @@ namespace Engine
 		stagBuffer = g_BufferManager.CreateBuffer(imageSize, vk::BufferUsageFlagBits::eTransferSrc,
 			VMA_MEMORY_USAGE_CPU_ONLY, VMA_ALLOCATION_CREATE_MAPPED_BIT, stagAllocation, &stagAllocInfo);
 
-		memcpy(stagAllocInfo.pMappedData, pixels, static_cast<size_t>(imageSize));
-		stbi_image_free(pixels);
+		memcpy(stagAllocInfo.pMappedData, mips.data(), static_cast<size_t>(imageSize));
 
 		VmaAllocation imageAllocation;
 
@@ -393,7 +693,20 @@ namespace Engine
 		req.imageIndex = index;
 		req.stagBuffer = stagBuffer;
 		req.stagAllocation = stagAllocation;
-		req.genmips = genmips;
+		req.genmips = false;
+
+		uint32_t width = tex.mWidth;
+		uint32_t height = tex.mHeight;
+		for (uint32_t i = 0; i < miplevels; i++)
+		{
+			req.regions.push_back(vk::BufferImageCopy(
+				offsets[i] * sizeof(float), 0, 0,
+				vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, i, 0, 1),
+				vk::Offset3D(0, 0, 0),
+				vk::Extent3D(width, height, 1)));
+			width = NextMipSize(width);
+			height = NextMipSize(height);
+		}
 		mUploadRequest.push_back(req);
 
 		return index;
@@ -619,6 +932,7 @@ namespace Engine
         req.imageIndex = index;
         req.stagBuffer = stagBuffer;
         req.stagAllocation = stagAllocation;
+        req.genmips = false;
         mUploadRequest.push_back(req);
 
         return index;
@@ -637,6 +951,8 @@ namespace Engine
 		CONVERT_TO_COLOR("red", 255, 0, 0)
 		CONVERT_TO_COLOR("green", 0, 255, 0)
 		CONVERT_TO_COLOR("blue", 0, 0, 255)
+		// Tangent space normal pointing straight out of the surface
+		CONVERT_TO_COLOR("flatnormal", 128, 128, 255)
 		THROW("Color not supported!");
 	}
 
@@ -662,6 +978,7 @@ namespace Engine
 
     vk::Sampler TextureManager::CreateSampler()
     {
+        // No max lod, every mip of the view is sampled
         vk::SamplerCreateInfo samplerCI({},
             vk::Filter::eLinear,
             vk::Filter::eNearest,
@@ -670,7 +987,7 @@ namespace Engine
             vk::SamplerAddressMode::eRepeat,
             vk::SamplerAddressMode::eRepeat,
             0.0f, VK_TRUE, 16, VK_FALSE,
-            vk::CompareOp::eAlways, 0.0f, 0.0f
+            vk::CompareOp::eAlways, 0.0f, VK_LOD_CLAMP_NONE
         );
 
         return g_vkDevice.createSampler(samplerCI);
@@ -810,6 +1127,26 @@ extern "C"
         return Engine::g_TextureManager.LoadTex2D(path, genmips);
     }
 
+    LAVA_API uint32_t Load2DAsync(const char* path, bool genmips)
+    {
+        return Engine::g_TextureManager.LoadTex2DAsync(path, genmips);
+    }
+
+    LAVA_API bool CookTexture_Native(const char* srcPath, const char* dstPath, bool genmips, bool srgb)
+    {
+        return Engine::TextureFile::Cook(srcPath, dstPath, genmips, srgb);
+    }
+
+    LAVA_API uint32_t Load2DStreamed(const char* path, bool srgb)
+    {
+        return Engine::g_TextureManager.LoadTex2DStreamed(path, srgb);
+    }
+
+    LAVA_API void SetTextureStreamingBudget_Native(uint64_t bytes)
+    {
+        Engine::g_TextureManager.SetStreamingBudget(bytes);
+    }
+
     LAVA_API uint32_t CreateFromColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a)
     {
         return Engine::g_TextureManager.CreateTextureFromColor(r, g, b, a);
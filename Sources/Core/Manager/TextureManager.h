@@ -1,7 +1,15 @@
 #pragma once
 #include <Engine\Texture.h>
+#include <Engine\TextureFile.h>
+#include <Common\MappedFile.h>
+#include <Common\TextureResidency.h>
 #include <string>
+#include <memory>
 #include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 
 #define GTextureManager Engine::g_TextureManager
 #define TextureAt(i) g_TextureManager.GetTexture(i);
@@ -11,6 +19,9 @@ namespace Engine
     class TextureManager
     {
         static constexpr uint32_t TEXTURE_INIT_CAPACITY = 16;
+        // Memory of the streamed textures and the bytes of mips they can load in one frame
+        static constexpr uint64_t STREAMING_BUDGET = 256ull * 1024 * 1024;
+        static constexpr uint64_t STREAMING_LOAD_PER_FRAME = 16ull * 1024 * 1024;
 
     public:
         void Init();
@@ -62,7 +73,24 @@ namespace Engine
 		uint32_t LoadTex2DFromData(const void* data, int width, int height, int channels = 4, bool genmips = false);
         uint32_t LoadTex2D(const char* path, bool genmips = false);
 		uint32_t LoadTexHDR(const char* path, bool genmips = false);
+		// Returns immediately and decodes the file on the task scheduler. The texture
+		// shows the 'placeholder' color texture until its upload is done
+		uint32_t LoadTex2DAsync(const char* path, bool genmips = false, const std::string& placeholder = "white");
+		// Maps a texture written by TextureFile and copies its mips straight to staging memory.
+		// Returns UINT32_MAX if the file is missing or invalid
+		uint32_t LoadCooked(const char* path);
+		// Streams the mips of the cooked version of the image at 'path', cooking it first if there
+		// is none. Only the small mips are resident until RequestTextureSize asks for more.
+		// Falls back to LoadTex2DAsync if the image can't be cooked
+		uint32_t LoadTex2DStreamed(const char* path, bool srgb = true, const std::string& placeholder = "white");
 		// --------------------------- //
+
+		// ---- Streaming ---- //
+		// Requests the mip of a streamed texture drawn 'pixels' wide on screen this frame
+		void RequestTextureSize(uint32_t index, float pixels);
+		void SetStreamingBudget(uint64_t bytes) { mResidency.SetBudget(bytes); }
+		const TextureResidency& GetResidency() const { return mResidency; }
+		// ------------------- //
         
         /// <summary>
         /// Creates a 1x1 texture given the color rgba
@@ -97,8 +125,63 @@ namespace Engine
             vk::Buffer stagBuffer;
             VmaAllocation stagAllocation;
 			bool genmips;
+			// One copy per mip of a cooked texture, the first mip only if empty
+			std::vector<vk::BufferImageCopy> regions;
+        };
+
+        // Pixels decoded by a task, null if the file couldn't be loaded
+        struct DecodeResult
+        {
+            uint32_t imageIndex;
+            unsigned char* pixels;
+            int width, height, channels;
+            bool genmips;
+        };
+
+        // Mapped cooked file of a streamed texture, the mips are staged from it on demand
+        struct StreamedTexture
+        {
+            uint32_t residency;
+            std::unique_ptr<MappedFile> file;
+            const TextureFileHeader* header;
         };
 
+        // New image of a streamed texture, swapped in once its copy retired
+        struct PendingStream
+        {
+            uint32_t texture;
+            Texture image;
+            uint64_t uploadId;
+        };
+
+        // Image replaced by streaming, destroyed once the frames in flight are done with it
+        struct PendingImageDestroy
+        {
+            vk::Image image;
+            vk::ImageView view;
+            VmaAllocation allocation;
+            uint32_t framesLeft;
+        };
+
+        // Loads the cooked version of the image at 'path' if there is one
+        bool TryLoadCooked(const char* path, uint32_t& index);
+        // Creates the image of the cooked mips from 'firstMip' for the texture at 'index'
+        // and requests their upload. 'data' is the whole cooked file
+        void CreateCookedImage(uint32_t index, const uint8_t* data, const TextureFileHeader* header, uint32_t firstMip);
+        // Sets the size of 'tex' to the cooked mips from 'firstMip' and creates its image. Returns
+        // the copies of the mips from a buffer holding the file from mipOffset[firstMip] on
+        std::vector<vk::BufferImageCopy> InitCookedImage(Texture& tex, const TextureFileHeader* header, uint32_t firstMip);
+        // Uploads new images for the streamed textures whose resident mips changed
+        void UpdateStreaming();
+        // Swaps the streamed images whose copy retired with the ones of their textures
+        void FinishStreams();
+        // Destroys the replaced images no frame uses anymore, all of them if 'all' is set
+        void ReleaseImages(bool all);
+        // Creates the image of the texture at 'index' and requests the upload of its pixels
+        void InitTex2D(uint32_t index, const void* pixels, int width, int height, int channels, bool genmips);
+        // Swaps the placeholders of the decoded textures with the real ones
+        void FinishDecodes();
+
         typedef std::vector<Texture> TextureList;
         typedef std::vector<UploadRequest> UploadRequestList;
 
@@ -107,6 +190,22 @@ namespace Engine
         TextureList mTexture;
         UploadRequestList mUploadRequest;
 
+        // Textures sharing the image of their placeholder, either decoding or failed to load
+        std::unordered_set<uint32_t> mPlaceholderTextures;
+        uint32_t mPendingDecodes = 0;
+        std::mutex mDecodeMutex;
+        std::condition_variable mDecodeDone;
+        std::vector<DecodeResult> mDecoded;
+        std::chrono::steady_clock::time_point mDecodeStart;
+
+        TextureResidency mResidency;
+        std::unordered_map<uint32_t, StreamedTexture> mStreamed;
+        // Texture index of every residency handle
+        std::vector<uint32_t> mResidencyTexture;
+        std::vector<TextureResidency::Change> mResidencyChanges;
+        std::vector<PendingStream> mPendingStreams;
+        std::vector<PendingImageDestroy> mPendingImageDestroys;
+
         vk::CommandPool mCommandPool;
         vk::CommandBuffer mTransferCmdBuffer;
         vk::Fence mUploadFence;
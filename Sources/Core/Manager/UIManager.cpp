@@ -167,7 +167,7 @@ namespace Engine
 		g_vkDevice.waitIdle();
 	}
 
-	void UIManager::Draw(vk::CommandBuffer cmdBuff)
+	void UIManager::Draw(vk::CommandBuffer cmdBuff, uint32_t imageIndex)
 	{
 		if (!mMaterial)
 		{
@@ -211,7 +211,7 @@ namespace Engine
 			cmdBuff.setScissor(0, { scissor });
 
 			mMaterial->UpdateUniform(0, (uint32_t)cmd->texture.id);
-			mMaterial->Bind(cmdBuff);
+			mMaterial->Bind(cmdBuff, imageIndex);
 
 			cmdBuff.drawIndexed(cmd->elem_count, 1, firstIndex, 0, 0);
 			firstIndex += cmd->elem_count;
@@ -22,7 +22,7 @@ namespace Engine
 
 		void MirrorInput();
 		void SetupDrawBuffers();
-		void Draw(vk::CommandBuffer cmdBuf);
+		void Draw(vk::CommandBuffer cmdBuf, uint32_t imageIndex);
 		void FreeDrawBuffers();
 
 		void Update();
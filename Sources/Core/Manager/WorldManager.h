@@ -22,7 +22,12 @@ namespace Engine
         void UpdatePhysicsWorld();
 
         World* GetCurrentWorld() { return mCurrentWorld; }
-        void SetCurrentWorld(World* world) { mCurrentWorld = world; }
+        void SetCurrentWorld(World* world)
+        {
+            mCurrentWorld = world;
+            if (world)
+                world->Invalidate();
+        }
 
     private:
         std::vector<World*> mWorld;
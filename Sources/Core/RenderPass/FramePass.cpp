@@ -42,12 +42,28 @@ namespace Engine
 
     void FramePass::Setup()
     {
-		CurrentWorld->UploadLightSources();
-		CurrentWorld->UploadFrameConsts();
-		g_ResourceManager.WriteBufferToDescriptorSlot(LIGHTSOURCE_SLOT, g_ResourceManager.GetLightsBuffer());
-		g_ResourceManager.WriteBufferToDescriptorSlot(FRAMECONSTS_SLOT, g_ResourceManager.GetFrameConstsBuffer());
-        CurrentWorld->RecordWorldCommandBuffers(GSwapchain.GetCurrentFrameIndex());
-        RecordCommandBuffer(GSwapchain.GetCurrentFrameIndex());
+		// The swapchain waited for the fence of this image, so its buffers and sets are free
+		const uint32_t imageIndex = GSwapchain.GetCurrentFrameIndex();
+		CurrentWorld->UploadLightSources(imageIndex);
+		CurrentWorld->UploadFrameConsts(imageIndex);
+		CurrentWorld->UploadTransforms(imageIndex);
+
+		bool rewritten = g_ResourceManager.WriteBufferToDescriptorSlot(LIGHTSOURCE_SLOT, imageIndex,
+			g_ResourceManager.GetLightsBuffer(imageIndex));
+		rewritten |= g_ResourceManager.WriteBufferToDescriptorSlot(FRAMECONSTS_SLOT, imageIndex,
+			g_ResourceManager.GetFrameConstsBuffer(imageIndex));
+		if (g_ResourceManager.GetObjectsBuffer(imageIndex).Size() > 0)
+		{
+			rewritten |= g_ResourceManager.WriteBufferToDescriptorSlot(OBJECTS_SLOT, imageIndex,
+				g_ResourceManager.GetObjectsBuffer(imageIndex), vk::DescriptorType::eStorageBuffer);
+		}
+
+		// Writing the global descriptors of the image invalidates the world recorded for it
+		if (rewritten)
+			CurrentWorld->mDirty |= 1 << imageIndex;
+
+        CurrentWorld->RecordWorldCommandBuffers(imageIndex);
+        RecordCommandBuffer(imageIndex);
     }
 
 	vk::SubmitInfo FramePass::GetSubmitInfo(vk::Semaphore& waitSem, vk::PipelineStageFlags waitStage, vk::Semaphore& signalSem)
@@ -183,7 +199,9 @@ namespace Engine
         mCommandBuffer[imageIndex].beginRenderPass(renderPassInfo,
             vk::SubpassContents::eSecondaryCommandBuffers);
 
-        mCommandBuffer[imageIndex].executeCommands(CurrentWorld->GetWorldCommandBuffer(imageIndex));
+        mCommandBuffer[imageIndex].executeCommands(
+            CurrentWorld->GetWorldCommandBufferCount(imageIndex),
+            CurrentWorld->GetWorldCommandBuffers(imageIndex));
 
         mCommandBuffer[imageIndex].endRenderPass();
 
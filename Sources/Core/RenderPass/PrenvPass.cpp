@@ -267,7 +267,8 @@ namespace Engine
 
 				cmdBuf.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
 
-				mMaterial->Bind(cmdBuf);
+				// Recorded once outside the frame loop, the set of the first image is enough
+				mMaterial->Bind(cmdBuf, 0);
 
 				vk::Buffer vbo = BufferAt(mVBO);
 				vk::DeviceSize vertOffset = 0;
@@ -198,7 +198,7 @@ namespace Engine
 			| vk::ShaderStageFlagBits::eFragment,
 			0, sizeof(SkyPS), &pc);
 
-		mMaterial->Bind(mCommandBuffer[imageIndex]);
+		mMaterial->Bind(mCommandBuffer[imageIndex], imageIndex);
 
 		vk::Buffer vbo = BufferAt(mVBO);
 		vk::DeviceSize vertOffset = 0;
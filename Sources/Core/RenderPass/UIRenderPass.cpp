@@ -166,7 +166,7 @@ namespace Engine
 		mCommandBuffer[imageIndex].beginRenderPass(renderPassInfo,
 			vk::SubpassContents::eInline);
 
-		g_UIManager.Draw(mCommandBuffer[imageIndex]);
+		g_UIManager.Draw(mCommandBuffer[imageIndex], imageIndex);
 
 		mCommandBuffer[imageIndex].endRenderPass();
 
@@ -1,6 +1,7 @@
 ﻿using Lava.Engine;
 using Lava.Mathematics;
 using Lava.Physics;
+using System.Collections.Generic;
 using System.Runtime.InteropServices;
 
 namespace Demo
@@ -24,6 +25,8 @@ namespace Demo
         static PhysicsWorld phys;
         static Entity sun;
         static AudioClip shotSound;
+        // Bodies whose trigger is inside another trigger, with the number of overlaps
+        static Dictionary<RigidBody, int> floatingBodies = new Dictionary<RigidBody, int>();
 
         static void Update()
         {
@@ -69,6 +72,11 @@ namespace Demo
                     visuals[i].GetComponent<RigidBody>().ApplyForceToCenterOfMass(Vector3.UnitY * power);
                 }
             }
+
+            foreach (var rb in floatingBodies.Keys)
+            {
+                rb.ApplyForceToCenterOfMass(Vector3.UnitY * 35f);
+            }
         }
 
         static void InitializeGame()
@@ -190,7 +198,12 @@ namespace Demo
         private static void TrigShape_CollisionEvent(CollisionInfo collisionInfo)
         {
             var rb = collisionInfo.owner.Owner.GetComponent<RigidBody>();
-            rb.ApplyForceToCenterOfMass(Vector3.UnitY * 35f);
+            floatingBodies.TryGetValue(rb, out int count);
+            count += collisionInfo.triggerEvent == TriggerEvent.Enter ? 1 : -1;
+            if (count > 0)
+                floatingBodies[rb] = count;
+            else
+                floatingBodies.Remove(rb);
         }
 
         static void Main(string[] args)
@@ -16,6 +16,9 @@ namespace Lava.Engine
         [DllImport("LavaCore.dll")]
         public static extern float GetFixedDeltaTime();
 
+        [DllImport("LavaCore.dll")]
+        public static extern void SetFixedDeltaTime(float dt);
+
         [DllImport("LavaCore.dll")]
         public static extern float GetDeltaTime();
 
@@ -28,9 +28,20 @@ namespace Lava.Engine
         private static extern IntPtr CreateMeshExt_Native(VertexExt[] vertices, int verticesLength,
             uint[] indices, int indicesLength);
 
+        [DllImport("LavaCore.dll")]
+        private static extern IntPtr CreateMeshPacked_Native(Vertex[] vertices, int verticesLength,
+            uint[] indices, int indicesLength);
+
+        [DllImport("LavaCore.dll")]
+        private static extern IntPtr CreateMeshExtPacked_Native(VertexExt[] vertices, int verticesLength,
+            uint[] indices, int indicesLength);
+
         [DllImport("LavaCore.dll")]
         private static extern IntPtr LoadFromFile_Native(string path);
 
+        [DllImport("LavaCore.dll")]
+        private static extern IntPtr LoadPackedFromFile_Native(string path);
+
 
         public StaticMesh(Vertex[] vertices, int verticesLength,
             uint[] indices, int indicesLength)
@@ -54,5 +65,36 @@ namespace Lava.Engine
         {
             NativePtr = LoadFromFile_Native(path);
         }
+
+        /// <summary>
+        /// Load the mesh quantized to VertexPacked, draw it with the "pbrpacked" pipeline.
+        /// </summary>
+        public StaticMesh(string path, bool packed)
+        {
+            NativePtr = packed ? LoadPackedFromFile_Native(path) : LoadFromFile_Native(path);
+        }
+
+        private StaticMesh(IntPtr nativePtr)
+        {
+            NativePtr = nativePtr;
+        }
+
+        /// <summary>
+        /// Create a mesh quantized to VertexPacked.
+        /// </summary>
+        public static StaticMesh CreatePacked(Vertex[] vertices, int verticesLength,
+            uint[] indices, int indicesLength)
+        {
+            return new StaticMesh(CreateMeshPacked_Native(vertices, verticesLength, indices, indicesLength));
+        }
+
+        /// <summary>
+        /// Create a mesh quantized to VertexExtPacked.
+        /// </summary>
+        public static StaticMesh CreatePacked(VertexExt[] vertices, int verticesLength,
+            uint[] indices, int indicesLength)
+        {
+            return new StaticMesh(CreateMeshExtPacked_Native(vertices, verticesLength, indices, indicesLength));
+        }
     }
 }
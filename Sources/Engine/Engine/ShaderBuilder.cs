@@ -1,6 +1,8 @@
 ﻿using System;
 using System.IO;
 using System.Diagnostics;
+using System.Collections.Generic;
+using System.Text.RegularExpressions;
 
 namespace Lava.Engine
 {
@@ -30,7 +32,7 @@ namespace Lava.Engine
         /// Build the shader file.
         /// </summary>
         /// <param name="path">Path to the shader source code file.</param>
-        /// <returns>True if the build succeded.</returns>
+        /// <exception cref="Exception">glslc could not be started or failed to compile the shader.</exception>
         private static void BuildShader(string path)
         {
             Console.WriteLine("Building shader: " + path);
@@ -45,10 +47,22 @@ namespace Lava.Engine
             using (var process = new Process())
             {
                 process.StartInfo = startInfo;
-                process.Start();
-                process.WaitForExit();
+                try
+                {
+                    process.Start();
+                }
+                catch (System.ComponentModel.Win32Exception e)
+                {
+                    throw new Exception("Cannot run glslc.exe to build shader " + path + ", is the Vulkan SDK in the PATH?", e);
+                }
+                // Read before waiting so a full error pipe cannot block glslc
                 string error = process.StandardError.ReadToEnd();
+                process.WaitForExit();
                 ConsoleEx.WriteError(error);
+
+                // A missing or stale binary would only fail later when the pipelines are created
+                if (process.ExitCode != 0)
+                    throw new Exception("Failed to build shader " + path + " (glslc exit code " + process.ExitCode + ")!");
             }
         }
 
@@ -57,14 +71,43 @@ namespace Lava.Engine
             if (!File.Exists(target))
                 return true;
 
-            DateTime sourceTimestamp = File.GetLastWriteTimeUtc(source);
+            DateTime sourceTimestamp = GetLastWriteTimeWithIncludes(source, new HashSet<string>());
             DateTime targetTimestamp = File.GetLastWriteTimeUtc(target);
 
-            // If the source file is more recent than the binary file then build
+            // If the source file or one of its includes is more recent than the binary file then build
             if (targetTimestamp < sourceTimestamp)
                 return true;
 
             return false;
         }
+
+        private static readonly Regex IncludeRegex = new Regex("^\\s*#\\s*include\\s*\"([^\"]+)\"");
+
+        /// <summary>
+        /// Get the most recent write time of the file and of the files it includes with quotes.
+        /// </summary>
+        /// <param name="path">Path to the shader source code file.</param>
+        /// <param name="visited">Files already checked, to stop on include cycles.</param>
+        private static DateTime GetLastWriteTimeWithIncludes(string path, HashSet<string> visited)
+        {
+            DateTime timestamp = File.GetLastWriteTimeUtc(path);
+            if (!visited.Add(Path.GetFullPath(path)))
+                return timestamp;
+
+            string dir = Path.GetDirectoryName(path);
+            foreach (string line in File.ReadLines(path))
+            {
+                Match match = IncludeRegex.Match(line);
+                if (!match.Success) continue;
+
+                string include = Path.Combine(dir, match.Groups[1].Value);
+                if (!File.Exists(include)) continue;
+
+                DateTime includeTimestamp = GetLastWriteTimeWithIncludes(include, visited);
+                if (includeTimestamp > timestamp)
+                    timestamp = includeTimestamp;
+            }
+            return timestamp;
+        }
     }
 }
@@ -19,6 +19,25 @@ namespace Lava.Engine
         [DllImport("LavaCore.dll")]
         public static extern uint LoadHDR(string path, bool genmips = false);
 
+        /// <summary>
+        /// Load an image as a streamed texture, only the mips needed on screen are resident.
+        /// </summary>
+        /// <param name="path">The relative path to the image</param>
+        /// <param name="srgb">False for normal maps and masks</param>
+        [DllImport("LavaCore.dll")]
+        public static extern uint Load2DStreamed(string path, bool srgb = true);
+
+        [DllImport("LavaCore.dll")]
+        private static extern void SetTextureStreamingBudget_Native(ulong bytes);
+
+        /// <summary>
+        /// Sets the memory the streamed textures can keep resident, in bytes.
+        /// </summary>
+        public static void SetStreamingBudget(ulong bytes)
+        {
+            SetTextureStreamingBudget_Native(bytes);
+        }
+
         [DllImport("LavaCore.dll")]
         private static extern uint CreateFromColor(byte r, byte g, byte b, byte a);
 
@@ -69,6 +69,12 @@ namespace Lava.Engine
             SetPosition_Native(NativePtr, Transform.Position);
         }
 
+        internal void UpdateTransform()
+        {
+            SetModel_Native(NativePtr, Transform.Model);
+            UpdatePosition();
+        }
+
         internal override void Update()
         {
             base.Update();
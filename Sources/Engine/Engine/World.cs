@@ -29,7 +29,7 @@ namespace Lava.Engine
         private static extern void SetSkyViewProj_Native(IntPtr world, Matrix4 viewProj);
 
         [DllImport("LavaCore.dll")]
-        private static extern void SetViewBounds_Native(IntPtr world, Vector3 bmin, Vector3 bmax);
+        private static extern void SetViewProj_Native(IntPtr world, Matrix4 viewProj);
 
         [DllImport("LavaCore.dll")]
         private static extern IntPtr GetPhysicsWorld_Native(IntPtr world);
@@ -43,7 +43,7 @@ namespace Lava.Engine
             if (ent is VisualEntity)
             {
                 VisualEntity vent = ent as VisualEntity;
-                vent.UpdatePosition();
+                vent.UpdateTransform();
                 AddEntity_Native(NativePtr, vent.NativePtr);
             }
 
@@ -74,13 +74,7 @@ namespace Lava.Engine
             {
                 SetCameraPos_Native(NativePtr, Camera.Main.Position);
 
-                //Mathf.Vector3 bmin = Camera.Main.Position - Camera.Main.Right * Camera.Main.FarPlane / 2f
-                //    - Camera.Main.Up * Camera.Main.FarPlane / 2f;
-                //Mathf.Vector3 bmax = Camera.Main.Position + Camera.Main.Right * Camera.Main.FarPlane / 2f
-                //    + Camera.Main.Up * Camera.Main.FarPlane / 2f + Camera.Main.Forward * Camera.Main.FarPlane;
-                Vector3 bmin = Camera.Main.Position - new Vector3(Camera.Main.FarPlane + 5f);
-                Vector3 bmax = Camera.Main.Position + new Vector3(Camera.Main.FarPlane + 5f);
-                SetViewBounds_Native(NativePtr, bmin, bmax);
+                SetViewProj_Native(NativePtr, Camera.Main.ViewProjection);
                 SetSkyViewProj_Native(NativePtr, Camera.Main.SkyViewProj);
                 SetSkySettings_Native(NativePtr, skySettings);
             }
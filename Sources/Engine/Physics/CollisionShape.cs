@@ -4,14 +4,22 @@ using Lava.Mathematics;
 
 namespace Lava.Physics
 {
+    public enum TriggerEvent : uint
+    {
+        Enter,
+        Exit
+    }
+
     public struct CollisionInfoMarshal
     {
         public Vector3 pointOfContact;
+        public TriggerEvent triggerEvent;
     }
 
     public struct CollisionInfo
     {
         public Vector3 pointOfContact;
+        public TriggerEvent triggerEvent;
         public Lava.Engine.Component owner;
     }
 
@@ -66,6 +74,7 @@ namespace Lava.Physics
         {
             CollisionInfo info = new CollisionInfo();
             info.pointOfContact = collInfo.pointOfContact;
+            info.triggerEvent = collInfo.triggerEvent;
             info.owner = CollisionBody;
             CollisionEvent?.Invoke(info);
         }
@@ -85,7 +94,7 @@ namespace Lava.Physics
         private static extern IntPtr DestroyBoxShape_Native(IntPtr rb, IntPtr proxy);
 
         [DllImport("LavaCore.dll")]
-        private static extern IntPtr DestroyBoxTrigger_Native(IntPtr cb, IntPtr proxy);
+        private static extern IntPtr DestroyBoxTrigger_Native(IntPtr pworld, IntPtr cb, IntPtr proxy);
 
         [DllImport("LavaCore.dll")]
         private static extern void SetBoxTriggerCallback_Native(IntPtr pworld, IntPtr proxy, CollisionCallback cback);
@@ -110,7 +119,7 @@ namespace Lava.Physics
 
         public override void DestroyProxyTrigger(CollisionBody cb)
         {
-            DestroyBoxTrigger_Native(cb.NativePtr, NativePtr);
+            DestroyBoxTrigger_Native(cb.PhysicsWorld.NativePtr, cb.NativePtr, NativePtr);
         }
 
         protected override void RegisterCollisionCallback()
@@ -9,6 +9,17 @@ namespace Lava.Physics
 {
     public delegate void UpdateRigidBodyCallback(Mathematics.Vector3 pos, Mathematics.Quaternion rot);
 
+    internal delegate void TransformSyncCallback(uint bodyCount);
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct PhysicsFrameStats
+    {
+        public uint substeps;
+        // Time that was not simulated because of the substep limit
+        public float timeDropped;
+        public float stepSize;
+    }
+
     public class PhysicsWorld
     {
         [DllImport("LavaCore.dll")]
@@ -22,6 +33,24 @@ namespace Lava.Physics
         [DllImport("LavaCore.dll")]
         private static extern void SetGravity_Native(IntPtr pworld, Mathematics.Vector3 gravuty);
 
+        [DllImport("LavaCore.dll")]
+        private static extern void SetSolverJobCount_Native(IntPtr pworld, uint count);
+
+        [DllImport("LavaCore.dll")]
+        private static extern void SetMaxSubsteps_Native(IntPtr pworld, uint count);
+
+        [DllImport("LavaCore.dll")]
+        private static extern void SetAdaptiveStep_Native(IntPtr pworld, bool adaptive);
+
+        [DllImport("LavaCore.dll")]
+        private static extern PhysicsFrameStats GetFrameStats_Native(IntPtr pworld);
+
+        [DllImport("LavaCore.dll")]
+        private static extern void SetTransformSyncBuffer_Native(IntPtr pworld, IntPtr positions,
+            IntPtr orientations, IntPtr dirtyBits, uint capacity, TransformSyncCallback cback);
+
+        private const int MIN_SYNC_CAPACITY = 64;
+
         public IntPtr NativePtr { get; internal set; }
 
         public Mathematics.Vector3 Gravity
@@ -29,33 +58,116 @@ namespace Lava.Physics
             set => SetGravity_Native(NativePtr, value);
         }
 
+        /// <summary>
+        /// Number of jobs the physics islands are solved on. The simulation gives the same results for any value.
+        /// </summary>
+        public uint SolverJobCount
+        {
+            set => SetSolverJobCount_Native(NativePtr, value);
+        }
+
+        /// <summary>
+        /// Physics steps taken in one frame at most. The time past that is dropped.
+        /// </summary>
+        public uint MaxSubsteps
+        {
+            set => SetMaxSubsteps_Native(NativePtr, value);
+        }
+
+        /// <summary>
+        /// Catch up long frames with larger steps before dropping time. The simulation then depends on the frame times.
+        /// </summary>
+        public bool AdaptiveStep
+        {
+            set => SetAdaptiveStep_Native(NativePtr, value);
+        }
+
+        /// <summary>
+        /// Substeps taken and time dropped in the last frame.
+        /// </summary>
+        public PhysicsFrameStats FrameStats => GetFrameStats_Native(NativePtr);
+
         public RigidBody CreateRigidBody(Mathematics.Vector3 position, Mathematics.Quaternion rotation)
         {
-            RigidBody rb = new RigidBody(position, rotation);
-            rb.UpdateCallback = new UpdateRigidBodyCallback(rb.OnRigidBodyUpdate);
-            rb.NativePtr = CreateRigidBody_Native(NativePtr, position, rotation, rb.UpdateCallback);
-            rb.PhysicsWorld = this;
-            return rb;
+            return CreateRigidBody(new RigidBody(position, rotation), position, rotation);
         }
 
         public RigidBody CreateRigidBody(Mathematics.Vector3 position)
         {
-            RigidBody rb = new RigidBody(position, Mathematics.Quaternion.Identity);
-            rb.UpdateCallback = new UpdateRigidBodyCallback(rb.OnRigidBodyUpdate);
-            rb.NativePtr = CreateRigidBody_Native(NativePtr, position, Mathematics.Quaternion.Identity, rb.UpdateCallback);
-            rb.PhysicsWorld = this;
-            return rb;
+            return CreateRigidBody(new RigidBody(position, Mathematics.Quaternion.Identity), position, Mathematics.Quaternion.Identity);
         }
 
         public RigidBody CreateRigidBody()
         {
-            RigidBody rb = new RigidBody();
+            return CreateRigidBody(new RigidBody(), Mathematics.Vector3.Zero, Mathematics.Quaternion.Identity);
+        }
+
+        private RigidBody CreateRigidBody(RigidBody rb, Mathematics.Vector3 position, Mathematics.Quaternion rotation)
+        {
+            // The native side writes the transform of a body at its creation index
+            EnsureSyncCapacity(rigidBodies.Count + 1);
             rb.UpdateCallback = new UpdateRigidBodyCallback(rb.OnRigidBodyUpdate);
-            rb.NativePtr = CreateRigidBody_Native(NativePtr, Mathematics.Vector3.Zero, Mathematics.Quaternion.Identity, rb.UpdateCallback);
+            rb.NativePtr = CreateRigidBody_Native(NativePtr, position, rotation, rb.UpdateCallback);
             rb.PhysicsWorld = this;
+            rigidBodies.Add(rb);
             return rb;
         }
 
+        private List<RigidBody> rigidBodies = new List<RigidBody>();
+
+        private Mathematics.Vector3[] syncPositions;
+        private Mathematics.Quaternion[] syncRotations;
+        private uint[] syncDirtyBits;
+        private GCHandle[] syncHandles;
+        private TransformSyncCallback onTransformSync;
+
+        private void EnsureSyncCapacity(int count)
+        {
+            int capacity = syncPositions == null ? MIN_SYNC_CAPACITY : syncPositions.Length;
+            if (syncPositions != null && count <= capacity)
+                return;
+
+            while (capacity < count)
+                capacity *= 2;
+
+            if (syncHandles != null)
+            {
+                foreach (var handle in syncHandles)
+                    handle.Free();
+            }
+
+            // Pinned so that the native side can write to them after each update
+            syncPositions = new Mathematics.Vector3[capacity];
+            syncRotations = new Mathematics.Quaternion[capacity];
+            syncDirtyBits = new uint[(capacity + 31) / 32];
+            syncHandles = new GCHandle[]
+            {
+                GCHandle.Alloc(syncPositions, GCHandleType.Pinned),
+                GCHandle.Alloc(syncRotations, GCHandleType.Pinned),
+                GCHandle.Alloc(syncDirtyBits, GCHandleType.Pinned)
+            };
+
+            if (onTransformSync == null)
+                onTransformSync = new TransformSyncCallback(OnTransformSync);
+
+            SetTransformSyncBuffer_Native(NativePtr, syncHandles[0].AddrOfPinnedObject(),
+                syncHandles[1].AddrOfPinnedObject(), syncHandles[2].AddrOfPinnedObject(),
+                (uint)capacity, onTransformSync);
+        }
+
+        private void OnTransformSync(uint bodyCount)
+        {
+            for (int word = 0; word * 32 < bodyCount; word++)
+            {
+                uint bits = syncDirtyBits[word];
+                for (int i = word * 32; bits != 0; i++, bits >>= 1)
+                {
+                    if ((bits & 1) != 0)
+                        rigidBodies[i].OnRigidBodyUpdate(syncPositions[i], syncRotations[i]);
+                }
+            }
+        }
+
         public CollisionBody CreateCollisionBody(Mathematics.Vector3 position, Mathematics.Quaternion rotation)
         {
             CollisionBody cb = new CollisionBody(position, rotation);
@@ -0,0 +1,124 @@
+﻿using Lava.Engine;
+using Lava.Mathematics;
+using System;
+using System.Runtime.InteropServices;
+
+namespace GpuTests
+{
+    /// <summary>
+    /// Renders a world on a real device and checks what the world recorded.
+    /// Run it from the repository root, on lavapipe with: LavaGpuTests.exe path\to\lvp_icd.x86_64.json
+    /// The exit code is the number of failed checks.
+    /// </summary>
+    static class Program
+    {
+        [StructLayout(LayoutKind.Sequential)]
+        private struct DrawStats
+        {
+            public uint draws;
+            public uint instances;
+            public uint binds;
+            public uint skippedBinds;
+            public uint indirectDraws;
+            public uint indirectCommands;
+        }
+
+        [DllImport("LavaCore.dll")]
+        private static extern DrawStats GetDrawStats_Native(IntPtr world);
+
+        [DllImport("LavaCore.dll")]
+        private static extern void SetIndirectDraw_Native(IntPtr world, bool enable);
+
+        [DllImport("LavaCore.dll")]
+        private static extern void SetLodErrorPixels_Native(IntPtr world, float pixels);
+
+        // Frames left to upload the meshes before the test gives up
+        private const int MAX_FRAMES = 120;
+        private const int ENTITIES_PER_GROUP = 3;
+
+        private static World world;
+        private static DrawStats stats;
+        private static int frame;
+        private static int failures;
+
+        private static void Check(bool condition, string what)
+        {
+            Console.WriteLine((condition ? "[     OK ] " : "[ FAILED ] ") + what);
+            if (!condition) ++failures;
+        }
+
+        /// <summary>
+        /// Two materials of the same pipeline times two meshes of the same mesh buffer, three entities each.
+        /// </summary>
+        private static void CreateIndirectWorld()
+        {
+            world = WorldManager.CreateWorld(true, false);
+            SetIndirectDraw_Native(world.NativePtr, true);
+            // Every entity keeps LOD 0, so the instance groups don't depend on the distance
+            SetLodErrorPixels_Native(world.NativePtr, -1f);
+
+            Camera.Main = new PerspectiveCamera(new Vector3(0f, 0f, 20f), Vector3.Zero);
+
+            StaticMesh[] meshes =
+            {
+                new StaticMesh(Settings.ModelsDirPath + "\\Crate1.obj"),
+                new StaticMesh(Settings.ModelsDirPath + "\\Crate1.obj")
+            };
+
+            Material[] materials = { new Material("phong"), new Material("phong") };
+            materials[0].SetUniform(0, Texture.FromColor(Color.RED));
+            materials[1].SetUniform(0, Texture.FromColor(Color.BLUE));
+
+            int index = 0;
+            foreach (var material in materials)
+            {
+                foreach (var mesh in meshes)
+                {
+                    for (int i = 0; i < ENTITIES_PER_GROUP; i++, index++)
+                    {
+                        VisualEntity visual = new VisualEntity(mesh, material);
+                        visual.Transform.Position = new Vector3(-6f + (index % 6) * 2.4f, index < 6 ? 2f : -2f, 0f);
+                        world.AddEntity(visual);
+                    }
+                }
+            }
+        }
+
+        private static void Update()
+        {
+            // The entities are drawn once their meshes are uploaded
+            stats = GetDrawStats_Native(world.NativePtr);
+            if (stats.instances == 4 * ENTITIES_PER_GROUP || ++frame >= MAX_FRAMES)
+            {
+                Application.Quit();
+            }
+        }
+
+        static int Main(string[] args)
+        {
+            if (args.Length > 0)
+            {
+                Environment.SetEnvironmentVariable("VK_ICD_FILENAMES", args[0]);
+            }
+
+            WindowParams p = new WindowParams(false, false, false, false, false, 640, 360, "LavaGpuTests");
+            Application.Init(p);
+
+            CreateIndirectWorld();
+            EventManager.UpdateEvent += Update;
+            Application.Run();
+
+            Console.WriteLine("Indirect world after " + frame + " frames: " + stats.indirectDraws + " indirect draws, "
+                + stats.indirectCommands + " commands, " + stats.instances + " instances, " + stats.draws + " direct draws");
+
+            Check(stats.instances == 4 * ENTITIES_PER_GROUP, "every entity is drawn");
+            // One command per mesh and material, the instances of a command are the entities sharing both
+            Check(stats.indirectCommands == 4, "one indirect command per mesh and material");
+            // One multi draw per material since both meshes share a mesh buffer, lavapipe has multiDrawIndirect
+            Check(stats.indirectDraws == 2, "one indirect draw per material");
+            Check(stats.draws == 0, "no direct draws in indirect mode");
+
+            return failures;
+        }
+    }
+}
@@ -27,6 +27,54 @@ namespace LavaEngine
         }
     }
 
+    [Generate]
+    public class ReactPhysics3DProject : Project
+    {
+        public string BasePath = @"[project.SharpmakeCsPath]\extern\rp3d";
+        public string Root = @"[project.SharpmakeCsPath]\..";
+
+        public ReactPhysics3DProject()
+        {
+            Name = "reactphysics3d";
+            SourceRootPath = "[project.BasePath]";
+            RootPath = "[project.Root]";
+            IsFileNameToLower = false;
+            IsTargetFileNameToLower = false;
+            AddTargets(Common.GetTargets());
+        }
+
+        // Built from the sources since the engine changes rp3d, LavaCore must not
+        // link a library compiled from other headers
+        [Configure()]
+        public void Configure(Configuration conf, Target target)
+        {
+            conf.Output = Configuration.OutputType.Lib;
+
+            conf.IncludePaths.Add(@"[project.BasePath]");
+
+            conf.TargetLibraryPath = @"[project.Root]\Temp\[project.Name]\[conf.Name]\Lib";
+            conf.IntermediatePath = @"[project.Root]\Temp\[project.Name]\[conf.Name]";
+            conf.ProjectPath = @"[project.Root]\Projects\[project.Name]";
+
+            conf.Options.Add(Options.Vc.General.WindowsTargetPlatformVersion.v10_0_16299_0);
+            conf.Options.Add(Options.Vc.Compiler.Exceptions.Enable);
+            conf.Options.Add(Options.Vc.Compiler.FloatingPointModel.Precise);
+            conf.Options.Add(Options.Vc.Compiler.CppLanguageStandard.Latest);
+            conf.Options.Add(Options.Vc.General.WarningLevel.Level3);
+
+            if (target.Optimization == Optimization.Debug)
+            {
+                conf.Options.Add(Options.Vc.Compiler.RuntimeChecks.Both);
+                conf.Options.Add(Options.Vc.Compiler.RuntimeLibrary.MultiThreadedDebugDLL);
+            }
+            else
+            {
+                conf.Options.Add(Options.Vc.Compiler.RuntimeLibrary.MultiThreadedDLL);
+                conf.Options.Add(Options.Vc.General.WholeProgramOptimization.LinkTime);
+            }
+        }
+    }
+
     [Generate]
     public class LavaCoreProject : Project
     {
@@ -65,10 +113,7 @@ namespace LavaEngine
             
             conf.ProjectPath = @"[project.Root]\Projects\[project.Name]";
 
-            if (target.Optimization == Optimization.Debug)
-                conf.LibraryFiles.Add("reactphysics3d_d");
-            else
-                conf.LibraryFiles.Add("reactphysics3d");
+            conf.AddPrivateDependency<ReactPhysics3DProject>(target);
 
             conf.LibraryFiles.Add("vulkan-1");
             conf.LibraryFiles.Add("glfw3");
@@ -190,6 +235,145 @@ namespace LavaEngine
         }
     }
 
+    // Renders worlds on a real device and checks what they recorded, LavaGpuTests.exe [ICD json]
+    // runs it on the driver of the given ICD, e.g. lavapipe
+    [Generate]
+    public class LavaGpuTestsProject : CSharpProject
+    {
+        public string BasePath = @"[project.SharpmakeCsPath]\GpuTests";
+        public string Root = @"[project.SharpmakeCsPath]\..";
+
+        public LavaGpuTestsProject()
+        {
+            Name = "LavaGpuTests";
+            RootPath = "[project.Root]";
+            SourceRootPath = "[project.BasePath]";
+            IsFileNameToLower = false;
+            IsTargetFileNameToLower = false;
+            DependenciesCopyLocal = DependenciesCopyLocalTypes.None;
+            AddTargets(Common.GetTargets());
+        }
+
+        [Configure()]
+        public void Configure(Configuration conf, Target target)
+        {
+            conf.Output = Configuration.OutputType.DotNetConsoleApp;
+            conf.ProjectPath = @"[project.Root]\Projects\[project.Name]";
+            conf.IntermediatePath = @"[project.Root]\Temp\[project.Name]\[conf.Name]";
+
+            if (target.Optimization == Optimization.Debug)
+                conf.TargetPath = @"[project.Root]" + Common.BinDebugPath;
+            else
+                conf.TargetPath = @"[project.Root]" + Common.BinPath;
+
+            conf.ReferencesByName.AddRange(new Strings("System",
+                                                        "System.Core"));
+
+            conf.ReferencesByPath.Add(conf.TargetPath + @"\LavaEngine.dll");
+            conf.AddPrivateDependency<LavaEngineProject>(target, DependencySetting.OnlyBuildOrder);
+        }
+    }
+
+    // Console programs built from the CPU-only core sources, they don't need a device or a window.
+    // The core sources they use are added to SourceFiles by the derived projects
+    public abstract class CoreConsoleProject : Project
+    {
+        public string BasePath;
+        public string CorePath = @"[project.SharpmakeCsPath]\Core";
+        public string Root = @"[project.SharpmakeCsPath]\..";
+
+        protected CoreConsoleProject(string name, string folder)
+        {
+            Name = name;
+            BasePath = @"[project.SharpmakeCsPath]\" + folder;
+            SourceRootPath = "[project.BasePath]";
+            RootPath = "[project.Root]";
+            IsFileNameToLower = false;
+            IsTargetFileNameToLower = false;
+            AddTargets(Common.GetTargets());
+
+            SourceFiles.Add(@"[project.CorePath]\Common\format.cc");
+            SourceFiles.Add(@"[project.CorePath]\Engine\TaskScheduler.cpp");
+        }
+
+        [Configure()]
+        public void Configure(Configuration conf, Target target)
+        {
+            conf.Output = Configuration.OutputType.Exe;
+
+            conf.IncludePaths.Add(@"[project.SharpmakeCsPath]\extern");
+            conf.IncludePaths.Add(@"$(VULKAN_SDK)\Include");
+            conf.IncludePaths.Add(@"[project.CorePath]");
+
+            // The physics world needs rp3d, and glfw for the clock of Time.cpp
+            conf.LibraryPaths.Add(@"[project.Root]\Dependencies");
+            conf.AddPrivateDependency<ReactPhysics3DProject>(target);
+            conf.LibraryFiles.Add("glfw3");
+
+            if (target.Optimization == Optimization.Debug)
+                conf.TargetPath = @"[project.Root]" + Common.BinDebugPath;
+            else
+                conf.TargetPath = @"[project.Root]" + Common.BinPath;
+
+            conf.IntermediatePath = @"[project.Root]\Temp\[project.Name]\[conf.Name]";
+            conf.ProjectPath = @"[project.Root]\Projects\[project.Name]";
+
+            conf.Defines.Add("_CRT_SECURE_NO_WARNINGS");
+            conf.Defines.Add("LAVA_EXPORTS");
+
+            conf.Options.Add(Options.Vc.General.WindowsTargetPlatformVersion.v10_0_16299_0);
+            conf.Options.Add(Options.Vc.Compiler.Exceptions.Enable);
+            conf.Options.Add(Options.Vc.Compiler.FloatingPointModel.Precise);
+            conf.Options.Add(Options.Vc.Compiler.CppLanguageStandard.Latest);
+            conf.Options.Add(Options.Vc.General.WarningLevel.Level3);
+
+            if (target.Optimization == Optimization.Debug)
+            {
+                conf.Options.Add(Options.Vc.Compiler.RuntimeChecks.Both);
+                conf.Options.Add(Options.Vc.Compiler.RuntimeLibrary.MultiThreadedDebugDLL);
+            }
+            else
+            {
+                conf.Options.Add(Options.Vc.Compiler.RuntimeLibrary.MultiThreadedDLL);
+                conf.Options.Add(Options.Vc.General.WholeProgramOptimization.LinkTime);
+            }
+        }
+    }
+
+    // Unit tests, LavaTests.exe [filter] returns non-zero when a test fails
+    [Generate]
+    public class LavaTestsProject : CoreConsoleProject
+    {
+        public LavaTestsProject() : base("LavaTests", "Tests")
+        {
+            SourceFiles.Add(@"[project.CorePath]\Common\AllocationCounter.cpp");
+            SourceFiles.Add(@"[project.CorePath]\Common\MeshOptimizer.cpp");
+            SourceFiles.Add(@"[project.CorePath]\Common\MeshSimplifier.cpp");
+            SourceFiles.Add(@"[project.CorePath]\Common\MipGenerator.cpp");
+            SourceFiles.Add(@"[project.CorePath]\Common\TextureResidency.cpp");
+            SourceFiles.Add(@"[project.CorePath]\Common\VertexPacking.cpp");
+            SourceFiles.Add(@"[project.CorePath]\Engine\PhysicsWorld.cpp");
+            SourceFiles.Add(@"[project.CorePath]\Engine\TextureFile.cpp");
+            SourceFiles.Add(@"[project.CorePath]\Engine\Time.cpp");
+        }
+    }
+
+    // Benchmarks, LavaBenchmarks.exe [filter] prints the results of each benchmark
+    [Generate]
+    public class LavaBenchmarksProject : CoreConsoleProject
+    {
+        public LavaBenchmarksProject() : base("LavaBenchmarks", "Benchmarks")
+        {
+            SourceFiles.Add(@"[project.CorePath]\Common\MappedFile.cpp");
+            SourceFiles.Add(@"[project.CorePath]\Common\MeshOptimizer.cpp");
+            SourceFiles.Add(@"[project.CorePath]\Common\MeshSimplifier.cpp");
+            SourceFiles.Add(@"[project.CorePath]\Common\MipGenerator.cpp");
+            SourceFiles.Add(@"[project.CorePath]\Engine\MeshFile.cpp");
+            SourceFiles.Add(@"[project.CorePath]\Engine\PhysicsWorld.cpp");
+            SourceFiles.Add(@"[project.CorePath]\Engine\Time.cpp");
+        }
+    }
+
     [Generate]
     public class LavaEngineSolution : Solution
     {
@@ -207,6 +391,9 @@ namespace LavaEngine
         {
             conf.SolutionPath = @"[solution.Root]\Projects";
             conf.AddProject<DemoProject>(target);
+            conf.AddProject<LavaTestsProject>(target);
+            conf.AddProject<LavaBenchmarksProject>(target);
+            conf.AddProject<LavaGpuTestsProject>(target);
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,154 @@
+#include "Test.h"
+#include <Common\ConcurrentMemoryPool.h>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <set>
+#include <thread>
+
+using namespace Engine;
+
+namespace
+{
+    struct Tracked
+    {
+        uint64_t owner;
+        uint64_t magic;
+        char pad[48];
+
+        explicit Tracked(uint64_t o) : owner(o), magic(Expected(o)) { }
+        ~Tracked() { magic = 0; }
+
+        static uint64_t Expected(uint64_t o) { return o ^ 0xABCD1234ABCD1234ull; }
+        bool IsIntact() const { return magic == Expected(owner); }
+    };
+
+    struct Small
+    {
+        uint32_t value;
+    };
+}
+
+TEST(ConcurrentMemoryPool, StressAcrossThreads)
+{
+    // Every thread allocates, frees its own objects and the ones handed over by the others
+    const uint32_t THREAD_COUNT = 12;
+    const uint32_t OPERATIONS = 40000;
+
+    ConcurrentMemoryPool<Tracked> pool;
+    std::mutex handoffMutex;
+    std::vector<Tracked*> handoff;
+    std::atomic<uint32_t> corrupted{ 0 };
+    std::vector<std::vector<Tracked*>> kept(THREAD_COUNT);
+
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < THREAD_COUNT; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            std::mt19937 rng(t);
+            std::vector<Tracked*>& mine = kept[t];
+            for (uint32_t i = 0; i < OPERATIONS; i++)
+            {
+                const uint32_t op = rng() % 4;
+                if (op < 2)
+                {
+                    mine.push_back(pool.newElement(uint64_t(t) << 32 | i));
+                }
+                else if (op == 2 && !mine.empty())
+                {
+                    const size_t k = rng() % mine.size();
+                    Tracked* p = mine[k];
+                    mine[k] = mine.back();
+                    mine.pop_back();
+                    corrupted += !p->IsIntact();
+
+                    std::lock_guard<std::mutex> lock(handoffMutex);
+                    handoff.push_back(p);
+                }
+                else
+                {
+                    Tracked* p = nullptr;
+                    {
+                        std::lock_guard<std::mutex> lock(handoffMutex);
+                        if (!handoff.empty())
+                        {
+                            p = handoff.back();
+                            handoff.pop_back();
+                        }
+                    }
+                    if (p)
+                    {
+                        corrupted += !p->IsIntact();
+                        pool.deleteElement(p);
+                    }
+                }
+            }
+            // Half of the objects outlive the thread that created them
+            for (size_t k = mine.size() / 2; k < mine.size(); k++)
+            {
+                corrupted += !mine[k]->IsIntact();
+                pool.deleteElement(mine[k]);
+            }
+            mine.resize(mine.size() / 2);
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    CHECK_EQ(corrupted.load(), 0u);
+
+    // No slot was handed out twice
+    std::set<Tracked*> live(handoff.begin(), handoff.end());
+    size_t liveCount = handoff.size();
+    for (const auto& mine : kept)
+    {
+        for (Tracked* p : mine)
+        {
+            CHECK(p->IsIntact());
+            live.insert(p);
+        }
+        liveCount += mine.size();
+    }
+    CHECK_EQ(live.size(), liveCount);
+
+    // New objects don't overlap the live ones, they reuse the slots freed by the threads that exited
+    for (uint32_t i = 0; i < 20000; i++)
+    {
+        CHECK(live.insert(pool.newElement(i)).second);
+    }
+    for (Tracked* p : live)
+    {
+        CHECK(p->IsIntact());
+        pool.deleteElement(p);
+    }
+}
+
+TEST(ConcurrentMemoryPool, ExitedThreadGivesSlotsBack)
+{
+    ConcurrentMemoryPool<Small> pool;
+    std::set<Small*> used;
+    std::thread([&]()
+    {
+        std::vector<Small*> objects;
+        for (uint32_t i = 0; i < 1000; i++)
+        {
+            objects.push_back(pool.newElement(Small{ i }));
+        }
+        for (Small* p : objects)
+        {
+            used.insert(p);
+            pool.deleteElement(p);
+        }
+    }).join();
+
+    // The exited thread gave back the 1000 slots and the rest of its last block, fewer than 200
+    // slots. They are all taken before the main thread carves a block of its own
+    uint32_t reused = 0;
+    for (uint32_t i = 0; i < 1200; i++)
+    {
+        reused += used.count(pool.allocate()) != 0;
+    }
+    CHECK_EQ(reused, 1000u);
+}
@@ -0,0 +1,178 @@
+#include "Test.h"
+#include <Common\FreeListAllocator.h>
+#include <random>
+
+using Engine::FreeListAllocator;
+
+TEST(FreeListAllocator, MergesNeighbours)
+{
+    FreeListAllocator allocator;
+    allocator.Init(400);
+
+    uint64_t a = allocator.Allocate(100);
+    uint64_t b = allocator.Allocate(100);
+    uint64_t c = allocator.Allocate(100);
+    uint64_t d = allocator.Allocate(100);
+    CHECK(a == 0 && b == 100 && c == 200 && d == 300);
+    CHECK_EQ(allocator.GetFreeSize(), 0u);
+    CHECK_EQ(allocator.GetFreeRangeCount(), 0u);
+    CHECK_EQ(allocator.Allocate(1), FreeListAllocator::INVALID_OFFSET);
+
+    // Not adjacent, two ranges
+    allocator.Free(a, 100);
+    allocator.Free(c, 100);
+    CHECK_EQ(allocator.GetFreeRangeCount(), 2u);
+    CHECK_EQ(allocator.GetLargestFreeRange(), 100u);
+
+    // Merges with the range before and the one after at once
+    allocator.Free(b, 100);
+    CHECK_EQ(allocator.GetFreeRangeCount(), 1u);
+    CHECK_EQ(allocator.GetLargestFreeRange(), 300u);
+
+    // Merges with the range before only
+    allocator.Free(d, 100);
+    CHECK_EQ(allocator.GetFreeRangeCount(), 1u);
+    CHECK_EQ(allocator.GetFreeSize(), 400u);
+    CHECK_EQ(allocator.GetLargestFreeRange(), 400u);
+
+    // Merges with the range after only
+    a = allocator.Allocate(150);
+    b = allocator.Allocate(250);
+    allocator.Free(b, 250);
+    allocator.Free(a, 150);
+    CHECK_EQ(allocator.GetFreeRangeCount(), 1u);
+    CHECK_EQ(allocator.GetLargestFreeRange(), 400u);
+}
+
+TEST(FreeListAllocator, FirstFit)
+{
+    FreeListAllocator allocator;
+    allocator.Init(1000);
+
+    uint64_t a = allocator.Allocate(100);
+    allocator.Allocate(100);
+    uint64_t c = allocator.Allocate(300);
+    allocator.Allocate(100);
+    allocator.Free(a, 100);
+    allocator.Free(c, 300);
+
+    // The first range big enough is used, even if a later one fits better
+    CHECK_EQ(allocator.Allocate(50), 0u);
+    CHECK_EQ(allocator.Allocate(200), 200u);
+    CHECK_EQ(allocator.Allocate(60), 400u);
+    CHECK_EQ(allocator.Allocate(40), 50u);
+    // Left free: [90, 100), [460, 500) and [600, 1000)
+    CHECK_EQ(allocator.Allocate(50), 600u);
+    CHECK_EQ(allocator.Allocate(40), 460u);
+    CHECK_EQ(allocator.Allocate(351), FreeListAllocator::INVALID_OFFSET);
+    CHECK_EQ(allocator.Allocate(0), FreeListAllocator::INVALID_OFFSET);
+}
+
+TEST(FreeListAllocator, Alignment)
+{
+    FreeListAllocator allocator;
+    allocator.Init(1024);
+
+    CHECK_EQ(allocator.Allocate(3), 0u);
+    // Power of two alignment, the padding [3, 16) stays free
+    CHECK_EQ(allocator.Allocate(16, 16), 16u);
+    CHECK_EQ(allocator.GetFreeSize(), 1024u - 19u);
+    // The padding is reused by a smaller allocation
+    CHECK_EQ(allocator.Allocate(13), 3u);
+
+    // Vertex strides are not powers of two
+    uint64_t v = allocator.Allocate(36 * 3, 36);
+    CHECK_EQ(v, 36u);
+    CHECK_EQ(allocator.Allocate(10, 12), 144u);
+    uint64_t w = allocator.Allocate(44, 44);
+    CHECK_EQ(w % 44, 0u);
+    CHECK(w >= 154u);
+
+    CHECK_EQ(allocator.Allocate(8, 0), FreeListAllocator::INVALID_OFFSET);
+
+    // An alignment larger than every free offset allows fails
+    CHECK_EQ(allocator.Allocate(1, 2048), FreeListAllocator::INVALID_OFFSET);
+}
+
+// Random allocations and frees checked against a map of the owner of every byte
+TEST(FreeListAllocator, RandomAgainstByteMap)
+{
+    constexpr uint64_t SIZE = 1 << 16;
+    struct Allocation
+    {
+        uint64_t offset;
+        uint64_t size;
+        uint32_t id;
+    };
+
+    std::mt19937 rng(9);
+    std::uniform_int_distribution<uint32_t> sizeDist(1, 700);
+    const uint64_t alignments[] = { 1, 4, 16, 256, 12, 24, 36, 44 };
+
+    FreeListAllocator allocator;
+    allocator.Init(SIZE);
+    std::vector<uint32_t> owner(SIZE, 0);
+    std::vector<Allocation> live;
+    uint64_t used = 0;
+    uint32_t nextId = 1;
+
+    for (int step = 0; step < 50000; step++)
+    {
+        // Mostly allocate until the block is about full, then mostly free
+        bool allocate = live.empty() || rng() % 100 < (used < SIZE * 3 / 4 ? 65u : 35u);
+        if (allocate)
+        {
+            uint64_t size = sizeDist(rng);
+            uint64_t alignment = alignments[rng() % 8];
+            uint64_t offset = allocator.Allocate(size, alignment);
+            if (offset == FreeListAllocator::INVALID_OFFSET)
+            {
+                // Only fails when no free range can hold the aligned size
+                CHECK(allocator.GetLargestFreeRange() < size + alignment - 1);
+                continue;
+            }
+
+            REQUIRE(offset + size <= SIZE);
+            REQUIRE(offset % alignment == 0);
+            for (uint64_t i = offset; i < offset + size; i++)
+            {
+                REQUIRE(owner[i] == 0);
+                owner[i] = nextId;
+            }
+            live.push_back({ offset, size, nextId++ });
+            used += size;
+        }
+        else
+        {
+            size_t index = rng() % live.size();
+            Allocation a = live[index];
+            live[index] = live.back();
+            live.pop_back();
+
+            for (uint64_t i = a.offset; i < a.offset + a.size; i++)
+            {
+                REQUIRE(owner[i] == a.id);
+                owner[i] = 0;
+            }
+            allocator.Free(a.offset, a.size);
+            used -= a.size;
+        }
+
+        REQUIRE(allocator.GetFreeSize() == SIZE - used);
+    }
+
+    // Free ranges never touch, so their count is the number of free runs in the map
+    uint32_t runs = 0;
+    for (uint64_t i = 0; i < SIZE; i++)
+    {
+        if (owner[i] == 0 && (i == 0 || owner[i - 1] != 0))
+            ++runs;
+    }
+    CHECK_EQ(allocator.GetFreeRangeCount(), runs);
+
+    for (const auto& a : live)
+        allocator.Free(a.offset, a.size);
+    CHECK_EQ(allocator.GetFreeSize(), SIZE);
+    CHECK_EQ(allocator.GetFreeRangeCount(), 1u);
+    CHECK_EQ(allocator.GetLargestFreeRange(), SIZE);
+}
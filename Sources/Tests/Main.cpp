@@ -0,0 +1,60 @@
+#include "Test.h"
+#include <Engine\TaskScheduler.h>
+#include <exception>
+#include <string>
+
+namespace Test
+{
+    static bool s_Failed;
+
+    std::vector<TestCase>& GetTests()
+    {
+        static std::vector<TestCase> tests;
+        return tests;
+    }
+
+    void ReportFailure(const char* file, int line, const char* expr)
+    {
+        printf("%s(%d): CHECK(%s) failed\n", file, line, expr);
+        s_Failed = true;
+    }
+}
+
+// Usage: LavaTests [filter], runs the tests whose "Suite.Name" contains the filter
+int main(int argc, char** argv)
+{
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+
+    // Some of the tested code schedules work on the engine task scheduler
+    GTaskScheduler.Init();
+
+    int run = 0;
+    int failed = 0;
+    for (const auto& test : Test::GetTests())
+    {
+        std::string name = std::string(test.suite) + "." + test.name;
+        if (filter && name.find(filter) == std::string::npos)
+            continue;
+
+        printf("[ RUN    ] %s\n", name.c_str());
+        Test::s_Failed = false;
+        try
+        {
+            test.func();
+        }
+        catch (const std::exception& e)
+        {
+            printf("Unexpected exception: %s\n", e.what());
+            Test::s_Failed = true;
+        }
+
+        printf("%s %s\n", Test::s_Failed ? "[ FAILED ]" : "[     OK ]", name.c_str());
+        ++run;
+        failed += Test::s_Failed ? 1 : 0;
+    }
+
+    GTaskScheduler.Destroy();
+
+    printf("%d tests run, %d failed\n", run, failed);
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,205 @@
+#include "Test.h"
+#include <Common\MeshOptimizer.h>
+#include <algorithm>
+#include <array>
+#include <random>
+
+using namespace Engine;
+
+namespace
+{
+    struct Position
+    {
+        float x, y, z;
+    };
+
+    // Triangle list of a size x size quad grid, row by row
+    std::vector<uint32_t> CreateGrid(uint32_t size)
+    {
+        std::vector<uint32_t> indices;
+        for (uint32_t z = 0; z < size; z++)
+        {
+            for (uint32_t x = 0; x < size; x++)
+            {
+                uint32_t i = z * (size + 1) + x;
+                indices.insert(indices.end(), { i, i + size + 1, i + 1, i + 1, i + size + 1, i + size + 2 });
+            }
+        }
+        return indices;
+    }
+
+    std::vector<uint32_t> ShuffleTriangles(const std::vector<uint32_t>& indices, uint32_t seed)
+    {
+        std::vector<uint32_t> order(indices.size() / 3);
+        for (uint32_t i = 0; i < order.size(); i++) order[i] = i;
+        std::shuffle(order.begin(), order.end(), std::mt19937(seed));
+
+        std::vector<uint32_t> shuffled;
+        for (uint32_t t : order)
+        {
+            shuffled.insert(shuffled.end(), { indices[t * 3], indices[t * 3 + 1], indices[t * 3 + 2] });
+        }
+        return shuffled;
+    }
+
+    // Triangles rotated to start with their smallest index, which keeps the winding, and sorted
+    std::vector<std::array<uint32_t, 3>> GetTriangleSet(const std::vector<uint32_t>& indices)
+    {
+        std::vector<std::array<uint32_t, 3>> triangles;
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            std::array<uint32_t, 3> t = { indices[i], indices[i + 1], indices[i + 2] };
+            std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+            triangles.push_back(t);
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+}
+
+TEST(MeshOptimizer, AnalyzeStrip)
+{
+    // Every triangle after the first one brings one new vertex
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        indices.insert(indices.end(), { i, i + 1, i + 2 });
+    }
+
+    VertexCacheStats stats = AnalyzeVertexCache(indices, 102);
+    CHECK_NEAR(stats.acmr, 102.f / 100.f, 1e-6f);
+    CHECK_NEAR(stats.atvr, 1.f, 1e-6f);
+}
+
+TEST(MeshOptimizer, AnalyzeWorstCase)
+{
+    // Twice the same 40 unconnected triangles, the first use of a vertex left the 16 entries long ago
+    std::vector<uint32_t> indices;
+    for (uint32_t pass = 0; pass < 2; pass++)
+    {
+        for (uint32_t i = 0; i < 120; i++) indices.push_back(i);
+    }
+
+    VertexCacheStats stats = AnalyzeVertexCache(indices, 120, 16);
+    CHECK_NEAR(stats.acmr, 3.f, 1e-6f);
+    CHECK_NEAR(stats.atvr, 2.f, 1e-6f);
+
+    // A cache holding every vertex only misses the first pass
+    stats = AnalyzeVertexCache(indices, 120, 128);
+    CHECK_NEAR(stats.acmr, 1.5f, 1e-6f);
+    CHECK_NEAR(stats.atvr, 1.f, 1e-6f);
+
+    stats = AnalyzeVertexCache({}, 0);
+    CHECK_EQ(stats.acmr, 0.f);
+    CHECK_EQ(stats.atvr, 0.f);
+}
+
+TEST(MeshOptimizer, WeldDuplicates)
+{
+    // Two triangles of a quad with the shared edge duplicated, and a copy of the first vertex
+    std::vector<Position> vertices = {
+        { 0, 0, 0 }, { 0, 0, 1 }, { 1, 0, 0 },
+        { 1, 0, 0 }, { 0, 0, 1 }, { 1, 0, 1 },
+        { 0, 0, 0 },
+    };
+    std::vector<uint32_t> indices = { 0, 1, 2, 3, 4, 5, 6, 2, 5 };
+
+    CHECK_EQ(WeldVertices(vertices, indices), 3u);
+    std::vector<uint32_t> expected = { 0, 1, 2, 2, 1, 5, 0, 2, 5 };
+    CHECK(indices == expected);
+    // The duplicates are left for OptimizeVertexFetch
+    CHECK_EQ(vertices.size(), 7u);
+
+    // Nothing to weld once the duplicates are dropped
+    OptimizeVertexFetch(vertices, indices);
+    CHECK_EQ(vertices.size(), 4u);
+    std::vector<uint32_t> unchanged = indices;
+    CHECK_EQ(WeldVertices(vertices, unchanged), 0u);
+    CHECK(unchanged == indices);
+}
+
+TEST(MeshOptimizer, VertexCacheKeepsTriangles)
+{
+    std::vector<uint32_t> grid = CreateGrid(32);
+    std::vector<uint32_t> indices = ShuffleTriangles(grid, 7);
+    const uint32_t vertexCount = 33 * 33;
+
+    std::vector<uint32_t> optimized = indices;
+    OptimizeVertexCache(optimized, vertexCount);
+    REQUIRE(optimized.size() == indices.size());
+    CHECK(GetTriangleSet(optimized) == GetTriangleSet(indices));
+}
+
+TEST(MeshOptimizer, VertexCacheLowersShuffledGridAcmr)
+{
+    std::vector<uint32_t> indices = ShuffleTriangles(CreateGrid(64), 11);
+    const uint32_t vertexCount = 65 * 65;
+
+    VertexCacheStats before = AnalyzeVertexCache(indices, vertexCount);
+    OptimizeVertexCache(indices, vertexCount);
+    VertexCacheStats after = AnalyzeVertexCache(indices, vertexCount);
+
+    // A shuffled grid misses about every vertex, a grid can't do better than 0.5
+    CHECK(before.acmr > 2.5f);
+    CHECK(after.acmr < 0.8f);
+    CHECK(after.acmr >= 0.5f);
+    CHECK(after.atvr < before.atvr);
+}
+
+TEST(MeshOptimizer, VertexCacheIsDeterministic)
+{
+    std::vector<uint32_t> indices = ShuffleTriangles(CreateGrid(48), 3);
+    std::vector<uint32_t> first = indices, second = indices;
+    OptimizeVertexCache(first, 49 * 49);
+    OptimizeVertexCache(second, 49 * 49);
+    CHECK(first == second);
+
+    // Optimizing an optimized list doesn't make it worse
+    std::vector<uint32_t> third = first;
+    OptimizeVertexCache(third, 49 * 49);
+    CHECK(AnalyzeVertexCache(third, 49 * 49).acmr <= AnalyzeVertexCache(first, 49 * 49).acmr + 1e-6f);
+}
+
+TEST(MeshOptimizer, VertexFetchDropsUnusedVertices)
+{
+    std::vector<Position> vertices(10);
+    for (uint32_t i = 0; i < vertices.size(); i++)
+    {
+        vertices[i] = { float(i), 0.f, 0.f };
+    }
+    // Vertices 0, 3 and 9 are never used
+    std::vector<uint32_t> indices = { 8, 2, 5, 5, 2, 1, 4, 6, 7 };
+    std::vector<Position> original = vertices;
+    std::vector<uint32_t> originalIndices = indices;
+
+    OptimizeVertexFetch(vertices, indices);
+    REQUIRE(vertices.size() == 7u);
+
+    // The vertices are in the order of their first use and the triangles are unchanged
+    std::vector<uint32_t> expected = { 0, 1, 2, 2, 1, 3, 4, 5, 6 };
+    CHECK(indices == expected);
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+        CHECK_EQ(vertices[indices[i]].x, original[originalIndices[i]].x);
+    }
+}
+
+TEST(MeshOptimizer, OptimizeMeshRemovesWeldedVertices)
+{
+    // The grid as a triangle soup, 6 vertices per quad
+    std::vector<uint32_t> grid = CreateGrid(16);
+    std::vector<Position> vertices;
+    std::vector<uint32_t> indices;
+    for (uint32_t index : grid)
+    {
+        indices.push_back(static_cast<uint32_t>(vertices.size()));
+        vertices.push_back({ float(index % 17), 0.f, float(index / 17) });
+    }
+
+    MeshOptimizeStats stats = OptimizeMesh(vertices, indices);
+    CHECK_EQ(vertices.size(), 17u * 17u);
+    CHECK_EQ(stats.removedVertices, 16u * 16u * 6u - 17u * 17u);
+    CHECK_EQ(stats.weldedVertices, stats.removedVertices);
+    CHECK_NEAR(stats.before.acmr, 3.f, 1e-6f);
+    CHECK(stats.after.acmr < 1.f);
+}
@@ -0,0 +1,303 @@
+#include "Test.h"
+#include <Common\MeshSimplifier.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <set>
+
+using namespace Engine;
+
+namespace
+{
+    struct Position
+    {
+        float x, y, z;
+    };
+
+    struct Mesh
+    {
+        std::vector<Position> positions;
+        std::vector<uint32_t> indices;
+    };
+
+    // Closed UV sphere of radius 1, the seam and the poles share their vertices
+    Mesh CreateSphere(uint32_t rings, uint32_t segments)
+    {
+        const float PI = 3.14159265f;
+        Mesh mesh;
+        mesh.positions.push_back({ 0.f, 1.f, 0.f });
+        for (uint32_t r = 1; r < rings; r++)
+        {
+            float theta = PI * r / rings;
+            for (uint32_t s = 0; s < segments; s++)
+            {
+                float phi = 2.f * PI * s / segments;
+                mesh.positions.push_back({ std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) });
+            }
+        }
+        mesh.positions.push_back({ 0.f, -1.f, 0.f });
+        const uint32_t bottom = static_cast<uint32_t>(mesh.positions.size() - 1);
+
+        auto ring = [segments](uint32_t r, uint32_t s) { return 1 + (r - 1) * segments + s % segments; };
+        for (uint32_t s = 0; s < segments; s++)
+        {
+            mesh.indices.insert(mesh.indices.end(), { 0, ring(1, s + 1), ring(1, s) });
+            mesh.indices.insert(mesh.indices.end(), { bottom, ring(rings - 1, s), ring(rings - 1, s + 1) });
+        }
+        for (uint32_t r = 1; r + 1 < rings; r++)
+        {
+            for (uint32_t s = 0; s < segments; s++)
+            {
+                mesh.indices.insert(mesh.indices.end(), { ring(r, s), ring(r, s + 1), ring(r + 1, s) });
+                mesh.indices.insert(mesh.indices.end(), { ring(r, s + 1), ring(r + 1, s + 1), ring(r + 1, s) });
+            }
+        }
+        return mesh;
+    }
+
+    // Open heightfield of size x size quads over [0, size], the border is the edge of the grid.
+    // With 'seam' the column at size / 2 is split in two vertices like a UV seam
+    Mesh CreateTerrain(uint32_t size, float amplitude, bool seam)
+    {
+        Mesh mesh;
+        const uint32_t side = size + 1;
+        for (uint32_t z = 0; z < side; z++)
+        {
+            for (uint32_t x = 0; x < side; x++)
+            {
+                float height = amplitude * std::sin(x * 0.15f) * std::cos(z * 0.11f);
+                mesh.positions.push_back({ float(x), height, float(z) });
+            }
+        }
+
+        // Copies of the seam column, used by the quads on its right
+        std::vector<uint32_t> seamCopy(side);
+        for (uint32_t z = 0; z < side && seam; z++)
+        {
+            seamCopy[z] = static_cast<uint32_t>(mesh.positions.size());
+            mesh.positions.push_back(mesh.positions[z * side + size / 2]);
+        }
+
+        for (uint32_t z = 0; z < size; z++)
+        {
+            for (uint32_t x = 0; x < size; x++)
+            {
+                uint32_t i00 = z * side + x, i10 = i00 + 1, i01 = i00 + side, i11 = i01 + 1;
+                if (seam && x == size / 2)
+                {
+                    i00 = seamCopy[z];
+                    i01 = seamCopy[z + 1];
+                }
+                mesh.indices.insert(mesh.indices.end(), { i00, i01, i10, i10, i01, i11 });
+            }
+        }
+        return mesh;
+    }
+
+    float Dot(const Position& a, const Position& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    Position Sub(const Position& a, const Position& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+
+    // Distance from 'p' to the triangle abc
+    float DistanceToTriangle(const Position& p, const Position& a, const Position& b, const Position& c)
+    {
+        // Ericson, Real-Time Collision Detection 5.1.5
+        Position ab = Sub(b, a), ac = Sub(c, a), ap = Sub(p, a);
+        float d1 = Dot(ab, ap), d2 = Dot(ac, ap);
+        Position closest;
+        auto along = [&a](const Position& d, float t) { return Position{ a.x + d.x * t, a.y + d.y * t, a.z + d.z * t }; };
+        if (d1 <= 0.f && d2 <= 0.f) closest = a;
+        else
+        {
+            Position bp = Sub(p, b);
+            float d3 = Dot(ab, bp), d4 = Dot(ac, bp);
+            Position cp = Sub(p, c);
+            float d5 = Dot(ab, cp), d6 = Dot(ac, cp);
+            float vc = d1 * d4 - d3 * d2, vb = d5 * d2 - d1 * d6, va = d3 * d6 - d5 * d4;
+            if (d3 >= 0.f && d4 <= d3) closest = b;
+            else if (d6 >= 0.f && d5 <= d6) closest = c;
+            else if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f) closest = along(ab, d1 / (d1 - d3));
+            else if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f) closest = along(ac, d2 / (d2 - d6));
+            else if (va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f)
+            {
+                Position bc = Sub(c, b);
+                float t = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+                closest = { b.x + bc.x * t, b.y + bc.y * t, b.z + bc.z * t };
+            }
+            else
+            {
+                float denom = 1.f / (va + vb + vc);
+                float v = vb * denom, w = vc * denom;
+                closest = { a.x + ab.x * v + ac.x * w, a.y + ab.y * v + ac.y * w, a.z + ab.z * v + ac.z * w };
+            }
+        }
+        Position d = Sub(p, closest);
+        return std::sqrt(Dot(d, d));
+    }
+
+    // Largest distance from a vertex of the original mesh to the simplified surface
+    float MeasureError(const Mesh& mesh, const std::vector<uint32_t>& simplified)
+    {
+        std::set<uint32_t> used(mesh.indices.begin(), mesh.indices.end());
+        float error = 0.f;
+        for (uint32_t v : used)
+        {
+            float distance = 1e30f;
+            for (size_t i = 0; i < simplified.size(); i += 3)
+            {
+                distance = std::min(distance, DistanceToTriangle(mesh.positions[v], mesh.positions[simplified[i]],
+                    mesh.positions[simplified[i + 1]], mesh.positions[simplified[i + 2]]));
+            }
+            error = std::max(error, distance);
+        }
+        return error;
+    }
+
+    std::vector<uint32_t> Simplify(const Mesh& mesh, size_t targetIndexCount, float maxError, float& error)
+    {
+        return SimplifyMesh(&mesh.positions[0].x, sizeof(Position), mesh.positions.size(), mesh.indices,
+            targetIndexCount, maxError, error);
+    }
+
+    bool IsValidTriangleList(const std::vector<uint32_t>& indices, size_t vertexCount)
+    {
+        if (indices.size() % 3 != 0) return false;
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            if (indices[i] >= vertexCount || indices[i + 1] >= vertexCount || indices[i + 2] >= vertexCount ||
+                indices[i] == indices[i + 1] || indices[i + 1] == indices[i + 2] || indices[i] == indices[i + 2])
+                return false;
+        }
+        return true;
+    }
+}
+
+TEST(MeshSimplifier, SphereErrorBound)
+{
+    Mesh sphere = CreateSphere(24, 48);
+    const float maxError = 0.02f;
+
+    float error;
+    std::vector<uint32_t> simplified = Simplify(sphere, sphere.indices.size() / 4, maxError, error);
+    REQUIRE(IsValidTriangleList(simplified, sphere.positions.size()));
+    CHECK(simplified.size() < sphere.indices.size());
+    CHECK(error <= maxError);
+
+    // The estimate is a mean over the planes of the collapsed triangles, the real distance of
+    // the original surface to the simplified one stays within twice the allowed error
+    CHECK(MeasureError(sphere, simplified) <= 2.f * maxError);
+}
+
+TEST(MeshSimplifier, TerrainErrorBound)
+{
+    Mesh terrain = CreateTerrain(48, 2.f, false);
+    const float maxError = 0.05f;
+
+    float error;
+    std::vector<uint32_t> simplified = Simplify(terrain, terrain.indices.size() / 4, maxError, error);
+    REQUIRE(IsValidTriangleList(simplified, terrain.positions.size()));
+    CHECK(simplified.size() < terrain.indices.size() / 2);
+    CHECK(error <= maxError);
+    CHECK(MeasureError(terrain, simplified) <= 2.f * maxError);
+
+    // A flat terrain collapses without any error
+    Mesh flat = CreateTerrain(32, 0.f, false);
+    simplified = Simplify(flat, 0, 0.f, error);
+    CHECK(simplified.size() < flat.indices.size() / 4);
+    CHECK_EQ(error, 0.f);
+    CHECK(MeasureError(flat, simplified) <= 1e-5f);
+}
+
+TEST(MeshSimplifier, ZeroErrorKeepsCurvedMesh)
+{
+    Mesh sphere = CreateSphere(12, 24);
+    float error;
+    std::vector<uint32_t> simplified = Simplify(sphere, 0, 0.f, error);
+    CHECK(simplified == sphere.indices);
+    CHECK_EQ(error, 0.f);
+}
+
+TEST(MeshSimplifier, BorderAndSeamVerticesStay)
+{
+    const uint32_t size = 32;
+    Mesh terrain = CreateTerrain(size, 0.5f, true);
+
+    float error;
+    std::vector<uint32_t> simplified = Simplify(terrain, 0, 1.f, error);
+    REQUIRE(IsValidTriangleList(simplified, terrain.positions.size()));
+    CHECK(simplified.size() < terrain.indices.size() / 4);
+
+    // Every border vertex and both sides of the seam are still used
+    std::set<uint32_t> used(simplified.begin(), simplified.end());
+    const uint32_t side = size + 1;
+    for (uint32_t i = 0; i < side; i++)
+    {
+        CHECK(used.count(i) == 1);
+        CHECK(used.count(size * side + i) == 1);
+        CHECK(used.count(i * side) == 1);
+        CHECK(used.count(i * side + size) == 1);
+
+        CHECK(used.count(i * side + size / 2) == 1);
+        CHECK(used.count(side * side + i) == 1);
+    }
+
+    // The left side of the seam is only used by triangles on the left, the copies by the ones on the right
+    for (size_t i = 0; i < simplified.size(); i += 3)
+    {
+        bool left = false, right = false;
+        for (uint32_t k = 0; k < 3; k++)
+        {
+            const Position& p = terrain.positions[simplified[i + k]];
+            bool copy = simplified[i + k] >= side * side;
+            if (p.x < size / 2 || (p.x == size / 2 && !copy)) left = true;
+            if (p.x > size / 2 || (p.x == size / 2 && copy)) right = true;
+        }
+        CHECK(!(left && right));
+    }
+}
+
+TEST(MeshSimplifier, LodErrorsCappedByBounds)
+{
+    // The collapses of the bumpy terrain are limited by the cap, the smooth one stays well under it
+    Mesh bumpy = CreateTerrain(64, 3.f, false);
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+    for (auto& p : bumpy.positions) p.y += noise(rng);
+
+    Mesh smooth = CreateTerrain(64, 1.f, false);
+
+    for (Mesh* mesh : { &bumpy, &smooth })
+    {
+        float ymin = 1e30f, ymax = -1e30f;
+        for (const auto& p : mesh->positions)
+        {
+            ymin = std::min(ymin, p.y);
+            ymax = std::max(ymax, p.y);
+        }
+        // MAX_LOD_ERROR of the bounding box diagonal per LOD
+        const float cap = 0.01f * std::sqrt(64.f * 64.f * 2.f + (ymax - ymin) * (ymax - ymin));
+
+        const size_t fullCount = mesh->indices.size();
+        MeshLodChain lods = BuildMeshLods(&mesh->positions[0].x, sizeof(Position), mesh->positions.size(), mesh->indices);
+        REQUIRE(lods.count >= 1 && lods.count <= MAX_MESH_LODS);
+        CHECK_EQ(lods.lods[0].indexCount, fullCount);
+        CHECK_EQ(lods.lods[0].error, 0.f);
+
+        for (uint32_t i = 1; i < lods.count; i++)
+        {
+            const MeshLod& lod = lods.lods[i];
+            CHECK(lod.error >= lods.lods[i - 1].error);
+            CHECK(lod.error - lods.lods[i - 1].error <= cap * 1.0001f);
+            CHECK(lod.indexCount < lods.lods[i - 1].indexCount);
+            REQUIRE(lod.firstIndex + lod.indexCount <= mesh->indices.size());
+
+            std::vector<uint32_t> indices(mesh->indices.begin() + lod.firstIndex,
+                mesh->indices.begin() + lod.firstIndex + lod.indexCount);
+            CHECK(IsValidTriangleList(indices, mesh->positions.size()));
+        }
+    }
+
+    // Too small for LODs
+    Mesh small = CreateTerrain(8, 1.f, false);
+    MeshLodChain single = BuildMeshLods(&small.positions[0].x, sizeof(Position), small.positions.size(), small.indices);
+    CHECK_EQ(single.count, 1u);
+}
@@ -0,0 +1,141 @@
+#include "Test.h"
+#include <Common\MipGenerator.h>
+#include <algorithm>
+#include <random>
+
+using namespace Engine;
+
+namespace
+{
+    std::vector<float> CreateImage(uint32_t width, uint32_t height, uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> value(0.f, 1.f);
+        std::vector<float> image((size_t)width * height * 4);
+        for (auto& v : image)
+            v = value(rng);
+        return image;
+    }
+
+    float MaxDifference(const std::vector<float>& a, const std::vector<float>& b)
+    {
+        float diff = 0.f;
+        for (size_t i = 0; i < a.size(); i++)
+            diff = std::max(diff, std::fabs(a[i] - b[i]));
+        return diff;
+    }
+
+    const uint32_t SIZES[][2] = { { 1, 1 }, { 1, 7 }, { 7, 1 }, { 2, 2 }, { 3, 3 }, { 5, 9 },
+        { 17, 13 }, { 64, 33 }, { 129, 65 }, { 256, 256 } };
+}
+
+// The SIMD kernels must give the result of the plain C++ ones on every size, odd and 1 pixel included
+TEST(MipGenerator, SimdMatchesScalar)
+{
+    for (MipFilter filter : { MipFilter::Box, MipFilter::Kaiser })
+    {
+        for (const auto& size : SIZES)
+        {
+            uint32_t width = size[0], height = size[1];
+            uint32_t dstWidth = NextMipSize(width), dstHeight = NextMipSize(height);
+            std::vector<float> src = CreateImage(width, height, width * 7 + height);
+            std::vector<float> simd((size_t)dstWidth * dstHeight * 4, -1.f);
+            std::vector<float> scalar((size_t)dstWidth * dstHeight * 4, -2.f);
+
+            DownsampleRGBA32F(src.data(), width, height, simd.data(), filter, 0, dstHeight);
+            DownsampleRGBA32FScalar(src.data(), width, height, scalar.data(), filter, 0, dstHeight);
+
+            float diff = MaxDifference(simd, scalar);
+            if (diff > 1e-5f)
+                printf("%s %ux%u differs by %g\n", filter == MipFilter::Box ? "Box" : "Kaiser", width, height, diff);
+            CHECK(diff <= 1e-5f);
+        }
+    }
+}
+
+// Row ranges are what the parallel generation hands to each task, they must only write their rows
+TEST(MipGenerator, RowRangesMatchWholeImage)
+{
+    const uint32_t width = 45, height = 31;
+    const uint32_t dstWidth = NextMipSize(width), dstHeight = NextMipSize(height);
+    std::vector<float> src = CreateImage(width, height, 3);
+
+    for (MipFilter filter : { MipFilter::Box, MipFilter::Kaiser })
+    {
+        std::vector<float> whole((size_t)dstWidth * dstHeight * 4);
+        DownsampleRGBA32F(src.data(), width, height, whole.data(), filter, 0, dstHeight);
+
+        std::vector<float> rows(whole.size(), -1.f);
+        for (uint32_t begin = 0; begin < dstHeight; begin += 4)
+        {
+            DownsampleRGBA32F(src.data(), width, height, rows.data(), filter, begin, std::min(begin + 4, dstHeight));
+        }
+        CHECK(rows == whole);
+    }
+}
+
+// The filters keep a constant color: every level of the chain is the color of the source
+TEST(MipGenerator, ConstantColorChain)
+{
+    const uint8_t color[4] = { 200, 100, 30, 128 };
+    for (bool srgb : { true, false })
+    {
+        for (MipFilter filter : { MipFilter::Box, MipFilter::Kaiser })
+        {
+            for (const auto& size : SIZES)
+            {
+                uint32_t width = size[0], height = size[1];
+                std::vector<uint8_t> mips((size_t)width * height * 4);
+                for (size_t i = 0; i < mips.size(); i++)
+                    mips[i] = color[i % 4];
+
+                uint32_t levels = GetMipLevelCount(width, height);
+                std::vector<size_t> offsets = GenerateMipChainRGBA8(mips, width, height, levels, filter, srgb);
+                REQUIRE(offsets.size() == levels);
+
+                bool constant = true;
+                for (size_t i = 0; i < mips.size(); i++)
+                    constant = constant && mips[i] == color[i % 4];
+                if (!constant)
+                    printf("%s %s %ux%u changed the color\n", srgb ? "sRGB" : "linear",
+                        filter == MipFilter::Box ? "Box" : "Kaiser", width, height);
+                CHECK(constant);
+            }
+        }
+    }
+}
+
+// sRGB color is averaged in linear space: black and white average to 188, not 128
+TEST(MipGenerator, SrgbAveragesInLinearSpace)
+{
+    std::vector<uint8_t> mips = { 0, 0, 0, 0, 255, 255, 255, 255, 0, 0, 0, 0, 255, 255, 255, 255 };
+    GenerateMipChainRGBA8(mips, 2, 2, 2, MipFilter::Box, true);
+    REQUIRE(mips.size() == 20);
+    CHECK_EQ(mips[16], 188);
+    CHECK_EQ(mips[17], 188);
+    CHECK_EQ(mips[18], 188);
+    // Alpha is always linear
+    CHECK_EQ(mips[19], 128);
+
+    mips = { 0, 0, 0, 0, 255, 255, 255, 255, 0, 0, 0, 0, 255, 255, 255, 255 };
+    GenerateMipChainRGBA8(mips, 2, 2, 2, MipFilter::Box, false);
+    CHECK_EQ(mips[16], 128);
+}
+
+// The parallel generation gives the serial result
+TEST(MipGenerator, ParallelMatchesSerial)
+{
+    std::vector<float> serial = CreateImage(300, 170, 4);
+    std::vector<float> parallel = serial;
+    uint32_t levels = GetMipLevelCount(300, 170);
+
+    GenerateMipChainRGBA32F(serial, 300, 170, levels, MipFilter::Kaiser);
+    GenerateMipChainRGBA32F(parallel, 300, 170, levels, MipFilter::Kaiser,
+        [](uint32_t count, const std::function<void(uint32_t)>& f)
+        {
+            // Reverse order, like threads finishing in any order would
+            for (uint32_t i = count; i-- > 0; )
+                f(i);
+        });
+    CHECK(serial == parallel);
+}
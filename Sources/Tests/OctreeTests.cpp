@@ -0,0 +1,211 @@
+#define OCTREE_IMPL
+#include "Test.h"
+#include <Octree.h>
+#include <algorithm>
+#include <random>
+
+namespace
+{
+    struct Item
+    {
+        int id;
+    };
+
+    // Column-major projection of a camera at the origin looking down -Z, 90 degrees fov, [0, 1] depth
+    otr::Frustum GetTestFrustum(float zNear, float zFar)
+    {
+        float m[16] = {};
+        m[0] = 1.f;
+        m[5] = 1.f;
+        m[10] = zFar / (zNear - zFar);
+        m[11] = -1.f;
+        m[14] = zNear * zFar / (zNear - zFar);
+        return otr::Frustum::FromMatrix(m);
+    }
+
+    std::vector<int> GetIds(const std::vector<otr::OctreeData<Item>*>& data)
+    {
+        std::vector<int> ids;
+        for (auto* d : data)
+            ids.push_back(d->mData->id);
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+}
+
+TEST(Octree, FrustumClassify)
+{
+    otr::Frustum frustum = GetTestFrustum(1.f, 100.f);
+
+    CHECK(frustum.Classify(otr::Vector3(0.f, 0.f, -50.f), otr::Vector3(1.f)) == otr::Containment::INSIDE);
+    CHECK(frustum.Classify(otr::Vector3(0.f, 0.f, 50.f), otr::Vector3(1.f)) == otr::Containment::OUTSIDE);
+    CHECK(frustum.Classify(otr::Vector3(0.f, 0.f, -200.f), otr::Vector3(1.f)) == otr::Containment::OUTSIDE);
+    CHECK(frustum.Classify(otr::Vector3(0.f, 0.f, -100.f), otr::Vector3(1.f)) == otr::Containment::INTERSECTING);
+    // Center outside the frustum but the box reaches into it
+    CHECK(frustum.Classify(otr::Vector3(12.f, 0.f, -10.f), otr::Vector3(3.f)) == otr::Containment::INTERSECTING);
+    CHECK(frustum.Classify(otr::Vector3(20.f, 0.f, -10.f), otr::Vector3(3.f)) == otr::Containment::OUTSIDE);
+}
+
+// The frustum and box queries must return exactly the boxes a brute force test finds
+TEST(Octree, QueriesMatchBruteForce)
+{
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> pos(-100.f, 100.f);
+    std::uniform_real_distribution<float> size(0.f, 10.f);
+
+    std::vector<Item> items(5000);
+    std::vector<otr::OctreeData<Item>*> boxes;
+    otr::Octree<Item>* octree = otr::Octree<Item>::New(otr::Vector3(0.f), otr::Vector3(100.f));
+    for (int i = 0; i < int(items.size()); i++)
+    {
+        items[i].id = i;
+        boxes.push_back(otr::OctreeData<Item>::New(otr::Vector3(pos(rng), pos(rng), pos(rng)),
+            otr::Vector3(size(rng), size(rng), size(rng)), &items[i]));
+        octree->Insert(boxes.back());
+    }
+    CHECK_EQ(octree->Size(), items.size());
+
+    otr::Frustum frustum = GetTestFrustum(0.5f, 80.f);
+    std::vector<otr::OctreeData<Item>*> result;
+    octree->GetDataInsideFrustum(frustum, result);
+
+    std::vector<int> expected;
+    for (auto* box : boxes)
+    {
+        if (frustum.Classify(box->mPosition, box->mExtent) != otr::Containment::OUTSIDE)
+            expected.push_back(box->mData->id);
+    }
+    std::sort(expected.begin(), expected.end());
+    CHECK(!expected.empty());
+    CHECK(GetIds(result) == expected);
+
+    otr::Vector3 bmin(-30.f, -5.f, 10.f), bmax(20.f, 40.f, 60.f);
+    result.clear();
+    octree->GetDataInsideBox(bmin, bmax, result);
+
+    expected.clear();
+    for (auto* box : boxes)
+    {
+        if (otr::IsIntersecting(box->mPosition - box->mExtent, box->mPosition + box->mExtent, bmin, bmax))
+            expected.push_back(box->mData->id);
+    }
+    std::sort(expected.begin(), expected.end());
+    CHECK(!expected.empty());
+    CHECK(GetIds(result) == expected);
+
+    result.clear();
+    octree->GetAllData(result);
+    CHECK_EQ(result.size(), items.size());
+
+    octree->Delete();
+}
+
+// Moving boxes around with Relocate must leave the tree as if they were inserted at their new place
+TEST(Octree, RelocateMatchesBruteForce)
+{
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> pos(-100.f, 100.f);
+    std::uniform_real_distribution<float> size(0.f, 5.f);
+    std::uniform_real_distribution<float> step(-3.f, 3.f);
+
+    std::vector<Item> items(2000);
+    std::vector<otr::OctreeData<Item>*> boxes;
+    otr::Octree<Item>* octree = otr::Octree<Item>::New(otr::Vector3(0.f), otr::Vector3(100.f));
+    for (int i = 0; i < int(items.size()); i++)
+    {
+        items[i].id = i;
+        boxes.push_back(otr::OctreeData<Item>::New(otr::Vector3(pos(rng), pos(rng), pos(rng)),
+            otr::Vector3(size(rng)), &items[i]));
+        octree->Insert(boxes.back());
+    }
+
+    for (int frame = 0; frame < 50; frame++)
+    {
+        for (auto* box : boxes)
+        {
+            otr::Vector3 p = box->mPosition + otr::Vector3(step(rng), step(rng), step(rng));
+            for (int k = 0; k < 3; k++)
+                p[k] = std::max(-100.f, std::min(100.f, p[k]));
+            // Every tenth box teleports and grows, the others move a little
+            if (box->mData->id % 10 == frame % 10)
+                octree->Relocate(box, otr::Vector3(pos(rng), pos(rng), pos(rng)), otr::Vector3(size(rng) * 4.f));
+            else
+                octree->Relocate(box, p, box->mExtent);
+            REQUIRE(box->GetNode() != nullptr);
+        }
+    }
+    CHECK_EQ(octree->Size(), items.size());
+
+    // Relocating to the same place keeps the box in its node
+    otr::Octree<Item>* node = boxes[0]->GetNode();
+    octree->Relocate(boxes[0], boxes[0]->mPosition, boxes[0]->mExtent);
+    CHECK(boxes[0]->GetNode() == node);
+
+    otr::Vector3 bmin(-40.f, -40.f, -40.f), bmax(35.f, 20.f, 50.f);
+    std::vector<otr::OctreeData<Item>*> result;
+    octree->GetDataInsideBox(bmin, bmax, result);
+
+    std::vector<int> expected;
+    for (auto* box : boxes)
+    {
+        if (otr::IsIntersecting(box->mPosition - box->mExtent, box->mPosition + box->mExtent, bmin, bmax))
+            expected.push_back(box->mData->id);
+    }
+    std::sort(expected.begin(), expected.end());
+    CHECK(GetIds(result) == expected);
+
+    // Removed boxes are not returned anymore
+    for (size_t i = 0; i < boxes.size(); i += 2)
+        octree->Remove(boxes[i]);
+    CHECK_EQ(octree->Size(), items.size() / 2);
+    result.clear();
+    octree->GetAllData(result);
+    for (auto* d : result)
+        CHECK(d->mData->id % 2 == 1);
+
+    for (size_t i = 0; i < boxes.size(); i += 2)
+        boxes[i]->Delete();
+    octree->Delete();
+}
+
+// Coincident boxes can't be separated by splitting, the max depth has to stop the tree
+TEST(Octree, CoincidentBoxesBoundedNodeCount)
+{
+    constexpr uint32_t BUCKET_SIZE = 4;
+    constexpr uint32_t MAX_DEPTH = 6;
+
+    std::vector<Item> items(10000);
+    otr::Octree<Item>* octree = otr::Octree<Item>::New(otr::Vector3(0.f), otr::Vector3(100.f), BUCKET_SIZE, MAX_DEPTH);
+    for (int i = 0; i < int(items.size()); i++)
+    {
+        items[i].id = i;
+        octree->Insert(otr::OctreeData<Item>::New(otr::Vector3(10.f, 20.f, 30.f), otr::Vector3(0.5f), &items[i]));
+    }
+    CHECK_EQ(octree->Size(), items.size());
+
+    // Only one path down to the max depth is split, 8 children per level
+    CHECK(octree->GetNodeCount() <= 1 + 8 * MAX_DEPTH);
+
+    std::vector<otr::OctreeData<Item>*> result;
+    octree->GetDataInsideBox(otr::Vector3(9.f), otr::Vector3(11.f, 21.f, 31.f), result);
+    CHECK_EQ(result.size(), items.size());
+
+    octree->Delete();
+}
+
+// A bucket holds several boxes before splitting, so a tree of N boxes has far fewer than N leaves
+TEST(Octree, BucketsLimitNodeCount)
+{
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> pos(-100.f, 100.f);
+
+    std::vector<Item> items(20000);
+    otr::Octree<Item>* octree = otr::Octree<Item>::New(otr::Vector3(0.f), otr::Vector3(100.f), 16);
+    for (int i = 0; i < int(items.size()); i++)
+    {
+        items[i].id = i;
+        octree->Insert(otr::OctreeData<Item>::New(otr::Vector3(pos(rng), pos(rng), pos(rng)), otr::Vector3(0.1f), &items[i]));
+    }
+    CHECK(octree->GetNodeCount() < items.size() / 2);
+    octree->Delete();
+}
@@ -0,0 +1,262 @@
+#include "Test.h"
+#include <Engine\PhysicsWorld.h>
+#include <Engine\Time.h>
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+using namespace Engine;
+
+namespace
+{
+    typedef std::pair<uint32_t, uint32_t> IndexPair;
+
+    int32_t gTriggerEvents = 0;
+
+    void CountTriggerEvent(CollisionInfoMarshal& info)
+    {
+        gTriggerEvents += info.event == TriggerEvent::Enter ? 1 : -1;
+    }
+
+    uint32_t GetIndex(rp3d::ProxyShape* shape)
+    {
+        return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(shape->getBody()->getUserData()));
+    }
+
+    // Every pair of triggers against each other. The boxes are axis aligned, so their AABBs are exact
+    std::vector<IndexPair> FindPairsBruteForce(const std::vector<rp3d::ProxyShape*>& shapes)
+    {
+        std::vector<IndexPair> pairs;
+        for (uint32_t i = 0; i + 1 < shapes.size(); i++)
+        {
+            for (uint32_t j = i + 1; j < shapes.size(); j++)
+            {
+                if (shapes[i]->getWorldAABB().testCollision(shapes[j]->getWorldAABB()))
+                {
+                    pairs.push_back({ GetIndex(shapes[i]), GetIndex(shapes[j]) });
+                }
+            }
+        }
+        std::sort(pairs.begin(), pairs.end());
+        return pairs;
+    }
+
+    std::vector<IndexPair> GetReportedPairs(const PhysicsWorld& world)
+    {
+        std::vector<IndexPair> pairs;
+        for (const auto& pair : world.GetTriggerPairs())
+        {
+            uint32_t a = GetIndex(pair.shape1), b = GetIndex(pair.shape2);
+            pairs.push_back({ std::min(a, b), std::max(a, b) });
+        }
+        std::sort(pairs.begin(), pairs.end());
+        return pairs;
+    }
+
+    struct TriggerGrid
+    {
+        PhysicsWorld* world;
+        std::vector<rp3d::CollisionBody*> bodies;
+        std::vector<rp3d::ProxyShape*> shapes;
+    };
+
+    // Box triggers of half extent 1 on a grid of 3 units, some of them overlap a neighbour
+    TriggerGrid CreateTriggerGrid(rp3d::BoxShape& box, uint32_t side, std::mt19937& rng)
+    {
+        TriggerGrid grid;
+        grid.world = PhysicsWorld::Allocate();
+        grid.world->Init();
+        grid.world->PhysicsUpdateCallback = []() { };
+
+        std::uniform_real_distribution<float> jitter(0.f, 1.5f);
+        for (uint32_t i = 0; i < side * side; i++)
+        {
+            rp3d::Vector3 position((i % side) * 3.f + jitter(rng), 0.f, (i / side) * 3.f);
+            rp3d::CollisionBody* body = grid.world->CreateCollisionBody(
+                rp3d::Transform(position, rp3d::Quaternion::identity()), nullptr);
+            body->setUserData(reinterpret_cast<void*>(static_cast<uintptr_t>(i)));
+            rp3d::ProxyShape* shape = body->addCollisionShape(&box, rp3d::Transform::identity());
+            grid.world->SetProxyCallback(shape, CountTriggerEvent);
+            grid.bodies.push_back(body);
+            grid.shapes.push_back(shape);
+        }
+
+        g_Time.deltaTime = TIME_STEP;
+        g_Time.fixedDeltaTime = TIME_STEP;
+        gTriggerEvents = 0;
+        return grid;
+    }
+
+    struct ReplayResult
+    {
+        uint64_t hash;
+        uint32_t maxSubsteps;
+        double dropped;
+    };
+
+    // 144 Hz frames with a 50 ms hitch every 97 frames and a 250 ms one every 300 frames
+    float GetReplayDeltaTime(uint32_t frame)
+    {
+        if (frame % 300 == 299) return 0.25f;
+        if (frame % 97 == 96) return 0.05f;
+        return 1.f / 144.f;
+    }
+
+    // Drops 200 boxes on a floor and feeds the synthetic frame times to Update, checking on every
+    // frame that the time fed is either simulated, left in the accumulator or dropped
+    ReplayResult ReplaySpikes(uint32_t maxSubsteps, bool adaptive)
+    {
+        const uint32_t BODY_COUNT = 201;
+        std::vector<rp3d::Vector3> positions(BODY_COUNT);
+        std::vector<rp3d::Quaternion> orientations(BODY_COUNT);
+        std::vector<uint32_t> dirtyBits((BODY_COUNT + 31) / 32);
+
+        rp3d::BoxShape ground(rp3d::Vector3(50.f, 1.f, 50.f));
+        rp3d::BoxShape box(rp3d::Vector3(0.5f, 0.5f, 0.5f));
+        const UpdateBodyCBack ignore = [](rp3d::Vector3, rp3d::Quaternion) { };
+
+        PhysicsWorld* world = PhysicsWorld::Allocate();
+        world->Init();
+        world->PhysicsUpdateCallback = []() { };
+        world->SetMaxSubsteps(maxSubsteps);
+        world->SetAdaptiveStep(adaptive);
+
+        rp3d::RigidBody* floor = world->CreateRigidBody(
+            rp3d::Transform(rp3d::Vector3(0.f, -1.f, 0.f), rp3d::Quaternion::identity()), ignore);
+        floor->setType(rp3d::BodyType::STATIC);
+        floor->addCollisionShape(&ground, rp3d::Transform::identity(), 1.f);
+        for (uint32_t i = 1; i < BODY_COUNT; i++)
+        {
+            rp3d::Vector3 position((i % 10) * 1.2f - 6.f, 1.f + (i / 100) * 1.1f, (i / 10 % 10) * 1.2f - 6.f);
+            rp3d::RigidBody* body = world->CreateRigidBody(rp3d::Transform(position, rp3d::Quaternion::identity()), ignore);
+            body->addCollisionShape(&box, rp3d::Transform::identity(), 1.f);
+        }
+        world->SetTransformSyncBuffer({ positions.data(), orientations.data(), dirtyBits.data(), BODY_COUNT },
+            [](uint32_t) { });
+
+        g_Time.fixedDeltaTime = TIME_STEP;
+
+        ReplayResult result = { 14695981039346656037ull, 0, 0.0 };
+        for (uint32_t frame = 0; frame < 1200; frame++)
+        {
+            const float before = world->GetAccumulator();
+            g_Time.deltaTime = GetReplayDeltaTime(frame);
+            world->Update();
+
+            const PhysicsFrameStats& stats = world->GetFrameStats();
+            CHECK(stats.substeps <= maxSubsteps);
+            const float simulated = stats.substeps * stats.stepSize;
+            CHECK_NEAR(simulated + world->GetAccumulator() + stats.timeDropped, before + g_Time.deltaTime, 1e-5f);
+            CHECK(world->GetAccumulator() < stats.stepSize + 1e-5f);
+            result.maxSubsteps = std::max(result.maxSubsteps, stats.substeps);
+            result.dropped += stats.timeDropped;
+
+            // The synced transforms are the ones the game sees
+            for (uint32_t i = 0; i < BODY_COUNT; i++)
+            {
+                uint8_t bytes[28];
+                memcpy(bytes, &positions[i], 12);
+                memcpy(bytes + 12, &orientations[i], 16);
+                for (uint8_t b : bytes)
+                {
+                    result.hash = (result.hash ^ b) * 1099511628211ull;
+                }
+            }
+        }
+
+        world->Destroy();
+        return result;
+    }
+}
+
+TEST(PhysicsWorld, TriggerPairsMatchBruteForce)
+{
+    rp3d::BoxShape box(rp3d::Vector3(1.f, 1.f, 1.f));
+    std::mt19937 rng(11);
+    TriggerGrid grid = CreateTriggerGrid(box, 24, rng);
+
+    std::uniform_real_distribution<float> move(-1.f, 1.f);
+    size_t pairCount = 0;
+    for (uint32_t frame = 0; frame < 40; frame++)
+    {
+        // A tenth of the triggers move on every frame, the others stay in the broad-phase pair cache
+        for (uint32_t k = 0; k < grid.bodies.size() / 10; k++)
+        {
+            rp3d::CollisionBody* body = grid.bodies[rng() % grid.bodies.size()];
+            rp3d::Transform t = body->getTransform();
+            t.setPosition(t.getPosition() + rp3d::Vector3(move(rng), 0.f, move(rng)));
+            body->setTransform(t);
+        }
+        grid.world->Update();
+
+        std::vector<IndexPair> expected = FindPairsBruteForce(grid.shapes);
+        CHECK(GetReportedPairs(*grid.world) == expected);
+        // Both triggers of a pair got an enter event, and an exit one once the pair is gone
+        CHECK_EQ(gTriggerEvents, 2 * (int32_t)expected.size());
+        pairCount += expected.size();
+    }
+    CHECK(pairCount > 0);
+
+    grid.world->Destroy();
+}
+
+TEST(PhysicsWorld, RemovedTriggerLeavesItsPairs)
+{
+    rp3d::BoxShape box(rp3d::Vector3(1.f, 1.f, 1.f));
+    std::mt19937 rng(5);
+    TriggerGrid grid = CreateTriggerGrid(box, 8, rng);
+
+    // Everything piled up on the first trigger overlaps everything else
+    for (auto body : grid.bodies)
+    {
+        body->setTransform(grid.bodies[0]->getTransform());
+    }
+    grid.world->Update();
+    const int32_t n = (int32_t)grid.bodies.size();
+    REQUIRE(grid.world->GetTriggerPairs().size() == size_t(n * (n - 1) / 2));
+    CHECK_EQ(gTriggerEvents, n * (n - 1));
+
+    // The partners of the removed trigger get an exit event, the removed one doesn't
+    grid.world->RemoveTrigger(grid.shapes[0]);
+    grid.bodies[0]->removeCollisionShape(grid.shapes[0]);
+    CHECK_EQ(grid.world->GetTriggerPairs().size(), size_t((n - 1) * (n - 2) / 2));
+    CHECK_EQ(gTriggerEvents, n * (n - 1) - (n - 1));
+
+    grid.world->Update();
+    CHECK_EQ(grid.world->GetTriggerPairs().size(), size_t((n - 1) * (n - 2) / 2));
+    CHECK_EQ(gTriggerEvents, n * (n - 1) - (n - 1));
+
+    grid.world->Destroy();
+}
+
+TEST(PhysicsWorld, ReplayedSpikesAreDeterministic)
+{
+    ReplayResult first = ReplaySpikes(4, false);
+    ReplayResult second = ReplaySpikes(4, false);
+    CHECK_EQ(first.hash, second.hash);
+    CHECK_EQ(first.dropped, second.dropped);
+
+    // The 250 ms hitches can't be caught up in 4 steps, the 50 ms ones can
+    CHECK_EQ(first.maxSubsteps, 4u);
+    CHECK(first.dropped > 0.0);
+}
+
+TEST(PhysicsWorld, ReplayedSpikesWithAdaptiveStep)
+{
+    ReplayResult first = ReplaySpikes(4, true);
+    ReplayResult second = ReplaySpikes(4, true);
+    CHECK_EQ(first.hash, second.hash);
+
+    // Larger steps catch up more of the hitches
+    ReplayResult fixed = ReplaySpikes(4, false);
+    CHECK(first.dropped < fixed.dropped);
+}
+
+TEST(PhysicsWorld, ReplayedSpikesWithoutLimitDropNothing)
+{
+    ReplayResult result = ReplaySpikes(1000, false);
+    CHECK_EQ(result.dropped, 0.0);
+    // 0.25 s plus what was left, at 60 Hz
+    CHECK(result.maxSubsteps >= 15u);
+    CHECK(result.maxSubsteps <= 16u);
+}
@@ -0,0 +1,92 @@
+#include "Test.h"
+#include <Common\RadixSort.h>
+#include <algorithm>
+#include <random>
+
+namespace
+{
+    struct Draw
+    {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    // The radix sort is stable, it must give the same order as std::stable_sort
+    void CheckSorted(std::vector<Draw> items)
+    {
+        std::vector<Draw> expected = items;
+        std::stable_sort(expected.begin(), expected.end(),
+            [](const Draw& a, const Draw& b) { return a.key < b.key; });
+
+        std::vector<Draw> tmp;
+        Engine::RadixSort(items, tmp);
+
+        REQUIRE(items.size() == expected.size());
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            REQUIRE(items[i].key == expected[i].key && items[i].index == expected[i].index);
+        }
+    }
+
+    std::vector<Draw> CreateDraws(size_t count, uint64_t keyMask, uint32_t seed)
+    {
+        std::mt19937_64 rng(seed);
+        std::vector<Draw> items(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            items[i] = { rng() & keyMask, uint32_t(i) };
+        }
+        return items;
+    }
+}
+
+TEST(RadixSort, MatchesStableSort)
+{
+    CheckSorted({});
+    CheckSorted(CreateDraws(1, ~0ull, 1));
+    CheckSorted(CreateDraws(2, ~0ull, 2));
+    CheckSorted(CreateDraws(1000, ~0ull, 3));
+    CheckSorted(CreateDraws(100000, ~0ull, 4));
+}
+
+// Few distinct keys, many equal ones keep their order
+TEST(RadixSort, DuplicateKeysStayStable)
+{
+    CheckSorted(CreateDraws(10000, 0x7ull, 5));
+    CheckSorted(CreateDraws(10000, 0xF00000000000F000ull, 6));
+    CheckSorted(CreateDraws(10000, 0ull, 7));
+}
+
+// Bytes shared by every key skip their pass, the remaining passes must still sort
+TEST(RadixSort, SkippedPasses)
+{
+    std::vector<Draw> items = CreateDraws(5000, 0x00FF0000FF0000FFull, 8);
+    for (auto& item : items)
+    {
+        item.key |= 0xAB00000000000000ull;
+    }
+    CheckSorted(items);
+
+    // An odd number of passes leaves the result in the scratch buffer before the swap
+    CheckSorted(CreateDraws(5000, 0xFFull, 9));
+    CheckSorted(CreateDraws(5000, 0xFFFFull, 10));
+}
+
+// Sorting again with the same scratch buffer doesn't grow it
+TEST(RadixSort, ReusesScratch)
+{
+    std::vector<Draw> items = CreateDraws(4096, ~0ull, 11);
+    std::vector<Draw> tmp;
+    Engine::RadixSort(items, tmp);
+
+    size_t capacity = items.capacity() + tmp.capacity();
+    for (int frame = 0; frame < 4; frame++)
+    {
+        std::vector<Draw> next = CreateDraws(4096, ~0ull, 12 + frame);
+        std::copy(next.begin(), next.end(), items.begin());
+        Engine::RadixSort(items, tmp);
+        CHECK(std::is_sorted(items.begin(), items.end(),
+            [](const Draw& a, const Draw& b) { return a.key < b.key; }));
+        CHECK_EQ(items.capacity() + tmp.capacity(), capacity);
+    }
+}
@@ -0,0 +1,82 @@
+#include "Test.h"
+#include <Engine\TaskScheduler.h>
+#include <Common\AllocationCounter.h>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+using namespace Engine;
+
+TEST(TaskScheduler, ParallelForRunsEveryIndexOnce)
+{
+    const uint32_t counts[] = { 0, 1, 2, 7, 64, 1000 };
+    for (uint32_t count : counts)
+    {
+        std::vector<std::atomic<uint32_t>> runs(count);
+        GTaskScheduler.ParallelFor(count, [&](uint32_t i) { runs[i]++; });
+
+        uint32_t wrong = 0;
+        for (const auto& run : runs)
+        {
+            wrong += run.load() != 1;
+        }
+        CHECK_EQ(wrong, 0u);
+    }
+}
+
+TEST(TaskScheduler, ParallelForAllocatesNothing)
+{
+    std::atomic<uint64_t> sum{ 0 };
+    auto add = [&sum](uint32_t i) { sum += i; };
+    // The way rp3d and the mip generator call it
+    const std::function<void(uint32_t)> function = add;
+
+#if _DEBUG
+    const uint64_t start = GetThreadAllocationCount();
+#endif
+    for (uint32_t frame = 0; frame < 100; frame++)
+    {
+        GTaskScheduler.ParallelFor(8, add);
+        GTaskScheduler.ParallelFor(8, function);
+    }
+#if _DEBUG
+    CHECK_EQ(GetThreadAllocationCount() - start, 0u);
+#endif
+    CHECK_EQ(sum.load(), 100u * 2u * 28u);
+}
+
+TEST(TaskScheduler, NestedParallelFor)
+{
+    std::atomic<uint32_t> runs{ 0 };
+    GTaskScheduler.ParallelFor(8, [&](uint32_t)
+    {
+        GTaskScheduler.ParallelFor(8, [&](uint32_t)
+        {
+            GTaskScheduler.ParallelFor(4, [&](uint32_t) { runs++; });
+        });
+    });
+    CHECK_EQ(runs.load(), 8u * 8u * 4u);
+}
+
+TEST(TaskScheduler, ParallelForFromSeveralThreads)
+{
+    // More callers than job slots, the ones without a slot run their indices themselves
+    const uint32_t THREAD_COUNT = 8;
+    std::atomic<uint32_t> runs{ 0 };
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < THREAD_COUNT; t++)
+    {
+        threads.emplace_back([&runs]()
+        {
+            for (uint32_t frame = 0; frame < 200; frame++)
+            {
+                GTaskScheduler.ParallelFor(16, [&runs](uint32_t) { runs++; });
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    CHECK_EQ(runs.load(), THREAD_COUNT * 200u * 16u);
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+/*
+ *  Minimal unit test framework of LavaTests.
+ *  TEST(Suite, Name) registers a test at static initialization, CHECK reports a failure
+ *  and goes on, REQUIRE reports it and leaves the test.
+ */
+namespace Test
+{
+    typedef void(*TestFunc)();
+
+    struct TestCase
+    {
+        const char* suite;
+        const char* name;
+        TestFunc func;
+    };
+
+    std::vector<TestCase>& GetTests();
+
+    // Prints the failed expression and marks the running test as failed
+    void ReportFailure(const char* file, int line, const char* expr);
+
+    struct Registrar
+    {
+        Registrar(const char* suite, const char* name, TestFunc func)
+        {
+            GetTests().push_back({ suite, name, func });
+        }
+    };
+}
+
+#define TEST(suite, name) \
+    static void suite##_##name(); \
+    static Test::Registrar suite##_##name##_registrar(#suite, #name, suite##_##name); \
+    static void suite##_##name()
+
+#define CHECK(expr) { if (!(expr)) Test::ReportFailure(__FILE__, __LINE__, #expr); }
+#define CHECK_EQ(a, b) CHECK((a) == (b))
+#define CHECK_NEAR(a, b, eps) CHECK(std::fabs((a) - (b)) <= (eps))
+#define REQUIRE(expr) { if (!(expr)) { Test::ReportFailure(__FILE__, __LINE__, #expr); return; } }
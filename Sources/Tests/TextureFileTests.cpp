@@ -0,0 +1,154 @@
+#include "Test.h"
+#include <Engine\TextureFile.h>
+#include <Common\MipGenerator.h>
+#include <vulkan\vulkan.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+using namespace Engine;
+
+namespace
+{
+    std::string GetTempPath(const char* name)
+    {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+
+    std::vector<uint8_t> ReadAll(const std::string& path)
+    {
+        std::ifstream fin(path, std::ifstream::binary);
+        return std::vector<uint8_t>(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+    }
+
+    std::vector<uint8_t> CreateImage(uint32_t width, uint32_t height, uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        std::vector<uint8_t> rgba((size_t)width * height * 4);
+        for (auto& c : rgba)
+            c = uint8_t(rng());
+        return rgba;
+    }
+
+    // Writes the image, reads the file back and checks the layout and every mip against the mip generator
+    void CheckRoundTrip(uint32_t width, uint32_t height, bool genmips, bool srgb)
+    {
+        std::vector<uint8_t> rgba = CreateImage(width, height, width * 131 + height);
+        std::string path = GetTempPath("LavaTests_roundtrip.ltex");
+        REQUIRE(TextureFile::Write(path.c_str(), rgba.data(), width, height, genmips, srgb));
+
+        std::vector<uint8_t> file = ReadAll(path);
+        std::filesystem::remove(path);
+        const TextureFileHeader* header = TextureFile::Read(file.data(), file.size());
+        REQUIRE(header != nullptr);
+
+        uint32_t levels = genmips ? GetMipLevelCount(width, height) : 1;
+        CHECK_EQ(header->width, width);
+        CHECK_EQ(header->height, height);
+        CHECK_EQ(header->format, static_cast<uint32_t>(vk::Format::eR8G8B8A8Unorm));
+        REQUIRE(header->mipLevels == levels);
+
+        std::vector<uint8_t> mips = rgba;
+        std::vector<size_t> offsets = GenerateMipChainRGBA8(mips, width, height, levels, MipFilter::Kaiser, srgb);
+
+        // The mips are tightly packed after the header, from the biggest one
+        uint64_t offset = sizeof(TextureFileHeader);
+        uint32_t w = width, h = height;
+        for (uint32_t i = 0; i < levels; i++)
+        {
+            CHECK_EQ(header->mipOffset[i], offset);
+            CHECK_EQ(header->mipSize[i], (uint64_t)w * h * 4);
+            REQUIRE(header->mipOffset[i] + header->mipSize[i] <= file.size());
+            CHECK(std::memcmp(file.data() + header->mipOffset[i], mips.data() + offsets[i], header->mipSize[i]) == 0);
+
+            offset += header->mipSize[i];
+            w = NextMipSize(w);
+            h = NextMipSize(h);
+        }
+        CHECK_EQ(offset, file.size());
+
+        // The top level is the source image as is
+        CHECK(std::memcmp(file.data() + header->mipOffset[0], rgba.data(), rgba.size()) == 0);
+    }
+
+    std::vector<uint8_t> WriteToMemory(uint32_t width, uint32_t height)
+    {
+        std::vector<uint8_t> rgba = CreateImage(width, height, 1);
+        std::string path = GetTempPath("LavaTests_invalid.ltex");
+        TextureFile::Write(path.c_str(), rgba.data(), width, height, true);
+        std::vector<uint8_t> file = ReadAll(path);
+        std::filesystem::remove(path);
+        return file;
+    }
+}
+
+TEST(TextureFile, RoundTripSquare)
+{
+    CheckRoundTrip(64, 64, true, true);
+    CheckRoundTrip(64, 64, true, false);
+    CheckRoundTrip(64, 64, false, true);
+}
+
+TEST(TextureFile, RoundTripOdd)
+{
+    CheckRoundTrip(37, 23, true, true);
+    CheckRoundTrip(1, 19, true, false);
+    CheckRoundTrip(129, 2, true, true);
+}
+
+TEST(TextureFile, RoundTripOnePixel)
+{
+    CheckRoundTrip(1, 1, true, true);
+    CheckRoundTrip(1, 1, false, false);
+}
+
+TEST(TextureFile, RejectsTruncated)
+{
+    std::vector<uint8_t> file = WriteToMemory(16, 8);
+    REQUIRE(TextureFile::Read(file.data(), file.size()) != nullptr);
+
+    // The last mip is one byte short
+    CHECK(TextureFile::Read(file.data(), file.size() - 1) == nullptr);
+    // Only the header is there
+    CHECK(TextureFile::Read(file.data(), sizeof(TextureFileHeader)) == nullptr);
+    // Not even the header
+    CHECK(TextureFile::Read(file.data(), sizeof(TextureFileHeader) - 1) == nullptr);
+    CHECK(TextureFile::Read(nullptr, file.size()) == nullptr);
+}
+
+TEST(TextureFile, RejectsBadHeader)
+{
+    std::vector<uint8_t> file = WriteToMemory(16, 8);
+    TextureFileHeader* header = reinterpret_cast<TextureFileHeader*>(file.data());
+
+    auto checkRejected = [&](auto modify)
+    {
+        std::vector<uint8_t> backup = file;
+        modify(*header);
+        CHECK(TextureFile::Read(file.data(), file.size()) == nullptr);
+        file = backup;
+        header = reinterpret_cast<TextureFileHeader*>(file.data());
+    };
+
+    checkRejected([](TextureFileHeader& h) { h.magic = 0x474E5089; });
+    checkRejected([](TextureFileHeader& h) { h.version = TextureFileHeader::VERSION + 1; });
+    checkRejected([](TextureFileHeader& h) { h.format = static_cast<uint32_t>(vk::Format::eR32G32B32Sfloat); });
+    checkRejected([](TextureFileHeader& h) { h.mipLevels = 0; });
+    checkRejected([](TextureFileHeader& h) { h.mipLevels = TextureFileHeader::MAX_MIPS + 1; });
+    // A mip size which doesn't match its level
+    checkRejected([](TextureFileHeader& h) { h.mipSize[1] -= 4; });
+    // An offset past the end of the file
+    checkRejected([](TextureFileHeader& h) { h.mipOffset[2] += 1024; });
+
+    CHECK(TextureFile::Read(file.data(), file.size()) != nullptr);
+}
+
+TEST(TextureFile, WriteRejectsInvalidImages)
+{
+    std::vector<uint8_t> rgba = CreateImage(4, 4, 2);
+    std::string path = GetTempPath("LavaTests_empty.ltex");
+    CHECK(!TextureFile::Write(path.c_str(), nullptr, 4, 4, true));
+    CHECK(!TextureFile::Write(path.c_str(), rgba.data(), 0, 4, true));
+    CHECK(!TextureFile::Write(path.c_str(), rgba.data(), 4, 0, true));
+}
@@ -0,0 +1,233 @@
+#include "Test.h"
+#include <Common\TextureResidency.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace Engine;
+
+namespace
+{
+    constexpr uint32_t BYTES_PER_TEXEL = 4;
+
+    uint64_t TailSize(uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t mip)
+    {
+        uint64_t size = 0;
+        for (uint32_t i = mip; i < mipLevels; i++)
+        {
+            size += (uint64_t)std::max(width >> i, 1u) * std::max(height >> i, 1u) * BYTES_PER_TEXEL;
+        }
+        return size;
+    }
+
+    // First mip at most MIN_RESIDENT_SIZE big, this one and the smaller ones are never dropped
+    uint32_t GetPinnedMip(uint32_t width, uint32_t height, uint32_t mipLevels)
+    {
+        uint32_t mip = 0;
+        while (mip + 1 < mipLevels && std::max(width >> mip, height >> mip) > TextureResidency::MIN_RESIDENT_SIZE)
+            mip++;
+        return mip;
+    }
+
+    struct StreamedTexture
+    {
+        uint32_t width, height, mipLevels;
+        float x, z;
+        uint32_t handle;
+        // Resident mip as seen through the changes, like the texture manager does
+        uint32_t mip;
+    };
+
+    struct ReplayStats
+    {
+        std::vector<TextureResidency::Change> log;
+        uint64_t maxResident = 0;
+        uint32_t frames = 0;
+    };
+
+    // A row of textured objects on both sides of a road, of different sizes
+    std::vector<StreamedTexture> CreateScene(TextureResidency& residency)
+    {
+        std::vector<StreamedTexture> scene;
+        for (uint32_t i = 0; i < 40; i++)
+        {
+            StreamedTexture tex;
+            tex.width = 256u << (i % 4);
+            tex.height = (i % 3) == 0 ? tex.width / 2 : tex.width;
+            tex.mipLevels = 1;
+            while ((std::max(tex.width, tex.height) >> tex.mipLevels) > 0) tex.mipLevels++;
+            tex.x = (i & 1) ? 4.f : -4.f;
+            tex.z = 10.f * (i / 2);
+            tex.handle = residency.Add(tex.width, tex.height, tex.mipLevels, BYTES_PER_TEXEL);
+            tex.mip = residency.GetResidentMip(tex.handle);
+            scene.push_back(tex);
+        }
+        return scene;
+    }
+
+    // Drives the camera down the road and back, requesting the mips of the objects in front of it
+    // and checking the residency after every frame against the changes it reported
+    ReplayStats ReplayCameraPath(uint64_t budget, uint64_t maxLoad)
+    {
+        TextureResidency residency;
+        residency.Init(budget, maxLoad);
+        std::vector<StreamedTexture> scene = CreateScene(residency);
+
+        ReplayStats stats;
+        std::vector<TextureResidency::Change> changes;
+        const uint32_t FRAME_COUNT = 600;
+        for (uint32_t frame = 0; frame < FRAME_COUNT; frame++)
+        {
+            // Forward for the first half, backward for the second one, then parked at the start
+            float t = frame < FRAME_COUNT / 2 ? frame / float(FRAME_COUNT / 2) : 2.f - frame / float(FRAME_COUNT / 2);
+            float cameraZ = std::max(t, 0.f) * 200.f;
+            float direction = frame < FRAME_COUNT / 2 ? 1.f : -1.f;
+
+            for (const auto& tex : scene)
+            {
+                float dz = (tex.z - cameraZ) * direction;
+                if (dz < 0.f || dz > 60.f)
+                    continue;
+                float distance = std::sqrt(dz * dz + tex.x * tex.x);
+                residency.Request(tex.handle, residency.GetMipForScreenSize(tex.handle, 2000.f / distance));
+            }
+
+            changes.clear();
+            residency.Update(changes);
+
+            uint64_t loaded = 0;
+            uint32_t loads = 0;
+            for (const auto& change : changes)
+            {
+                StreamedTexture& tex = scene[change.texture];
+                CHECK_EQ(change.oldMip, tex.mip);
+                CHECK(change.newMip != change.oldMip);
+                tex.mip = change.newMip;
+                if (change.newMip < change.oldMip)
+                {
+                    loaded += TailSize(tex.width, tex.height, tex.mipLevels, change.newMip);
+                    ++loads;
+                }
+                stats.log.push_back(change);
+            }
+            // The first load always goes through, the others stay under the limit together
+            CHECK(loads <= 1 || loaded <= maxLoad);
+
+            uint64_t resident = 0;
+            for (const auto& tex : scene)
+            {
+                CHECK_EQ(residency.GetResidentMip(tex.handle), tex.mip);
+                CHECK(tex.mip <= GetPinnedMip(tex.width, tex.height, tex.mipLevels));
+                resident += TailSize(tex.width, tex.height, tex.mipLevels, tex.mip);
+            }
+            CHECK_EQ(residency.GetResidentSize(), resident);
+            CHECK(resident <= budget);
+            stats.maxResident = std::max(stats.maxResident, resident);
+            stats.frames++;
+        }
+
+        // Parked at the start, the objects in front of the camera got their mips
+        for (const auto& tex : scene)
+        {
+            if (tex.z <= 10.f)
+            {
+                float distance = std::sqrt(tex.z * tex.z + tex.x * tex.x);
+                CHECK(tex.mip <= residency.GetMipForScreenSize(tex.handle, 2000.f / distance));
+            }
+        }
+        return stats;
+    }
+
+    bool SameLog(const ReplayStats& a, const ReplayStats& b)
+    {
+        if (a.log.size() != b.log.size()) return false;
+        for (size_t i = 0; i < a.log.size(); i++)
+        {
+            if (a.log[i].texture != b.log[i].texture || a.log[i].oldMip != b.log[i].oldMip ||
+                a.log[i].newMip != b.log[i].newMip)
+                return false;
+        }
+        return true;
+    }
+}
+
+TEST(TextureResidency, CameraPathFitsBudget)
+{
+    // Tight enough that the road doesn't fit at full resolution
+    ReplayStats stats = ReplayCameraPath(24ull << 20, 4ull << 20);
+    CHECK_EQ(stats.frames, 600u);
+    CHECK(stats.maxResident > (16ull << 20));
+
+    // The mips of the objects left behind made room for the ones ahead
+    uint32_t loads = 0, drops = 0;
+    for (const auto& change : stats.log)
+    {
+        if (change.newMip < change.oldMip) loads++;
+        else drops++;
+    }
+    CHECK(loads > 0);
+    CHECK(drops > 0);
+}
+
+TEST(TextureResidency, CameraPathIsDeterministic)
+{
+    ReplayStats first = ReplayCameraPath(24ull << 20, 4ull << 20);
+    ReplayStats second = ReplayCameraPath(24ull << 20, 4ull << 20);
+    CHECK(SameLog(first, second));
+}
+
+TEST(TextureResidency, CameraPathWithoutPressureNeverEvicts)
+{
+    // Everything fits, the mips stay cached once loaded
+    ReplayStats stats = ReplayCameraPath(1ull << 30, 1ull << 30);
+    for (const auto& change : stats.log)
+    {
+        CHECK(change.newMip < change.oldMip);
+    }
+}
+
+TEST(TextureResidency, PinnedMipsStayUnderZeroBudget)
+{
+    TextureResidency residency;
+    residency.Init(0, 1ull << 30);
+    uint32_t big = residency.Add(4096, 4096, 13, BYTES_PER_TEXEL);
+    uint32_t small = residency.Add(32, 32, 6, BYTES_PER_TEXEL);
+
+    // 4096 >> 6 == 64 is the first mip kept, a texture smaller than that keeps every mip
+    CHECK_EQ(residency.GetResidentMip(big), 6u);
+    CHECK_EQ(residency.GetResidentMip(small), 0u);
+
+    std::vector<TextureResidency::Change> changes;
+    residency.Request(big, 0);
+    residency.Update(changes);
+    CHECK(changes.empty());
+    CHECK_EQ(residency.GetResidentMip(big), 6u);
+    CHECK_EQ(residency.GetResidentSize(), TailSize(4096, 4096, 13, 6) + TailSize(32, 32, 6, 0));
+}
+
+TEST(TextureResidency, LeastRecentlyUsedEvictedFirst)
+{
+    TextureResidency residency;
+    const uint64_t full = TailSize(1024, 1024, 11, 0);
+    // Room for two textures at full resolution, plus the pinned mips of the third one
+    residency.Init(2 * full + TailSize(1024, 1024, 11, 4), 1ull << 30);
+    uint32_t a = residency.Add(1024, 1024, 11, BYTES_PER_TEXEL);
+    uint32_t b = residency.Add(1024, 1024, 11, BYTES_PER_TEXEL);
+    uint32_t c = residency.Add(1024, 1024, 11, BYTES_PER_TEXEL);
+
+    std::vector<TextureResidency::Change> changes;
+    residency.Request(a, 0);
+    residency.Update(changes);
+    residency.Request(b, 0);
+    residency.Update(changes);
+    CHECK_EQ(residency.GetResidentMip(a), 0u);
+    CHECK_EQ(residency.GetResidentMip(b), 0u);
+
+    // 'a' is the oldest one, it makes room for 'c' and 'b' keeps its mips
+    changes.clear();
+    residency.Request(c, 0);
+    residency.Update(changes);
+    CHECK_EQ(residency.GetResidentMip(c), 0u);
+    CHECK_EQ(residency.GetResidentMip(b), 0u);
+    CHECK(residency.GetResidentMip(a) > 0u);
+    CHECK(residency.GetResidentSize() <= residency.GetBudget());
+}
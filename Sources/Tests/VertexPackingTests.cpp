@@ -0,0 +1,189 @@
+#include "Test.h"
+#include <Common\VertexPacking.h>
+#include <cmath>
+#include <random>
+
+using namespace Engine;
+
+namespace
+{
+    // Largest angle between a unit vector and its octahedral encoding, in degrees. The snorm grid
+    // step is 1/32767 on the square, rounding is off by at most about 2 / 32767 radians on the sphere
+    constexpr float OCTAHEDRAL_MAX_ERROR = 0.005f;
+
+    // In double, the rounding of a float cosine near 1 alone is worth about 0.02 degrees
+    float AngleDegrees(const Vector3& a, const Vector3& b)
+    {
+        double la = std::sqrt((double)a.x * a.x + (double)a.y * a.y + (double)a.z * a.z);
+        double lb = std::sqrt((double)b.x * b.x + (double)b.y * b.y + (double)b.z * b.z);
+        double cosine = ((double)a.x * b.x + (double)a.y * b.y + (double)a.z * b.z) / (la * lb);
+        return static_cast<float>(std::acos(std::fmin(1.0, std::fmax(-1.0, cosine))) * 57.29577951308232);
+    }
+
+    Vector3 RoundTripOctahedral(const Vector3& v)
+    {
+        int16_t encoded[2];
+        EncodeOctahedral(v, encoded);
+        return DecodeOctahedral(encoded);
+    }
+}
+
+TEST(VertexPacking, HalfRoundTripsEveryFiniteValue)
+{
+    uint32_t mismatches = 0;
+    for (uint32_t h = 0; h < 0x10000; h++)
+    {
+        // Infinities and NaNs
+        if ((h & 0x7C00) == 0x7C00) continue;
+        if (FloatToHalf(HalfToFloat(static_cast<uint16_t>(h))) != h) mismatches++;
+    }
+    CHECK_EQ(mismatches, 0u);
+
+    CHECK_EQ(HalfToFloat(0x3C00), 1.f);
+    CHECK_EQ(HalfToFloat(0xC000), -2.f);
+    CHECK_EQ(HalfToFloat(0x7BFF), 65504.f);
+    CHECK(std::signbit(HalfToFloat(0x8000)));
+}
+
+TEST(VertexPacking, HalfOverflow)
+{
+    // 65520 is halfway between 65504 and the next half, which is infinity, the tie goes to the even one
+    CHECK_EQ(FloatToHalf(65504.f), 0x7BFF);
+    CHECK_EQ(FloatToHalf(65519.99f), 0x7BFF);
+    CHECK_EQ(FloatToHalf(65520.f), 0x7C00);
+    CHECK_EQ(FloatToHalf(-65520.f), 0xFC00);
+    CHECK_EQ(FloatToHalf(1e10f), 0x7C00);
+    CHECK_EQ(FloatToHalf(INFINITY), 0x7C00);
+    CHECK_EQ(FloatToHalf(-INFINITY), 0xFC00);
+
+    // NaN stays NaN
+    uint16_t nan = FloatToHalf(NAN);
+    CHECK_EQ(nan & 0x7C00, 0x7C00);
+    CHECK((nan & 0x3FF) != 0);
+    CHECK(std::isnan(HalfToFloat(nan)));
+    CHECK(std::isinf(HalfToFloat(0x7C00)));
+}
+
+TEST(VertexPacking, HalfSubnormals)
+{
+    const float ulp = std::ldexp(1.f, -24);
+    CHECK_EQ(FloatToHalf(ulp), 0x0001);
+    CHECK_EQ(FloatToHalf(-ulp), 0x8001);
+    CHECK_EQ(FloatToHalf(1023 * ulp), 0x03FF);
+    CHECK_EQ(FloatToHalf(std::ldexp(1.f, -14)), 0x0400);
+    CHECK_EQ(HalfToFloat(0x0001), ulp);
+    CHECK_EQ(HalfToFloat(0x03FF), 1023 * ulp);
+
+    // Ties go to the even multiple of 2^-24, up to the smallest normal
+    CHECK_EQ(FloatToHalf(0.5f * ulp), 0x0000);
+    CHECK_EQ(FloatToHalf(0.51f * ulp), 0x0001);
+    CHECK_EQ(FloatToHalf(1.5f * ulp), 0x0002);
+    CHECK_EQ(FloatToHalf(2.5f * ulp), 0x0002);
+    CHECK_EQ(FloatToHalf(1023.5f * ulp), 0x0400);
+    CHECK_EQ(FloatToHalf(std::ldexp(1.f, -30)), 0x0000);
+    CHECK(std::signbit(HalfToFloat(FloatToHalf(-std::ldexp(1.f, -30)))));
+
+    // Same for the normal halves, 2^-11 is half the step above 1
+    CHECK_EQ(FloatToHalf(1.f + std::ldexp(1.f, -11)), 0x3C00);
+    CHECK_EQ(FloatToHalf(1.f + 3 * std::ldexp(1.f, -11)), 0x3C02);
+}
+
+TEST(VertexPacking, OctahedralErrorBound)
+{
+    std::mt19937 rng(5);
+    std::normal_distribution<float> normal;
+
+    float maxError = 0.f;
+    for (uint32_t i = 0; i < 200000; i++)
+    {
+        Vector3 v(normal(rng), normal(rng), normal(rng));
+        float length = std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+        if (length < 1e-6f) continue;
+        v = Vector3(v.x / length, v.y / length, v.z / length);
+        maxError = std::fmax(maxError, AngleDegrees(v, RoundTripOctahedral(v)));
+    }
+    CHECK(maxError <= OCTAHEDRAL_MAX_ERROR);
+
+    // The axes and the fold of the lower hemisphere, whose corners are -Z
+    const Vector3 axes[] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+    for (const auto& axis : axes)
+    {
+        Vector3 decoded = RoundTripOctahedral(axis);
+        CHECK_NEAR(decoded.x, axis.x, 1e-6f);
+        CHECK_NEAR(decoded.y, axis.y, 1e-6f);
+        CHECK_NEAR(decoded.z, axis.z, 1e-6f);
+    }
+    const float d = 1.f / std::sqrt(2.f);
+    const Vector3 diagonals[] = { { d, 0, -d }, { -d, 0, -d }, { 0, d, -d }, { 0, -d, -d }, { 0.f, 1e-4f, -1.f } };
+    for (const auto& v : diagonals)
+    {
+        CHECK(AngleDegrees(v, RoundTripOctahedral(v)) <= OCTAHEDRAL_MAX_ERROR);
+    }
+
+    // A zero vector, e.g. a degenerate triangle, decodes to +Z
+    int16_t encoded[2];
+    EncodeOctahedral(Vector3(0.f, 0.f, 0.f), encoded);
+    CHECK_EQ(encoded[0], 0);
+    CHECK_EQ(encoded[1], 0);
+    Vector3 up = DecodeOctahedral(encoded);
+    CHECK_EQ(up.z, 1.f);
+}
+
+TEST(VertexPacking, PositionWithinHalfStep)
+{
+    const Vector3 center(12.f, -3.f, 40.f);
+    const Vector3 extent(50.f, 2.f, 30.f);
+    VertexQuantization q = VertexQuantization::FromBounds(center, extent);
+    CHECK_EQ(q.scale, 50.f);
+    // Half a snorm step plus the rounding of the float math
+    const float bound = 0.5f * q.scale / 32767.f + 1e-5f;
+
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+    VertexList vertices;
+    for (uint32_t i = 0; i < 50000; i++)
+    {
+        Vertex v;
+        v.position = Vector3(center.x + unit(rng) * extent.x, center.y + unit(rng) * extent.y,
+            center.z + unit(rng) * extent.z);
+        v.normal = Vector3(0.f, 1.f, 0.f);
+        v.texcoord = Vector2(0.f, 0.f);
+        vertices.push_back(v);
+    }
+    // The corners of the bounds
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        Vertex v = vertices[0];
+        v.position = Vector3(center.x + (i & 1 ? extent.x : -extent.x), center.y + (i & 2 ? extent.y : -extent.y),
+            center.z + (i & 4 ? extent.z : -extent.z));
+        vertices.push_back(v);
+    }
+
+    VertexPackedList packed = PackVertices(vertices, q);
+    VertexPackingError error = MeasurePackingError(vertices, packed, q);
+    CHECK(error.position <= bound);
+    CHECK(error.normal <= OCTAHEDRAL_MAX_ERROR);
+
+    // w is 1 so the dequantization folds in the model matrix
+    CHECK_EQ(packed[0].position[3], 32767);
+}
+
+TEST(VertexPacking, FlatBoundsKeepAScale)
+{
+    // A quad in the XZ plane, and a single point
+    VertexQuantization flat = VertexQuantization::FromBounds(Vector3(0.f, 5.f, 0.f), Vector3(2.f, 0.f, 1.f));
+    CHECK_EQ(flat.scale, 2.f);
+    VertexQuantization point = VertexQuantization::FromBounds(Vector3(1.f, 2.f, 3.f), Vector3(0.f, 0.f, 0.f));
+    CHECK_EQ(point.scale, 1.f);
+
+    Vertex v;
+    v.position = Vector3(1.f, 2.f, 3.f);
+    v.normal = Vector3(0.f, 0.f, 1.f);
+    v.texcoord = Vector2(0.25f, 0.75f);
+    Vertex unpacked = UnpackVertex(PackVertex(v, point), point);
+    CHECK_EQ(unpacked.position.x, 1.f);
+    CHECK_EQ(unpacked.position.y, 2.f);
+    CHECK_EQ(unpacked.position.z, 3.f);
+    CHECK_EQ(unpacked.texcoord.x, 0.25f);
+    CHECK_EQ(unpacked.texcoord.y, 0.75f);
+}
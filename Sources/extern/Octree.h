@@ -6,12 +6,15 @@
 
 #include "OctreeData.h"
 #include <vector>
+#include <cmath>
+#include <cassert>
+#include <cstdint>
 
 #define SPLIT_DIM(dim, i, k) dim * ((i & k) ? 0.5f : -0.5f)
 
 namespace otr
 {
-    bool IsPointInsideBox(const Vector3& p, const Vector3& bmin, const Vector3& bmax)
+    inline bool IsPointInsideBox(const Vector3& p, const Vector3& bmin, const Vector3& bmax)
     {
         if (p.x <= bmax.x && p.y <= bmax.y && p.z <= bmax.z &&
             p.x >= bmin.x && p.y >= bmin.y && p.z >= bmin.z)
@@ -19,7 +22,7 @@ namespace otr
         return false;
     }
 
-    bool IsIntersecting(const Vector3& amin, const Vector3& amax,
+    inline bool IsIntersecting(const Vector3& amin, const Vector3& amax,
         const Vector3& bmin, const Vector3& bmax)
     {
         if (amax.x >= bmin.x && amax.y >= bmin.y && amax.z >= bmin.z &&
@@ -28,6 +31,77 @@ namespace otr
         return false;
     }
 
+    // Plane in the form dot(normal, p) + d = 0. The normal points inside the frustum.
+    struct Plane
+    {
+        Vector3 normal;
+        float d;
+
+        Plane() : normal(0.f), d(0.f) { }
+
+        Plane(float a, float b, float c, float w)
+        {
+            float len = std::sqrt(a * a + b * b + c * c);
+            normal = Vector3(a / len, b / len, c / len);
+            d = w / len;
+        }
+    };
+
+    enum class Containment
+    {
+        OUTSIDE,
+        INTERSECTING,
+        INSIDE
+    };
+
+    struct Frustum
+    {
+        static constexpr int PLANE_COUNT = 6;
+        Plane planes[PLANE_COUNT];
+
+        /*
+         *  Extracts the planes from a column-major view-projection matrix
+         *  (m[4 * col + row]) with a [0, 1] clip depth range.
+         */
+        static Frustum FromMatrix(const float* m)
+        {
+            Frustum f;
+            f.planes[0] = Plane(m[3] + m[0], m[7] + m[4], m[11] + m[8], m[15] + m[12]); // left
+            f.planes[1] = Plane(m[3] - m[0], m[7] - m[4], m[11] - m[8], m[15] - m[12]); // right
+            f.planes[2] = Plane(m[3] + m[1], m[7] + m[5], m[11] + m[9], m[15] + m[13]); // bottom
+            f.planes[3] = Plane(m[3] - m[1], m[7] - m[5], m[11] - m[9], m[15] - m[13]); // top
+            f.planes[4] = Plane(m[2], m[6], m[10], m[14]);                              // near
+            f.planes[5] = Plane(m[3] - m[2], m[7] - m[6], m[11] - m[10], m[15] - m[14]); // far
+            return f;
+        }
+
+        Containment Classify(const Vector3& center, const Vector3& extent) const
+        {
+            Containment result = Containment::INSIDE;
+            for (const auto& p : planes)
+            {
+                float dist = p.normal.x * center.x + p.normal.y * center.y + p.normal.z * center.z + p.d;
+                float radius = std::fabs(p.normal.x) * extent.x + std::fabs(p.normal.y) * extent.y
+                    + std::fabs(p.normal.z) * extent.z;
+
+                if (dist + radius < 0.f)
+                    return Containment::OUTSIDE;
+                if (dist - radius < 0.f)
+                    result = Containment::INTERSECTING;
+            }
+            return result;
+        }
+    };
+
+    /*
+     *  Loose octree. Every node covers its tight bounds (origin +- extent) scaled by LOOSENESS,
+     *  so data is pushed down to the deepest child whose loose bounds fully contain its box.
+     *  Data which doesn't fit any child stays in the node.
+     *  Every data keeps a back-pointer to its node so it can be removed or relocated in O(depth).
+     *  Leaves hold up to 'bucketSize' data before splitting and nodes at 'maxDepth' never split,
+     *  so coincident data can't make the tree recurse forever.
+     *  Nodes whose subtree drops below the bucket size are collapsed lazily, on the next insertion into them.
+     */
     template<typename T = void>
     class Octree
     {
@@ -41,11 +115,18 @@ namespace otr
          *  z: - + - + - + - +
          */
 
-        static Octree<T>* New(const Vector3& origin, const Vector3& extent)
+        static constexpr float LOOSENESS = 2.f;
+        static constexpr uint32_t DEFAULT_BUCKET_SIZE = 8;
+        static constexpr uint32_t DEFAULT_MAX_DEPTH = 16;
+
+        static Octree<T>* New(const Vector3& origin, const Vector3& extent,
+            uint32_t bucketSize = DEFAULT_BUCKET_SIZE, uint32_t maxDepth = DEFAULT_MAX_DEPTH)
         {
             Octree<T>* octree = mAllocator.newElement();
             octree->mOrigin = origin;
             octree->mExtent = extent;
+            octree->mBucketSize = bucketSize > 0 ? bucketSize : 1;
+            octree->mMaxDepth = maxDepth;
             return octree;
         }
 
@@ -59,10 +140,11 @@ namespace otr
                 }
                 child = nullptr;
             }
-            if (mData)
+            while (mData)
             {
+                OctreeData<T>* next = mData->mNext;
                 mData->Delete();
-                mData = nullptr;
+                mData = next;
             }
             mAllocator.deleteElement(this);
         }
@@ -81,76 +163,304 @@ namespace otr
             return mChild[0] == nullptr;
         }
 
-        void Insert(OctreeData<T>* dataPoint)
+        // True if no data is stored in this node or its children
+        bool IsEmpty() const
         {
-            if (IsLeaf())
+            return mCount == 0;
+        }
+
+        // Number of data stored in this node and its children
+        size_t Size() const
+        {
+            return mCount;
+        }
+
+        // Number of nodes in this subtree, this node included
+        size_t GetNodeCount() const
+        {
+            size_t count = 1;
+            if (!IsLeaf())
             {
-                if (mData == nullptr)
+                for (int i = 0; i < OCT_SIZE; ++i)
                 {
-                    mData = dataPoint;
+                    count += mChild[i]->GetNodeCount();
                 }
-                else
-                {
-                    OctreeData<T>* oldPoint = mData;
-                    mData = nullptr;
+            }
+            return count;
+        }
 
-                    for (int i = 0; i < OCT_SIZE; ++i)
-                    {
-                        Vector3 newOrig = mOrigin;
-                        newOrig.x += SPLIT_DIM(mExtent.x, i, 4);
-                        newOrig.y += SPLIT_DIM(mExtent.y, i, 2);
-                        newOrig.z += SPLIT_DIM(mExtent.z, i, 1);
-                        mChild[i] = Octree::New(newOrig, mExtent * 0.5f);
-                    }
+        // True if the loose bounds of this node fully contain the data box
+        bool Fits(const OctreeData<T>* dataBox) const
+        {
+            Vector3 slack = mExtent * (LOOSENESS - 1.f);
+            return IsPointInsideBox(dataBox->mPosition, mOrigin - mExtent, mOrigin + mExtent) &&
+                dataBox->mExtent.x <= slack.x &&
+                dataBox->mExtent.y <= slack.y &&
+                dataBox->mExtent.z <= slack.z;
+        }
+
+        void Insert(OctreeData<T>* dataBox)
+        {
+            if (!IsLeaf() && mCount < mBucketSize)
+            {
+                Collapse();
+            }
+            ++mCount;
 
-                    mChild[GetOctantContainingPoint(oldPoint->mPosition)]->Insert(oldPoint);
-                    mChild[GetOctantContainingPoint(dataPoint->mPosition)]->Insert(dataPoint);
+            if (IsLeaf())
+            {
+                if (mCount <= mBucketSize || mDepth >= mMaxDepth)
+                {
+                    PushData(dataBox);
+                    return;
                 }
+                Split();
+            }
+
+            Octree<T>* child = mChild[GetOctantContainingPoint(dataBox->mPosition)];
+            if (child->Fits(dataBox))
+            {
+                child->Insert(dataBox);
             }
             else
             {
-                mChild[GetOctantContainingPoint(dataPoint->mPosition)]->Insert(dataPoint);
+                PushData(dataBox);
             }
         }
-        
-        void GetPointsInsideBox(const Vector3& bmin, const Vector3& bmax,
-            std::vector<OctreeData<T>*>& points) const
+
+        // Unlinks the data from its node. The data is not deleted.
+        static void Remove(OctreeData<T>* dataBox)
         {
-            if (IsLeaf())
+            Octree<T>* node = dataBox->mNode;
+            assert(node != nullptr);
+            node->UnlinkData(dataBox);
+
+            for (; node != nullptr; node = node->mParent)
+            {
+                --node->mCount;
+            }
+        }
+
+        // Updates the data box and moves it to the node which should hold it now
+        static void Relocate(OctreeData<T>* dataBox, const Vector3& position, const Vector3& extent)
+        {
+            Octree<T>* node = dataBox->mNode;
+            assert(node != nullptr);
+            dataBox->mPosition = position;
+            dataBox->mExtent = extent;
+
+            if (node->IsBestFit(dataBox))
+                return;
+
+            Remove(dataBox);
+
+            // Go up until a node can hold the data. The root holds everything.
+            Octree<T>* target = node;
+            while (target->mParent && !target->Fits(dataBox))
             {
-                if (mData != nullptr && IsPointInsideBox(mData->mPosition, bmin, bmax))
+                target = target->mParent;
+            }
+
+            for (Octree<T>* p = target->mParent; p != nullptr; p = p->mParent)
+            {
+                ++p->mCount;
+            }
+            target->Insert(dataBox);
+        }
+
+        void GetDataInsideBox(const Vector3& bmin, const Vector3& bmax,
+            std::vector<OctreeData<T>*>& result) const
+        {
+            for (OctreeData<T>* d = mData; d != nullptr; d = d->mNext)
+            {
+                if (IsIntersecting(d->mPosition - d->mExtent, d->mPosition + d->mExtent, bmin, bmax))
                 {
-                    points.push_back(mData);
+                    result.push_back(d);
                 }
             }
-            else
+
+            if (!IsLeaf())
             {
                 for (int i = 0; i < OCT_SIZE; ++i)
                 {
-                    Vector3 cmax = mChild[i]->mOrigin + mChild[i]->mExtent;
-                    Vector3 cmin = mChild[i]->mOrigin - mChild[i]->mExtent;
-                    
+                    if (mChild[i]->IsEmpty())
+                        continue;
+
+                    Vector3 loose = mChild[i]->mExtent * LOOSENESS;
+                    Vector3 cmax = mChild[i]->mOrigin + loose;
+                    Vector3 cmin = mChild[i]->mOrigin - loose;
+
                     if (IsIntersecting(cmin, cmax, bmin, bmax))
                     {
-                        mChild[i]->GetPointsInsideBox(bmin, bmax, points);
+                        mChild[i]->GetDataInsideBox(bmin, bmax, result);
                     }
                 }
             }
         }
+
+        void GetDataInsideFrustum(const Frustum& frustum, std::vector<OctreeData<T>*>& result) const
+        {
+            for (OctreeData<T>* d = mData; d != nullptr; d = d->mNext)
+            {
+                if (frustum.Classify(d->mPosition, d->mExtent) != Containment::OUTSIDE)
+                {
+                    result.push_back(d);
+                }
+            }
+
+            if (!IsLeaf())
+            {
+                for (int i = 0; i < OCT_SIZE; ++i)
+                {
+                    if (mChild[i]->IsEmpty())
+                        continue;
+
+                    Containment c = frustum.Classify(mChild[i]->mOrigin, mChild[i]->mExtent * LOOSENESS);
+                    if (c == Containment::INSIDE)
+                    {
+                        mChild[i]->GetAllData(result);
+                    }
+                    else if (c == Containment::INTERSECTING)
+                    {
+                        mChild[i]->GetDataInsideFrustum(frustum, result);
+                    }
+                }
+            }
+        }
+
+        void GetAllData(std::vector<OctreeData<T>*>& result) const
+        {
+            for (OctreeData<T>* d = mData; d != nullptr; d = d->mNext)
+            {
+                result.push_back(d);
+            }
+
+            if (!IsLeaf())
+            {
+                for (int i = 0; i < OCT_SIZE; ++i)
+                {
+                    if (!mChild[i]->IsEmpty())
+                        mChild[i]->GetAllData(result);
+                }
+            }
+        }
+
     private:
-        Octree() : mData(nullptr)
+        Octree() : mParent(nullptr), mData(nullptr), mCount(0), mDepth(0)
         {
             for (auto& child : mChild)
                 child = nullptr;
         }
 
+        void PushData(OctreeData<T>* dataBox)
+        {
+            dataBox->mPrev = nullptr;
+            dataBox->mNext = mData;
+            if (mData)
+                mData->mPrev = dataBox;
+            mData = dataBox;
+            dataBox->mNode = this;
+        }
+
+        void UnlinkData(OctreeData<T>* dataBox)
+        {
+            if (dataBox->mPrev)
+                dataBox->mPrev->mNext = dataBox->mNext;
+            else
+                mData = dataBox->mNext;
+
+            if (dataBox->mNext)
+                dataBox->mNext->mPrev = dataBox->mPrev;
+
+            dataBox->mPrev = nullptr;
+            dataBox->mNext = nullptr;
+            dataBox->mNode = nullptr;
+        }
+
+        // True if the data would be inserted in this node if it were inserted from the root
+        bool IsBestFit(const OctreeData<T>* dataBox) const
+        {
+            if (mParent && !Fits(dataBox))
+                return false;
+            if (IsLeaf())
+                return true;
+            return !mChild[GetOctantContainingPoint(dataBox->mPosition)]->Fits(dataBox);
+        }
+
+        // Moves the data of the children into this node and frees them
+        void Collapse()
+        {
+            for (auto& child : mChild)
+            {
+                child->MoveDataTo(this);
+                child->Delete();
+                child = nullptr;
+            }
+        }
+
+        void MoveDataTo(Octree<T>* node)
+        {
+            while (mData)
+            {
+                OctreeData<T>* next = mData->mNext;
+                node->PushData(mData);
+                mData = next;
+            }
+
+            if (!IsLeaf())
+            {
+                for (int i = 0; i < OCT_SIZE; ++i)
+                {
+                    mChild[i]->MoveDataTo(node);
+                }
+            }
+        }
+
+        void Split()
+        {
+            for (int i = 0; i < OCT_SIZE; ++i)
+            {
+                Vector3 newOrig = mOrigin;
+                newOrig.x += SPLIT_DIM(mExtent.x, i, 4);
+                newOrig.y += SPLIT_DIM(mExtent.y, i, 2);
+                newOrig.z += SPLIT_DIM(mExtent.z, i, 1);
+                mChild[i] = Octree::New(newOrig, mExtent * 0.5f, mBucketSize, mMaxDepth);
+                mChild[i]->mParent = this;
+                mChild[i]->mDepth = mDepth + 1;
+            }
+
+            // Push the data we hold down to the children if it fits
+            OctreeData<T>* oldData = mData;
+            mData = nullptr;
+
+            while (oldData)
+            {
+                OctreeData<T>* next = oldData->mNext;
+                Octree<T>* child = mChild[GetOctantContainingPoint(oldData->mPosition)];
+                if (child->Fits(oldData))
+                {
+                    child->Insert(oldData);
+                }
+                else
+                {
+                    PushData(oldData);
+                }
+                oldData = next;
+            }
+        }
+
         static constexpr int OCT_SIZE = 8;
 
         Vector3 mOrigin; // center of this octree
-        Vector3 mExtent; // half the dimension
+        Vector3 mExtent; // half the dimension (tight bounds)
 
+        Octree<T>* mParent;
         Octree<T>* mChild[OCT_SIZE];
-        OctreeData<T>* mData;
+        OctreeData<T>* mData; // list of data stored in this node
+        size_t mCount; // number of data stored in this node and its children
+        uint32_t mDepth; // 0 for the root
+        uint32_t mBucketSize; // max data held by a leaf before it splits
+        uint32_t mMaxDepth; // nodes at this depth never split
 
         static MemoryPool<Octree<T>> mAllocator;
     };
@@ -161,4 +471,4 @@ namespace otr
 #endif
 
 #undef SPLIT_DIM
-}
\ No newline at end of file
+}
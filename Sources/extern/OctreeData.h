@@ -9,23 +9,43 @@
 
 namespace otr
 {
+    template<typename T> class Octree;
+
     template<typename T = void>
     class OctreeData
     {
         friend class MemoryPool<OctreeData<T>>;
+        friend class Octree<T>;
     public:
+        // Center of the world-space bounding box
         Vector3 mPosition;
-        // Custom user-data associated with this point
+        // Half the dimension of the world-space bounding box
+        Vector3 mExtent;
+        // Custom user-data associated with this box
         T* mData;
+        // Next data stored in the same octree node
+        OctreeData<T>* mNext;
 
-        static OctreeData<T>* New(const Vector3& position, T* data = nullptr)
+        // Octree node currently holding this data, null if not inserted
+        Octree<T>* GetNode() const { return mNode; }
+
+        static OctreeData<T>* New(const Vector3& position, const Vector3& extent, T* data = nullptr)
         {
             OctreeData<T>* node = mAllocator.newElement();
             node->mPosition = position;
+            node->mExtent = extent;
             node->mData = data;
+            node->mNext = nullptr;
+            node->mPrev = nullptr;
+            node->mNode = nullptr;
             return node;
         }
 
+        static OctreeData<T>* New(const Vector3& position, T* data = nullptr)
+        {
+            return New(position, Vector3(0.f), data);
+        }
+
         void Delete()
         {
             mAllocator.deleteElement(this);
@@ -33,6 +53,10 @@ namespace otr
 
     private:
         OctreeData() { }
+
+        OctreeData<T>* mPrev;
+        Octree<T>* mNode;
+
         static MemoryPool<OctreeData<T>> mAllocator;
     };
 
@@ -40,4 +64,4 @@ namespace otr
     template<typename T>
     MemoryPool<OctreeData<T>> OctreeData<T>::mAllocator;
 #endif
-}
\ No newline at end of file
+}
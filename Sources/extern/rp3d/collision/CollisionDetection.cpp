@@ -746,6 +746,94 @@ void CollisionDetection::testOverlap(CollisionBody* body, OverlapCallback* overl
     }
 }
 
+// Report all the pairs of proxy shapes of the world that overlap
+void CollisionDetection::testOverlap(OverlappingPairCallback* callback) {
+
+    assert(callback != nullptr);
+
+    RP3D_PROFILE("CollisionDetection::testOverlap()", mProfiler);
+
+    // Compute the broad-phase collision detection. Only the shapes that have moved
+    // are tested against the dynamic AABB tree to find the new overlapping pairs.
+    computeBroadPhase();
+
+    // For each possible collision pair of bodies
+    Map<Pair<uint, uint>, OverlappingPair*>::Iterator it;
+    for (it = mOverlappingPairs.begin(); it != mOverlappingPairs.end(); ) {
+
+        OverlappingPair* originalPair = it->second;
+        ProxyShape* shape1 = originalPair->getShape1();
+        ProxyShape* shape2 = originalPair->getShape2();
+
+        // Check if the two shapes are still overlapping. Otherwise, we destroy the
+        // overlapping pair
+        if (!mBroadPhaseAlgorithm.testOverlappingShapes(shape1, shape2)) {
+
+            // Destroy the overlapping pair
+            it->second->~OverlappingPair();
+
+            mWorld->mMemoryManager.release(MemoryManager::AllocationType::Pool, it->second, sizeof(OverlappingPair));
+            it = mOverlappingPairs.remove(it);
+            continue;
+        }
+        else {
+            ++it;
+        }
+
+        // Check if the collision filtering allows collision between the two shapes
+        if ((shape1->getCollideWithMaskBits() & shape2->getCollisionCategoryBits()) == 0 ||
+            (shape1->getCollisionCategoryBits() & shape2->getCollideWithMaskBits()) == 0) continue;
+
+        // The AABBs of the pair may overlap only because they are fat
+        if (!shape1->getWorldAABB().testCollision(shape2->getWorldAABB())) continue;
+
+        // Create a new overlapping pair so that we do not work on the original one
+        OverlappingPair pair(shape1, shape2, mMemoryManager.getPoolAllocator(),
+                             mMemoryManager.getPoolAllocator(), mWorld->mConfig);
+
+        // Compute the middle-phase collision detection between the two shapes
+        NarrowPhaseInfo* narrowPhaseInfo = computeMiddlePhaseForProxyShapes(&pair);
+
+        bool isOverlapping = false;
+
+        // For each narrow-phase info object
+        while (narrowPhaseInfo != nullptr) {
+
+            // If we have not found an overlap yet
+            if (!isOverlapping) {
+
+                const CollisionShapeType shape1Type = narrowPhaseInfo->collisionShape1->getType();
+                const CollisionShapeType shape2Type = narrowPhaseInfo->collisionShape2->getType();
+
+                // Select the narrow phase algorithm to use according to the two collision shapes
+                NarrowPhaseAlgorithm* narrowPhaseAlgorithm = selectNarrowPhaseAlgorithm(shape1Type, shape2Type);
+
+                // If there is a collision algorithm for those two kinds of shapes
+                if (narrowPhaseAlgorithm != nullptr) {
+
+                    // Use the narrow-phase collision detection algorithm to check
+                    // if there really is an overlap, without computing the contacts
+                    isOverlapping |= narrowPhaseAlgorithm->testCollision(narrowPhaseInfo, false, mMemoryManager.getPoolAllocator());
+                }
+            }
+
+            NarrowPhaseInfo* currentNarrowPhaseInfo = narrowPhaseInfo;
+            narrowPhaseInfo = narrowPhaseInfo->next;
+
+            // Call the destructor
+            currentNarrowPhaseInfo->~NarrowPhaseInfo();
+
+            // Release the allocated memory
+            mMemoryManager.release(MemoryManager::AllocationType::Pool, currentNarrowPhaseInfo, sizeof(NarrowPhaseInfo));
+        }
+
+        // Report the overlapping pair to the user
+        if (isOverlapping) {
+            callback->notifyOverlappingPair(shape1, shape2);
+        }
+    }
+}
+
 // Test and report collisions between two bodies
 void CollisionDetection::testCollision(CollisionBody* body1, CollisionBody* body2, CollisionCallback* collisionCallback) {
 
@@ -42,6 +42,7 @@ namespace reactphysics3d {
 class CollisionWorld;
 class CollisionCallback;
 class OverlapCallback;
+class OverlappingPairCallback;
 class RaycastCallback;
 class ContactPoint;
 class MemoryManager;
@@ -196,6 +197,9 @@ class CollisionDetection {
         /// Report all the bodies that overlap with the body in parameter
         void testOverlap(CollisionBody* body, OverlapCallback* overlapCallback, unsigned short categoryMaskBits = 0xFFFF);
 
+        /// Report all the pairs of proxy shapes of the world that overlap
+        void testOverlap(OverlappingPairCallback* callback);
+
         /// Test and report collisions between two bodies
         void testCollision(CollisionBody* body1, CollisionBody* body2, CollisionCallback* callback);
 
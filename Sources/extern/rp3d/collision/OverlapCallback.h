@@ -31,6 +31,7 @@ namespace reactphysics3d {
 
 // Declarations
 class CollisionBody;
+class ProxyShape;
 
 // Class OverlapCallback
 /**
@@ -52,6 +53,26 @@ class OverlapCallback {
         virtual void notifyOverlap(CollisionBody* collisionBody)=0;
 };
 
+// Class OverlappingPairCallback
+/**
+ * This class can be used to get all the pairs of proxy shapes of the world
+ * that overlap. You should implement your own class inherited from this one
+ * and implement the notifyOverlappingPair() method. The world must not be
+ * modified from this method.
+ */
+class OverlappingPairCallback {
+
+    public:
+
+        /// Destructor
+        virtual ~OverlappingPairCallback() {
+
+        }
+
+        /// This method will be called for each pair of overlapping proxy shapes
+        virtual void notifyOverlappingPair(ProxyShape* shape1, ProxyShape* shape2)=0;
+};
+
 }
 
 #endif
@@ -47,6 +47,7 @@ class CollisionBody;
 struct RaycastInfo;
 class CollisionCallback;
 class OverlapCallback;
+class OverlappingPairCallback;
 
 // Class CollisionWorld
 /**
@@ -156,6 +157,9 @@ class CollisionWorld {
         /// Report all the bodies that overlap with the body in parameter
         void testOverlap(CollisionBody* body, OverlapCallback* overlapCallback, unsigned short categoryMaskBits = 0xFFFF);
 
+        /// Report all the pairs of proxy shapes of the world that overlap
+        void testOverlap(OverlappingPairCallback* callback);
+
         /// Test and report collisions between two bodies
         void testCollision(CollisionBody* body1, CollisionBody* body2, CollisionCallback* callback);
 
@@ -255,6 +259,17 @@ inline void CollisionWorld::testOverlap(CollisionBody* body, OverlapCallback* ov
     mCollisionDetection.testOverlap(body, overlapCallback, categoryMaskBits);
 }
 
+// Report all the pairs of proxy shapes of the world that overlap
+/// The pairs come from the overlapping pairs of the broad-phase, so only the
+/// shapes that have moved are tested against the dynamic AABB tree and only the
+/// pairs with overlapping AABBs go through the narrow-phase.
+/**
+ * @param callback Pointer to the object with the callback method to report the pairs
+ */
+inline void CollisionWorld::testOverlap(OverlappingPairCallback* callback) {
+    mCollisionDetection.testOverlap(callback);
+}
+
 // Return the name of the world
 /**
  * @return Name of the world
@@ -44,7 +44,8 @@ const decimal ContactSolver::SLOP = decimal(0.01);
 ContactSolver::ContactSolver(MemoryManager& memoryManager, const WorldSettings& worldSettings)
               :mMemoryManager(memoryManager), mSplitLinearVelocities(nullptr),
                mSplitAngularVelocities(nullptr), mContactConstraints(nullptr),
-               mContactPoints(nullptr), mLinearVelocities(nullptr), mAngularVelocities(nullptr),
+               mContactPoints(nullptr), mIslandContacts(nullptr), mNbIslands(0), mStaticVelocityIndex(0),
+               mLinearVelocities(nullptr), mAngularVelocities(nullptr),
                mIsSplitImpulseActive(true), mWorldSettings(worldSettings) {
 
 #ifdef IS_PROFILING_ACTIVE
@@ -54,64 +55,79 @@ ContactSolver::ContactSolver(MemoryManager& memoryManager, const WorldSettings&
 }
 
 // Initialize the contact constraints
-void ContactSolver::init(Island** islands, uint nbIslands, decimal timeStep) {
+/// This only computes where the contacts of each island go in the solver
+/// arrays, the islands are then initialized with initializeForIsland().
+/**
+ * @param staticVelocityIndex Index of the zero velocity slot of the first island.
+ *                            Island i uses the slot staticVelocityIndex + i for its
+ *                            static bodies so that islands never write the same slot.
+ */
+void ContactSolver::init(Island** islands, uint nbIslands, decimal timeStep, uint staticVelocityIndex) {
 
     RP3D_PROFILE("ContactSolver::init()", mProfiler);
 
     mTimeStep = timeStep;
-
-    // TODO : Try not to count manifolds and contact points here
-    uint nbContactManifolds = 0;
-    uint nbContactPoints = 0;
-    for (uint i = 0; i < nbIslands; i++) {
-        uint nbManifoldsInIsland = islands[i]->getNbContactManifolds();
-        nbContactManifolds += nbManifoldsInIsland;
-
-        for (uint j=0; j < nbManifoldsInIsland; j++) {
-            nbContactPoints += islands[i]->getContactManifolds()[j]->getNbContactPoints();
-        }
-    }
+    mNbIslands = nbIslands;
+    mStaticVelocityIndex = staticVelocityIndex;
 
     mNbContactManifolds = 0;
     mNbContactPoints = 0;
 
     mContactConstraints = nullptr;
     mContactPoints = nullptr;
+    mIslandContacts = nullptr;
 
-    if (nbContactManifolds == 0 || nbContactPoints == 0) return;
+    if (nbIslands == 0) return;
 
-    // TODO : Count exactly the number of constraints to allocate here
-    mContactPoints = static_cast<ContactPointSolver*>(mMemoryManager.allocate(MemoryManager::AllocationType::Frame,
-                                                                              sizeof(ContactPointSolver) * nbContactPoints));
-    assert(mContactPoints != nullptr);
+    mIslandContacts = static_cast<IslandContacts*>(mMemoryManager.allocate(MemoryManager::AllocationType::Frame,
+                                                                           sizeof(IslandContacts) * nbIslands));
+    assert(mIslandContacts != nullptr);
 
-    mContactConstraints = static_cast<ContactManifoldSolver*>(mMemoryManager.allocate(MemoryManager::AllocationType::Frame,
-                                                                                      sizeof(ContactManifoldSolver) * nbContactManifolds));
-    assert(mContactConstraints != nullptr);
+    // Count the contact manifolds and contact points of each island
+    for (uint i = 0; i < nbIslands; i++) {
+        uint nbManifoldsInIsland = islands[i]->getNbContactManifolds();
+
+        mIslandContacts[i].firstManifold = mNbContactManifolds;
+        mIslandContacts[i].nbManifolds = nbManifoldsInIsland;
+        mIslandContacts[i].firstContactPoint = mNbContactPoints;
 
-    // For each island of the world
-    for (uint islandIndex = 0; islandIndex < nbIslands; islandIndex++) {
+        mNbContactManifolds += nbManifoldsInIsland;
 
-        if (islands[islandIndex]->getNbContactManifolds() > 0) {
-            initializeForIsland(islands[islandIndex]);
+        for (uint j=0; j < nbManifoldsInIsland; j++) {
+            mNbContactPoints += islands[i]->getContactManifolds()[j]->getNbContactPoints();
         }
     }
 
-    // Warmstarting
-    warmStart();
+    if (mNbContactManifolds == 0 || mNbContactPoints == 0) return;
+
+    mContactPoints = static_cast<ContactPointSolver*>(mMemoryManager.allocate(MemoryManager::AllocationType::Frame,
+                                                                              sizeof(ContactPointSolver) * mNbContactPoints));
+    assert(mContactPoints != nullptr);
+
+    mContactConstraints = static_cast<ContactManifoldSolver*>(mMemoryManager.allocate(MemoryManager::AllocationType::Frame,
+                                                                                      sizeof(ContactManifoldSolver) * mNbContactManifolds));
+    assert(mContactConstraints != nullptr);
 }
 
 // Initialize the constraint solver for a given island
-void ContactSolver::initializeForIsland(Island* island) {
-
-    RP3D_PROFILE("ContactSolver::initializeForIsland()", mProfiler);
+/// Each island writes its own range of the solver arrays, so this can be
+/// called for different islands at the same time.
+void ContactSolver::initializeForIsland(Island* island, uint islandIndex) {
 
     assert(island != nullptr);
     assert(island->getNbBodies() > 0);
-    assert(island->getNbContactManifolds() > 0);
+    assert(islandIndex < mNbIslands);
     assert(mSplitLinearVelocities != nullptr);
     assert(mSplitAngularVelocities != nullptr);
 
+    if (island->getNbContactManifolds() == 0) return;
+
+    // Slot of the static bodies of the island in the velocity arrays
+    const uint staticVelocityIndex = mStaticVelocityIndex + islandIndex;
+
+    uint manifoldIndex = mIslandContacts[islandIndex].firstManifold;
+    uint contactPointIndex = mIslandContacts[islandIndex].firstContactPoint;
+
     // For each contact manifold of the island
     ContactManifold** contactManifolds = island->getContactManifolds();
     for (uint i=0; i<island->getNbContactManifolds(); i++) {
@@ -136,26 +152,30 @@ void ContactSolver::initializeForIsland(Island* island) {
 
         // Initialize the internal contact manifold structure using the external
         // contact manifold
-        new (mContactConstraints + mNbContactManifolds) ContactManifoldSolver();
-        mContactConstraints[mNbContactManifolds].indexBody1 = body1->mArrayIndex;
-        mContactConstraints[mNbContactManifolds].indexBody2 = body2->mArrayIndex;
-        mContactConstraints[mNbContactManifolds].inverseInertiaTensorBody1 = body1->getInertiaTensorInverseWorld();
-        mContactConstraints[mNbContactManifolds].inverseInertiaTensorBody2 = body2->getInertiaTensorInverseWorld();
-        mContactConstraints[mNbContactManifolds].massInverseBody1 = body1->mMassInverse;
-        mContactConstraints[mNbContactManifolds].massInverseBody2 = body2->mMassInverse;
-        mContactConstraints[mNbContactManifolds].nbContacts = externalManifold->getNbContactPoints();
-        mContactConstraints[mNbContactManifolds].frictionCoefficient = computeMixedFrictionCoefficient(body1, body2);
-        mContactConstraints[mNbContactManifolds].rollingResistanceFactor = computeMixedRollingResistance(body1, body2);
-        mContactConstraints[mNbContactManifolds].externalContactManifold = externalManifold;
-        mContactConstraints[mNbContactManifolds].normal.setToZero();
-        mContactConstraints[mNbContactManifolds].frictionPointBody1.setToZero();
-        mContactConstraints[mNbContactManifolds].frictionPointBody2.setToZero();
+        new (mContactConstraints + manifoldIndex) ContactManifoldSolver();
+        // A static body can be in several islands, its impulses are always zero
+        // so it reads and writes the island's own zero velocity slot
+        mContactConstraints[manifoldIndex].indexBody1 = body1->getType() == BodyType::STATIC ?
+                                                        staticVelocityIndex : body1->mArrayIndex;
+        mContactConstraints[manifoldIndex].indexBody2 = body2->getType() == BodyType::STATIC ?
+                                                        staticVelocityIndex : body2->mArrayIndex;
+        mContactConstraints[manifoldIndex].inverseInertiaTensorBody1 = body1->getInertiaTensorInverseWorld();
+        mContactConstraints[manifoldIndex].inverseInertiaTensorBody2 = body2->getInertiaTensorInverseWorld();
+        mContactConstraints[manifoldIndex].massInverseBody1 = body1->mMassInverse;
+        mContactConstraints[manifoldIndex].massInverseBody2 = body2->mMassInverse;
+        mContactConstraints[manifoldIndex].nbContacts = externalManifold->getNbContactPoints();
+        mContactConstraints[manifoldIndex].frictionCoefficient = computeMixedFrictionCoefficient(body1, body2);
+        mContactConstraints[manifoldIndex].rollingResistanceFactor = computeMixedRollingResistance(body1, body2);
+        mContactConstraints[manifoldIndex].externalContactManifold = externalManifold;
+        mContactConstraints[manifoldIndex].normal.setToZero();
+        mContactConstraints[manifoldIndex].frictionPointBody1.setToZero();
+        mContactConstraints[manifoldIndex].frictionPointBody2.setToZero();
 
         // Get the velocities of the bodies
-        const Vector3& v1 = mLinearVelocities[mContactConstraints[mNbContactManifolds].indexBody1];
-        const Vector3& w1 = mAngularVelocities[mContactConstraints[mNbContactManifolds].indexBody1];
-        const Vector3& v2 = mLinearVelocities[mContactConstraints[mNbContactManifolds].indexBody2];
-        const Vector3& w2 = mAngularVelocities[mContactConstraints[mNbContactManifolds].indexBody2];
+        const Vector3& v1 = mLinearVelocities[mContactConstraints[manifoldIndex].indexBody1];
+        const Vector3& w1 = mAngularVelocities[mContactConstraints[manifoldIndex].indexBody1];
+        const Vector3& v2 = mLinearVelocities[mContactConstraints[manifoldIndex].indexBody2];
+        const Vector3& w2 = mAngularVelocities[mContactConstraints[manifoldIndex].indexBody2];
 
         // For each  contact point of the contact manifold
         ContactPoint* externalContact = externalManifold->getContactPoints();
@@ -166,178 +186,179 @@ void ContactSolver::initializeForIsland(Island* island) {
             Vector3 p1 = shape1->getLocalToWorldTransform() * externalContact->getLocalPointOnShape1();
             Vector3 p2 = shape2->getLocalToWorldTransform() * externalContact->getLocalPointOnShape2();
 
-            new (mContactPoints + mNbContactPoints) ContactPointSolver();
-            mContactPoints[mNbContactPoints].externalContact = externalContact;
-            mContactPoints[mNbContactPoints].normal = externalContact->getNormal();
-            mContactPoints[mNbContactPoints].r1.x = p1.x - x1.x;
-            mContactPoints[mNbContactPoints].r1.y = p1.y - x1.y;
-            mContactPoints[mNbContactPoints].r1.z = p1.z - x1.z;
-            mContactPoints[mNbContactPoints].r2.x = p2.x - x2.x;
-            mContactPoints[mNbContactPoints].r2.y = p2.y - x2.y;
-            mContactPoints[mNbContactPoints].r2.z = p2.z - x2.z;
-            mContactPoints[mNbContactPoints].penetrationDepth = externalContact->getPenetrationDepth();
-            mContactPoints[mNbContactPoints].isRestingContact = externalContact->getIsRestingContact();
+            new (mContactPoints + contactPointIndex) ContactPointSolver();
+            mContactPoints[contactPointIndex].externalContact = externalContact;
+            mContactPoints[contactPointIndex].normal = externalContact->getNormal();
+            mContactPoints[contactPointIndex].r1.x = p1.x - x1.x;
+            mContactPoints[contactPointIndex].r1.y = p1.y - x1.y;
+            mContactPoints[contactPointIndex].r1.z = p1.z - x1.z;
+            mContactPoints[contactPointIndex].r2.x = p2.x - x2.x;
+            mContactPoints[contactPointIndex].r2.y = p2.y - x2.y;
+            mContactPoints[contactPointIndex].r2.z = p2.z - x2.z;
+            mContactPoints[contactPointIndex].penetrationDepth = externalContact->getPenetrationDepth();
+            mContactPoints[contactPointIndex].isRestingContact = externalContact->getIsRestingContact();
             externalContact->setIsRestingContact(true);
-            mContactPoints[mNbContactPoints].penetrationImpulse = externalContact->getPenetrationImpulse();
-            mContactPoints[mNbContactPoints].penetrationSplitImpulse = 0.0;
+            mContactPoints[contactPointIndex].penetrationImpulse = externalContact->getPenetrationImpulse();
+            mContactPoints[contactPointIndex].penetrationSplitImpulse = 0.0;
 
-            mContactConstraints[mNbContactManifolds].frictionPointBody1.x += p1.x;
-            mContactConstraints[mNbContactManifolds].frictionPointBody1.y += p1.y;
-            mContactConstraints[mNbContactManifolds].frictionPointBody1.z += p1.z;
-            mContactConstraints[mNbContactManifolds].frictionPointBody2.x += p2.x;
-            mContactConstraints[mNbContactManifolds].frictionPointBody2.y += p2.y;
-            mContactConstraints[mNbContactManifolds].frictionPointBody2.z += p2.z;
+            mContactConstraints[manifoldIndex].frictionPointBody1.x += p1.x;
+            mContactConstraints[manifoldIndex].frictionPointBody1.y += p1.y;
+            mContactConstraints[manifoldIndex].frictionPointBody1.z += p1.z;
+            mContactConstraints[manifoldIndex].frictionPointBody2.x += p2.x;
+            mContactConstraints[manifoldIndex].frictionPointBody2.y += p2.y;
+            mContactConstraints[manifoldIndex].frictionPointBody2.z += p2.z;
 
             // Compute the velocity difference
-            //deltaV = v2 + w2.cross(mContactPoints[mNbContactPoints].r2) - v1 - w1.cross(mContactPoints[mNbContactPoints].r1);
-            Vector3 deltaV(v2.x + w2.y * mContactPoints[mNbContactPoints].r2.z - w2.z * mContactPoints[mNbContactPoints].r2.y
-                           - v1.x - w1.y * mContactPoints[mNbContactPoints].r1.z - w1.z * mContactPoints[mNbContactPoints].r1.y,
-                           v2.y + w2.z * mContactPoints[mNbContactPoints].r2.x - w2.x * mContactPoints[mNbContactPoints].r2.z
-                           - v1.y - w1.z * mContactPoints[mNbContactPoints].r1.x - w1.x * mContactPoints[mNbContactPoints].r1.z,
-                           v2.z + w2.x * mContactPoints[mNbContactPoints].r2.y - w2.y * mContactPoints[mNbContactPoints].r2.x
-                           - v1.z - w1.x * mContactPoints[mNbContactPoints].r1.y - w1.y * mContactPoints[mNbContactPoints].r1.x);
-
-            // r1CrossN = mContactPoints[mNbContactPoints].r1.cross(mContactPoints[mNbContactPoints].normal);
-            Vector3 r1CrossN(mContactPoints[mNbContactPoints].r1.y * mContactPoints[mNbContactPoints].normal.z -
-                             mContactPoints[mNbContactPoints].r1.z * mContactPoints[mNbContactPoints].normal.y,
-                             mContactPoints[mNbContactPoints].r1.z * mContactPoints[mNbContactPoints].normal.x -
-                             mContactPoints[mNbContactPoints].r1.x * mContactPoints[mNbContactPoints].normal.z,
-                             mContactPoints[mNbContactPoints].r1.x * mContactPoints[mNbContactPoints].normal.y -
-                             mContactPoints[mNbContactPoints].r1.y * mContactPoints[mNbContactPoints].normal.x);
-            // r2CrossN = mContactPoints[mNbContactPoints].r2.cross(mContactPoints[mNbContactPoints].normal);
-            Vector3 r2CrossN(mContactPoints[mNbContactPoints].r2.y * mContactPoints[mNbContactPoints].normal.z -
-                             mContactPoints[mNbContactPoints].r2.z * mContactPoints[mNbContactPoints].normal.y,
-                             mContactPoints[mNbContactPoints].r2.z * mContactPoints[mNbContactPoints].normal.x -
-                             mContactPoints[mNbContactPoints].r2.x * mContactPoints[mNbContactPoints].normal.z,
-                             mContactPoints[mNbContactPoints].r2.x * mContactPoints[mNbContactPoints].normal.y -
-                             mContactPoints[mNbContactPoints].r2.y * mContactPoints[mNbContactPoints].normal.x);
-
-            mContactPoints[mNbContactPoints].i1TimesR1CrossN = mContactConstraints[mNbContactManifolds].inverseInertiaTensorBody1 * r1CrossN;
-            mContactPoints[mNbContactPoints].i2TimesR2CrossN = mContactConstraints[mNbContactManifolds].inverseInertiaTensorBody2 * r2CrossN;
+            //deltaV = v2 + w2.cross(mContactPoints[contactPointIndex].r2) - v1 - w1.cross(mContactPoints[contactPointIndex].r1);
+            Vector3 deltaV(v2.x + w2.y * mContactPoints[contactPointIndex].r2.z - w2.z * mContactPoints[contactPointIndex].r2.y
+                           - v1.x - w1.y * mContactPoints[contactPointIndex].r1.z - w1.z * mContactPoints[contactPointIndex].r1.y,
+                           v2.y + w2.z * mContactPoints[contactPointIndex].r2.x - w2.x * mContactPoints[contactPointIndex].r2.z
+                           - v1.y - w1.z * mContactPoints[contactPointIndex].r1.x - w1.x * mContactPoints[contactPointIndex].r1.z,
+                           v2.z + w2.x * mContactPoints[contactPointIndex].r2.y - w2.y * mContactPoints[contactPointIndex].r2.x
+                           - v1.z - w1.x * mContactPoints[contactPointIndex].r1.y - w1.y * mContactPoints[contactPointIndex].r1.x);
+
+            // r1CrossN = mContactPoints[contactPointIndex].r1.cross(mContactPoints[contactPointIndex].normal);
+            Vector3 r1CrossN(mContactPoints[contactPointIndex].r1.y * mContactPoints[contactPointIndex].normal.z -
+                             mContactPoints[contactPointIndex].r1.z * mContactPoints[contactPointIndex].normal.y,
+                             mContactPoints[contactPointIndex].r1.z * mContactPoints[contactPointIndex].normal.x -
+                             mContactPoints[contactPointIndex].r1.x * mContactPoints[contactPointIndex].normal.z,
+                             mContactPoints[contactPointIndex].r1.x * mContactPoints[contactPointIndex].normal.y -
+                             mContactPoints[contactPointIndex].r1.y * mContactPoints[contactPointIndex].normal.x);
+            // r2CrossN = mContactPoints[contactPointIndex].r2.cross(mContactPoints[contactPointIndex].normal);
+            Vector3 r2CrossN(mContactPoints[contactPointIndex].r2.y * mContactPoints[contactPointIndex].normal.z -
+                             mContactPoints[contactPointIndex].r2.z * mContactPoints[contactPointIndex].normal.y,
+                             mContactPoints[contactPointIndex].r2.z * mContactPoints[contactPointIndex].normal.x -
+                             mContactPoints[contactPointIndex].r2.x * mContactPoints[contactPointIndex].normal.z,
+                             mContactPoints[contactPointIndex].r2.x * mContactPoints[contactPointIndex].normal.y -
+                             mContactPoints[contactPointIndex].r2.y * mContactPoints[contactPointIndex].normal.x);
+
+            mContactPoints[contactPointIndex].i1TimesR1CrossN = mContactConstraints[manifoldIndex].inverseInertiaTensorBody1 * r1CrossN;
+            mContactPoints[contactPointIndex].i2TimesR2CrossN = mContactConstraints[manifoldIndex].inverseInertiaTensorBody2 * r2CrossN;
 
             // Compute the inverse mass matrix K for the penetration constraint
-            decimal massPenetration = mContactConstraints[mNbContactManifolds].massInverseBody1 + mContactConstraints[mNbContactManifolds].massInverseBody2 +
-                    ((mContactPoints[mNbContactPoints].i1TimesR1CrossN).cross(mContactPoints[mNbContactPoints].r1)).dot(mContactPoints[mNbContactPoints].normal) +
-                    ((mContactPoints[mNbContactPoints].i2TimesR2CrossN).cross(mContactPoints[mNbContactPoints].r2)).dot(mContactPoints[mNbContactPoints].normal);
-            mContactPoints[mNbContactPoints].inversePenetrationMass = massPenetration > decimal(0.0) ? decimal(1.0) / massPenetration : decimal(0.0);
+            decimal massPenetration = mContactConstraints[manifoldIndex].massInverseBody1 + mContactConstraints[manifoldIndex].massInverseBody2 +
+                    ((mContactPoints[contactPointIndex].i1TimesR1CrossN).cross(mContactPoints[contactPointIndex].r1)).dot(mContactPoints[contactPointIndex].normal) +
+                    ((mContactPoints[contactPointIndex].i2TimesR2CrossN).cross(mContactPoints[contactPointIndex].r2)).dot(mContactPoints[contactPointIndex].normal);
+            mContactPoints[contactPointIndex].inversePenetrationMass = massPenetration > decimal(0.0) ? decimal(1.0) / massPenetration : decimal(0.0);
 
             // Compute the restitution velocity bias "b". We compute this here instead
             // of inside the solve() method because we need to use the velocity difference
             // at the beginning of the contact. Note that if it is a resting contact (normal
             // velocity bellow a given threshold), we do not add a restitution velocity bias
-            mContactPoints[mNbContactPoints].restitutionBias = 0.0;
-            // deltaVDotN = deltaV.dot(mContactPoints[mNbContactPoints].normal);
-            decimal deltaVDotN = deltaV.x * mContactPoints[mNbContactPoints].normal.x +
-                                 deltaV.y * mContactPoints[mNbContactPoints].normal.y +
-                                 deltaV.z * mContactPoints[mNbContactPoints].normal.z;
+            mContactPoints[contactPointIndex].restitutionBias = 0.0;
+            // deltaVDotN = deltaV.dot(mContactPoints[contactPointIndex].normal);
+            decimal deltaVDotN = deltaV.x * mContactPoints[contactPointIndex].normal.x +
+                                 deltaV.y * mContactPoints[contactPointIndex].normal.y +
+                                 deltaV.z * mContactPoints[contactPointIndex].normal.z;
             const decimal restitutionFactor = computeMixedRestitutionFactor(body1, body2);
             if (deltaVDotN < -mWorldSettings.restitutionVelocityThreshold) {
-                mContactPoints[mNbContactPoints].restitutionBias = restitutionFactor * deltaVDotN;
+                mContactPoints[contactPointIndex].restitutionBias = restitutionFactor * deltaVDotN;
             }
 
-            mContactConstraints[mNbContactManifolds].normal.x += mContactPoints[mNbContactPoints].normal.x;
-            mContactConstraints[mNbContactManifolds].normal.y += mContactPoints[mNbContactPoints].normal.y;
-            mContactConstraints[mNbContactManifolds].normal.z += mContactPoints[mNbContactPoints].normal.z;
+            mContactConstraints[manifoldIndex].normal.x += mContactPoints[contactPointIndex].normal.x;
+            mContactConstraints[manifoldIndex].normal.y += mContactPoints[contactPointIndex].normal.y;
+            mContactConstraints[manifoldIndex].normal.z += mContactPoints[contactPointIndex].normal.z;
 
-            mNbContactPoints++;
+            contactPointIndex++;
 
             externalContact = externalContact->getNext();
         }
 
-        mContactConstraints[mNbContactManifolds].frictionPointBody1 /=static_cast<decimal>(mContactConstraints[mNbContactManifolds].nbContacts);
-        mContactConstraints[mNbContactManifolds].frictionPointBody2 /=static_cast<decimal>(mContactConstraints[mNbContactManifolds].nbContacts);
-        mContactConstraints[mNbContactManifolds].r1Friction.x = mContactConstraints[mNbContactManifolds].frictionPointBody1.x - x1.x;
-        mContactConstraints[mNbContactManifolds].r1Friction.y = mContactConstraints[mNbContactManifolds].frictionPointBody1.y - x1.y;
-        mContactConstraints[mNbContactManifolds].r1Friction.z = mContactConstraints[mNbContactManifolds].frictionPointBody1.z - x1.z;
-        mContactConstraints[mNbContactManifolds].r2Friction.x = mContactConstraints[mNbContactManifolds].frictionPointBody2.x - x2.x;
-        mContactConstraints[mNbContactManifolds].r2Friction.y = mContactConstraints[mNbContactManifolds].frictionPointBody2.y - x2.y;
-        mContactConstraints[mNbContactManifolds].r2Friction.z = mContactConstraints[mNbContactManifolds].frictionPointBody2.z - x2.z;
-        mContactConstraints[mNbContactManifolds].oldFrictionVector1 = externalManifold->getFrictionVector1();
-        mContactConstraints[mNbContactManifolds].oldFrictionVector2 = externalManifold->getFrictionVector2();
+        mContactConstraints[manifoldIndex].frictionPointBody1 /=static_cast<decimal>(mContactConstraints[manifoldIndex].nbContacts);
+        mContactConstraints[manifoldIndex].frictionPointBody2 /=static_cast<decimal>(mContactConstraints[manifoldIndex].nbContacts);
+        mContactConstraints[manifoldIndex].r1Friction.x = mContactConstraints[manifoldIndex].frictionPointBody1.x - x1.x;
+        mContactConstraints[manifoldIndex].r1Friction.y = mContactConstraints[manifoldIndex].frictionPointBody1.y - x1.y;
+        mContactConstraints[manifoldIndex].r1Friction.z = mContactConstraints[manifoldIndex].frictionPointBody1.z - x1.z;
+        mContactConstraints[manifoldIndex].r2Friction.x = mContactConstraints[manifoldIndex].frictionPointBody2.x - x2.x;
+        mContactConstraints[manifoldIndex].r2Friction.y = mContactConstraints[manifoldIndex].frictionPointBody2.y - x2.y;
+        mContactConstraints[manifoldIndex].r2Friction.z = mContactConstraints[manifoldIndex].frictionPointBody2.z - x2.z;
+        mContactConstraints[manifoldIndex].oldFrictionVector1 = externalManifold->getFrictionVector1();
+        mContactConstraints[manifoldIndex].oldFrictionVector2 = externalManifold->getFrictionVector2();
 
         // Initialize the accumulated impulses with the previous step accumulated impulses
-        mContactConstraints[mNbContactManifolds].friction1Impulse = externalManifold->getFrictionImpulse1();
-        mContactConstraints[mNbContactManifolds].friction2Impulse = externalManifold->getFrictionImpulse2();
-        mContactConstraints[mNbContactManifolds].frictionTwistImpulse = externalManifold->getFrictionTwistImpulse();
+        mContactConstraints[manifoldIndex].friction1Impulse = externalManifold->getFrictionImpulse1();
+        mContactConstraints[manifoldIndex].friction2Impulse = externalManifold->getFrictionImpulse2();
+        mContactConstraints[manifoldIndex].frictionTwistImpulse = externalManifold->getFrictionTwistImpulse();
 
         // Compute the inverse K matrix for the rolling resistance constraint
         bool isBody1DynamicType = body1->getType() == BodyType::DYNAMIC;
         bool isBody2DynamicType = body2->getType() == BodyType::DYNAMIC;
-        mContactConstraints[mNbContactManifolds].inverseRollingResistance.setToZero();
-        if (mContactConstraints[mNbContactManifolds].rollingResistanceFactor > 0 && (isBody1DynamicType || isBody2DynamicType)) {
+        mContactConstraints[manifoldIndex].inverseRollingResistance.setToZero();
+        if (mContactConstraints[manifoldIndex].rollingResistanceFactor > 0 && (isBody1DynamicType || isBody2DynamicType)) {
 
-            mContactConstraints[mNbContactManifolds].inverseRollingResistance = mContactConstraints[mNbContactManifolds].inverseInertiaTensorBody1 + mContactConstraints[mNbContactManifolds].inverseInertiaTensorBody2;
-            decimal det = mContactConstraints[mNbContactManifolds].inverseRollingResistance.getDeterminant();
+            mContactConstraints[manifoldIndex].inverseRollingResistance = mContactConstraints[manifoldIndex].inverseInertiaTensorBody1 + mContactConstraints[manifoldIndex].inverseInertiaTensorBody2;
+            decimal det = mContactConstraints[manifoldIndex].inverseRollingResistance.getDeterminant();
 
             // If the matrix is not inversible
             if (approxEqual(det, decimal(0.0))) {
-               mContactConstraints[mNbContactManifolds].inverseRollingResistance.setToZero();
+               mContactConstraints[manifoldIndex].inverseRollingResistance.setToZero();
             }
             else {
-               mContactConstraints[mNbContactManifolds].inverseRollingResistance = mContactConstraints[mNbContactManifolds].inverseRollingResistance.getInverse();
+               mContactConstraints[manifoldIndex].inverseRollingResistance = mContactConstraints[manifoldIndex].inverseRollingResistance.getInverse();
             }
         }
 
-        mContactConstraints[mNbContactManifolds].normal.normalize();
-
-        // deltaVFrictionPoint = v2 + w2.cross(mContactConstraints[mNbContactManifolds].r2Friction) -
-        //                              v1 - w1.cross(mContactConstraints[mNbContactManifolds].r1Friction);
-        Vector3 deltaVFrictionPoint(v2.x + w2.y * mContactConstraints[mNbContactManifolds].r2Friction.z -
-                                    w2.z * mContactConstraints[mNbContactManifolds].r2Friction.y -
-                                      v1.x - w1.y * mContactConstraints[mNbContactManifolds].r1Friction.z -
-                                      w1.z * mContactConstraints[mNbContactManifolds].r1Friction.y,
-                                   v2.y + w2.z * mContactConstraints[mNbContactManifolds].r2Friction.x -
-                                    w2.x * mContactConstraints[mNbContactManifolds].r2Friction.z -
-                                      v1.y - w1.z * mContactConstraints[mNbContactManifolds].r1Friction.x -
-                                      w1.x * mContactConstraints[mNbContactManifolds].r1Friction.z,
-                                   v2.z + w2.x * mContactConstraints[mNbContactManifolds].r2Friction.y -
-                                    w2.y * mContactConstraints[mNbContactManifolds].r2Friction.x -
-                                      v1.z - w1.x * mContactConstraints[mNbContactManifolds].r1Friction.y -
-                                      w1.y * mContactConstraints[mNbContactManifolds].r1Friction.x);
+        mContactConstraints[manifoldIndex].normal.normalize();
+
+        // deltaVFrictionPoint = v2 + w2.cross(mContactConstraints[manifoldIndex].r2Friction) -
+        //                              v1 - w1.cross(mContactConstraints[manifoldIndex].r1Friction);
+        Vector3 deltaVFrictionPoint(v2.x + w2.y * mContactConstraints[manifoldIndex].r2Friction.z -
+                                    w2.z * mContactConstraints[manifoldIndex].r2Friction.y -
+                                      v1.x - w1.y * mContactConstraints[manifoldIndex].r1Friction.z -
+                                      w1.z * mContactConstraints[manifoldIndex].r1Friction.y,
+                                   v2.y + w2.z * mContactConstraints[manifoldIndex].r2Friction.x -
+                                    w2.x * mContactConstraints[manifoldIndex].r2Friction.z -
+                                      v1.y - w1.z * mContactConstraints[manifoldIndex].r1Friction.x -
+                                      w1.x * mContactConstraints[manifoldIndex].r1Friction.z,
+                                   v2.z + w2.x * mContactConstraints[manifoldIndex].r2Friction.y -
+                                    w2.y * mContactConstraints[manifoldIndex].r2Friction.x -
+                                      v1.z - w1.x * mContactConstraints[manifoldIndex].r1Friction.y -
+                                      w1.y * mContactConstraints[manifoldIndex].r1Friction.x);
 
         // Compute the friction vectors
-        computeFrictionVectors(deltaVFrictionPoint, mContactConstraints[mNbContactManifolds]);
+        computeFrictionVectors(deltaVFrictionPoint, mContactConstraints[manifoldIndex]);
 
         // Compute the inverse mass matrix K for the friction constraints at the center of
         // the contact manifold
-        mContactConstraints[mNbContactManifolds].r1CrossT1 = mContactConstraints[mNbContactManifolds].r1Friction.cross(mContactConstraints[mNbContactManifolds].frictionVector1);
-        mContactConstraints[mNbContactManifolds].r1CrossT2 = mContactConstraints[mNbContactManifolds].r1Friction.cross(mContactConstraints[mNbContactManifolds].frictionVector2);
-        mContactConstraints[mNbContactManifolds].r2CrossT1 = mContactConstraints[mNbContactManifolds].r2Friction.cross(mContactConstraints[mNbContactManifolds].frictionVector1);
-        mContactConstraints[mNbContactManifolds].r2CrossT2 = mContactConstraints[mNbContactManifolds].r2Friction.cross(mContactConstraints[mNbContactManifolds].frictionVector2);
-        decimal friction1Mass = mContactConstraints[mNbContactManifolds].massInverseBody1 + mContactConstraints[mNbContactManifolds].massInverseBody2 +
-                                ((mContactConstraints[mNbContactManifolds].inverseInertiaTensorBody1 * mContactConstraints[mNbContactManifolds].r1CrossT1).cross(mContactConstraints[mNbContactManifolds].r1Friction)).dot(
-                                mContactConstraints[mNbContactManifolds].frictionVector1) +
-                                ((mContactConstraints[mNbContactManifolds].inverseInertiaTensorBody2 * mContactConstraints[mNbContactManifolds].r2CrossT1).cross(mContactConstraints[mNbContactManifolds].r2Friction)).dot(
-                                mContactConstraints[mNbContactManifolds].frictionVector1);
-        decimal friction2Mass = mContactConstraints[mNbContactManifolds].massInverseBody1 + mContactConstraints[mNbContactManifolds].massInverseBody2 +
-                                ((mContactConstraints[mNbContactManifolds].inverseInertiaTensorBody1 * mContactConstraints[mNbContactManifolds].r1CrossT2).cross(mContactConstraints[mNbContactManifolds].r1Friction)).dot(
-                                mContactConstraints[mNbContactManifolds].frictionVector2) +
-                                ((mContactConstraints[mNbContactManifolds].inverseInertiaTensorBody2 * mContactConstraints[mNbContactManifolds].r2CrossT2).cross(mContactConstraints[mNbContactManifolds].r2Friction)).dot(
-                                mContactConstraints[mNbContactManifolds].frictionVector2);
-        decimal frictionTwistMass = mContactConstraints[mNbContactManifolds].normal.dot(mContactConstraints[mNbContactManifolds].inverseInertiaTensorBody1 *
-                                       mContactConstraints[mNbContactManifolds].normal) +
-                                    mContactConstraints[mNbContactManifolds].normal.dot(mContactConstraints[mNbContactManifolds].inverseInertiaTensorBody2 *
-                                       mContactConstraints[mNbContactManifolds].normal);
-        mContactConstraints[mNbContactManifolds].inverseFriction1Mass = friction1Mass > decimal(0.0) ? decimal(1.0) / friction1Mass : decimal(0.0);
-        mContactConstraints[mNbContactManifolds].inverseFriction2Mass = friction2Mass > decimal(0.0) ? decimal(1.0) / friction2Mass : decimal(0.0);
-        mContactConstraints[mNbContactManifolds].inverseTwistFrictionMass = frictionTwistMass > decimal(0.0) ? decimal(1.0) / frictionTwistMass : decimal(0.0);
-
-        mNbContactManifolds++;
+        mContactConstraints[manifoldIndex].r1CrossT1 = mContactConstraints[manifoldIndex].r1Friction.cross(mContactConstraints[manifoldIndex].frictionVector1);
+        mContactConstraints[manifoldIndex].r1CrossT2 = mContactConstraints[manifoldIndex].r1Friction.cross(mContactConstraints[manifoldIndex].frictionVector2);
+        mContactConstraints[manifoldIndex].r2CrossT1 = mContactConstraints[manifoldIndex].r2Friction.cross(mContactConstraints[manifoldIndex].frictionVector1);
+        mContactConstraints[manifoldIndex].r2CrossT2 = mContactConstraints[manifoldIndex].r2Friction.cross(mContactConstraints[manifoldIndex].frictionVector2);
+        decimal friction1Mass = mContactConstraints[manifoldIndex].massInverseBody1 + mContactConstraints[manifoldIndex].massInverseBody2 +
+                                ((mContactConstraints[manifoldIndex].inverseInertiaTensorBody1 * mContactConstraints[manifoldIndex].r1CrossT1).cross(mContactConstraints[manifoldIndex].r1Friction)).dot(
+                                mContactConstraints[manifoldIndex].frictionVector1) +
+                                ((mContactConstraints[manifoldIndex].inverseInertiaTensorBody2 * mContactConstraints[manifoldIndex].r2CrossT1).cross(mContactConstraints[manifoldIndex].r2Friction)).dot(
+                                mContactConstraints[manifoldIndex].frictionVector1);
+        decimal friction2Mass = mContactConstraints[manifoldIndex].massInverseBody1 + mContactConstraints[manifoldIndex].massInverseBody2 +
+                                ((mContactConstraints[manifoldIndex].inverseInertiaTensorBody1 * mContactConstraints[manifoldIndex].r1CrossT2).cross(mContactConstraints[manifoldIndex].r1Friction)).dot(
+                                mContactConstraints[manifoldIndex].frictionVector2) +
+                                ((mContactConstraints[manifoldIndex].inverseInertiaTensorBody2 * mContactConstraints[manifoldIndex].r2CrossT2).cross(mContactConstraints[manifoldIndex].r2Friction)).dot(
+                                mContactConstraints[manifoldIndex].frictionVector2);
+        decimal frictionTwistMass = mContactConstraints[manifoldIndex].normal.dot(mContactConstraints[manifoldIndex].inverseInertiaTensorBody1 *
+                                       mContactConstraints[manifoldIndex].normal) +
+                                    mContactConstraints[manifoldIndex].normal.dot(mContactConstraints[manifoldIndex].inverseInertiaTensorBody2 *
+                                       mContactConstraints[manifoldIndex].normal);
+        mContactConstraints[manifoldIndex].inverseFriction1Mass = friction1Mass > decimal(0.0) ? decimal(1.0) / friction1Mass : decimal(0.0);
+        mContactConstraints[manifoldIndex].inverseFriction2Mass = friction2Mass > decimal(0.0) ? decimal(1.0) / friction2Mass : decimal(0.0);
+        mContactConstraints[manifoldIndex].inverseTwistFrictionMass = frictionTwistMass > decimal(0.0) ? decimal(1.0) / frictionTwistMass : decimal(0.0);
+
+        manifoldIndex++;
     }
 }
 
 // Warm start the solver.
 /// For each constraint, we apply the previous impulse (from the previous step)
 /// at the beginning. With this technique, we will converge faster towards
-/// the solution of the linear system
-void ContactSolver::warmStart() {
-
-    RP3D_PROFILE("ContactSolver::warmStart()", mProfiler);
+/// the solution of the linear system. Islands are independent so this can
+/// be called for different islands at the same time.
+void ContactSolver::warmStart(uint islandIndex) {
 
-    uint contactPointIndex = 0;
+    assert(islandIndex < mNbIslands);
+    const IslandContacts& range = mIslandContacts[islandIndex];
+    uint contactPointIndex = range.firstContactPoint;
 
     // For each constraint
-    for (uint c=0; c<mNbContactManifolds; c++) {
+    for (uint c=range.firstManifold; c<range.firstManifold + range.nbManifolds; c++) {
 
         bool atLeastOneRestingContactPoint = false;
 
@@ -482,17 +503,19 @@ void ContactSolver::warmStart() {
     }
 }
 
-// Solve the contacts
-void ContactSolver::solve() {
+// Solve the contacts of an island
+/// Islands are independent so this can be called for different islands at the same time
+void ContactSolver::solve(uint islandIndex) {
 
-    RP3D_PROFILE("ContactSolver::solve()", mProfiler);
+    assert(islandIndex < mNbIslands);
+    const IslandContacts& range = mIslandContacts[islandIndex];
 
     decimal deltaLambda;
     decimal lambdaTemp;
-    uint contactPointIndex = 0;
+    uint contactPointIndex = range.firstContactPoint;
 
     // For each contact manifold
-    for (uint c=0; c<mNbContactManifolds; c++) {
+    for (uint c=range.firstManifold; c<range.firstManifold + range.nbManifolds; c++) {
 
         decimal sumPenetrationImpulse = 0.0;
 
@@ -784,16 +807,16 @@ inline decimal ContactSolver::computeMixedRollingResistance(RigidBody* body1,
     return decimal(0.5f) * (body1->getMaterial().getRollingResistance() + body2->getMaterial().getRollingResistance());
 }
 
-// Store the computed impulses to use them to
+// Store the computed impulses of an island to use them to
 // warm start the solver at the next iteration
-void ContactSolver::storeImpulses() {
-
-    RP3D_PROFILE("ContactSolver::storeImpulses()", mProfiler);
+void ContactSolver::storeImpulses(uint islandIndex) {
 
-    uint contactPointIndex = 0;
+    assert(islandIndex < mNbIslands);
+    const IslandContacts& range = mIslandContacts[islandIndex];
+    uint contactPointIndex = range.firstContactPoint;
 
     // For each contact manifold
-    for (uint c=0; c<mNbContactManifolds; c++) {
+    for (uint c=range.firstManifold; c<range.firstManifold + range.nbManifolds; c++) {
 
         for (short int i=0; i<mContactConstraints[c].nbContacts; i++) {
 
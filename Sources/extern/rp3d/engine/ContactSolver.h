@@ -263,6 +263,24 @@ class ContactSolver {
             int8 nbContacts;
         };
 
+        // Structure IslandContacts
+        /**
+         * Range of the contact manifolds and contact points of one island
+         * in the solver arrays. Islands share no bodies so their ranges can
+         * be solved independently from each other.
+         */
+        struct IslandContacts {
+
+            /// Index of the first contact manifold of the island
+            uint firstManifold;
+
+            /// Number of contact manifolds of the island
+            uint nbManifolds;
+
+            /// Index of the first contact point of the island
+            uint firstContactPoint;
+        };
+
         // -------------------- Constants --------------------- //
 
         /// Beta value for the penetration depth position correction without split impulses
@@ -300,6 +318,15 @@ class ContactSolver {
         /// Number of contact constraints
         uint mNbContactManifolds;
 
+        /// Contact ranges of each island
+        IslandContacts* mIslandContacts;
+
+        /// Number of islands
+        uint mNbIslands;
+
+        /// Index of the zero velocity slot of the first island
+        uint mStaticVelocityIndex;
+
         /// Array of linear velocities
         Vector3* mLinearVelocities;
 
@@ -338,9 +365,6 @@ class ContactSolver {
         void computeFrictionVectors(const Vector3& deltaVelocity,
                                     ContactManifoldSolver& contactPoint) const;
 
-        /// Warm start the solver.
-        void warmStart();
-
    public:
 
         // -------------------- Methods -------------------- //
@@ -352,10 +376,10 @@ class ContactSolver {
         ~ContactSolver() = default;
 
         /// Initialize the contact constraints
-        void init(Island** islands, uint nbIslands, decimal timeStep);
+        void init(Island** islands, uint nbIslands, decimal timeStep, uint staticVelocityIndex);
 
         /// Initialize the constraint solver for a given island
-        void initializeForIsland(Island* island);
+        void initializeForIsland(Island* island, uint islandIndex);
 
         /// Set the split velocities arrays
         void setSplitVelocitiesArrays(Vector3* splitLinearVelocities,
@@ -365,12 +389,15 @@ class ContactSolver {
         void setConstrainedVelocitiesArrays(Vector3* constrainedLinearVelocities,
                                             Vector3* constrainedAngularVelocities);
 
-        /// Store the computed impulses to use them to
+        /// Warm start the solver for the contacts of an island
+        void warmStart(uint islandIndex);
+
+        /// Store the computed impulses of an island to use them to
         /// warm start the solver at the next iteration
-        void storeImpulses();
+        void storeImpulses(uint islandIndex);
 
-        /// Solve the contacts
-        void solve();
+        /// Solve the contacts of an island
+        void solve(uint islandIndex);
 
         /// Return true if the split impulses position correction technique is used for contacts
         bool isSplitImpulseActive() const;
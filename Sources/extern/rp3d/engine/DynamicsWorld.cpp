@@ -38,6 +38,9 @@
 using namespace reactphysics3d;
 using namespace std;
 
+// Constants initialization
+const uint DynamicsWorld::MIN_ISLAND_BATCH_WORK = 64;
+
 // Constructor
 /**
  * @param gravity Gravity vector in the world (in meters per second squared)
@@ -57,6 +60,7 @@ DynamicsWorld::DynamicsWorld(const Vector3& gravity, const WorldSettings& worldS
                 mConstrainedAngularVelocities(nullptr), mSplitLinearVelocities(nullptr),
                 mSplitAngularVelocities(nullptr), mConstrainedPositions(nullptr),
                 mConstrainedOrientations(nullptr), mNbIslands(0), mIslands(nullptr),
+                mParallelFor(nullptr), mNbSolverJobs(1), mNbIslandBatches(0), mIslandBatches(nullptr),
                 mSleepLinearVelocity(mConfig.defaultSleepLinearVelocity),
                 mSleepAngularVelocity(mConfig.defaultSleepAngularVelocity),
                 mTimeBeforeSleep(mConfig.defaultTimeBeforeSleep),
@@ -128,6 +132,9 @@ void DynamicsWorld::update(decimal timeStep) {
     // Compute the islands (separate groups of bodies with constraints between each others)
     computeIslands();
 
+    // Split the islands into the batches solved by each job
+    computeIslandBatches();
+
     // Integrate the velocities
     integrateRigidBodiesVelocities();
 
@@ -163,13 +170,17 @@ void DynamicsWorld::integrateRigidBodiesPositions() {
     RP3D_PROFILE("DynamicsWorld::integrateRigidBodiesPositions()", mProfiler);
     
     // For each island of the world
-    for (uint i=0; i < mNbIslands; i++) {
+    forEachIsland([this](uint i) {
 
         RigidBody** bodies = mIslands[i]->getBodies();
 
         // For each body of the island
         for (uint b=0; b < mIslands[i]->getNbBodies(); b++) {
 
+            // Static bodies can be in several islands, their constrained
+            // position is set in initVelocityArrays()
+            if (bodies[b]->getType() == BodyType::STATIC) continue;
+
             // Get the constrained velocity
             uint indexArray = bodies[b]->mArrayIndex;
             Vector3 newLinVelocity = mConstrainedLinearVelocities[indexArray];
@@ -193,7 +204,7 @@ void DynamicsWorld::integrateRigidBodiesPositions() {
                                                    Quaternion(0, newAngVelocity) *
                                                    currentOrientation * decimal(0.5) * mTimeStep;
         }
-    }
+    });
 }
 
 // Update the postion/orientation of the bodies
@@ -202,13 +213,16 @@ void DynamicsWorld::updateBodiesState() {
     RP3D_PROFILE("DynamicsWorld::updateBodiesState()", mProfiler);
 
     // For each island of the world
-    for (uint islandIndex = 0; islandIndex < mNbIslands; islandIndex++) {
+    forEachIsland([this](uint islandIndex) {
 
         // For each body of the island
         RigidBody** bodies = mIslands[islandIndex]->getBodies();
 
         for (uint b=0; b < mIslands[islandIndex]->getNbBodies(); b++) {
 
+            // Static bodies do not move
+            if (bodies[b]->getType() == BodyType::STATIC) continue;
+
             uint index = bodies[b]->mArrayIndex;
 
             // Update the linear and angular velocity of the body
@@ -226,6 +240,17 @@ void DynamicsWorld::updateBodiesState() {
 
             // Update the world inverse inertia tensor of the body
             bodies[b]->updateInertiaTensorInverseWorld();
+        }
+    });
+
+    // The broad-phase tree is shared by all the islands, so it is updated on this thread
+    for (uint islandIndex = 0; islandIndex < mNbIslands; islandIndex++) {
+
+        RigidBody** bodies = mIslands[islandIndex]->getBodies();
+
+        for (uint b=0; b < mIslands[islandIndex]->getNbBodies(); b++) {
+
+            if (bodies[b]->getType() == BodyType::STATIC) continue;
 
             // Update the broad-phase state of the body
             bodies[b]->updateBroadPhaseState();
@@ -238,17 +263,20 @@ void DynamicsWorld::initVelocityArrays() {
 
     RP3D_PROFILE("DynamicsWorld::initVelocityArrays()", mProfiler);
 
-    // Allocate memory for the bodies velocity arrays
+    // Allocate memory for the bodies velocity arrays. Each island also gets a zero
+    // velocity slot after the bodies for the contacts with static bodies, because
+    // a static body can be in several islands that are solved at the same time.
     uint nbBodies = mRigidBodies.size();
+    uint nbVelocities = nbBodies + mNbIslands;
 
     mSplitLinearVelocities = static_cast<Vector3*>(mMemoryManager.allocate(MemoryManager::AllocationType::Frame,
-                                                                           nbBodies * sizeof(Vector3)));
+                                                                           nbVelocities * sizeof(Vector3)));
     mSplitAngularVelocities = static_cast<Vector3*>(mMemoryManager.allocate(MemoryManager::AllocationType::Frame,
-                                                                            nbBodies * sizeof(Vector3)));
+                                                                            nbVelocities * sizeof(Vector3)));
     mConstrainedLinearVelocities = static_cast<Vector3*>(mMemoryManager.allocate(MemoryManager::AllocationType::Frame,
-                                                                                 nbBodies * sizeof(Vector3)));
+                                                                                 nbVelocities * sizeof(Vector3)));
     mConstrainedAngularVelocities = static_cast<Vector3*>(mMemoryManager.allocate(MemoryManager::AllocationType::Frame,
-                                                                                  nbBodies * sizeof(Vector3)));
+                                                                                  nbVelocities * sizeof(Vector3)));
     mConstrainedPositions = static_cast<Vector3*>(mMemoryManager.allocate(MemoryManager::AllocationType::Frame,
                                                                           nbBodies * sizeof(Vector3)));
     mConstrainedOrientations = static_cast<Quaternion*>(mMemoryManager.allocate(MemoryManager::AllocationType::Frame,
@@ -267,8 +295,26 @@ void DynamicsWorld::initVelocityArrays() {
         mSplitLinearVelocities[i].setToZero();
         mSplitAngularVelocities[i].setToZero();
 
+        // The state of the static bodies does not change during the step. It is
+        // only read by the joints, so it is written once here instead of by
+        // every island that contains the body.
+        if ((*it)->getType() == BodyType::STATIC) {
+            mConstrainedLinearVelocities[i].setToZero();
+            mConstrainedAngularVelocities[i].setToZero();
+            mConstrainedPositions[i] = (*it)->mCenterOfMassWorld;
+            mConstrainedOrientations[i] = (*it)->getTransform().getOrientation();
+        }
+
         (*it)->mArrayIndex = i++;
     }
+
+    // Zero velocity slots of the islands
+    for (; i < nbVelocities; i++) {
+        mSplitLinearVelocities[i].setToZero();
+        mSplitAngularVelocities[i].setToZero();
+        mConstrainedLinearVelocities[i].setToZero();
+        mConstrainedAngularVelocities[i].setToZero();
+    }
 }
 
 // Integrate the velocities of rigid bodies.
@@ -284,13 +330,16 @@ void DynamicsWorld::integrateRigidBodiesVelocities() {
     initVelocityArrays();
 
     // For each island of the world
-    for (uint i=0; i < mNbIslands; i++) {
+    forEachIsland([this](uint i) {
 
         RigidBody** bodies = mIslands[i]->getBodies();
 
         // For each body of the island
         for (uint b=0; b < mIslands[i]->getNbBodies(); b++) {
 
+            // The velocity of static bodies is set in initVelocityArrays()
+            if (bodies[b]->getType() == BodyType::STATIC) continue;
+
             // Insert the body into the map of constrained velocities
             uint indexBody = bodies[b]->mArrayIndex;
 
@@ -331,10 +380,8 @@ void DynamicsWorld::integrateRigidBodiesVelocities() {
             decimal angularDamping = pow(decimal(1.0) - angDampingFactor, mTimeStep);
             mConstrainedLinearVelocities[indexBody] *= linearDamping;
             mConstrainedAngularVelocities[indexBody] *= angularDamping;
-
-            indexBody++;
         }
-    }
+    });
 }
 
 // Solve the contacts and constraints
@@ -353,38 +400,61 @@ void DynamicsWorld::solveContactsAndConstraints() {
 
     // ---------- Solve velocity constraints for joints and contacts ---------- //
 
-    // Initialize the contact solver
-    mContactSolver.init(mIslands, mNbIslands, mTimeStep);
+    // Compute the contact ranges of the islands, their zero velocity slots
+    // come after the bodies
+    mContactSolver.init(mIslands, mNbIslands, mTimeStep, mRigidBodies.size());
 
-    // For each island of the world
+    // The islands without joints only use their own velocity slots, so they
+    // are solved in parallel
+    forEachIsland([this](uint islandIndex) {
+        if (mIslands[islandIndex]->getNbJoints() == 0) {
+            solveIslandVelocities(islandIndex);
+        }
+    });
+
+    // The joints use the shared slot of their static bodies and the constraint
+    // solver keeps the state of the island it solves, so the islands with joints
+    // are solved on this thread
     for (uint islandIndex = 0; islandIndex < mNbIslands; islandIndex++) {
+        if (mIslands[islandIndex]->getNbJoints() > 0) {
+            solveIslandVelocities(islandIndex);
+        }
+    }
+}
 
-        // Check if there are contacts and constraints to solve
-        bool isConstraintsToSolve = mIslands[islandIndex]->getNbJoints() > 0;
+// Solve the velocity constraints of the joints and contacts of an island
+/// The islands share no dynamic bodies so the result of an island does not
+/// depend on the order or the thread the islands are solved on.
+void DynamicsWorld::solveIslandVelocities(uint islandIndex) {
 
-        // If there are constraints
-        if (isConstraintsToSolve) {
+    Island* island = mIslands[islandIndex];
 
-            // Initialize the constraint solver
-            mConstraintSolver.initializeForIsland(mTimeStep, mIslands[islandIndex]);
-        }
+    // Check if there are contacts and constraints to solve
+    bool isConstraintsToSolve = island->getNbJoints() > 0;
+
+    // Initialize and warm start the contacts
+    mContactSolver.initializeForIsland(island, islandIndex);
+    mContactSolver.warmStart(islandIndex);
+
+    // If there are constraints
+    if (isConstraintsToSolve) {
+
+        // Initialize the constraint solver
+        mConstraintSolver.initializeForIsland(mTimeStep, island);
     }
 
     // For each iteration of the velocity solver
     for (uint i=0; i<mNbVelocitySolverIterations; i++) {
 
-        for (uint islandIndex = 0; islandIndex < mNbIslands; islandIndex++) {
-            // Solve the constraints
-            bool isConstraintsToSolve = mIslands[islandIndex]->getNbJoints() > 0;
-            if (isConstraintsToSolve) {
-                mConstraintSolver.solveVelocityConstraints(mIslands[islandIndex]);
-            }
+        // Solve the constraints
+        if (isConstraintsToSolve) {
+            mConstraintSolver.solveVelocityConstraints(island);
         }
 
-        mContactSolver.solve();
+        mContactSolver.solve(islandIndex);
     }
 
-    mContactSolver.storeImpulses();
+    mContactSolver.storeImpulses(islandIndex);
 }
 
 // Solve the position error correction of the constraints
@@ -398,6 +468,9 @@ void DynamicsWorld::solvePositionCorrection() {
     // For each island of the world
     for (uint islandIndex = 0; islandIndex < mNbIslands; islandIndex++) {
 
+        // Only the islands with joints have position constraints
+        if (mIslands[islandIndex]->getNbJoints() == 0) continue;
+
         // ---------- Solve the position error correction for the constraints ---------- //
 
         // For each iteration of the position (error correction) solver
@@ -806,6 +879,64 @@ void DynamicsWorld::computeIslands() {
      }
 }
 
+// Split the islands into batches of similar amount of work
+/// A batch is a range of consecutive islands, so every island is solved
+/// by one job whatever the number of batches is.
+void DynamicsWorld::computeIslandBatches() {
+
+    RP3D_PROFILE("DynamicsWorld::computeIslandBatches()", mProfiler);
+
+    // Estimate the work of the step
+    uint totalWork = 0;
+    for (uint i=0; i < mNbIslands; i++) {
+        totalWork += mIslands[i]->getNbBodies() + mIslands[i]->getNbContactManifolds() +
+                     mIslands[i]->getNbJoints();
+    }
+
+    uint nbBatches = std::min(mNbSolverJobs, std::max(totalWork / MIN_ISLAND_BATCH_WORK, uint(1)));
+    nbBatches = std::min(nbBatches, mNbIslands);
+
+    mNbIslandBatches = nbBatches;
+    mIslandBatches = static_cast<uint*>(mMemoryManager.allocate(MemoryManager::AllocationType::Frame,
+                                                                sizeof(uint) * (nbBatches + 1)));
+    mIslandBatches[0] = 0;
+    if (nbBatches == 0) return;
+
+    // Close a batch each time the work done so far reaches its share of the total
+    uint batch = 1;
+    uint work = 0;
+    for (uint i=0; i < mNbIslands && batch < nbBatches; i++) {
+        work += mIslands[i]->getNbBodies() + mIslands[i]->getNbContactManifolds() +
+                mIslands[i]->getNbJoints();
+
+        // Leave at least one island for each of the remaining batches
+        if ((std::uint64_t(work) * nbBatches >= std::uint64_t(totalWork) * batch) ||
+            (mNbIslands - (i + 1) == nbBatches - batch)) {
+            mIslandBatches[batch++] = i + 1;
+        }
+    }
+    mIslandBatches[nbBatches] = mNbIslands;
+}
+
+// Call a function for each island, one job per batch of islands
+/// The function is called from several threads at the same time, it must only
+/// modify the state of the island it is given.
+void DynamicsWorld::forEachIsland(const std::function<void(uint)>& function) {
+
+    if (mParallelFor == nullptr || mNbIslandBatches <= 1) {
+        for (uint i=0; i < mNbIslands; i++) {
+            function(i);
+        }
+        return;
+    }
+
+    mParallelFor(mNbIslandBatches, [this, &function](uint batch) {
+        for (uint i=mIslandBatches[batch]; i < mIslandBatches[batch + 1]; i++) {
+            function(i);
+        }
+    });
+}
+
 // Put bodies to sleep if needed.
 /// For each island, if all the bodies have been almost still for a long enough period of
 /// time, we put all the bodies of the island to sleep.
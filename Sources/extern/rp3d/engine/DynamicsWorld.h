@@ -32,6 +32,7 @@
 #include "configuration.h"
 #include "utils/Logger.h"
 #include "engine/ContactSolver.h"
+#include <functional>
 
 /// Namespace ReactPhysics3D
 namespace reactphysics3d {
@@ -41,6 +42,11 @@ class CollisionDetection;
 class Island;
 class RigidBody;
 
+/// Function that calls f(i) for every i in [0, count) and returns when all the
+/// calls are done. It lets the world run its islands on the job system of the
+/// application.
+using ParallelForFunction = std::function<void(uint count, const std::function<void(uint)>& f)>;
+
 // Class DynamicsWorld
 /**
  * This class represents a dynamics world. This class inherits from
@@ -51,6 +57,12 @@ class DynamicsWorld : public CollisionWorld {
 
     protected :
 
+        // -------------------- Constants --------------------- //
+
+        /// Minimum amount of work (bodies, contact manifolds and joints) in a batch
+        /// of islands, smaller batches cost more to schedule than to solve
+        static const uint MIN_ISLAND_BATCH_WORK;
+
         // -------------------- Attributes -------------------- //
 
         /// Contact solver
@@ -109,6 +121,18 @@ class DynamicsWorld : public CollisionWorld {
         /// Array with all the islands of awaken bodies
         Island** mIslands;
 
+        /// Function used to process the batches of islands in parallel
+        ParallelForFunction mParallelFor;
+
+        /// Maximum number of jobs the islands are split into
+        uint mNbSolverJobs;
+
+        /// Number of batches of islands for the current step
+        uint mNbIslandBatches;
+
+        /// Index of the first island of each batch (mNbIslandBatches + 1 entries)
+        uint* mIslandBatches;
+
         /// Sleep linear velocity threshold
         decimal mSleepLinearVelocity;
 
@@ -148,6 +172,15 @@ class DynamicsWorld : public CollisionWorld {
         /// Compute the islands of awake bodies.
         void computeIslands();
 
+        /// Split the islands into batches of similar amount of work
+        void computeIslandBatches();
+
+        /// Call a function for each island, one job per batch of islands
+        void forEachIsland(const std::function<void(uint)>& function);
+
+        /// Solve the velocity constraints of the joints and contacts of an island
+        void solveIslandVelocities(uint islandIndex);
+
         /// Update the postion/orientation of the bodies
         void updateBodiesState();
 
@@ -198,6 +231,12 @@ class DynamicsWorld : public CollisionWorld {
         /// Set the position correction technique used for joints
         void setJointsPositionCorrectionTechnique(JointsPositionCorrectionTechnique technique);
 
+        /// Set the function used to solve the islands on several threads
+        void setParallelFor(const ParallelForFunction& parallelFor, uint nbJobs);
+
+        /// Return the maximum number of jobs used to solve the islands
+        uint getNbSolverJobs() const;
+
         /// Create a rigid body into the physics world.
         RigidBody* createRigidBody(const Transform& transform);
 
@@ -340,6 +379,30 @@ inline void DynamicsWorld::setJointsPositionCorrectionTechnique(
     }
 }
 
+// Set the function used to solve the islands on several threads
+/// The islands are split into at most nbJobs batches and each batch is a job.
+/// An island is always solved by a single job in the same order, so the
+/// simulation gives the same results for any number of jobs.
+/**
+ * @param parallelFor Function that runs the jobs, or nullptr to solve on the calling thread
+ * @param nbJobs Maximum number of jobs per solver phase
+ */
+inline void DynamicsWorld::setParallelFor(const ParallelForFunction& parallelFor, uint nbJobs) {
+    mParallelFor = parallelFor;
+    mNbSolverJobs = nbJobs > 0 ? nbJobs : 1;
+
+    RP3D_LOG(mLogger, Logger::Level::Information, Logger::Category::World,
+             "Dynamics World: Set nb solver jobs to " + std::to_string(mNbSolverJobs));
+}
+
+// Return the maximum number of jobs used to solve the islands
+/**
+ * @return The maximum number of jobs per solver phase
+ */
+inline uint DynamicsWorld::getNbSolverJobs() const {
+    return mNbSolverJobs;
+}
+
 // Return the gravity vector of the world
 /**
  * @return The current gravity vector (in meter per seconds squared)